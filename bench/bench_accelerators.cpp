@@ -0,0 +1,123 @@
+// Accelerator comparison: build time, memory and closest-hit throughput of the BVH, the
+// uniform grid and the kd-tree on three kinds of scenes (an even field of particles,
+// sparse clusters, long overlapping triangles), and the structure "auto" picks for each.
+// Single-threaded, best of several runs.
+// Usage: bench_accelerators [primitives] [rays] [runs]
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "accel/Accelerator.hpp"
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
+#include "core/Scene.hpp"
+#include "entities/Sphere.hpp"
+#include "entities/Triangle.hpp"
+
+namespace {
+
+void particles(Scene& scene, int count, std::mt19937& rng) {
+    std::uniform_real_distribution<float> pos(-20.0f, 20.0f);
+    for (int i = 0; i < count; ++i)
+        scene.add(std::make_shared<Sphere>(Point3(pos(rng), pos(rng), pos(rng)), 0.1f));
+}
+
+void clusters(Scene& scene, int count, std::mt19937& rng) {
+    // Eight tight clumps of small spheres at the corners of the volume, and a few big ones
+    std::normal_distribution<float> spread(0.0f, 0.7f);
+    std::uniform_real_distribution<float> radius(0.01f, 0.08f);
+    std::uniform_real_distribution<float> pos(-20.0f, 20.0f);
+    for (int i = 0; i < count; ++i) {
+        const Point3 c((i & 1) ? 15.0f : -15.0f, (i & 2) ? 15.0f : -15.0f,
+                       (i & 4) ? 15.0f : -15.0f);
+        scene.add(std::make_shared<Sphere>(c + Vec3(spread(rng), spread(rng), spread(rng)),
+                                           radius(rng)));
+    }
+    for (int i = 0; i < 16; ++i)
+        scene.add(std::make_shared<Sphere>(Point3(pos(rng), pos(rng), pos(rng)), 3.0f));
+}
+
+void slivers(Scene& scene, int count, std::mt19937& rng) {
+    // Long thin triangles, their boxes overlapping heavily
+    std::uniform_real_distribution<float> pos(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> span(-4.0f, 4.0f);
+    std::uniform_real_distribution<float> wobble(-0.05f, 0.05f);
+    for (int i = 0; i < count; ++i) {
+        const Point3 a(pos(rng), pos(rng), pos(rng));
+        const Point3 b = a + Vec3(span(rng), span(rng), span(rng));
+        scene.add(std::make_shared<Triangle>(a, b, a + Vec3(wobble(rng), 0.1f, wobble(rng))));
+    }
+}
+
+std::vector<Ray> random_rays(int count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    std::vector<Ray> rays;
+    for (int i = 0; i < count; ++i) {
+        rays.emplace_back(Point3(20.0f * u(rng), 20.0f * u(rng), 20.0f * u(rng)),
+                          Vec3(u(rng), u(rng), u(rng)));
+    }
+    return rays;
+}
+
+/// Best time of `runs` passes over `rays`, in seconds
+double time_rays(const Scene& scene, const std::vector<Ray>& rays, int runs) {
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < runs; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        for (const Ray& ray : rays) {
+            HitRecord rec{};
+            scene.hit(ray, 0.001f, std::numeric_limits<float>::max(), rec);
+        }
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    return best;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100000;
+    const int ray_count = argc > 2 ? std::max(1, std::atoi(argv[2])) : 200000;
+    const int runs = argc > 3 ? std::max(1, std::atoi(argv[3])) : 3;
+    const std::vector<Ray> rays = random_rays(ray_count, 2);
+    std::cout << count << " primitives per scene, " << rays.size()
+              << " incoherent rays, best of " << runs << " runs" << std::endl;
+
+    const struct {
+        const char* name;
+        std::function<void(Scene&, int, std::mt19937&)> fill;
+    } scenes[] = {{"particles", particles}, {"clusters", clusters}, {"slivers", slivers}};
+    for (const auto& s : scenes) {
+        Scene scene;
+        std::mt19937 rng(1);
+        s.fill(scene, count, rng);
+
+        raylabs::Bvh::BuildOptions options;
+        options.accelerator = raylabs::Accelerator::Auto;
+        scene.build_acceleration(options);
+        std::cout << s.name << " (auto: " << raylabs::to_string(scene.accelerator()) << ")"
+                  << std::endl;
+        for (raylabs::Accelerator kind : {raylabs::Accelerator::Bvh, raylabs::Accelerator::Grid,
+                                          raylabs::Accelerator::KdTree}) {
+            options.accelerator = kind;
+            const auto start = std::chrono::steady_clock::now();
+            scene.build_acceleration(options);
+            const auto end = std::chrono::steady_clock::now();
+            const double seconds = time_rays(scene, rays, runs);
+            std::cout << "  " << raylabs::to_string(kind) << ": build "
+                      << std::chrono::duration<double, std::milli>(end - start).count()
+                      << " ms, " << static_cast<double>(scene.acceleration_bytes()) / 1048576.0
+                      << " MiB, " << static_cast<double>(rays.size()) / seconds * 1e-6
+                      << " Mrays/s" << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+// BVH construction benchmark: build time and SAH cost of the exact serial builder and of the
+// binned builder on 1, 2, 4, ... threads, over random sphere boxes.
+// Usage: bench_bvh_build [primitives] [runs] [exact=0|1]
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "accel/Bvh.hpp"
+#include "utils/ThreadPool.hpp"
+
+using namespace raylabs;
+
+namespace {
+
+template <typename Build>
+double best_ms(int runs, Build&& build) {
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < runs; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        build();
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000000;
+    const int runs = argc > 2 ? std::max(1, std::atoi(argv[2])) : 3;
+    const bool exact = argc > 3 ? std::atoi(argv[3]) != 0 : count <= 200000;
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> pos(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> radius(0.05f, 0.5f);
+    std::vector<Aabb> boxes;
+    boxes.reserve(static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        const Point3 c(pos(rng), pos(rng), pos(rng));
+        const float r = radius(rng);
+        boxes.emplace_back(c - Vec3(r, r, r), c + Vec3(r, r, r));
+    }
+    std::cout << count << " primitives, best of " << runs << " runs" << std::endl;
+
+    Bvh bvh;
+    if (exact) {
+        const double ms = best_ms(runs, [&] { bvh.build(boxes); });
+        std::cout << "  exact SAH, serial: " << ms << " ms, SAH cost " << bvh.sah_cost()
+                  << std::endl;
+    }
+    double single_ms = 0.0;
+    for (unsigned threads = 1;; threads *= 2) {
+        threads = std::min(threads, ThreadPool::default_thread_count());
+        ThreadPool pool(threads);
+        const double ms = best_ms(runs, [&] { bvh.build_binned(boxes, pool); });
+        if (threads == 1)
+            single_ms = ms;
+        std::cout << "  binned SAH, " << threads << " thread(s): " << ms << " ms (x"
+                  << single_ms / ms << "), SAH cost " << bvh.sah_cost() << std::endl;
+        if (threads == ThreadPool::default_thread_count())
+            break;
+    }
+    return 0;
+}
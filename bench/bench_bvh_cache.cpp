@@ -0,0 +1,56 @@
+// Scene setup with the on-disk BVH cache: time of Scene::build_acceleration when it builds
+// and stores the hierarchy (cold) and when it maps it back (warm), on random spheres.
+// Usage: bench_bvh_cache [spheres] [width] [cache directory]
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "accel/BvhCache.hpp"
+#include "core/Scene.hpp"
+#include "entities/Sphere.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace {
+
+void fill(Scene& scene, int count) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> pos(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> radius(0.05f, 0.5f);
+    for (int i = 0; i < count; ++i) {
+        scene.add(std::make_shared<Sphere>(Point3(pos(rng), pos(rng), pos(rng)), radius(rng)));
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000000;
+    raylabs::Bvh::BuildOptions options;
+    options.width = argc > 2 ? std::atoi(argv[2]) : 4;
+    const std::string dir =
+        argc > 3 ? argv[3]
+                 : (std::filesystem::temp_directory_path() / "raylabs_bench_bvh_cache").string();
+    std::filesystem::remove_all(dir);
+    const raylabs::BvhCache cache(dir);
+    raylabs::ThreadPool pool;
+    std::cout << count << " spheres, BVH" << options.width << ", " << pool.size()
+              << " threads, cache in " << dir << std::endl;
+
+    for (const char* run : {"cold (build + store)", "warm (mapped)"}) {
+        Scene scene;
+        fill(scene, count);
+        const auto start = std::chrono::steady_clock::now();
+        scene.build_acceleration(options, &pool, &cache);
+        const auto end = std::chrono::steady_clock::now();
+        std::cout << "  " << run << ": "
+                  << std::chrono::duration<double, std::milli>(end - start).count() << " ms"
+                  << (scene.acceleration_cached() ? ", loaded from the cache" : "") << std::endl;
+    }
+    std::filesystem::remove_all(dir);
+    return 0;
+}
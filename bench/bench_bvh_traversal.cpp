@@ -0,0 +1,110 @@
+// BVH traversal throughput: closest-hit queries per second of Scene::hit on random spheres,
+// for the binary, 4-wide and 8-wide hierarchies (the wide ones also with quantized nodes),
+// with coherent (camera) and incoherent (random) rays, and the memory of each hierarchy.
+// Single-threaded, best of several runs.
+// Usage: bench_bvh_traversal [spheres] [rays] [runs]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
+#include "core/Scene.hpp"
+#include "entities/Sphere.hpp"
+
+namespace {
+
+std::vector<Ray> camera_rays(int count) {
+    // A square grid of rays fanning out from outside the sphere cloud
+    std::vector<Ray> rays;
+    const int side = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(count))));
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            const float u = (static_cast<float>(x) + 0.5f) / static_cast<float>(side) - 0.5f;
+            const float v = (static_cast<float>(y) + 0.5f) / static_cast<float>(side) - 0.5f;
+            rays.emplace_back(Point3(0, 0, 40), Vec3(u, v, -1.2f));
+        }
+    }
+    return rays;
+}
+
+std::vector<Ray> random_rays(int count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    std::vector<Ray> rays;
+    for (int i = 0; i < count; ++i) {
+        rays.emplace_back(Point3(20.0f * u(rng), 20.0f * u(rng), 20.0f * u(rng)),
+                          Vec3(u(rng), u(rng), u(rng)));
+    }
+    return rays;
+}
+
+/// Best time of `runs` passes over `rays`, in seconds; `hits` counts the rays that hit
+double time_rays(const Scene& scene, const std::vector<Ray>& rays, int runs, int& hits) {
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < runs; ++run) {
+        hits = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (const Ray& ray : rays) {
+            HitRecord rec{};
+            if (scene.hit(ray, 0.001f, std::numeric_limits<float>::max(), rec))
+                ++hits;
+        }
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    return best;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int spheres = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100000;
+    const int ray_count = argc > 2 ? std::max(1, std::atoi(argv[2])) : 1000000;
+    const int runs = argc > 3 ? std::max(1, std::atoi(argv[3])) : 3;
+
+    Scene scene;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> pos(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> radius(0.02f, 0.2f);
+    for (int i = 0; i < spheres; ++i) {
+        scene.add(std::make_shared<Sphere>(Point3(pos(rng), pos(rng), pos(rng)), radius(rng)));
+    }
+    const std::vector<Ray> coherent = camera_rays(ray_count);
+    const std::vector<Ray> incoherent = random_rays(ray_count, 2);
+
+    std::cout << spheres << " spheres, " << coherent.size() << " coherent / "
+              << incoherent.size() << " incoherent rays, best of " << runs << " runs"
+              << std::endl;
+    const struct {
+        int width;
+        bool quantized;
+    } variants[] = {{2, false}, {4, false}, {4, true}, {8, false}, {8, true}};
+    for (const auto& variant : variants) {
+        raylabs::Bvh::BuildOptions options;
+        options.width = variant.width;
+        options.quantized = variant.quantized;
+        scene.build_acceleration(options);
+
+        int hits = 0;
+        const double t_coherent = time_rays(scene, coherent, runs, hits);
+        const int coherent_hits = hits;
+        const double t_incoherent = time_rays(scene, incoherent, runs, hits);
+        std::cout << "  BVH" << variant.width << (variant.quantized ? " quantized" : "") << " ("
+                  << static_cast<double>(scene.traversal_bytes()) / (1024.0 * 1024.0)
+                  << " MiB traversed, "
+                  << static_cast<double>(scene.acceleration_bytes()) / (1024.0 * 1024.0)
+                  << " MiB held): coherent "
+                  << static_cast<double>(coherent.size()) / t_coherent * 1e-6 << " Mrays/s ("
+                  << coherent_hits << " hits), incoherent "
+                  << static_cast<double>(incoherent.size()) / t_incoherent * 1e-6
+                  << " Mrays/s (" << hits << " hits)" << std::endl;
+    }
+    return 0;
+}
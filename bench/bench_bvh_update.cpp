@@ -0,0 +1,74 @@
+// Per-frame BVH setup cost of an animated scene: random spheres on a turntable, each frame
+// rotated by a small angle, then either refitted/updated (Scene::update_acceleration) or
+// rebuilt from scratch (Scene::build_acceleration). Reports mean milliseconds per frame.
+// Usage: bench_bvh_update [spheres] [frames] [degrees per frame]
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+
+#include "core/Scene.hpp"
+#include "entities/Sphere.hpp"
+#include "math/Transform.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace {
+
+void fill(Scene& scene, int count) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> pos(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> radius(0.02f, 0.2f);
+    for (int i = 0; i < count; ++i) {
+        scene.add(std::make_shared<Sphere>(Point3(pos(rng), pos(rng), pos(rng)), radius(rng)));
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200000;
+    const int frames = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+    const float degrees = argc > 3 ? static_cast<float>(std::atof(argv[3])) : 1.0f;
+    const auto step = raylabs::Transform::rotate_about(Point3(0, 0, 0), Vec3(0, 1, 0),
+                                                       degrees * 3.14159265f / 180.0f);
+
+    raylabs::ThreadPool pool;
+    std::cout << count << " spheres, " << frames << " frames of " << degrees << " degrees, "
+              << pool.size() << " threads" << std::endl;
+
+    for (const bool refit : {true, false}) {
+        Scene scene;
+        fill(scene, count);
+        scene.build_acceleration({}, &pool);
+        double total_ms = 0.0;
+        std::size_t rebuilt = 0;
+        float sah = 0.0f;
+        float growth = 1.0f;
+        for (int frame = 0; frame < frames; ++frame) {
+            for (std::size_t i = 0; i < scene.entities.size(); ++i)
+                scene.transform_entity(i, step);
+            const auto start = std::chrono::steady_clock::now();
+            if (refit) {
+                const raylabs::BvhUpdateStats stats = scene.update_acceleration(&pool);
+                rebuilt += stats.rebuilt_primitives;
+                sah = stats.sah_cost;
+                growth = stats.sah_growth;
+            } else {
+                scene.build_acceleration({}, &pool);
+                sah = scene.bvh().sah_cost();
+            }
+            const auto end = std::chrono::steady_clock::now();
+            total_ms += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+        std::cout << "  " << (refit ? "update " : "rebuild") << ": "
+                  << total_ms / static_cast<double>(frames) << " ms/frame, final SAH cost "
+                  << sah;
+        if (refit)
+            std::cout << " (x" << growth << " since the last full build), " << rebuilt
+                      << " primitives rebuilt in total";
+        std::cout << std::endl;
+    }
+    return 0;
+}
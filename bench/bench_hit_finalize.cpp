@@ -0,0 +1,120 @@
+// Deferred hit finalization: closest-hit throughput of a BVH traversal finalizing every
+// candidate that gets closer (Shape::hit and a HitRecord copy for each, as Scene::hit did
+// before) against the same traversal finalizing the closest candidate only, as it does now.
+// Random spheres and triangles of two densities, rays from inside the cloud; also reports how
+// many candidates per ray are accepted on the way to the closest. Single-threaded, best of
+// several runs.
+// Usage: bench_hit_finalize [primitives] [rays] [runs]
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
+#include "core/Scene.hpp"
+#include "entities/Sphere.hpp"
+#include "entities/Triangle.hpp"
+
+namespace {
+
+template <typename Trace>
+double best_mrays(int runs, std::size_t rays, Trace&& trace) {
+    double best = 0.0;
+    for (int run = 0; run < runs; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        trace();
+        const auto end = std::chrono::steady_clock::now();
+        const double s = std::chrono::duration<double>(end - start).count();
+        best = std::max(best, static_cast<double>(rays) / s / 1e6);
+    }
+    return best;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200000;
+    const int ray_count = argc > 2 ? std::max(1, std::atoi(argv[2])) : 1000000;
+    const int runs = argc > 3 ? std::max(1, std::atoi(argv[3])) : 3;
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    for (float size : {0.01f, 0.03f}) {
+        Scene scene;
+        for (int i = 0; i < count; ++i) {
+            const Point3 p(50 * u(rng), 50 * u(rng), 50 * u(rng));
+            if (i % 2 == 0) {
+                scene.add(std::make_shared<Sphere>(p, 50 * size * (1.2f + u(rng))));
+            } else {
+                const float s = 100 * size;
+                scene.add(std::make_shared<Triangle>(p, p + s * Vec3(u(rng), u(rng), u(rng)),
+                                                     p + s * Vec3(u(rng), u(rng), u(rng))));
+            }
+        }
+        scene.build_acceleration();
+        std::vector<Ray> rays;
+        for (int i = 0; i < ray_count; ++i) {
+            rays.emplace_back(Point3(40 * u(rng), 40 * u(rng), 40 * u(rng)),
+                              Vec3(u(rng), u(rng), u(rng)));
+        }
+
+        std::vector<HitRecord> records(rays.size());
+        std::size_t hits = 0, accepted = 0;
+        auto eager = [&] {
+            hits = accepted = 0;
+            for (std::size_t i = 0; i < rays.size(); ++i) {
+                const Ray& ray = rays[i];
+                HitRecord& out = records[i];
+                HitRecord temp{};
+                float closest = std::numeric_limits<float>::max();
+                const bool found = scene.bvh().intersect(
+                    ray, 0.001f, closest, [&](std::uint32_t e, float& t_max) {
+                        if (!scene.entities[e].shape->hit(ray, 0.001f, t_max, temp))
+                            return false;
+                        t_max = temp.t;
+                        out = temp;
+                        ++accepted;
+                        return true;
+                    });
+                hits += found ? 1 : 0;
+            }
+        };
+        auto deferred = [&] {
+            hits = 0;
+            for (std::size_t i = 0; i < rays.size(); ++i) {
+                const Ray& ray = rays[i];
+                PrimitiveHit prim;
+                std::uint32_t entity = 0;
+                float closest = std::numeric_limits<float>::max();
+                const bool found = scene.bvh().intersect(
+                    ray, 0.001f, closest, [&](std::uint32_t e, float& t_max) {
+                        if (!scene.entities[e].shape->intersect(ray, 0.001f, t_max, prim))
+                            return false;
+                        t_max = prim.t;
+                        entity = e;
+                        return true;
+                    });
+                if (found) {
+                    scene.entities[entity].shape->finalize(ray, prim, records[i]);
+                    ++hits;
+                }
+            }
+        };
+        const double deferred_mrays = best_mrays(runs, rays.size(), deferred);
+        const double eager_mrays = best_mrays(runs, rays.size(), eager);
+        std::cout << count << " primitives (size " << size << "), " << rays.size()
+                  << " rays, best of " << runs << " runs: " << hits << " hits, "
+                  << static_cast<double>(accepted) / static_cast<double>(hits)
+                  << " candidates accepted per hit\n"
+                  << "  finalize every candidate: " << eager_mrays << " Mrays/s\n"
+                  << "  finalize the closest:     " << deferred_mrays << " Mrays/s (x"
+                  << deferred_mrays / eager_mrays << ")" << std::endl;
+    }
+    return 0;
+}
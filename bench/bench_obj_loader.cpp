@@ -0,0 +1,110 @@
+// OBJ import: time of ObjLoader::load_from_file on a generated height-field mesh (positions,
+// normals and v//vn faces) on 1, 2, 4, ... threads, in MB/s, against a plain iostream parser
+// of the same file. The file is read once beforehand so that both start from the page cache.
+// Usage: bench_obj_loader [grid side] [runs] [file]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "io/ObjLoader.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace {
+
+template <typename Load>
+double best_ms(int runs, Load&& load) {
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < runs; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        load();
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+void write_grid(const std::string& path, int side) {
+    std::ofstream out(path);
+    out.precision(7);
+    for (int j = 0; j <= side; ++j) {
+        for (int i = 0; i <= side; ++i) {
+            const float x = static_cast<float>(i) / static_cast<float>(side);
+            const float z = static_cast<float>(j) / static_cast<float>(side);
+            out << "v " << x << ' ' << 0.1f * std::sin(20.0f * x) * std::cos(20.0f * z) << ' '
+                << z << '\n';
+            out << "vn " << -std::cos(20.0f * x) * std::cos(20.0f * z) << " 1 "
+                << std::sin(20.0f * x) * std::sin(20.0f * z) << '\n';
+        }
+    }
+    for (int j = 0; j < side; ++j) {
+        for (int i = 0; i < side; ++i) {
+            const int k = j * (side + 1) + i + 1;
+            out << "f " << k << "//" << k << ' ' << k + side + 1 << "//" << k + side + 1 << ' '
+                << k + 1 << "//" << k + 1 << '\n';
+            out << "f " << k + 1 << "//" << k + 1 << ' ' << k + side + 1 << "//" << k + side + 1
+                << ' ' << k + side + 2 << "//" << k + side + 2 << '\n';
+        }
+    }
+}
+
+/// What a straightforward importer does: getline and stream extraction, one line at a time
+std::size_t iostream_triangles(const std::string& path) {
+    std::ifstream in(path);
+    std::vector<float> positions, normals;
+    std::vector<std::uint32_t> indices;
+    std::string line, keyword, corner;
+    while (std::getline(in, line)) {
+        std::istringstream ls(line);
+        ls >> keyword;
+        if (keyword == "v" || keyword == "vn") {
+            float x, y, z;
+            ls >> x >> y >> z;
+            auto& out = keyword == "v" ? positions : normals;
+            out.insert(out.end(), {x, y, z});
+        } else if (keyword == "f") {
+            while (ls >> corner)
+                indices.push_back(static_cast<std::uint32_t>(std::stoul(corner)) - 1);
+        }
+    }
+    return indices.size() / 3;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int side = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000;
+    const int runs = argc > 2 ? std::max(1, std::atoi(argv[2])) : 3;
+    const std::string path =
+        argc > 3 ? argv[3]
+                 : (std::filesystem::temp_directory_path() / "raylabs_bench.obj").string();
+
+    write_grid(path, side);
+    const double mb = static_cast<double>(std::filesystem::file_size(path)) / 1e6;
+    std::cout << 2 * side * side << " triangles, " << mb << " MB in " << path << ", best of "
+              << runs << " runs" << std::endl;
+    std::cout << "  iostream parser: " << iostream_triangles(path) << " triangles" << std::flush;
+    const double stream_ms = best_ms(runs, [&] { iostream_triangles(path); });
+    std::cout << ", " << stream_ms << " ms (" << mb / stream_ms * 1e3 << " MB/s)" << std::endl;
+
+    for (unsigned threads = 1;; threads *= 2) {
+        threads = std::min(threads, raylabs::ThreadPool::default_thread_count());
+        raylabs::ThreadPool pool(threads);
+        const double ms = best_ms(runs, [&] { io::ObjLoader::load_from_file(path, &pool); });
+        std::cout << "  ObjLoader, " << threads << " thread(s): " << ms << " ms ("
+                  << mb / ms * 1e3 << " MB/s, x" << stream_ms / ms << ")" << std::endl;
+        if (threads == raylabs::ThreadPool::default_thread_count())
+            break;
+    }
+    if (argc <= 3)
+        std::filesystem::remove(path);
+    return 0;
+}
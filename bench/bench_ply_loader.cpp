@@ -0,0 +1,114 @@
+// PLY import: time of PlyLoader::load_from_file on a generated height-field mesh (float
+// positions and normals, triangle faces, the layout scanners write) on 1, 2, 4, ... threads,
+// against ObjLoader on the same mesh written as OBJ. Both files are read once beforehand so
+// that every load starts from the page cache.
+// Usage: bench_ply_loader [grid side] [runs]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include "io/ObjLoader.hpp"
+#include "io/PlyLoader.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace {
+
+template <typename Load>
+double best_ms(int runs, Load&& load) {
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < runs; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        load();
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    return best;
+}
+
+template <typename T>
+void put(std::ofstream& out, T value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/// The same height field as bench_obj_loader, once as binary PLY and once as OBJ
+void write_grid(const std::string& ply_path, const std::string& obj_path, int side) {
+    std::ofstream ply(ply_path, std::ios::binary), obj(obj_path);
+    obj.precision(7);
+    const int vertices = (side + 1) * (side + 1);
+    ply << "ply\nformat binary_little_endian 1.0\nelement vertex " << vertices
+        << "\nproperty float x\nproperty float y\nproperty float z\n"
+           "property float nx\nproperty float ny\nproperty float nz\n"
+           "element face "
+        << 2 * side * side << "\nproperty list uchar int vertex_indices\nend_header\n";
+    for (int j = 0; j <= side; ++j) {
+        for (int i = 0; i <= side; ++i) {
+            const float x = static_cast<float>(i) / static_cast<float>(side);
+            const float z = static_cast<float>(j) / static_cast<float>(side);
+            const float p[6] = {x, 0.1f * std::sin(20.0f * x) * std::cos(20.0f * z), z,
+                                -std::cos(20.0f * x) * std::cos(20.0f * z), 1.0f,
+                                std::sin(20.0f * x) * std::sin(20.0f * z)};
+            for (float c : p)
+                put(ply, c);
+            obj << "v " << p[0] << ' ' << p[1] << ' ' << p[2] << '\n';
+            obj << "vn " << p[3] << ' ' << p[4] << ' ' << p[5] << '\n';
+        }
+    }
+    for (int j = 0; j < side; ++j) {
+        for (int i = 0; i < side; ++i) {
+            const std::int32_t k = j * (side + 1) + i;
+            const std::int32_t faces[2][3] = {{k, k + side + 1, k + 1},
+                                              {k + 1, k + side + 1, k + side + 2}};
+            for (const auto& f : faces) {
+                put(ply, std::uint8_t(3));
+                obj << 'f';
+                for (std::int32_t v : f) {
+                    put(ply, v);
+                    obj << ' ' << v + 1 << "//" << v + 1;
+                }
+                obj << '\n';
+            }
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int side = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000;
+    const int runs = argc > 2 ? std::max(1, std::atoi(argv[2])) : 3;
+    const auto dir = std::filesystem::temp_directory_path();
+    const std::string ply = (dir / "raylabs_bench.ply").string();
+    const std::string obj = (dir / "raylabs_bench_ply.obj").string();
+
+    write_grid(ply, obj, side);
+    const double ply_mb = static_cast<double>(std::filesystem::file_size(ply)) / 1e6;
+    const double obj_mb = static_cast<double>(std::filesystem::file_size(obj)) / 1e6;
+    const double mtris = 2.0 * side * side / 1e6;
+    std::cout << 2 * side * side << " triangles, PLY " << ply_mb << " MB, OBJ " << obj_mb
+              << " MB, best of " << runs << " runs" << std::endl;
+    io::PlyLoader::load_from_file(ply);
+    io::ObjLoader::load_from_file(obj);
+
+    for (unsigned threads = 1;; threads *= 2) {
+        threads = std::min(threads, raylabs::ThreadPool::default_thread_count());
+        raylabs::ThreadPool pool(threads);
+        const double obj_ms = best_ms(runs, [&] { io::ObjLoader::load_from_file(obj, &pool); });
+        const double ply_ms = best_ms(runs, [&] { io::PlyLoader::load_from_file(ply, &pool); });
+        std::cout << "  " << threads << " thread(s): ObjLoader " << obj_ms << " ms ("
+                  << mtris / obj_ms * 1e3 << " Mtri/s), PlyLoader " << ply_ms << " ms ("
+                  << mtris / ply_ms * 1e3 << " Mtri/s, " << ply_mb / ply_ms * 1e3 << " MB/s, x"
+                  << obj_ms / ply_ms << ")" << std::endl;
+        if (threads == raylabs::ThreadPool::default_thread_count())
+            break;
+    }
+    std::filesystem::remove(ply);
+    std::filesystem::remove(obj);
+    return 0;
+}
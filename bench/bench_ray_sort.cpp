@@ -0,0 +1,77 @@
+// Secondary ray sorting in the wavefront integrator: renders a cloud of diffuse spheres
+// with and without the sort stage (--ray-sort) and reports the best wall-clock time of each.
+// Bounced rays only become incoherent after the first bounce, so use max_depth >= 4.
+// Usage: bench_ray_sort [spheres] [max_depth] [samples] [runs]
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+
+#include "core/Camera.hpp"
+#include "core/Integrator.hpp"
+#include "core/Scene.hpp"
+#include "entities/Plane.hpp"
+#include "entities/Sphere.hpp"
+#include "io/JsonSceneLoader.hpp"
+#include "materials/Lambertian.hpp"
+#include "renderer/Renderer.hpp"
+
+using namespace raylabs;
+
+int main(int argc, char* argv[]) {
+    const int spheres = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200000;
+    const int max_depth = argc > 2 ? std::max(1, std::atoi(argv[2])) : 8;
+    const int samples = argc > 3 ? std::max(1, std::atoi(argv[3])) : 4;
+    const int runs = argc > 4 ? std::max(1, std::atoi(argv[4])) : 3;
+
+    Scene scene;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> pos(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    scene.add(std::make_shared<Plane>(Point3(0, -20, 0), Vec3(0, 1, 0)),
+              std::make_shared<Lambertian>(Color(0.6f, 0.6f, 0.6f)));
+    for (int i = 0; i < spheres; ++i) {
+        scene.add(std::make_shared<Sphere>(Point3(pos(rng), pos(rng), pos(rng)),
+                                           0.05f + 0.25f * unit(rng)),
+                  std::make_shared<Lambertian>(Color(unit(rng), unit(rng), unit(rng))));
+    }
+    scene.build_acceleration();
+
+    io::ImageDTO image;
+    image.width = 320;
+    image.height = 240;
+    image.samples = samples;
+    image.max_depth = max_depth;
+    image.threads = 1;
+    image.integrator = "wavefront";
+    const Camera camera(Point3(0, 0, 45), Point3(0, 0, 0), Vec3(0, 1, 0), 50.0f,
+                        float(image.width) / float(image.height));
+
+    std::cout << spheres << " diffuse spheres, " << image.width << "x" << image.height << ", "
+              << samples << " spp, max_depth " << max_depth << ", 1 thread, best of " << runs
+              << " runs" << std::endl;
+    double baseline_ms = 0.0;
+    for (bool sort_rays : {false, true}) {
+        Renderer renderer(scene, camera, image, Integrator::create("wavefront", sort_rays));
+        double best_ms = std::numeric_limits<double>::max();
+        for (int run = 0; run < runs; ++run) {
+            // Renderer progress output is not part of the measurement
+            std::streambuf* saved = std::cout.rdbuf(nullptr);
+            const auto start = std::chrono::steady_clock::now();
+            renderer.render_frame();
+            const auto end = std::chrono::steady_clock::now();
+            std::cout.rdbuf(saved);
+            best_ms =
+                std::min(best_ms, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        if (baseline_ms == 0.0) {
+            baseline_ms = best_ms;
+        }
+        std::cout << "  " << (sort_rays ? "sorted" : "unsorted") << ": " << best_ms << " ms (x"
+                  << (baseline_ms / best_ms) << " vs unsorted)" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+// Spatial-split BVH: build time, primitive references, SAH cost and closest-hit throughput
+// of Scene::hit with object splits only and with spatial splits under a few reference
+// budgets, on a building-like scene: floor slabs, walls and long diagonal beams, all made
+// of triangles. Camera rays look into the building from outside, random rays start inside.
+// Single-threaded, BVH4, best of several runs.
+// Usage: bench_spatial_splits [floors] [rays] [runs]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
+#include "core/Scene.hpp"
+#include "entities/Triangle.hpp"
+
+namespace {
+
+void quad(Scene& scene, const Point3& p, const Vec3& u, const Vec3& v) {
+    scene.add(std::make_shared<Triangle>(p, p + u, p + u + v));
+    scene.add(std::make_shared<Triangle>(p, p + u + v, p + v));
+}
+
+/// Floors of 20 x 20 units, each a grid of slabs with walls between rooms and bracing beams
+/// running diagonally across the floor
+void building(Scene& scene, int floors) {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    for (int f = 0; f < floors; ++f) {
+        const float y = 3.0f * static_cast<float>(f);
+        for (int i = 0; i < 10; ++i) {
+            for (int j = 0; j < 10; ++j) {
+                const Point3 corner(2.0f * static_cast<float>(i), y, 2.0f * static_cast<float>(j));
+                quad(scene, corner, Vec3(2, 0, 0), Vec3(0, 0, 2));
+                if (u(rng) < 0.4f)
+                    quad(scene, corner, Vec3(2, 0, 0), Vec3(0, 3, 0));
+                if (u(rng) < 0.4f)
+                    quad(scene, corner, Vec3(0, 0, 2), Vec3(0, 3, 0));
+            }
+        }
+        for (int k = 0; k < 40; ++k) {
+            const Point3 a(20.0f * u(rng), y + 3.0f * u(rng), 20.0f * u(rng));
+            const Point3 b(20.0f * u(rng), y + 3.0f * u(rng), 20.0f * u(rng));
+            quad(scene, a, b - a, Vec3(0.0f, 0.15f, 0.0f));
+        }
+    }
+}
+
+std::vector<Ray> camera_rays(int count, float height) {
+    std::vector<Ray> rays;
+    const int side = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(count))));
+    for (int y = 0; y < side; ++y) {
+        for (int x = 0; x < side; ++x) {
+            const float s = (static_cast<float>(x) + 0.5f) / static_cast<float>(side) - 0.5f;
+            const float t = (static_cast<float>(y) + 0.5f) / static_cast<float>(side) - 0.5f;
+            rays.emplace_back(Point3(-25, 0.5f * height, -25), Vec3(1 + s, 1.5f * t, 1 - s));
+        }
+    }
+    return rays;
+}
+
+std::vector<Ray> random_rays(int count, float height, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    std::uniform_real_distribution<float> d(-1.0f, 1.0f);
+    std::vector<Ray> rays;
+    for (int i = 0; i < count; ++i) {
+        rays.emplace_back(Point3(20.0f * u(rng), height * u(rng), 20.0f * u(rng)),
+                          Vec3(d(rng), d(rng), d(rng)));
+    }
+    return rays;
+}
+
+/// Best time of `runs` passes over `rays`, in seconds
+double time_rays(const Scene& scene, const std::vector<Ray>& rays, int runs) {
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < runs; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        for (const Ray& ray : rays) {
+            HitRecord rec{};
+            scene.hit(ray, 0.001f, std::numeric_limits<float>::max(), rec);
+        }
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    return best;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int floors = argc > 1 ? std::max(1, std::atoi(argv[1])) : 40;
+    const int ray_count = argc > 2 ? std::max(1, std::atoi(argv[2])) : 500000;
+    const int runs = argc > 3 ? std::max(1, std::atoi(argv[3])) : 3;
+
+    Scene scene;
+    building(scene, floors);
+    const float height = 3.0f * static_cast<float>(floors);
+    const std::vector<Ray> camera = camera_rays(ray_count, height);
+    const std::vector<Ray> random = random_rays(ray_count, height, 9);
+    std::cout << scene.entities.size() << " triangles (" << floors << " floors), "
+              << camera.size() << " camera and " << random.size()
+              << " random rays, best of " << runs << " runs" << std::endl;
+
+    double base_camera = 0.0, base_random = 0.0;
+    for (float budget : {0.0f, 0.1f, 0.3f, 1.0f}) {
+        raylabs::Bvh::BuildOptions options;
+        options.spatial_split_budget = budget;
+        const auto start = std::chrono::steady_clock::now();
+        scene.build_acceleration(options);
+        const auto end = std::chrono::steady_clock::now();
+        const double camera_s = time_rays(scene, camera, runs);
+        const double random_s = time_rays(scene, random, runs);
+        if (budget == 0.0f) {
+            base_camera = camera_s;
+            base_random = random_s;
+        }
+        std::cout << (budget == 0.0f ? "object splits" : "spatial splits, budget ");
+        if (budget > 0.0f)
+            std::cout << budget;
+        std::cout << ": build "
+                  << std::chrono::duration<double, std::milli>(end - start).count() << " ms, "
+                  << scene.bvh().primitive_count() << " references, SAH "
+                  << scene.bvh().sah_cost(options) << ", camera "
+                  << static_cast<double>(camera.size()) / camera_s * 1e-6 << " Mrays/s (x"
+                  << base_camera / camera_s << "), random "
+                  << static_cast<double>(random.size()) / random_s * 1e-6 << " Mrays/s (x"
+                  << base_random / random_s << ")" << std::endl;
+    }
+    return 0;
+}
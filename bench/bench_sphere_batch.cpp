@@ -0,0 +1,112 @@
+// Sphere batches: a cloud of spheres as one Sphere shape each against the same spheres grouped
+// into SphereBatch shapes of SphereBatch::kWidth (16 with AVX-512, 8 with AVX2, 4 with SSE),
+// as the JSON loader does. Reports scene entities, build time (grouping included) and
+// closest-hit and shadow-ray throughput through Scene::hit / Scene::occluded, for a sparse and
+// a dense cloud with rays from inside it. Single-threaded, best of several runs.
+// Usage: bench_sphere_batch [spheres] [rays] [runs]
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
+#include "core/Scene.hpp"
+#include "entities/Sphere.hpp"
+#include "entities/SphereBatch.hpp"
+
+namespace {
+
+template <typename Trace>
+double best_mrays(int runs, std::size_t rays, Trace&& trace) {
+    double best = 0.0;
+    for (int run = 0; run < runs; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        trace();
+        const auto end = std::chrono::steady_clock::now();
+        const double s = std::chrono::duration<double>(end - start).count();
+        best = std::max(best, static_cast<double>(rays) / s / 1e6);
+    }
+    return best;
+}
+
+struct Result {
+    std::size_t entities = 0;
+    double build_ms = 0.0;
+    double hit_mrays = 0.0;
+    double shadow_mrays = 0.0;
+    std::size_t hits = 0;
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int count = argc > 1 ? std::max(1, std::atoi(argv[1])) : 200000;
+    const int ray_count = argc > 2 ? std::max(1, std::atoi(argv[2])) : 1000000;
+    const int runs = argc > 3 ? std::max(1, std::atoi(argv[3])) : 3;
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    for (float size : {0.01f, 0.03f}) {
+        std::vector<SphereBatch::Member> spheres;
+        for (int i = 0; i < count; ++i) {
+            spheres.push_back({Point3(50 * u(rng), 50 * u(rng), 50 * u(rng)),
+                               50 * size * (1.2f + u(rng)), nullptr});
+        }
+        std::vector<Ray> rays;
+        for (int i = 0; i < ray_count; ++i) {
+            rays.emplace_back(Point3(40 * u(rng), 40 * u(rng), 40 * u(rng)),
+                              Vec3(u(rng), u(rng), u(rng)));
+        }
+
+        auto measure = [&](bool batched) {
+            Result result;
+            Scene scene;
+            const auto start = std::chrono::steady_clock::now();
+            if (batched) {
+                for (const auto& batch : SphereBatch::group(spheres))
+                    scene.add(batch);
+            } else {
+                for (const auto& s : spheres)
+                    scene.add(std::make_shared<Sphere>(s.center, s.radius));
+            }
+            scene.build_acceleration();
+            const auto end = std::chrono::steady_clock::now();
+            result.entities = scene.entities.size();
+            result.build_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+            result.hit_mrays = best_mrays(runs, rays.size(), [&] {
+                result.hits = 0;
+                HitRecord rec{};
+                for (const Ray& ray : rays)
+                    result.hits += scene.hit(ray, 0.001f, 1e9f, rec) ? 1 : 0;
+            });
+            std::size_t blocked = 0;
+            result.shadow_mrays = best_mrays(runs, rays.size(), [&] {
+                blocked = 0;
+                for (const Ray& ray : rays)
+                    blocked += scene.occluded(ray, 0.001f, 10.0f) ? 1 : 0;
+            });
+            return result;
+        };
+        const Result flat = measure(false);
+        const Result batched = measure(true);
+
+        std::cout << count << " spheres (size " << size << "), " << rays.size()
+                  << " rays, best of " << runs << " runs, batches of up to "
+                  << SphereBatch::kWidth << ": " << flat.hits << " hits"
+                  << (flat.hits == batched.hits ? "" : " (MISMATCH)") << "\n"
+                  << "  separate spheres: " << flat.entities << " entities, build "
+                  << flat.build_ms << " ms, " << flat.hit_mrays << " Mrays/s closest, "
+                  << flat.shadow_mrays << " Mrays/s shadow\n"
+                  << "  sphere batches:   " << batched.entities << " entities, build "
+                  << batched.build_ms << " ms, " << batched.hit_mrays
+                  << " Mrays/s closest (x" << batched.hit_mrays / flat.hit_mrays << "), "
+                  << batched.shadow_mrays << " Mrays/s shadow (x"
+                  << batched.shadow_mrays / flat.shadow_mrays << ")" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+// Tile traversal order benchmark: renders the same frame with row-major, Morton and Hilbert
+// tile orders and reports the best wall-clock time of each.
+// Usage: bench_tile_order [scene.json] [samples] [runs]
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include "core/Camera.hpp"
+#include "core/Integrator.hpp"
+#include "core/Scene.hpp"
+#include "io/JsonSceneLoader.hpp"
+#include "renderer/Renderer.hpp"
+
+using namespace raylabs;
+
+int main(int argc, char* argv[]) {
+    try {
+        const std::string scene_file = argc > 1 ? argv[1] : "assets/scenes/multiple_spheres.json";
+        io::SceneDTO dto = io::JsonSceneLoader::load_from_file(scene_file);
+        if (argc > 2) {
+            dto.image.samples = std::max(1, std::atoi(argv[2]));
+        }
+        const int runs = argc > 3 ? std::max(1, std::atoi(argv[3])) : 3;
+        dto.image.progressive = false;
+        dto.image.adaptive = false;
+        dto.image.time_budget_ms = 0;
+
+        Scene scene;
+        Camera camera;
+        io::JsonSceneLoader::populateScene(dto, scene, camera);
+        auto integrator = Integrator::create(dto.image.integrator, dto.image.ray_sort);
+
+        std::cout << scene_file << ": " << dto.image.width << "x" << dto.image.height << ", "
+                  << dto.image.samples << " spp, best of " << runs << " runs" << std::endl;
+
+        double baseline_ms = 0.0;
+        for (const char* order : {"row", "morton", "hilbert"}) {
+            io::ImageDTO cfg = dto.image;
+            cfg.tile_order = order;
+            Renderer renderer(scene, camera, cfg, integrator);
+
+            double best_ms = std::numeric_limits<double>::max();
+            for (int run = 0; run < runs; ++run) {
+                // Renderer progress output is not part of the measurement
+                std::streambuf* saved = std::cout.rdbuf(nullptr);
+                const auto start = std::chrono::steady_clock::now();
+                renderer.render_frame();
+                const auto end = std::chrono::steady_clock::now();
+                std::cout.rdbuf(saved);
+                best_ms = std::min(
+                    best_ms, std::chrono::duration<double, std::milli>(end - start).count());
+            }
+            if (baseline_ms == 0.0) {
+                baseline_ms = best_ms;
+            }
+            std::cout << "  " << order << ": " << best_ms << " ms (x" << (baseline_ms / best_ms)
+                      << " vs row-major)" << std::endl;
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
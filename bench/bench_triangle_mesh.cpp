@@ -0,0 +1,140 @@
+// Indexed triangle mesh against separate Triangle shapes: build time, bytes per triangle and
+// closest-hit throughput of Scene::hit on a tessellated sphere (a UV sphere of 2 x n x n
+// triangles) seen from outside and from inside. The Triangle count does not include the
+// allocator's own overhead per shape. Single-threaded, best of several runs.
+// Usage: bench_triangle_mesh [subdivisions] [rays] [runs]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
+#include "core/Scene.hpp"
+#include "entities/Triangle.hpp"
+#include "entities/TriangleMesh.hpp"
+
+namespace {
+
+/// Unit sphere with n rings of n quads, with its vertex normals
+std::shared_ptr<TriangleMesh::Buffers> uv_sphere(int n) {
+    auto b = std::make_shared<TriangleMesh::Buffers>();
+    const float pi = 3.14159265f;
+    for (int j = 0; j <= n; ++j) {
+        const float theta = pi * static_cast<float>(j) / static_cast<float>(n);
+        for (int i = 0; i <= n; ++i) {
+            const float phi = 2.0f * pi * static_cast<float>(i) / static_cast<float>(n);
+            const Vec3 p(std::sin(theta) * std::cos(phi), std::cos(theta),
+                         std::sin(theta) * std::sin(phi));
+            b->x.push_back(p.x);
+            b->y.push_back(p.y);
+            b->z.push_back(p.z);
+            b->nx.push_back(p.x);
+            b->ny.push_back(p.y);
+            b->nz.push_back(p.z);
+        }
+    }
+    const auto row = static_cast<std::uint32_t>(n + 1);
+    for (std::uint32_t j = 0; j < static_cast<std::uint32_t>(n); ++j) {
+        for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(n); ++i) {
+            const std::uint32_t k = j * row + i;
+            for (std::uint32_t index : {k, k + 1, k + row, k + 1, k + row + 1, k + row})
+                b->indices.push_back(index);
+        }
+    }
+    return b;
+}
+
+std::vector<Ray> rays_from(int count, float distance, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    std::vector<Ray> rays;
+    for (int i = 0; i < count; ++i) {
+        const Vec3 origin = distance * normalize(Vec3(u(rng), u(rng), u(rng)));
+        const Vec3 target = 0.8f * Vec3(u(rng), u(rng), u(rng));
+        rays.emplace_back(Point3(origin.x, origin.y, origin.z), target - origin);
+    }
+    return rays;
+}
+
+/// Best time of `runs` passes over `rays`, in seconds
+double time_rays(const Scene& scene, const std::vector<Ray>& rays, int runs) {
+    double best = std::numeric_limits<double>::max();
+    for (int run = 0; run < runs; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        for (const Ray& ray : rays) {
+            HitRecord rec{};
+            scene.hit(ray, 0.001f, std::numeric_limits<float>::max(), rec);
+        }
+        const auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(end - start).count());
+    }
+    return best;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const int n = argc > 1 ? std::max(2, std::atoi(argv[1])) : 700;
+    const int ray_count = argc > 2 ? std::max(1, std::atoi(argv[2])) : 500000;
+    const int runs = argc > 3 ? std::max(1, std::atoi(argv[3])) : 3;
+
+    const std::shared_ptr<TriangleMesh::Buffers> buffers = uv_sphere(n);
+    const std::size_t triangles = buffers->triangle_count();
+    const std::vector<Ray> outside = rays_from(ray_count, 3.0f, 4);
+    const std::vector<Ray> inside = rays_from(ray_count, 0.5f, 5);
+    std::cout << triangles << " triangles, " << outside.size() << " rays from outside and "
+              << inside.size() << " from inside, best of " << runs << " runs" << std::endl;
+
+    auto report = [&](const char* name, const Scene& scene, double build_ms, std::size_t bytes) {
+        const double outside_s = time_rays(scene, outside, runs);
+        const double inside_s = time_rays(scene, inside, runs);
+        std::cout << name << ": build " << build_ms << " ms, "
+                  << static_cast<double>(bytes) / static_cast<double>(triangles)
+                  << " bytes/triangle, outside "
+                  << static_cast<double>(outside.size()) / outside_s * 1e-6
+                  << " Mrays/s, inside " << static_cast<double>(inside.size()) / inside_s * 1e-6
+                  << " Mrays/s" << std::endl;
+    };
+
+    {
+        // Separate shapes: one Triangle, one shared_ptr control block and one entity each
+        const auto start = std::chrono::steady_clock::now();
+        Scene scene;
+        scene.entities.reserve(triangles);
+        const TriangleMesh::Buffers& b = *buffers;
+        auto vertex = [&](std::uint32_t i) { return Point3(b.x[i], b.y[i], b.z[i]); };
+        for (std::size_t t = 0; t < triangles; ++t) {
+            scene.add(std::make_shared<Triangle>(vertex(b.indices[3 * t]),
+                                                 vertex(b.indices[3 * t + 1]),
+                                                 vertex(b.indices[3 * t + 2])));
+        }
+        scene.build_acceleration();
+        const auto end = std::chrono::steady_clock::now();
+        const std::size_t bytes =
+            triangles * (sizeof(Triangle) + 2 * sizeof(long) + sizeof(Scene::Entity)) +
+            scene.acceleration_bytes();
+        report("triangles", scene, std::chrono::duration<double, std::milli>(end - start).count(),
+               bytes);
+    }
+    {
+        const auto start = std::chrono::steady_clock::now();
+        Scene scene;
+        // Quantized BVH4, the most compact layout a mesh can use
+        raylabs::Bvh::BuildOptions options;
+        options.quantized = true;
+        auto mesh = std::make_shared<TriangleMesh>(buffers, nullptr, options);
+        scene.add(mesh);
+        scene.build_acceleration();
+        const auto end = std::chrono::steady_clock::now();
+        report("mesh", scene, std::chrono::duration<double, std::milli>(end - start).count(),
+               mesh->memory_bytes());
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <limits>
+
+#include "core/Ray.hpp"
+#include "math/Vec3.hpp"
+
+namespace raylabs {
+
+/// Slab test of the box [lo, hi] against the ray segment [tMin, tMax]; inv_dir holds
+/// 1 / direction. On a hit, t_entry is where the ray enters the box (clamped to tMin).
+inline bool slab_hit(const float lo[3], const float hi[3], const Point3& origin,
+                     const Vec3& inv_dir, float tMin, float tMax, float& t_entry) {
+    for (int axis = 0; axis < 3; ++axis) {
+        float t0 = (lo[axis] - origin[axis]) * inv_dir[axis];
+        float t1 = (hi[axis] - origin[axis]) * inv_dir[axis];
+        if (t0 > t1) {
+            const float tmp = t0;
+            t0 = t1;
+            t1 = tmp;
+        }
+        // Written so that a NaN slab (origin on the plane, zero direction) is ignored
+        tMin = t0 > tMin ? t0 : tMin;
+        tMax = t1 < tMax ? t1 : tMax;
+        if (tMax < tMin)
+            return false;
+    }
+    t_entry = tMin;
+    return true;
+}
+
+/// Axis-aligned bounding box. Default-constructed boxes are empty (min > max) so that
+/// expanding them by a point or another box yields exactly that point or box.
+struct Aabb {
+    Point3 min{std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(),
+               std::numeric_limits<float>::infinity()};
+    Point3 max{-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+               -std::numeric_limits<float>::infinity()};
+
+    Aabb() = default;
+    Aabb(const Point3& lo, const Point3& hi) : min(lo), max(hi) {}
+
+    /// Box of shapes without finite bounds (planes)
+    static Aabb unbounded() {
+        constexpr float inf = std::numeric_limits<float>::infinity();
+        return Aabb(Point3(-inf, -inf, -inf), Point3(inf, inf, inf));
+    }
+
+    bool is_empty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+    /// False for empty boxes and boxes reaching infinity
+    bool is_bounded() const {
+        constexpr float big = std::numeric_limits<float>::max();
+        return !is_empty() && min.x >= -big && min.y >= -big && min.z >= -big && max.x <= big &&
+               max.y <= big && max.z <= big;
+    }
+
+    void expand(const Point3& p) {
+        min = Point3(p.x < min.x ? p.x : min.x, p.y < min.y ? p.y : min.y,
+                     p.z < min.z ? p.z : min.z);
+        max = Point3(p.x > max.x ? p.x : max.x, p.y > max.y ? p.y : max.y,
+                     p.z > max.z ? p.z : max.z);
+    }
+
+    void expand(const Aabb& b) {
+        if (b.is_empty())
+            return;
+        expand(b.min);
+        expand(b.max);
+    }
+
+    Point3 centroid() const { return 0.5f * (min + max); }
+    Vec3 extent() const { return max - min; }
+
+    /// Half of the surface area (the SAH only uses ratios); 0 for empty boxes
+    float half_area() const {
+        if (is_empty())
+            return 0.0f;
+        const Vec3 e = extent();
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+
+    /// Index of the longest axis (0 = x, 1 = y, 2 = z)
+    int longest_axis() const {
+        const Vec3 e = extent();
+        if (e.x >= e.y && e.x >= e.z)
+            return 0;
+        return e.y >= e.z ? 1 : 2;
+    }
+
+    /// Slab test against the ray segment [tMin, tMax]; inv_dir holds 1 / direction.
+    /// On a hit, t_entry is where the ray enters the box (clamped to tMin).
+    bool hit(const Point3& origin, const Vec3& inv_dir, float tMin, float tMax,
+             float& t_entry) const;
+};
+
+inline bool Aabb::hit(const Point3& origin, const Vec3& inv_dir, float tMin, float tMax,
+                      float& t_entry) const {
+    const float lo[3] = {min.x, min.y, min.z};
+    const float hi[3] = {max.x, max.y, max.z};
+    return slab_hit(lo, hi, origin, inv_dir, tMin, tMax, t_entry);
+}
+
+inline Aabb merge(Aabb a, const Aabb& b) {
+    a.expand(b);
+    return a;
+}
+
+/// Common part of two boxes (empty if they are disjoint)
+inline Aabb intersection(const Aabb& a, const Aabb& b) {
+    return Aabb(Point3(a.min.x > b.min.x ? a.min.x : b.min.x, a.min.y > b.min.y ? a.min.y : b.min.y,
+                       a.min.z > b.min.z ? a.min.z : b.min.z),
+                Point3(a.max.x < b.max.x ? a.max.x : b.max.x, a.max.y < b.max.y ? a.max.y : b.max.y,
+                       a.max.z < b.max.z ? a.max.z : b.max.z));
+}
+
+}  // namespace raylabs
@@ -0,0 +1,104 @@
+#include "accel/Accelerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace raylabs {
+
+Accelerator accelerator_from_string(const std::string& name) {
+    if (name == "bvh")
+        return Accelerator::Bvh;
+    if (name == "grid")
+        return Accelerator::Grid;
+    if (name == "kdtree")
+        return Accelerator::KdTree;
+    if (name == "auto")
+        return Accelerator::Auto;
+    throw std::runtime_error("Unknown accelerator '" + name +
+                             "' (expected 'bvh', 'grid', 'kdtree' or 'auto')");
+}
+
+const char* to_string(Accelerator accelerator) {
+    switch (accelerator) {
+        case Accelerator::Grid:
+            return "grid";
+        case Accelerator::KdTree:
+            return "kdtree";
+        case Accelerator::Auto:
+            return "auto";
+        default:
+            return "bvh";
+    }
+}
+
+SceneStatistics measure_scene(const std::vector<Aabb>& bounds) {
+    SceneStatistics stats;
+    stats.count = bounds.size();
+    if (bounds.empty())
+        return stats;
+
+    Aabb scene;
+    double sum = 0.0;
+    double sum_squared = 0.0;
+    double volume = 0.0;
+    for (const Aabb& box : bounds) {
+        scene.expand(box);
+        const Vec3 e = box.extent();
+        const double size = std::max(e.x, std::max(e.y, e.z));
+        sum += size;
+        sum_squared += size * size;
+        volume += static_cast<double>(e.x) * e.y * e.z;
+    }
+    const double n = static_cast<double>(bounds.size());
+    const double mean = sum / n;
+    const double variance = std::max(0.0, sum_squared / n - mean * mean);
+    stats.size_variation = mean > 0.0 ? static_cast<float>(std::sqrt(variance) / mean) : 0.0f;
+
+    // Flat scenes get a thin slab rather than a zero volume
+    const Vec3 extent = scene.extent();
+    const float pad = 1e-3f * std::max(extent.x, std::max(extent.y, extent.z));
+    const float ex = std::max(extent.x, pad), ey = std::max(extent.y, pad),
+                ez = std::max(extent.z, pad);
+    const double scene_volume = static_cast<double>(ex) * ey * ez;
+    stats.overlap = scene_volume > 0.0 ? static_cast<float>(volume / scene_volume) : 0.0f;
+
+    // Cubic cells, about one per primitive, at most 64 per axis
+    const double cell = std::cbrt(scene_volume / std::min(n, 64.0 * 64.0 * 64.0));
+    int res[3];
+    const float ext[3] = {ex, ey, ez};
+    for (int axis = 0; axis < 3; ++axis)
+        res[axis] = std::clamp(static_cast<int>(ext[axis] / cell), 1, 64);
+    std::vector<std::uint8_t> filled(static_cast<std::size_t>(res[0]) * res[1] * res[2], 0);
+    for (const Aabb& box : bounds) {
+        const Point3 c = box.centroid();
+        int cell_index[3];
+        for (int axis = 0; axis < 3; ++axis) {
+            const float u = (c[axis] - scene.min[axis]) / ext[axis];
+            cell_index[axis] = std::clamp(static_cast<int>(u * res[axis]), 0, res[axis] - 1);
+        }
+        filled[(static_cast<std::size_t>(cell_index[2]) * res[1] + cell_index[1]) * res[0] +
+               cell_index[0]] = 1;
+    }
+    std::size_t occupied = 0;
+    for (std::uint8_t f : filled)
+        occupied += f;
+    // A uniform random field fills 1 - 1/e of the cells at one point per cell; rescale so
+    // that it scores about 1
+    const double expected = 1.0 - std::exp(-n / static_cast<double>(filled.size()));
+    stats.occupancy = static_cast<float>(
+        std::min(1.0, static_cast<double>(occupied) / static_cast<double>(filled.size()) /
+                          expected));
+    return stats;
+}
+
+Accelerator choose_accelerator(const SceneStatistics& stats) {
+    if (stats.count < 1024)
+        return Accelerator::Bvh;
+    if (stats.size_variation < 0.5f && stats.occupancy > 0.6f && stats.overlap < 1.0f)
+        return Accelerator::Grid;
+    return Accelerator::Bvh;
+}
+
+}  // namespace raylabs
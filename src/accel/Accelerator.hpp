@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "accel/Aabb.hpp"
+
+namespace raylabs {
+
+/// Spatial structures Scene can build over its bounded entities. They all offer the same
+/// closest-hit traversal, `intersect(ray, tMin, tMax, hit_prim)` (see Bvh::intersect()):
+/// `hit_prim(index, tMax)` is called for the primitives the ray may hit, returns true and
+/// shrinks tMax on a closer hit, and the traversal stops once nothing left can beat tMax.
+enum class Accelerator {
+    Bvh,     // bounding volume hierarchy (binary, wide or quantized, see BvhBuildOptions)
+    Grid,    // uniform grid walked with a 3D DDA (UniformGrid)
+    KdTree,  // SAH kd-tree (KdTree)
+    Auto,    // one of the above, picked from the scene statistics (choose_accelerator())
+};
+
+/// "bvh", "grid", "kdtree" or "auto"; throws std::runtime_error for anything else
+Accelerator accelerator_from_string(const std::string& name);
+const char* to_string(Accelerator accelerator);
+
+/// What choose_accelerator() looks at, measured over the primitive boxes
+struct SceneStatistics {
+    std::size_t count = 0;
+    // Coefficient of variation (deviation / mean) of the largest extent of the boxes:
+    // near 0 for particles of similar size, well above 1 when big and tiny ones mix
+    float size_variation = 0.0f;
+    // Fraction of the cells of a coarse grid over the scene box (about one per primitive)
+    // that contain a box centroid: near 1 for evenly filled volumes, low for sparse or
+    // clustered geometry
+    float occupancy = 0.0f;
+    // Sum of the box volumes over the scene volume: above 1, the boxes overlap heavily
+    float overlap = 0.0f;
+};
+
+SceneStatistics measure_scene(const std::vector<Aabb>& bounds);
+
+/// Grid for many primitives of similar size spread through the whole volume, where it
+/// needs no hierarchy to skip empty space; BVH otherwise (sparse, clustered or uneven
+/// scenes, and small ones). The kd-tree is never picked: it did not beat the BVH on any
+/// scene of bench_accelerators, heavily overlapping ones included. Never returns
+/// Accelerator::Auto.
+Accelerator choose_accelerator(const SceneStatistics& stats);
+
+}  // namespace raylabs
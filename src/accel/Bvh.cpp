@@ -0,0 +1,1060 @@
+#include "accel/Bvh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "utils/ThreadPool.hpp"
+
+namespace raylabs {
+
+namespace {
+
+struct BuildRef {
+    Aabb bounds;
+    Point3 centroid;
+    std::uint32_t index;
+};
+
+/// Node range of the work list: refs [begin, end) go into nodes[node]
+struct BuildTask {
+    std::uint32_t node;
+    std::size_t begin, end;
+    int depth;
+};
+
+/// Ranges larger than this build their two subtrees as separate tasks
+constexpr std::size_t kParallelSubtree = 4096;
+/// Refs per task when a single range is binned in parallel
+constexpr std::size_t kParallelChunk = 16384;
+constexpr int kMaxBins = 64;
+
+/// Box of the primitives and box of their centroids over a ref range
+struct RangeBounds {
+    Aabb bounds;
+    Aabb centroids;
+};
+
+/// Bin of the binned SAH. Plain floats (no initializers) so that declaring a set of bins
+/// costs nothing; reset() the ones in use.
+struct Bin {
+    float lo[3], hi[3];    // primitive boxes
+    float clo[3], chi[3];  // centroids
+    std::uint32_t count;
+
+    void reset() {
+        constexpr float inf = std::numeric_limits<float>::infinity();
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = clo[a] = inf;
+            hi[a] = chi[a] = -inf;
+        }
+        count = 0;
+    }
+
+    void add(const BuildRef& ref) {
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], ref.bounds.min[a]);
+            hi[a] = std::max(hi[a], ref.bounds.max[a]);
+            clo[a] = std::min(clo[a], ref.centroid[a]);
+            chi[a] = std::max(chi[a], ref.centroid[a]);
+        }
+        ++count;
+    }
+
+    void merge(const Bin& other) {
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], other.lo[a]);
+            hi[a] = std::max(hi[a], other.hi[a]);
+            clo[a] = std::min(clo[a], other.clo[a]);
+            chi[a] = std::max(chi[a], other.chi[a]);
+        }
+        count += other.count;
+    }
+
+    float half_area() const {
+        if (count == 0)
+            return 0.0f;
+        const float dx = hi[0] - lo[0];
+        const float dy = hi[1] - lo[1];
+        const float dz = hi[2] - lo[2];
+        return dx * dy + dy * dz + dz * dx;
+    }
+
+    RangeBounds range() const {
+        if (count == 0)
+            return {};
+        return {Aabb(Point3(lo[0], lo[1], lo[2]), Point3(hi[0], hi[1], hi[2])),
+                Aabb(Point3(clo[0], clo[1], clo[2]), Point3(chi[0], chi[1], chi[2]))};
+    }
+};
+
+void set_bounds(Bvh::Node& node, const Aabb& box) {
+    node.min[0] = box.min.x;
+    node.min[1] = box.min.y;
+    node.min[2] = box.min.z;
+    node.max[0] = box.max.x;
+    node.max[1] = box.max.y;
+    node.max[2] = box.max.z;
+}
+
+/// Depth at which the builders make a leaf of whatever is left
+int depth_limit(const BvhBuildOptions& options) {
+    return std::clamp(options.max_depth, 0, Bvh::kMaxDepth);
+}
+
+}  // namespace
+
+void check_build_options(const BvhBuildOptions& options) {
+    if (options.width != 2 && options.width != 4 && options.width != 8) {
+        throw std::runtime_error("BVH width must be 2, 4 or 8, got " +
+                                 std::to_string(options.width));
+    }
+    if (options.quantized && options.width == 2)
+        throw std::runtime_error("Quantized BVH nodes need a width of 4 or 8");
+    if (options.spatial_split_budget < 0.0f)
+        throw std::runtime_error("The spatial split budget must be >= 0");
+}
+
+void Bvh::clear() {
+    nodes_.clear();
+    indices_.clear();
+    built_area_.clear();
+    built_sah_ = 0.0f;
+    garbage_ = 0;
+}
+
+void Bvh::adopt(FlatArray<Node> nodes, FlatArray<std::uint32_t> indices, float built_sah) {
+    clear();
+    nodes_ = std::move(nodes);
+    indices_ = std::move(indices);
+    // The node areas update() compares against are recorded on the first refit
+    built_sah_ = built_sah;
+}
+
+void Bvh::build(const std::vector<Aabb>& bounds, const BuildOptions& options) {
+    clear();
+    if (bounds.empty())
+        return;
+
+    std::vector<BuildRef> refs(bounds.size());
+    for (std::size_t i = 0; i < bounds.size(); ++i) {
+        refs[i] = {bounds[i], bounds[i].centroid(), static_cast<std::uint32_t>(i)};
+    }
+    const std::size_t max_leaf = static_cast<std::size_t>(std::max(1, options.max_leaf_size));
+    const int max_depth = depth_limit(options);
+
+    nodes_.reserve(2 * refs.size());
+    nodes_.push_back(Node{});
+    std::vector<BuildTask> work{{0, 0, refs.size(), 0}};
+    std::vector<float> right_area(refs.size());
+
+    while (!work.empty()) {
+        const BuildTask task = work.back();
+        work.pop_back();
+        const std::size_t count = task.end - task.begin;
+
+        Aabb box;
+        for (std::size_t i = task.begin; i < task.end; ++i) {
+            box.expand(refs[i].bounds);
+        }
+        set_bounds(nodes_[task.node], box);
+
+        auto make_leaf = [&] {
+            nodes_[task.node].offset = static_cast<std::uint32_t>(task.begin);
+            nodes_[task.node].count = static_cast<std::uint32_t>(count);
+        };
+        if (count == 1 || task.depth >= max_depth) {
+            make_leaf();
+            continue;
+        }
+
+        // Exact SAH sweep: for every axis, sort by centroid and evaluate every split position
+        const float parent_area = std::max(box.half_area(), 1e-20f);
+        float best_cost = std::numeric_limits<float>::infinity();
+        int best_axis = -1;
+        std::size_t best_split = 0;
+        for (int axis = 0; axis < 3; ++axis) {
+            std::sort(refs.begin() + static_cast<std::ptrdiff_t>(task.begin),
+                      refs.begin() + static_cast<std::ptrdiff_t>(task.end),
+                      [axis](const BuildRef& a, const BuildRef& b) {
+                          return a.centroid[axis] < b.centroid[axis];
+                      });
+            Aabb right;
+            for (std::size_t i = task.end - 1; i > task.begin; --i) {
+                right.expand(refs[i].bounds);
+                right_area[i] = right.half_area();
+            }
+            Aabb left;
+            for (std::size_t i = task.begin + 1; i < task.end; ++i) {
+                left.expand(refs[i - 1].bounds);
+                const float cost =
+                    options.traversal_cost +
+                    options.intersection_cost *
+                        (left.half_area() * static_cast<float>(i - task.begin) +
+                         right_area[i] * static_cast<float>(task.end - i)) /
+                        parent_area;
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_split = i;
+                }
+            }
+        }
+
+        const float leaf_cost = options.intersection_cost * static_cast<float>(count);
+        if (count <= max_leaf && leaf_cost <= best_cost) {
+            make_leaf();
+            continue;
+        }
+        if (best_axis < 0) {
+            // Degenerate boxes (NaN areas): split the range in the middle
+            best_axis = box.longest_axis();
+            best_split = task.begin + count / 2;
+        }
+        if (best_axis != 2) {
+            std::sort(refs.begin() + static_cast<std::ptrdiff_t>(task.begin),
+                      refs.begin() + static_cast<std::ptrdiff_t>(task.end),
+                      [best_axis](const BuildRef& a, const BuildRef& b) {
+                          return a.centroid[best_axis] < b.centroid[best_axis];
+                      });
+        }
+
+        const auto left_child = static_cast<std::uint32_t>(nodes_.size());
+        nodes_[task.node].offset = left_child;
+        nodes_[task.node].count = 0;
+        nodes_.push_back(Node{});
+        nodes_.push_back(Node{});
+        // The left task is popped first, so the tree is laid out depth-first
+        work.push_back({left_child + 1, best_split, task.end, task.depth + 1});
+        work.push_back({left_child, task.begin, best_split, task.depth + 1});
+    }
+
+    indices_.resize(refs.size());
+    for (std::size_t i = 0; i < refs.size(); ++i) {
+        indices_[i] = refs[i].index;
+    }
+    finish_build(options);
+}
+
+/// Binned SAH builder. Nodes are allocated from an atomic counter by whichever task gets
+/// there first, then renumbered depth-first at the end so the layout matches build().
+struct Bvh::BinnedBuilder {
+    /// Best bin boundary of a range: refs whose centroid falls in a lower bin go left
+    struct Split {
+        Point3 lo;
+        float scale[3];
+        int bins = 2;  // fewer than BuildOptions::sah_bins for small ranges
+        int axis = -1;
+        int bin = 0;
+        float cost = std::numeric_limits<float>::infinity();
+        RangeBounds left, right;
+
+        int bin_of(const Point3& c, int a) const {
+            const int b = static_cast<int>((c[a] - lo[a]) * scale[a]);
+            return std::clamp(b, 0, bins - 1);
+        }
+    };
+    using Bins = std::array<std::array<Bin, kMaxBins>, 3>;
+
+    ThreadPool& pool;
+    const BuildOptions& options;
+    std::vector<BuildRef> refs;
+    std::vector<Node> nodes;
+    std::atomic<std::uint32_t> next_node{1};
+    std::size_t max_leaf = 1;
+    int bins = 2;
+
+    BinnedBuilder(ThreadPool& p, const BuildOptions& o) : pool(p), options(o) {}
+
+    std::size_t chunk_count(std::size_t count) const {
+        return count <= 2 * kParallelChunk ? 1 : (count + kParallelChunk - 1) / kParallelChunk;
+    }
+
+    /// Run body(chunk, begin, end) over [begin, end) cut in chunk_count() chunks, on the pool
+    /// when there is more than one
+    template <typename Body>
+    void for_chunks(std::size_t begin, std::size_t end, Body&& body) {
+        const std::size_t count = end - begin;
+        const std::size_t chunks = chunk_count(count);
+        if (chunks == 1) {
+            body(0, begin, end);
+            return;
+        }
+        pool.parallel_for(chunks, [&](std::size_t c) {
+            body(c, begin + c * count / chunks, begin + (c + 1) * count / chunks);
+        });
+    }
+
+    /// Bounds of a range by scanning it (the root, and the halves of a median split)
+    RangeBounds range_bounds(std::size_t begin, std::size_t end) {
+        std::vector<Bin> partial(chunk_count(end - begin));
+        for_chunks(begin, end, [&](std::size_t c, std::size_t b, std::size_t e) {
+            partial[c].reset();
+            for (std::size_t i = b; i < e; ++i)
+                partial[c].add(refs[i]);
+        });
+        for (std::size_t c = 1; c < partial.size(); ++c)
+            partial[0].merge(partial[c]);
+        return partial[0].range();
+    }
+
+    Split find_split(std::size_t begin, std::size_t end, const RangeBounds& range) {
+        const std::size_t count = end - begin;
+        Split split;
+        split.lo = range.centroids.min;
+        split.bins = static_cast<int>(
+            std::clamp<std::size_t>(count, 2, static_cast<std::size_t>(bins)));
+        const Vec3 extent = range.centroids.extent();
+        for (int axis = 0; axis < 3; ++axis) {
+            // Flat axes put everything in bin 0 and never yield a split
+            split.scale[axis] =
+                extent[axis] > 0.0f ? static_cast<float>(split.bins) / extent[axis] : 0.0f;
+        }
+
+        auto fill = [&](Bins& local, std::size_t b, std::size_t e) {
+            for (auto& axis_bins : local) {
+                for (int k = 0; k < split.bins; ++k)
+                    axis_bins[k].reset();
+            }
+            for (std::size_t i = b; i < e; ++i) {
+                for (int axis = 0; axis < 3; ++axis)
+                    local[axis][split.bin_of(refs[i].centroid, axis)].add(refs[i]);
+            }
+        };
+        Bins binned;
+        if (chunk_count(count) == 1) {
+            fill(binned, begin, end);
+        } else {
+            std::vector<Bins> partial(chunk_count(count));
+            for_chunks(begin, end, [&](std::size_t c, std::size_t b, std::size_t e) {
+                fill(partial[c], b, e);
+            });
+            binned = partial[0];
+            for (std::size_t c = 1; c < partial.size(); ++c) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    for (int k = 0; k < split.bins; ++k)
+                        binned[axis][k].merge(partial[c][axis][k]);
+                }
+            }
+        }
+
+        // SAH sweep over the bin boundaries
+        const float parent_area = std::max(range.bounds.half_area(), 1e-20f);
+        for (int axis = 0; axis < 3; ++axis) {
+            if (split.scale[axis] == 0.0f)
+                continue;
+            const auto& axis_bins = binned[axis];
+            std::array<float, kMaxBins> right_area;
+            Bin right;
+            right.reset();
+            for (int k = split.bins - 1; k > 0; --k) {
+                right.merge(axis_bins[k]);
+                right_area[k] = right.half_area();
+            }
+            Bin left;
+            left.reset();
+            for (int k = 1; k < split.bins; ++k) {
+                left.merge(axis_bins[k - 1]);
+                const std::uint32_t right_n = static_cast<std::uint32_t>(count) - left.count;
+                if (left.count == 0 || right_n == 0)
+                    continue;
+                const float cost = options.traversal_cost +
+                                   options.intersection_cost *
+                                       (left.half_area() * static_cast<float>(left.count) +
+                                        right_area[k] * static_cast<float>(right_n)) /
+                                       parent_area;
+                if (cost < split.cost) {
+                    split.cost = cost;
+                    split.axis = axis;
+                    split.bin = k;
+                }
+            }
+        }
+
+        // The children's bounds come with the bins
+        if (split.axis >= 0) {
+            Bin left, right;
+            left.reset();
+            right.reset();
+            for (int k = 0; k < split.bins; ++k)
+                (k < split.bin ? left : right).merge(binned[split.axis][k]);
+            split.left = left.range();
+            split.right = right.range();
+        }
+        return split;
+    }
+
+    void build(std::uint32_t node, std::size_t begin, std::size_t end, const RangeBounds& range,
+               int depth) {
+        const std::size_t count = end - begin;
+        set_bounds(nodes[node], range.bounds);
+
+        auto make_leaf = [&] {
+            nodes[node].offset = static_cast<std::uint32_t>(begin);
+            nodes[node].count = static_cast<std::uint32_t>(count);
+        };
+        if (count == 1 || depth >= depth_limit(options)) {
+            make_leaf();
+            return;
+        }
+
+        Split split = find_split(begin, end, range);
+        const float leaf_cost = options.intersection_cost * static_cast<float>(count);
+        if (count <= max_leaf && leaf_cost <= split.cost) {
+            make_leaf();
+            return;
+        }
+        std::size_t middle;
+        if (split.axis >= 0) {
+            const auto it = std::partition(
+                refs.begin() + static_cast<std::ptrdiff_t>(begin),
+                refs.begin() + static_cast<std::ptrdiff_t>(end),
+                [&](const BuildRef& r) { return split.bin_of(r.centroid, split.axis) < split.bin; });
+            middle = static_cast<std::size_t>(it - refs.begin());
+        } else {
+            // Every centroid in the same spot: split the range in the middle
+            middle = begin + count / 2;
+            split.left = range_bounds(begin, middle);
+            split.right = range_bounds(middle, end);
+        }
+
+        const std::uint32_t left_child = next_node.fetch_add(2, std::memory_order_relaxed);
+        nodes[node].offset = left_child;
+        nodes[node].count = 0;
+        if (count > kParallelSubtree) {
+            pool.parallel_for(2, [&](std::size_t side) {
+                if (side == 0)
+                    build(left_child, begin, middle, split.left, depth + 1);
+                else
+                    build(left_child + 1, middle, end, split.right, depth + 1);
+            });
+        } else {
+            build(left_child, begin, middle, split.left, depth + 1);
+            build(left_child + 1, middle, end, split.right, depth + 1);
+        }
+    }
+};
+
+void Bvh::build_binned(const std::vector<Aabb>& bounds, ThreadPool& pool,
+                       const BuildOptions& options) {
+    clear();
+    if (bounds.empty())
+        return;
+
+    BinnedBuilder builder(pool, options);
+    builder.max_leaf = static_cast<std::size_t>(std::max(1, options.max_leaf_size));
+    builder.bins = std::clamp(options.sah_bins, 2, kMaxBins);
+    builder.refs.resize(bounds.size());
+    builder.for_chunks(0, bounds.size(), [&](std::size_t, std::size_t b, std::size_t e) {
+        for (std::size_t i = b; i < e; ++i) {
+            builder.refs[i] = {bounds[i], bounds[i].centroid(), static_cast<std::uint32_t>(i)};
+        }
+    });
+    // A binary tree over n primitives has at most 2n - 1 nodes
+    builder.nodes.resize(2 * bounds.size() - 1);
+    builder.build(0, 0, bounds.size(), builder.range_bounds(0, bounds.size()), 0);
+
+    builder.nodes.resize(builder.next_node.load());
+    nodes_ = std::move(builder.nodes);
+    // Renumber depth-first, the two children of a node next to each other
+    compact();
+
+    indices_.resize(builder.refs.size());
+    for (std::size_t i = 0; i < builder.refs.size(); ++i) {
+        indices_[i] = builder.refs[i].index;
+    }
+    finish_build(options);
+}
+
+/// Spatial-split builder. Every node owns its list of references (a primitive straddling a
+/// spatial split is copied into both children, with a clipped box), and the nodes are
+/// allocated in pairs as the recursion goes, left subtree first: the layout matches build()
+/// and the references of every subtree are contiguous in indices_, which update() relies on.
+struct Bvh::SpatialBuilder {
+    /// Best split of a node: a bin boundary of the centroids (object) or of space (spatial)
+    struct Split {
+        int axis = -1;
+        int bin = 0;
+        float cost = std::numeric_limits<float>::infinity();
+        // Boxes and references of the children (a straddling reference counts on both
+        // sides of a spatial split)
+        Aabb left, right;
+        std::size_t left_count = 0, right_count = 0;
+    };
+
+    /// Spatial bin: clipped boxes of the references in the slab, and how many start or end
+    /// in it
+    struct SpatialBin {
+        Aabb bounds;
+        std::size_t entries = 0, exits = 0;
+    };
+
+    const BuildOptions& options;
+    const ClipFunction& clip;
+    FlatArray<Node>& nodes;
+    FlatArray<std::uint32_t>& indices;
+    std::size_t max_leaf = 1;
+    int bins = 2;
+    std::size_t references = 0;      // references in the tree so far
+    std::size_t max_references = 0;  // the budget
+    float min_overlap = 0.0f;        // half area of overlap past which spatial splits are tried
+
+    /// Binned SAH over the centroids, as BinnedBuilder::find_split()
+    Split object_split(const std::vector<BuildRef>& refs, const Aabb& box, Aabb& centroids,
+                       float scale[3]) const {
+        for (const BuildRef& r : refs)
+            centroids.expand(r.centroid);
+        const Vec3 extent = centroids.extent();
+        for (int axis = 0; axis < 3; ++axis)
+            scale[axis] = extent[axis] > 0.0f ? static_cast<float>(bins) / extent[axis] : 0.0f;
+
+        Split split;
+        const float parent_area = std::max(box.half_area(), 1e-20f);
+        std::array<Bin, kMaxBins> axis_bins;
+        std::array<float, kMaxBins> right_area;
+        for (int axis = 0; axis < 3; ++axis) {
+            if (scale[axis] == 0.0f)
+                continue;
+            for (int k = 0; k < bins; ++k)
+                axis_bins[k].reset();
+            for (const BuildRef& r : refs)
+                axis_bins[bin_of(r.centroid, centroids, scale, axis)].add(r);
+            Bin right;
+            right.reset();
+            for (int k = bins - 1; k > 0; --k) {
+                right.merge(axis_bins[k]);
+                right_area[k] = right.half_area();
+            }
+            Bin left;
+            left.reset();
+            for (int k = 1; k < bins; ++k) {
+                left.merge(axis_bins[k - 1]);
+                const std::size_t right_n = refs.size() - left.count;
+                if (left.count == 0 || right_n == 0)
+                    continue;
+                const float cost = options.traversal_cost +
+                                   options.intersection_cost *
+                                       (left.half_area() * static_cast<float>(left.count) +
+                                        right_area[k] * static_cast<float>(right_n)) /
+                                       parent_area;
+                if (cost < split.cost) {
+                    split.cost = cost;
+                    split.axis = axis;
+                    split.bin = k;
+                }
+            }
+        }
+        if (split.axis >= 0) {
+            for (const BuildRef& r : refs) {
+                const bool left = bin_of(r.centroid, centroids, scale, split.axis) < split.bin;
+                (left ? split.left : split.right).expand(r.bounds);
+                ++(left ? split.left_count : split.right_count);
+            }
+        }
+        return split;
+    }
+
+    int bin_of(const Point3& c, const Aabb& centroids, const float scale[3], int axis) const {
+        const int b = static_cast<int>((c[axis] - centroids.min[axis]) * scale[axis]);
+        return std::clamp(b, 0, bins - 1);
+    }
+
+    /// Position of boundary k between the spatial bins of `box` along `axis`
+    float plane(const Aabb& box, int axis, int k) const {
+        return box.min[axis] +
+               (box.max[axis] - box.min[axis]) * static_cast<float>(k) / static_cast<float>(bins);
+    }
+
+    /// Binned SAH over planes cutting the node box, references clipped into every bin they
+    /// cross
+    Split spatial_split(const std::vector<BuildRef>& refs, const Aabb& box) const {
+        Split split;
+        const float parent_area = std::max(box.half_area(), 1e-20f);
+        std::array<SpatialBin, kMaxBins> slabs;
+        std::array<float, kMaxBins> right_area;
+        std::array<std::size_t, kMaxBins> right_count;
+        for (int axis = 0; axis < 3; ++axis) {
+            const float extent = box.max[axis] - box.min[axis];
+            if (!(extent > 0.0f))
+                continue;
+            const float scale = static_cast<float>(bins) / extent;
+            auto slab_of = [&](float x) {
+                return std::clamp(static_cast<int>((x - box.min[axis]) * scale), 0, bins - 1);
+            };
+            for (int k = 0; k < bins; ++k)
+                slabs[k] = SpatialBin{};
+            for (const BuildRef& r : refs) {
+                const int first = slab_of(r.bounds.min[axis]);
+                const int last = slab_of(r.bounds.max[axis]);
+                if (first == last) {
+                    slabs[first].bounds.expand(r.bounds);
+                    ++slabs[first].entries;
+                    ++slabs[first].exits;
+                    continue;
+                }
+                // The first and last slabs the clipped primitive really reaches
+                int enter = -1, exit = -1;
+                for (int k = first; k <= last; ++k) {
+                    Aabb part = r.bounds;
+                    part.min[axis] = std::max(part.min[axis], plane(box, axis, k));
+                    part.max[axis] = std::min(part.max[axis], plane(box, axis, k + 1));
+                    part = clip(r.index, part);
+                    if (part.is_empty())
+                        continue;
+                    slabs[k].bounds.expand(part);
+                    if (enter < 0)
+                        enter = k;
+                    exit = k;
+                }
+                if (enter < 0) {
+                    // Rounding lost the whole primitive: keep its box in the first slab
+                    slabs[first].bounds.expand(r.bounds);
+                    enter = exit = first;
+                }
+                ++slabs[enter].entries;
+                ++slabs[exit].exits;
+            }
+
+            Aabb right;
+            std::size_t right_n = 0;
+            for (int k = bins - 1; k > 0; --k) {
+                right.expand(slabs[k].bounds);
+                right_n += slabs[k].exits;
+                right_area[k] = right.half_area();
+                right_count[k] = right_n;
+            }
+            Aabb left;
+            std::size_t left_n = 0;
+            for (int k = 1; k < bins; ++k) {
+                left.expand(slabs[k - 1].bounds);
+                left_n += slabs[k - 1].entries;
+                if (left_n == 0 || right_count[k] == 0)
+                    continue;
+                const float cost = options.traversal_cost +
+                                   options.intersection_cost *
+                                       (left.half_area() * static_cast<float>(left_n) +
+                                        right_area[k] * static_cast<float>(right_count[k])) /
+                                       parent_area;
+                if (cost < split.cost) {
+                    split.cost = cost;
+                    split.axis = axis;
+                    split.bin = k;
+                    split.left = left;
+                    split.left_count = left_n;
+                    split.right_count = right_count[k];
+                }
+            }
+            if (split.axis == axis) {
+                split.right = Aabb();
+                for (int k = split.bin; k < bins; ++k)
+                    split.right.expand(slabs[k].bounds);
+            }
+        }
+        return split;
+    }
+
+    /// Share `refs` between the children of a spatial split at plane(split.bin). A straddling
+    /// reference is clipped into both unless keeping it whole on one side is cheaper
+    /// (reference unsplitting): a larger box there, but one reference less on the other side.
+    void partition_spatial(const std::vector<BuildRef>& refs, const Aabb& box,
+                           const Split& split, std::vector<BuildRef>& left,
+                           std::vector<BuildRef>& right) {
+        const int axis = split.axis;
+        const float position = plane(box, axis, split.bin);
+        const float left_area = split.left.half_area();
+        const float right_area = split.right.half_area();
+        float left_n = static_cast<float>(split.left_count);
+        float right_n = static_cast<float>(split.right_count);
+        for (const BuildRef& r : refs) {
+            if (r.bounds.max[axis] <= position) {
+                left.push_back(r);
+                continue;
+            }
+            if (r.bounds.min[axis] >= position) {
+                right.push_back(r);
+                continue;
+            }
+            Aabb below = r.bounds;
+            Aabb above = r.bounds;
+            below.max[axis] = position;
+            above.min[axis] = position;
+            below = clip(r.index, below);
+            above = clip(r.index, above);
+            if (above.is_empty() || below.is_empty()) {
+                // Only the box straddles the plane
+                const Aabb& part = above.is_empty() ? below : above;
+                (above.is_empty() ? left : right).push_back({part, part.centroid(), r.index});
+                continue;
+            }
+            const float split_cost = left_area * left_n + right_area * right_n;
+            const float left_only =
+                merge(split.left, r.bounds).half_area() * left_n + right_area * (right_n - 1.0f);
+            const float right_only =
+                left_area * (left_n - 1.0f) + merge(split.right, r.bounds).half_area() * right_n;
+            if (left_only < split_cost && left_only <= right_only) {
+                left.push_back(r);
+                right_n -= 1.0f;
+            } else if (right_only < split_cost) {
+                right.push_back(r);
+                left_n -= 1.0f;
+            } else {
+                left.push_back({below, below.centroid(), r.index});
+                right.push_back({above, above.centroid(), r.index});
+                ++references;
+            }
+        }
+    }
+
+    void build(std::uint32_t node, std::vector<BuildRef> refs, int depth) {
+        Aabb box;
+        for (const BuildRef& r : refs)
+            box.expand(r.bounds);
+        set_bounds(nodes[node], box);
+        const std::size_t count = refs.size();
+
+        auto make_leaf = [&] {
+            nodes[node].offset = static_cast<std::uint32_t>(indices.size());
+            nodes[node].count = static_cast<std::uint32_t>(count);
+            for (const BuildRef& r : refs)
+                indices.push_back(r.index);
+        };
+        if (count == 1 || depth >= depth_limit(options)) {
+            make_leaf();
+            return;
+        }
+
+        Aabb centroids;
+        float scale[3];
+        const Split object = object_split(refs, box, centroids, scale);
+        Split spatial;
+        if (references < max_references &&
+            (object.axis < 0 || intersection(object.left, object.right).half_area() > min_overlap))
+            spatial = spatial_split(refs, box);
+        const bool use_spatial =
+            spatial.cost < object.cost &&
+            references + spatial.left_count + spatial.right_count - count <= max_references;
+        const float best_cost = use_spatial ? spatial.cost : object.cost;
+        const float leaf_cost = options.intersection_cost * static_cast<float>(count);
+        if (count <= max_leaf && leaf_cost <= best_cost) {
+            make_leaf();
+            return;
+        }
+
+        std::vector<BuildRef> left, right;
+        const std::size_t references_before = references;
+        if (use_spatial)
+            partition_spatial(refs, box, spatial, left, right);
+        if (left.empty() || right.empty()) {
+            references = references_before;
+            left.clear();
+            right.clear();
+            if (object.axis >= 0) {
+                for (const BuildRef& r : refs) {
+                    const bool below =
+                        bin_of(r.centroid, centroids, scale, object.axis) < object.bin;
+                    (below ? left : right).push_back(r);
+                }
+            } else {
+                // Every centroid in the same spot: split the list in the middle
+                left.assign(refs.begin(), refs.begin() + static_cast<std::ptrdiff_t>(count / 2));
+                right.assign(refs.begin() + static_cast<std::ptrdiff_t>(count / 2), refs.end());
+            }
+        }
+        refs.clear();
+        refs.shrink_to_fit();
+
+        const auto left_child = static_cast<std::uint32_t>(nodes.size());
+        nodes[node].offset = left_child;
+        nodes[node].count = 0;
+        nodes.push_back(Node{});
+        nodes.push_back(Node{});
+        build(left_child, std::move(left), depth + 1);
+        build(left_child + 1, std::move(right), depth + 1);
+    }
+};
+
+void Bvh::build_spatial(const std::vector<Aabb>& bounds, const ClipFunction& clip,
+                        const BuildOptions& options) {
+    clear();
+    if (bounds.empty())
+        return;
+
+    std::vector<BuildRef> refs(bounds.size());
+    Aabb root;
+    for (std::size_t i = 0; i < bounds.size(); ++i) {
+        refs[i] = {bounds[i], bounds[i].centroid(), static_cast<std::uint32_t>(i)};
+        root.expand(bounds[i]);
+    }
+    SpatialBuilder builder{options, clip, nodes_, indices_};
+    builder.max_leaf = static_cast<std::size_t>(std::max(1, options.max_leaf_size));
+    builder.bins = std::clamp(options.sah_bins, 2, kMaxBins);
+    builder.references = bounds.size();
+    builder.max_references = bounds.size() + static_cast<std::size_t>(
+        static_cast<double>(std::max(0.0f, options.spatial_split_budget)) * bounds.size());
+    builder.min_overlap = 1e-5f * root.half_area();
+
+    nodes_.reserve(2 * bounds.size());
+    indices_.reserve(builder.max_references);
+    nodes_.push_back(Node{});
+    builder.build(0, std::move(refs), 0);
+    finish_build(options);
+}
+
+void Bvh::compact() {
+    std::vector<Node> old = std::move(nodes_.vector());
+    std::vector<float> old_area = std::move(built_area_);
+    const bool has_area = old_area.size() == old.size();
+    nodes_.clear();
+    nodes_.reserve(old.size() - garbage_);
+    nodes_.push_back(old[0]);
+    std::vector<std::uint32_t> from{0};  // old index of every new node
+    struct Move {
+        std::uint32_t from, to;
+    };
+    std::vector<Move> work{{0, 0}};
+    while (!work.empty()) {
+        const Move move = work.back();
+        work.pop_back();
+        const Node& old_node = old[move.from];
+        if (old_node.is_leaf())
+            continue;
+        const auto left_child = static_cast<std::uint32_t>(nodes_.size());
+        nodes_.push_back(old[old_node.offset]);
+        nodes_.push_back(old[old_node.offset + 1]);
+        from.push_back(old_node.offset);
+        from.push_back(old_node.offset + 1);
+        nodes_[move.to].offset = left_child;
+        work.push_back({old_node.offset + 1, left_child + 1});
+        work.push_back({old_node.offset, left_child});
+    }
+    built_area_.clear();
+    if (has_area) {
+        built_area_.resize(nodes_.size());
+        for (std::size_t i = 0; i < nodes_.size(); ++i)
+            built_area_[i] = old_area[from[i]];
+    }
+    garbage_ = 0;
+}
+
+void Bvh::finish_build(const BuildOptions& options) {
+    built_area_.resize(nodes_.size());
+    for (std::size_t i = 0; i < nodes_.size(); ++i) {
+        built_area_[i] = nodes_[i].bounds().half_area();
+    }
+    built_sah_ = sah_area_cost(options);
+    garbage_ = 0;
+}
+
+void Bvh::remap_indices(const std::vector<std::uint32_t>& ids) {
+    for (std::uint32_t& index : indices_) {
+        index = ids[index];
+    }
+}
+
+float Bvh::sah_area_cost(const BuildOptions& options) const {
+    if (nodes_.empty())
+        return 0.0f;
+    float cost = 0.0f;
+    if (garbage_ == 0) {
+        for (const Node& node : nodes_) {
+            const float area = node.bounds().half_area();
+            cost += node.is_leaf()
+                        ? area * options.intersection_cost * static_cast<float>(node.count)
+                        : area * options.traversal_cost;
+        }
+        return cost;
+    }
+    // Walk the tree rather than the array, which holds nodes left by partial rebuilds
+    std::vector<std::uint32_t> stack{0};
+    while (!stack.empty()) {
+        const Node& node = nodes_[stack.back()];
+        stack.pop_back();
+        const float area = node.bounds().half_area();
+        if (node.is_leaf()) {
+            cost += area * options.intersection_cost * static_cast<float>(node.count);
+        } else {
+            cost += area * options.traversal_cost;
+            stack.push_back(node.offset);
+            stack.push_back(node.offset + 1);
+        }
+    }
+    return cost;
+}
+
+float Bvh::sah_cost(const BuildOptions& options) const {
+    if (nodes_.empty())
+        return 0.0f;
+    return sah_area_cost(options) / std::max(nodes_[0].bounds().half_area(), 1e-20f);
+}
+
+// ------------------------ refit / update ------------------------------------
+
+void Bvh::refit_node(std::uint32_t node, const std::vector<Aabb>& bounds, ThreadPool* pool,
+                     int depth) {
+    Node& n = nodes_[node];
+    if (n.is_leaf()) {
+        Aabb box;
+        for (std::uint32_t k = 0; k < n.count; ++k)
+            box.expand(bounds[indices_[n.offset + k]]);
+        set_bounds(n, box);
+    } else {
+        const std::uint32_t left = n.offset;
+        // The top levels fan out as tasks; kRefitTaskDepth levels give up to 2^depth tasks
+        constexpr int kRefitTaskDepth = 6;
+        if (pool && depth < kRefitTaskDepth) {
+            pool->parallel_for(
+                2, [&](std::size_t side) { refit_node(left + side, bounds, pool, depth + 1); });
+        } else {
+            refit_node(left, bounds, pool, depth + 1);
+            refit_node(left + 1, bounds, pool, depth + 1);
+        }
+        const Node& a = nodes_[left];
+        const Node& b = nodes_[left + 1];
+        for (int axis = 0; axis < 3; ++axis) {
+            n.min[axis] = std::min(a.min[axis], b.min[axis]);
+            n.max[axis] = std::max(a.max[axis], b.max[axis]);
+        }
+    }
+}
+
+void Bvh::refit(const std::vector<Aabb>& bounds, ThreadPool* pool) {
+    if (nodes_.empty())
+        return;
+    // Adopted trees: copy the nodes out of the cache before the tasks write to them, and
+    // record the areas they were built with
+    nodes_.vector();
+    if (built_area_.size() != nodes_.size()) {
+        built_area_.resize(nodes_.size());
+        for (std::size_t i = 0; i < nodes_.size(); ++i)
+            built_area_[i] = nodes_[i].bounds().half_area();
+    }
+    refit_node(0, bounds, pool, 0);
+}
+
+void Bvh::rebuild_subtree(std::uint32_t node, int depth, std::size_t begin, std::size_t end,
+                          const std::vector<Aabb>& bounds, ThreadPool* pool,
+                          const BuildOptions& options) {
+    std::size_t old_nodes = 0;
+    std::vector<std::uint32_t> stack{node};
+    while (!stack.empty()) {
+        const Node& n = nodes_[stack.back()];
+        stack.pop_back();
+        ++old_nodes;
+        if (!n.is_leaf()) {
+            stack.push_back(n.offset);
+            stack.push_back(n.offset + 1);
+        }
+    }
+
+    std::vector<std::uint32_t> ids(indices_.begin() + static_cast<std::ptrdiff_t>(begin),
+                                   indices_.begin() + static_cast<std::ptrdiff_t>(end));
+    std::vector<Aabb> boxes(ids.size());
+    for (std::size_t i = 0; i < ids.size(); ++i)
+        boxes[i] = bounds[ids[i]];
+    // Spliced in `depth` levels down, the new subtree gets what is left of the depth budget
+    BuildOptions sub_options = options;
+    sub_options.max_depth = depth_limit(options) - depth;
+    Bvh sub;
+    if (pool)
+        sub.build_binned(boxes, *pool, sub_options);
+    else
+        sub.build(boxes, sub_options);
+
+    // Splice: the new root takes the old one's slot, the rest goes at the end of the array
+    const auto base = static_cast<std::uint32_t>(nodes_.size());
+    auto relocate = [&](Node n) {
+        n.offset = n.is_leaf() ? n.offset + static_cast<std::uint32_t>(begin)
+                               : n.offset - 1 + base;
+        return n;
+    };
+    for (std::size_t j = 1; j < sub.nodes_.size(); ++j) {
+        nodes_.push_back(relocate(sub.nodes_[j]));
+        built_area_.push_back(sub.built_area_[j]);
+    }
+    nodes_[node] = relocate(sub.nodes_[0]);
+    built_area_[node] = sub.built_area_[0];
+    for (std::size_t i = 0; i < ids.size(); ++i)
+        indices_[begin + i] = ids[sub.indices_[i]];
+    garbage_ += old_nodes - 1;
+}
+
+BvhUpdateStats Bvh::update(const std::vector<Aabb>& bounds, ThreadPool* pool,
+                           const BuildOptions& options) {
+    BvhUpdateStats stats;
+    if (nodes_.empty())
+        return stats;
+    refit(bounds, pool);
+    auto measure = [&] {
+        const float area_cost = sah_area_cost(options);
+        stats.sah_cost = area_cost / std::max(nodes_[0].bounds().half_area(), 1e-20f);
+        stats.sah_growth = area_cost / std::max(built_sah_, 1e-20f);
+    };
+    measure();
+    if (stats.sah_growth <= options.refit_sah_limit)
+        return stats;
+
+    // Highest subtrees that grew past the limit, with the range of indices they cover
+    struct Degraded {
+        std::uint32_t node;
+        int depth;
+        std::size_t begin, end;
+    };
+    std::vector<Degraded> degraded;
+    std::size_t degraded_primitives = 0;
+    std::vector<std::pair<std::uint32_t, int>> stack{{0, 0}};
+    while (!stack.empty()) {
+        const auto [index, depth] = stack.back();
+        stack.pop_back();
+        const Node& n = nodes_[index];
+        if (n.bounds().half_area() > options.refit_sah_limit * built_area_[index]) {
+            // A subtree's leaves cover a contiguous range of indices_
+            std::size_t begin = indices_.size();
+            std::size_t end = 0;
+            std::vector<std::uint32_t> sub{index};
+            while (!sub.empty()) {
+                const Node& m = nodes_[sub.back()];
+                sub.pop_back();
+                if (m.is_leaf()) {
+                    begin = std::min<std::size_t>(begin, m.offset);
+                    end = std::max<std::size_t>(end, m.offset + m.count);
+                } else {
+                    sub.push_back(m.offset);
+                    sub.push_back(m.offset + 1);
+                }
+            }
+            degraded.push_back({index, depth, begin, end});
+            degraded_primitives += end - begin;
+        } else if (!n.is_leaf()) {
+            stack.push_back({n.offset, depth + 1});
+            stack.push_back({n.offset + 1, depth + 1});
+        }
+    }
+
+    if (degraded.empty() || 2 * degraded_primitives > indices_.size()) {
+        // Degraded all over: start again from the whole primitive list
+        rebuild_subtree(0, 0, 0, indices_.size(), bounds, pool, options);
+        compact();
+        finish_build(options);
+        stats.full_rebuild = true;
+        stats.rebuilt_subtrees = 1;
+        stats.rebuilt_primitives = indices_.size();
+        measure();
+        return stats;
+    }
+    for (const Degraded& d : degraded)
+        rebuild_subtree(d.node, d.depth, d.begin, d.end, bounds, pool, options);
+    if (2 * garbage_ > nodes_.size())
+        compact();
+    // The next updates measure the growth from this tree, not from the one refitted into it
+    built_sah_ = sah_area_cost(options);
+    stats.rebuilt_subtrees = degraded.size();
+    stats.rebuilt_primitives = degraded_primitives;
+    measure();
+    return stats;
+}
+
+}  // namespace raylabs
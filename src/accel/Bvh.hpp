@@ -0,0 +1,306 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "accel/Aabb.hpp"
+#include "accel/Accelerator.hpp"
+#include "accel/FlatArray.hpp"
+#include "core/Ray.hpp"
+#include "core/RayPacket.hpp"
+
+namespace raylabs {
+
+class ThreadPool;
+
+/// Settings of the BVH builders
+struct BvhBuildOptions {
+    int max_leaf_size = 4;           // leaves never hold more primitives than this...
+    int max_depth = 64;              // ...unless this deep (at most Bvh::kMaxDepth)
+    float traversal_cost = 1.0f;     // SAH cost of visiting a node...
+    float intersection_cost = 1.0f;  // ...relative to intersecting one primitive
+    int width = 4;                   // children per node for closest-hit queries: 2, 4 or 8
+    int sah_bins = 32;               // binned builder: centroid bins per axis
+    bool quantized = false;          // width 4 or 8: compress the wide nodes (QuantizedBvh)
+    // Bvh::update(): once refitting has grown the SAH cost (not normalized by the root box)
+    // past this multiple of its value at build time, the subtrees whose box grew by more
+    // than this factor are rebuilt
+    float refit_sah_limit = 1.3f;
+    // Above 0, Scene::build_acceleration() and TriangleMesh build with spatial splits
+    // (Bvh::build_spatial()), allowed this fraction of primitive references on top of one per
+    // primitive (0.3 = 30%)
+    float spatial_split_budget = 0.0f;
+    // Scene::build_acceleration(): structure to build over the entities. The settings above
+    // only apply to BVHs; grids and kd-trees use their own defaults.
+    Accelerator accelerator = Accelerator::Bvh;
+};
+
+/// Throws std::runtime_error for options that do not describe a BVH: a width other than 2,
+/// 4 or 8, quantized binary nodes, or a negative spatial split budget
+void check_build_options(const BvhBuildOptions& options);
+
+/// What Bvh::update() did
+struct BvhUpdateStats {
+    float sah_cost = 0.0f;               // after the update, see Bvh::sah_cost()
+    float sah_growth = 1.0f;             // SAH cost relative to the last rebuild
+    std::size_t rebuilt_subtrees = 0;    // subtrees rebuilt after the refit
+    std::size_t rebuilt_primitives = 0;  // primitives in them
+    bool full_rebuild = false;
+};
+
+/// Binary bounding volume hierarchy over a set of primitive boxes.
+/// Built top-down with the surface area heuristic, either serially with an exact sweep over
+/// the sorted centroids of every axis (build) or in parallel with binned split candidates
+/// (build_binned), and stored as a flat array of 32-byte nodes in depth-first order, the two
+/// children of a node next to each other. Primitives are referenced by their index in the
+/// box list given to build(); the traversals hand those indices to a callback, so the same
+/// hierarchy serves scenes, meshes or anything else that can intersect one primitive.
+class Bvh {
+   public:
+    struct Node {
+        float min[3];
+        std::uint32_t offset;  // interior: index of the left child (right = offset + 1)
+                               // leaf: first slot in indices()
+        float max[3];
+        std::uint32_t count;  // primitives in the leaf, 0 for interior nodes
+
+        bool is_leaf() const { return count > 0; }
+        Aabb bounds() const {
+            return Aabb(Point3(min[0], min[1], min[2]), Point3(max[0], max[1], max[2]));
+        }
+
+        /// Slab test, see slab_hit()
+        bool hit(const Point3& origin, const Vec3& inv_dir, float tMin, float tMax,
+                 float& t_entry) const {
+            return slab_hit(min, max, origin, inv_dir, tMin, tMax, t_entry);
+        }
+    };
+    static_assert(sizeof(Node) == 32, "BVH nodes are meant to fill half a cache line");
+
+    using BuildOptions = BvhBuildOptions;
+
+    /// Deepest tree the traversal stacks can handle; deeper subtrees become (large) leaves.
+    /// Every builder stops at BuildOptions::max_depth, which may only lower it.
+    static constexpr int kMaxDepth = 64;
+
+    /// Build over `bounds` (one box per primitive, all bounded). Replaces the previous tree.
+    void build(const std::vector<Aabb>& bounds, const BuildOptions& options = {});
+
+    /// Same, evaluating the SAH on `options.sah_bins` centroid bins per axis instead of every
+    /// split position. Sibling subtrees are built as separate tasks on `pool` and the binning
+    /// of large ranges is split across it too. The result does not depend on the pool size.
+    void build_binned(const std::vector<Aabb>& bounds, ThreadPool& pool,
+                      const BuildOptions& options = {});
+
+    /// Box around the part of primitive `index` lying inside `box` (empty if none), no larger
+    /// than the intersection of the two boxes
+    using ClipFunction = std::function<Aabb(std::uint32_t index, const Aabb& box)>;
+
+    /// Spatial-split BVH (SBVH, Stich et al. 2009), built serially with binned SAH. Besides
+    /// object splits, a node may split space at a plane: primitives straddling it go to both
+    /// children, each with the box `clip` gives for its side, so long thin primitives stop
+    /// inflating the boxes of their neighbours. Spatial splits are only tried where the best
+    /// object split leaves children overlapping by more than 1e-5 of the root area, and while
+    /// the references stay within (1 + options.spatial_split_budget) times the primitives.
+    /// A primitive may then appear in several leaves (primitive_count() counts references);
+    /// refit() and update() work on the references with their whole boxes.
+    void build_spatial(const std::vector<Aabb>& bounds, const ClipFunction& clip,
+                       const BuildOptions& options = {});
+
+    /// Replace every primitive index i by ids[i] (e.g. to refer to a subset of a larger list)
+    void remap_indices(const std::vector<std::uint32_t>& ids);
+
+    /// Recompute every node box bottom-up from `bounds`, indexed by the values of indices()
+    /// (so after remap_indices(), by the remapped ids). Keeps the topology; the top subtrees
+    /// are refitted as parallel tasks on `pool` if given.
+    void refit(const std::vector<Aabb>& bounds, ThreadPool* pool = nullptr);
+
+    /// refit(), then, if the SAH cost went past options.refit_sah_limit times its value at the
+    /// last (full or partial) rebuild (both measured in absolute area, as the root box moves
+    /// too), rebuild the highest subtrees whose box grew by more than that factor since they
+    /// were built (binned builder on `pool`, exact one without), each within the depth left
+    /// below it. Falls back to a full rebuild when those subtrees hold more than half of the
+    /// primitives.
+    BvhUpdateStats update(const std::vector<Aabb>& bounds, ThreadPool* pool,
+                          const BuildOptions& options = {});
+
+    /// Take over a tree built earlier instead of building one, typically borrowed from a
+    /// mapped BvhCache file. `built_sah` is the sah_area_cost() it had when it was built.
+    /// Editing the tree afterwards (refit, update) copies it out of the borrowed memory.
+    void adopt(FlatArray<Node> nodes, FlatArray<std::uint32_t> indices, float built_sah);
+
+    void clear();
+    bool empty() const { return nodes_.empty(); }
+
+    const FlatArray<Node>& nodes() const { return nodes_; }
+    const FlatArray<std::uint32_t>& indices() const { return indices_; }
+    /// Primitive references in the leaves: one per primitive, more after spatial splits
+    std::size_t primitive_count() const { return indices_.size(); }
+
+    /// Bytes of nodes and primitive indices
+    std::size_t memory_bytes() const {
+        return nodes_.size() * sizeof(Node) + indices_.size() * sizeof(std::uint32_t);
+    }
+
+    /// sah_area_cost() recorded at the last build or update() that rebuilt subtrees
+    float built_sah() const { return built_sah_; }
+
+    /// Box of the whole hierarchy (empty if nothing was built)
+    Aabb bounds() const { return nodes_.empty() ? Aabb() : nodes_[0].bounds(); }
+
+    /// SAH cost of the tree: expected cost of a random ray hitting the root box, in units of
+    /// one primitive intersection
+    float sah_cost(const BuildOptions& options = {}) const;
+
+    /// Closest-hit traversal, children visited front to back. For every primitive whose leaf
+    /// the ray reaches, calls `hit_prim(index, tMax)`, which must return true and shrink tMax
+    /// when it finds a closer hit. Returns true if any call did.
+    template <typename HitPrim>
+    bool intersect(const Ray& ray, float tMin, float& tMax, HitPrim&& hit_prim) const;
+
+    /// Packet traversal: a node is entered when any active lane hits its box before the
+    /// lane's closest hit so far (`t_max`, read again at every node so the callback may
+    /// shrink it). Calls `hit_prims(index, lanes)` with the lanes that reached the leaf.
+    template <int N, typename HitPrims>
+    void intersect_packet(const RayPacket<N>& rays, float tMin, const PacketFloat<N>& t_max,
+                          const PacketMask<N>& active, HitPrims&& hit_prims) const;
+
+   private:
+    struct BinnedBuilder;
+    struct SpatialBuilder;
+
+    /// Record the state update() compares against: node areas and SAH cost
+    void finish_build(const BuildOptions& options);
+    /// SAH cost times the half area of the root (what built_sah() records)
+    float sah_area_cost(const BuildOptions& options) const;
+    void refit_node(std::uint32_t node, const std::vector<Aabb>& bounds, ThreadPool* pool,
+                    int depth);
+    /// Rebuild the subtree under `node`, which covers indices_[begin, end) and sits `depth`
+    /// levels below the root; the new one goes no deeper than the builders would
+    void rebuild_subtree(std::uint32_t node, int depth, std::size_t begin, std::size_t end,
+                         const std::vector<Aabb>& bounds, ThreadPool* pool,
+                         const BuildOptions& options);
+    /// Renumber the reachable nodes depth-first, dropping the ones left by rebuilds
+    void compact();
+
+    FlatArray<Node> nodes_;
+    FlatArray<std::uint32_t> indices_;
+    std::vector<float> built_area_;  // half area of every node when it was built
+    float built_sah_ = 0.0f;
+    std::size_t garbage_ = 0;  // unreachable nodes left in nodes_ by partial rebuilds
+};
+
+// ------------------------ traversal -----------------------------------------
+
+template <typename HitPrim>
+bool Bvh::intersect(const Ray& ray, float tMin, float& tMax, HitPrim&& hit_prim) const {
+    if (nodes_.empty())
+        return false;
+    const Vec3 inv_dir(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+
+    struct Entry {
+        std::uint32_t node;
+        float t;  // where the ray enters the node
+    };
+    Entry stack[kMaxDepth + 1];
+    int top = 0;
+
+    float t_root;
+    if (!nodes_[0].hit(ray.origin, inv_dir, tMin, tMax, t_root))
+        return false;
+    stack[top++] = {0, t_root};
+
+    bool found = false;
+    while (top > 0) {
+        const Entry entry = stack[--top];
+        if (entry.t > tMax)
+            continue;  // a closer hit was found since the node was pushed
+        const Node& node = nodes_[entry.node];
+        if (node.is_leaf()) {
+            for (std::uint32_t k = 0; k < node.count; ++k) {
+                if (hit_prim(indices_[node.offset + k], tMax))
+                    found = true;
+            }
+            continue;
+        }
+
+        float t_left = 0.0f, t_right = 0.0f;
+        const bool hit_left = nodes_[node.offset].hit(ray.origin, inv_dir, tMin, tMax, t_left);
+        const bool hit_right =
+            nodes_[node.offset + 1].hit(ray.origin, inv_dir, tMin, tMax, t_right);
+        if (hit_left && hit_right) {
+            // Far child below the near one on the stack
+            if (t_left <= t_right) {
+                stack[top++] = {node.offset + 1, t_right};
+                stack[top++] = {node.offset, t_left};
+            } else {
+                stack[top++] = {node.offset, t_left};
+                stack[top++] = {node.offset + 1, t_right};
+            }
+        } else if (hit_left) {
+            stack[top++] = {node.offset, t_left};
+        } else if (hit_right) {
+            stack[top++] = {node.offset + 1, t_right};
+        }
+    }
+    return found;
+}
+
+template <int N, typename HitPrims>
+void Bvh::intersect_packet(const RayPacket<N>& rays, float tMin, const PacketFloat<N>& t_max,
+                           const PacketMask<N>& active, HitPrims&& hit_prims) const {
+    using F = PacketFloat<N>;
+    if (nodes_.empty() || !simd::any(active))
+        return;
+    const F ix = F(1.0f) / rays.dx;
+    const F iy = F(1.0f) / rays.dy;
+    const F iz = F(1.0f) / rays.dz;
+
+    // Lanes of `active` whose ray enters the node before its closest hit so far
+    auto hit_node = [&](const Node& node) {
+        const F tx0 = (F(node.min[0]) - rays.ox) * ix;
+        const F tx1 = (F(node.max[0]) - rays.ox) * ix;
+        const F ty0 = (F(node.min[1]) - rays.oy) * iy;
+        const F ty1 = (F(node.max[1]) - rays.oy) * iy;
+        const F tz0 = (F(node.min[2]) - rays.oz) * iz;
+        const F tz1 = (F(node.max[2]) - rays.oz) * iz;
+        const F t_near =
+            max(max(min(tx0, tx1), min(ty0, ty1)), max(min(tz0, tz1), F(tMin)));
+        const F t_far = min(min(max(tx0, tx1), max(ty0, ty1)), min(max(tz0, tz1), t_max));
+        return active & (t_near <= t_far);
+    };
+
+    // Coherent packets share a direction: order the children for the first active lane
+    int lead = 0;
+    while (!active[lead])
+        ++lead;
+    const Vec3 lead_dir(rays.dx[lead], rays.dy[lead], rays.dz[lead]);
+
+    std::uint32_t stack[kMaxDepth + 1];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes_[stack[--top]];
+        const PacketMask<N> lanes = hit_node(node);
+        if (!simd::any(lanes))
+            continue;
+        if (node.is_leaf()) {
+            for (std::uint32_t k = 0; k < node.count; ++k)
+                hit_prims(indices_[node.offset + k], lanes);
+            continue;
+        }
+        const Vec3 to_right =
+            nodes_[node.offset + 1].bounds().centroid() - nodes_[node.offset].bounds().centroid();
+        if (dot(lead_dir, to_right) >= 0.0f) {
+            stack[top++] = node.offset + 1;
+            stack[top++] = node.offset;
+        } else {
+            stack[top++] = node.offset;
+            stack[top++] = node.offset + 1;
+        }
+    }
+}
+
+}  // namespace raylabs
@@ -0,0 +1,307 @@
+#include "accel/BvhCache.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <system_error>
+#include <type_traits>
+
+#include "utils/MappedFile.hpp"
+
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+namespace raylabs {
+
+namespace {
+
+constexpr char kMagic[8] = {'R', 'L', 'B', 'V', 'H', 'C', 0, 0};
+constexpr std::uint64_t kAlignment = 64;  // wide nodes are cache-line aligned
+
+struct Section {
+    std::uint64_t offset;  // from the start of the file, a multiple of kAlignment
+    std::uint64_t count;
+};
+
+struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t width;  // wide tree stored after the binary one: 4, 8, or 2 for none
+    std::uint64_t key;
+    std::uint32_t node_size;  // sizeof(Bvh::Node) and sizeof(WideBvh<width>::Node), so that
+    std::uint32_t wide_node_size;  // a file from a build with another layout is refused
+    float built_sah;
+    std::uint32_t reserved;
+    Section nodes;
+    Section indices;  // shared by both trees
+    Section wide_nodes;
+    Section sources;
+};
+static_assert(std::is_trivially_copyable_v<Header>);
+static_assert(std::is_trivially_copyable_v<Bvh::Node>);
+
+/// FNV-1a over 32-bit words
+struct Hasher {
+    std::uint64_t h = 14695981039346656037ull;
+
+    void word(std::uint32_t w) {
+        h ^= w;
+        h *= 1099511628211ull;
+    }
+    void value(float f) {
+        std::uint32_t w;
+        std::memcpy(&w, &f, sizeof(w));
+        word(w);
+    }
+};
+
+std::uint64_t align_up(std::uint64_t offset) {
+    return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+template <typename T>
+bool section_fits(const Section& s, std::size_t file_size) {
+    return s.offset % kAlignment == 0 && s.offset <= file_size &&
+           s.count <= (file_size - s.offset) / sizeof(T);
+}
+
+template <typename T>
+FlatArray<T> borrow(const std::shared_ptr<const void>& owner, const Section& s) {
+    const auto* base = static_cast<const char*>(owner.get());
+    return FlatArray<T>::borrow(reinterpret_cast<const T*>(base + s.offset),
+                                static_cast<std::size_t>(s.count), owner);
+}
+
+/// Whether an interior child `child` of node `parent` or a leaf of `count` primitives from
+/// slot `child` points inside the arrays. Children are stored after their parent (depth-first
+/// order), which also rules out cycles; `depth` is filled in as the nodes are visited.
+bool child_fits(std::uint32_t parent, std::uint32_t child, std::uint32_t count,
+                std::uint64_t node_count, std::uint64_t index_count, std::vector<int>& depth) {
+    if (count > 0)
+        return std::uint64_t{child} + count <= index_count;
+    if (child <= parent || child >= node_count)
+        return false;
+    depth[child] = std::max(depth[child], depth[parent] + 1);
+    return depth[child] <= Bvh::kMaxDepth;
+}
+
+/// Whether a mapped binary tree can be traversed without leaving the file or overflowing
+/// the traversal stack
+bool nodes_valid(const FlatArray<Bvh::Node>& nodes, std::uint64_t index_count) {
+    std::vector<int> depth(nodes.size(), 0);
+    for (std::uint32_t i = 0; i < nodes.size(); ++i) {
+        const Bvh::Node& n = nodes[i];
+        const bool fits =
+            n.is_leaf() ? child_fits(i, n.offset, n.count, nodes.size(), index_count, depth)
+                        : child_fits(i, n.offset, 0, nodes.size(), index_count, depth) &&
+                              child_fits(i, n.offset + 1, 0, nodes.size(), index_count, depth);
+        if (!fits)
+            return false;
+    }
+    return true;
+}
+
+template <int W>
+bool wide_nodes_valid(const FlatArray<typename WideBvh<W>::Node>& nodes,
+                      const FlatArray<std::uint32_t>& sources, std::uint64_t index_count,
+                      std::uint64_t binary_count) {
+    std::vector<int> depth(nodes.size(), 0);
+    for (std::uint32_t i = 0; i < nodes.size(); ++i) {
+        const typename WideBvh<W>::Node& n = nodes[i];
+        if (n.children > W)
+            return false;
+        for (std::uint32_t k = 0; k < n.children; ++k) {
+            if (!child_fits(i, n.child[k], n.count[k], nodes.size(), index_count, depth))
+                return false;
+        }
+    }
+    for (std::uint32_t source : sources) {
+        if (source >= binary_count)
+            return false;
+    }
+    return true;
+}
+
+template <int W>
+bool adopt_wide(const std::shared_ptr<const void>& owner, const Header& header,
+                std::size_t file_size, WideBvh<W>& wide) {
+    if (header.wide_node_size != sizeof(typename WideBvh<W>::Node) ||
+        !section_fits<typename WideBvh<W>::Node>(header.wide_nodes, file_size) ||
+        !section_fits<std::uint32_t>(header.sources, file_size) ||
+        header.sources.count != header.wide_nodes.count * W) {
+        return false;
+    }
+    auto nodes = borrow<typename WideBvh<W>::Node>(owner, header.wide_nodes);
+    auto sources = borrow<std::uint32_t>(owner, header.sources);
+    if (!wide_nodes_valid<W>(nodes, sources, header.indices.count, header.nodes.count))
+        return false;
+    wide.adopt(std::move(nodes), borrow<std::uint32_t>(owner, header.indices),
+               std::move(sources));
+    return true;
+}
+
+}  // namespace
+
+std::uint64_t BvhCache::key(const std::vector<Aabb>& bounds,
+                            const std::vector<std::uint32_t>& ids,
+                            const BvhBuildOptions& options, bool binned) {
+    Hasher hash;
+    hash.word(kVersion);
+    hash.word(static_cast<std::uint32_t>(options.max_leaf_size));
+    hash.word(static_cast<std::uint32_t>(options.max_depth));
+    hash.value(options.traversal_cost);
+    hash.value(options.intersection_cost);
+    hash.word(static_cast<std::uint32_t>(options.width));
+    hash.word(binned ? static_cast<std::uint32_t>(options.sah_bins) : 0u);
+    hash.word(static_cast<std::uint32_t>(bounds.size()));
+    for (const Aabb& box : bounds) {
+        for (int axis = 0; axis < 3; ++axis) {
+            hash.value(box.min[axis]);
+            hash.value(box.max[axis]);
+        }
+    }
+    for (std::uint32_t id : ids)
+        hash.word(id);
+    return hash.h;
+}
+
+std::string BvhCache::path(std::uint64_t key) const {
+    std::ostringstream name;
+    name << std::hex;
+    name.width(16);
+    name.fill('0');
+    name << key;
+    return (std::filesystem::path(directory_) / ("bvh-" + name.str() + ".bin")).string();
+}
+
+bool BvhCache::load(std::uint64_t key, std::uint32_t id_limit, Bvh& bvh, WideBvh<4>& bvh4,
+                    WideBvh<8>& bvh8) const {
+    std::size_t size = 0;
+    const std::shared_ptr<const void> owner = map_file(path(key), size, kAlignment);
+    if (!owner || size < sizeof(Header))
+        return false;
+    Header header;
+    std::memcpy(&header, owner.get(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.key != key || header.node_size != sizeof(Bvh::Node) ||
+        !section_fits<Bvh::Node>(header.nodes, size) ||
+        !section_fits<std::uint32_t>(header.indices, size) ||
+        std::max({header.nodes.count, header.indices.count, header.wide_nodes.count}) >
+            std::numeric_limits<std::uint32_t>::max()) {
+        return false;
+    }
+    // Past the header, check everything a traversal follows: child links, leaf ranges, depth
+    // and the primitive ids, so that a damaged file means a rebuild rather than a crash
+    FlatArray<Bvh::Node> nodes = borrow<Bvh::Node>(owner, header.nodes);
+    FlatArray<std::uint32_t> indices = borrow<std::uint32_t>(owner, header.indices);
+    if (!nodes_valid(nodes, indices.size()))
+        return false;
+    for (std::uint32_t id : indices) {
+        if (id >= id_limit)
+            return false;
+    }
+
+    WideBvh<4> wide4;
+    WideBvh<8> wide8;
+    if ((header.width == 4 && !adopt_wide(owner, header, size, wide4)) ||
+        (header.width == 8 && !adopt_wide(owner, header, size, wide8)) ||
+        (header.width != 2 && header.width != 4 && header.width != 8)) {
+        return false;
+    }
+    bvh.adopt(std::move(nodes), std::move(indices), header.built_sah);
+    bvh4 = std::move(wide4);
+    bvh8 = std::move(wide8);
+    return true;
+}
+
+bool BvhCache::store(std::uint64_t key, int width, const Bvh& bvh, const WideBvh<4>& bvh4,
+                     const WideBvh<8>& bvh8) const {
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.width = static_cast<std::uint32_t>(width == 4 || width == 8 ? width : 2);
+    header.key = key;
+    header.node_size = sizeof(Bvh::Node);
+    header.built_sah = bvh.built_sah();
+
+    // Sections in file order, each starting on an aligned offset
+    struct Chunk {
+        Section* section;
+        const void* data;
+        std::size_t count, size;
+    };
+    std::vector<Chunk> chunks{
+        {&header.nodes, bvh.nodes().data(), bvh.nodes().size(), sizeof(Bvh::Node)},
+        {&header.indices, bvh.indices().data(), bvh.indices().size(), sizeof(std::uint32_t)}};
+    if (header.width == 4) {
+        header.wide_node_size = sizeof(WideBvh<4>::Node);
+        chunks.push_back({&header.wide_nodes, bvh4.nodes().data(), bvh4.nodes().size(),
+                          sizeof(WideBvh<4>::Node)});
+        chunks.push_back({&header.sources, bvh4.sources().data(), bvh4.sources().size(),
+                          sizeof(std::uint32_t)});
+    } else if (header.width == 8) {
+        header.wide_node_size = sizeof(WideBvh<8>::Node);
+        chunks.push_back({&header.wide_nodes, bvh8.nodes().data(), bvh8.nodes().size(),
+                          sizeof(WideBvh<8>::Node)});
+        chunks.push_back({&header.sources, bvh8.sources().data(), bvh8.sources().size(),
+                          sizeof(std::uint32_t)});
+    }
+    std::uint64_t offset = align_up(sizeof(Header));
+    for (Chunk& c : chunks) {
+        *c.section = {offset, c.count};
+        offset = align_up(offset + c.count * c.size);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory_, ec);
+    const std::string final_path = path(key);
+    // Unique across the processes sharing the directory and the stores of this one
+#ifndef _WIN32
+    const long pid = static_cast<long>(::getpid());
+#else
+    const long pid = static_cast<long>(::_getpid());
+#endif
+    const std::string temp_path =
+        final_path + ".tmp" + std::to_string(pid) + "-" +
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+        const char zeros[kAlignment] = {};
+        std::uint64_t written = 0;
+        auto pad_to = [&](std::uint64_t target) {
+            out.write(zeros, static_cast<std::streamsize>(target - written));
+            written = target;
+        };
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        written = sizeof(header);
+        for (const Chunk& c : chunks) {
+            pad_to(c.section->offset);
+            const std::uint64_t bytes = c.count * c.size;
+            out.write(static_cast<const char*>(c.data), static_cast<std::streamsize>(bytes));
+            written += bytes;
+        }
+        if (!out) {
+            out.close();
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, final_path, ec);
+    if (ec) {
+        std::filesystem::remove(temp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace raylabs
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "accel/Aabb.hpp"
+#include "accel/Bvh.hpp"
+#include "accel/WideBvh.hpp"
+
+namespace raylabs {
+
+/// On-disk cache of built hierarchies, one file per key in a directory. A file holds the
+/// node and index arrays exactly as they sit in memory, behind a small versioned header;
+/// load() maps it and lets the trees borrow those pages (FlatArray), so there is nothing
+/// to parse or copy, and processes rendering the same scene share one copy through the
+/// page cache. Files are written to a temporary name and renamed into place, so concurrent
+/// readers see either the whole file or none.
+/// The key only covers what the builder reads; load() still checks every node and index of
+/// a file against the sizes it maps, and turns down one that does not hold together.
+class BvhCache {
+   public:
+    /// Bump when the file layout or the builders change
+    static constexpr std::uint32_t kVersion = 1;
+
+    explicit BvhCache(std::string directory) : directory_(std::move(directory)) {}
+
+    const std::string& directory() const { return directory_; }
+
+    /// Content hash of a build: the primitive boxes, the ids they stand for (see
+    /// Bvh::remap_indices()), the options that shape the tree and the builder used
+    static std::uint64_t key(const std::vector<Aabb>& bounds,
+                             const std::vector<std::uint32_t>& ids, const BvhBuildOptions& options,
+                             bool binned);
+
+    /// File of `key`
+    std::string path(std::uint64_t key) const;
+
+    /// Map the file of `key` and adopt its trees: `bvh`, and `bvh4` or `bvh8` if it was
+    /// stored with a wide tree. Returns false, leaving the trees alone, if there is no file,
+    /// it was written by another version or for another key, or it is damaged: a child or
+    /// leaf outside the arrays, a tree deeper than Bvh::kMaxDepth, or a primitive id not
+    /// below `id_limit`.
+    bool load(std::uint64_t key, std::uint32_t id_limit, Bvh& bvh, WideBvh<4>& bvh4,
+              WideBvh<8>& bvh8) const;
+
+    /// Write the trees under `key`, along with the wide one matching `width` (2 = none).
+    /// Creates the directory if needed. Returns false if the file could not be written.
+    bool store(std::uint64_t key, int width, const Bvh& bvh, const WideBvh<4>& bvh4,
+               const WideBvh<8>& bvh8) const;
+
+   private:
+    std::string directory_;
+};
+
+}  // namespace raylabs
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace raylabs {
+
+/// Contiguous array of trivially copyable values, either owned (a std::vector) or borrowed
+/// read-only from memory that `owner` keeps alive, such as the pages of a mapped BVH cache
+/// file (see BvhCache). Const access reads either storage through the same pointer; any
+/// non-const access first copies a borrowed array into an owned one.
+template <typename T>
+class FlatArray {
+   public:
+    FlatArray() = default;
+    FlatArray(std::vector<T> values) : owned_(std::move(values)) { sync(); }
+
+    FlatArray(const FlatArray& other)
+        : owned_(other.owned_), owner_(other.owner_), data_(other.data_), size_(other.size_) {
+        if (!owner_)
+            sync();
+    }
+    FlatArray(FlatArray&& other) noexcept
+        : owned_(std::move(other.owned_)),
+          owner_(std::move(other.owner_)),
+          data_(other.data_),
+          size_(other.size_) {
+        other.owner_.reset();
+        other.sync();
+    }
+    FlatArray& operator=(const FlatArray& other) {
+        if (this != &other) {
+            owned_ = other.owned_;
+            owner_ = other.owner_;
+            data_ = other.data_;
+            size_ = other.size_;
+            if (!owner_)
+                sync();
+        }
+        return *this;
+    }
+    FlatArray& operator=(FlatArray&& other) noexcept {
+        owned_ = std::move(other.owned_);
+        owner_ = std::move(other.owner_);
+        data_ = other.data_;
+        size_ = other.size_;
+        other.owner_.reset();
+        other.sync();
+        return *this;
+    }
+
+    /// `size` values at `data`, valid as long as `owner` lives
+    static FlatArray borrow(const T* data, std::size_t size, std::shared_ptr<const void> owner) {
+        FlatArray array;
+        array.owner_ = std::move(owner);
+        array.data_ = data;
+        array.size_ = size;
+        return array;
+    }
+
+    bool borrowed() const { return owner_ != nullptr; }
+
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const T* data() const { return data_; }
+    const T& operator[](std::size_t i) const { return data_[i]; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    const T& back() const { return data_[size_ - 1]; }
+
+    /// Owned storage, for in-place edits
+    std::vector<T>& vector() {
+        if (owner_) {
+            owned_.assign(data_, data_ + size_);
+            owner_.reset();
+            sync();
+        }
+        return owned_;
+    }
+    T* data() { return vector().data(); }
+    T& operator[](std::size_t i) { return vector()[i]; }
+    T* begin() { return data(); }
+    T* end() { return data() + size_; }
+    T& back() { return vector().back(); }
+
+    // Resizing edits; they keep data() pointing at the vector
+    void clear() {
+        owner_.reset();
+        owned_.clear();
+        sync();
+    }
+    void reserve(std::size_t n) {
+        vector().reserve(n);
+        sync();
+    }
+    void resize(std::size_t n) {
+        vector().resize(n);
+        sync();
+    }
+    void resize(std::size_t n, const T& value) {
+        vector().resize(n, value);
+        sync();
+    }
+    void assign(std::size_t n, const T& value) {
+        owner_.reset();
+        owned_.assign(n, value);
+        sync();
+    }
+    void push_back(const T& value) {
+        vector().push_back(value);
+        sync();
+    }
+
+    friend bool operator==(const FlatArray& a, const FlatArray& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+   private:
+    void sync() {
+        data_ = owned_.data();
+        size_ = owned_.size();
+    }
+
+    std::vector<T> owned_;
+    std::shared_ptr<const void> owner_;  // set while borrowed
+    const T* data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+}  // namespace raylabs
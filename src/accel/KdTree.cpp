@@ -0,0 +1,163 @@
+#include "accel/KdTree.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace raylabs {
+
+/// Recursive SAH builder (pbrt's): at every node the box edges of its primitives are sorted
+/// along an axis and swept once to price each edge as a split plane
+struct KdTree::Builder {
+    const std::vector<Aabb>& bounds;
+    const BuildOptions& options;
+    std::vector<Node>& nodes;
+    std::vector<std::uint32_t>& indices;
+
+    struct Edge {
+        float t;
+        std::uint32_t prim;
+        bool start;
+
+        bool operator<(const Edge& o) const {
+            // At the same position, starts come before ends
+            return t == o.t ? (start && !o.start) : t < o.t;
+        }
+    };
+    std::vector<Edge> edges;  // scratch, reused by every node
+
+    void make_leaf(const std::vector<std::uint32_t>& prims) {
+        Node leaf;
+        leaf.first = static_cast<std::uint32_t>(indices.size());
+        leaf.bits = 3u | (static_cast<std::uint32_t>(prims.size()) << 2);
+        indices.insert(indices.end(), prims.begin(), prims.end());
+        nodes.push_back(leaf);
+    }
+
+    void build(const Aabb& box, std::vector<std::uint32_t> prims, int depth, int bad_refines) {
+        const std::size_t n = prims.size();
+        if (n <= static_cast<std::size_t>(options.max_leaf_size) || depth == 0) {
+            make_leaf(prims);
+            return;
+        }
+
+        // Best plane, trying the longest axis first and the others if it has none
+        const Vec3 extent = box.extent();
+        const float inv_area = 1.0f / std::max(box.half_area(), 1e-30f);
+        const float leaf_cost = options.intersection_cost * static_cast<float>(n);
+        float best_cost = std::numeric_limits<float>::infinity();
+        int best_axis = -1;
+        std::size_t best_offset = 0;
+        int axis =
+            extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+        for (int retries = 0; retries < 3 && best_axis == -1; ++retries, axis = (axis + 1) % 3) {
+            edges.clear();
+            for (std::uint32_t p : prims) {
+                edges.push_back({bounds[p].min[axis], p, true});
+                edges.push_back({bounds[p].max[axis], p, false});
+            }
+            std::sort(edges.begin(), edges.end());
+
+            const int o0 = (axis + 1) % 3, o1 = (axis + 2) % 3;
+            std::size_t below = 0, above = n;
+            for (std::size_t i = 0; i < edges.size(); ++i) {
+                if (!edges[i].start)
+                    --above;
+                const float t = edges[i].t;
+                if (t > box.min[axis] && t < box.max[axis]) {
+                    // Half areas of the two children
+                    const float cross = extent[o0] * extent[o1];
+                    const float below_area =
+                        cross + (t - box.min[axis]) * (extent[o0] + extent[o1]);
+                    const float above_area =
+                        cross + (box.max[axis] - t) * (extent[o0] + extent[o1]);
+                    const float bonus = (below == 0 || above == 0) ? options.empty_bonus : 0.0f;
+                    const float cost =
+                        options.traversal_cost +
+                        options.intersection_cost * (1.0f - bonus) * inv_area *
+                            (below_area * static_cast<float>(below) +
+                             above_area * static_cast<float>(above));
+                    if (cost < best_cost) {
+                        best_cost = cost;
+                        best_axis = axis;
+                        best_offset = i;
+                    }
+                }
+                if (edges[i].start)
+                    ++below;
+            }
+        }
+
+        // A split costing more than the leaf is only kept a few times along a path, in case
+        // it makes way for better ones
+        if (best_cost > leaf_cost)
+            ++bad_refines;
+        if ((best_cost > 4.0f * leaf_cost && n < 16) || best_axis == -1 || bad_refines == 3) {
+            make_leaf(prims);
+            return;
+        }
+
+        // The search stops at the first axis offering a plane: the edges are sorted along it
+        const float split = edges[best_offset].t;
+        std::vector<std::uint32_t> below_prims;
+        std::vector<std::uint32_t> above_prims;
+        for (std::size_t i = 0; i < best_offset; ++i) {
+            if (edges[i].start)
+                below_prims.push_back(edges[i].prim);
+        }
+        for (std::size_t i = best_offset + 1; i < edges.size(); ++i) {
+            if (!edges[i].start)
+                above_prims.push_back(edges[i].prim);
+        }
+        prims.clear();
+        prims.shrink_to_fit();
+
+        Aabb below_box = box;
+        Aabb above_box = box;
+        below_box.max[best_axis] = split;
+        above_box.min[best_axis] = split;
+
+        const std::size_t self = nodes.size();
+        nodes.push_back(Node{});
+        build(below_box, std::move(below_prims), depth - 1, bad_refines);
+        Node& interior = nodes[self];
+        interior.split = split;
+        interior.bits = static_cast<std::uint32_t>(best_axis) |
+                        (static_cast<std::uint32_t>(nodes.size()) << 2);
+        build(above_box, std::move(above_prims), depth - 1, bad_refines);
+    }
+};
+
+void KdTree::clear() {
+    bounds_ = Aabb();
+    nodes_.clear();
+    indices_.clear();
+}
+
+void KdTree::build(const std::vector<Aabb>& bounds, const BuildOptions& options) {
+    clear();
+    if (bounds.empty())
+        return;
+    std::vector<std::uint32_t> prims(bounds.size());
+    for (std::size_t i = 0; i < bounds.size(); ++i) {
+        prims[i] = static_cast<std::uint32_t>(i);
+        bounds_.expand(bounds[i]);
+    }
+    int depth = options.max_depth;
+    if (depth <= 0) {
+        depth = static_cast<int>(
+            std::lround(8.0 + 2.0 * std::log2(static_cast<double>(bounds.size()))));
+    }
+    depth = std::min(depth, kMaxDepth);
+
+    Builder builder{bounds, options, nodes_, indices_, {}};
+    builder.build(bounds_, std::move(prims), depth, 0);
+}
+
+void KdTree::remap_indices(const std::vector<std::uint32_t>& ids) {
+    for (std::uint32_t& index : indices_)
+        index = ids[index];
+}
+
+}  // namespace raylabs
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "accel/Aabb.hpp"
+#include "core/Ray.hpp"
+
+namespace raylabs {
+
+/// Settings of the kd-tree builder (the pbrt SAH: a primitive test costs `intersection_cost`
+/// node steps, and splits that cut off empty space get `empty_bonus` off their cost)
+struct KdTreeBuildOptions {
+    float traversal_cost = 1.0f;
+    float intersection_cost = 80.0f;
+    float empty_bonus = 0.5f;
+    // A node stops splitting at this many primitives or this depth (0 = 8 + 2 log2(primitives),
+    // at most 60). Nodes holding a single primitive still split off the empty space around it,
+    // which takes a few levels more than pbrt's 8 + 1.3 log2(primitives) allows for.
+    int max_leaf_size = 0;
+    int max_depth = 0;
+};
+
+/// kd-tree over a set of primitive boxes: space is split by axis-aligned planes chosen with
+/// the surface area heuristic among the box edges of every node, and a primitive straddling
+/// a plane goes to both sides. Unlike BVH siblings, the two halves of a node never overlap,
+/// so a traversal front to back can stop at the first leaf holding a hit before its far
+/// plane, and large overlapping primitives do not make every ray descend both ways.
+/// Nodes take 8 bytes, stored depth-first with the child below the plane right after its
+/// parent. Primitives are referenced by their index in the box list given to build().
+class KdTree {
+   public:
+    struct Node {
+        union {
+            float split;          // interior: plane position
+            std::uint32_t first;  // leaf: first slot in indices()
+        };
+        // Low 2 bits: split axis, or 3 for a leaf. Above them: the child above the plane
+        // (interior) or the primitive count (leaf).
+        std::uint32_t bits;
+
+        bool is_leaf() const { return (bits & 3u) == 3u; }
+        int axis() const { return static_cast<int>(bits & 3u); }
+        std::uint32_t above() const { return bits >> 2; }
+        std::uint32_t count() const { return bits >> 2; }
+    };
+    static_assert(sizeof(Node) == 8, "kd-tree nodes are meant to be 8 bytes");
+
+    using BuildOptions = KdTreeBuildOptions;
+
+    /// Deepest tree the traversal stack can handle
+    static constexpr int kMaxDepth = 60;
+
+    /// Build over `bounds` (one box per primitive, all bounded). Replaces the previous tree.
+    void build(const std::vector<Aabb>& bounds, const BuildOptions& options = {});
+
+    /// Replace every primitive index i by ids[i], as Bvh::remap_indices()
+    void remap_indices(const std::vector<std::uint32_t>& ids);
+
+    void clear();
+    bool empty() const { return nodes_.empty(); }
+
+    const std::vector<Node>& nodes() const { return nodes_; }
+    const std::vector<std::uint32_t>& indices() const { return indices_; }
+    const Aabb& bounds() const { return bounds_; }
+
+    /// Bytes of nodes and primitive references
+    std::size_t memory_bytes() const {
+        return nodes_.size() * sizeof(Node) + indices_.size() * sizeof(std::uint32_t);
+    }
+
+    /// Closest-hit traversal with the same contract as Bvh::intersect(): leaves are visited
+    /// front to back and the walk stops once the next one starts beyond tMax
+    template <typename HitPrim>
+    bool intersect(const Ray& ray, float tMin, float& tMax, HitPrim&& hit_prim) const;
+
+   private:
+    struct Builder;
+
+    Aabb bounds_;
+    std::vector<Node> nodes_;
+    std::vector<std::uint32_t> indices_;
+};
+
+template <typename HitPrim>
+bool KdTree::intersect(const Ray& ray, float tMin, float& tMax, HitPrim&& hit_prim) const {
+    if (nodes_.empty())
+        return false;
+    const Vec3 inv_dir(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+
+    // Segment of the ray inside the root box
+    float t0 = tMin;
+    float t1 = tMax;
+    for (int axis = 0; axis < 3; ++axis) {
+        float near = (bounds_.min[axis] - ray.origin[axis]) * inv_dir[axis];
+        float far = (bounds_.max[axis] - ray.origin[axis]) * inv_dir[axis];
+        if (near > far) {
+            const float tmp = near;
+            near = far;
+            far = tmp;
+        }
+        t0 = near > t0 ? near : t0;
+        t1 = far < t1 ? far : t1;
+        if (t1 < t0)
+            return false;
+    }
+
+    struct Entry {
+        std::uint32_t node;
+        float t0, t1;  // segment of the ray inside the node
+    };
+    Entry stack[kMaxDepth + 1];
+    int top = 0;
+    std::uint32_t node = 0;
+
+    bool found = false;
+    while (true) {
+        // Skip nodes starting beyond the closest hit so far
+        const Node& n = nodes_[node];
+        if (tMax < t0) {
+            if (top == 0)
+                break;
+            const Entry entry = stack[--top];
+            node = entry.node;
+            t0 = entry.t0;
+            t1 = entry.t1;
+            continue;
+        }
+        if (!n.is_leaf()) {
+            const int axis = n.axis();
+            if (ray.direction[axis] == 0.0f && ray.origin[axis] == n.split) {
+                // Running inside the plane: primitives lying in it may be on either side
+                stack[top++] = {n.above(), t0, t1};
+                node = node + 1;
+                continue;
+            }
+            const float t_plane = (n.split - ray.origin[axis]) * inv_dir[axis];
+            // The child on the origin's side comes first
+            const bool below_first =
+                ray.origin[axis] < n.split ||
+                (ray.origin[axis] == n.split && ray.direction[axis] <= 0.0f);
+            const std::uint32_t first = below_first ? node + 1 : n.above();
+            const std::uint32_t second = below_first ? n.above() : node + 1;
+            if (t_plane > t1 || t_plane <= 0.0f) {
+                node = first;
+            } else if (t_plane < t0) {
+                node = second;
+            } else {
+                stack[top++] = {second, t_plane, t1};
+                node = first;
+                t1 = t_plane;
+            }
+            continue;
+        }
+
+        const std::uint32_t count = n.count();
+        for (std::uint32_t k = 0; k < count; ++k) {
+            if (hit_prim(indices_[n.first + k], tMax))
+                found = true;
+        }
+        if (top == 0)
+            break;
+        const Entry entry = stack[--top];
+        node = entry.node;
+        t0 = entry.t0;
+        t1 = entry.t1;
+    }
+    return found;
+}
+
+}  // namespace raylabs
@@ -0,0 +1,135 @@
+#include "accel/QuantizedBvh.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace raylabs {
+
+namespace {
+
+/// Grid of one axis of a node box: lo + q * 2^exponent for q in [0, 255]
+struct AxisGrid {
+    float origin;
+    std::int8_t exponent;
+    float step;
+
+    float decode(int q) const { return origin + static_cast<float>(q) * step; }
+
+    AxisGrid(float lo, float hi, float (*step_of)(std::int8_t)) : origin(lo) {
+        // Smallest step whose last grid line still reaches hi
+        const float extent = hi - lo;
+        int e = extent > 0.0f ? static_cast<int>(std::ceil(std::log2(extent / 255.0f))) : -126;
+        e = std::clamp(e, -126, 127);
+        step = step_of(static_cast<std::int8_t>(e));
+        while (decode(255) < hi && e < 127) {
+            ++e;
+            step = step_of(static_cast<std::int8_t>(e));
+        }
+        exponent = static_cast<std::int8_t>(e);
+    }
+
+    /// Largest grid line at or below v
+    std::uint8_t floor_of(float v) const {
+        int q = std::clamp(static_cast<int>(std::floor((v - origin) / step)), 0, 255);
+        while (q > 0 && decode(q) > v)
+            --q;
+        return static_cast<std::uint8_t>(q);
+    }
+    /// Smallest grid line at or above v
+    std::uint8_t ceil_of(float v) const {
+        int q = std::clamp(static_cast<int>(std::ceil((v - origin) / step)), 0, 255);
+        while (q < 255 && decode(q) < v)
+            ++q;
+        while (q > 0 && decode(q - 1) >= v)
+            --q;
+        return static_cast<std::uint8_t>(q);
+    }
+};
+
+}  // namespace
+
+template <int W>
+void QuantizedBvh<W>::clear() {
+    nodes_.clear();
+    indices_.clear();
+}
+
+template <int W>
+bool QuantizedBvh<W>::build(const WideBvh<W>& wide) {
+    clear();
+    if (wide.empty())
+        return true;
+    const FlatArray<typename WideBvh<W>::Node>& source = wide.nodes();
+    const FlatArray<std::uint32_t>& source_indices = wide.indices();
+    std::vector<Node> nodes(1);
+    std::vector<std::uint32_t> indices;
+    nodes.reserve(source.size());
+    indices.reserve(source_indices.size());
+
+    // Breadth-first, so that the interior children of a node get consecutive slots
+    std::vector<std::uint32_t> from{0};  // wide node behind every quantized node
+    for (std::size_t n = 0; n < from.size(); ++n) {
+        const typename WideBvh<W>::Node& src = source[from[n]];
+        Node node{};
+        node.children = static_cast<std::uint8_t>(src.children);
+
+        float lo[3] = {std::numeric_limits<float>::infinity(),
+                       std::numeric_limits<float>::infinity(),
+                       std::numeric_limits<float>::infinity()};
+        float hi[3] = {-lo[0], -lo[1], -lo[2]};
+        for (std::uint32_t i = 0; i < src.children; ++i) {
+            lo[0] = std::min(lo[0], src.min_x[i]);
+            lo[1] = std::min(lo[1], src.min_y[i]);
+            lo[2] = std::min(lo[2], src.min_z[i]);
+            hi[0] = std::max(hi[0], src.max_x[i]);
+            hi[1] = std::max(hi[1], src.max_y[i]);
+            hi[2] = std::max(hi[2], src.max_z[i]);
+        }
+        const AxisGrid gx(lo[0], hi[0], &step), gy(lo[1], hi[1], &step), gz(lo[2], hi[2], &step);
+        node.origin[0] = gx.origin;
+        node.origin[1] = gy.origin;
+        node.origin[2] = gz.origin;
+        node.exponent[0] = gx.exponent;
+        node.exponent[1] = gy.exponent;
+        node.exponent[2] = gz.exponent;
+
+        node.child_base = static_cast<std::uint32_t>(nodes.size());
+        node.prim_base = static_cast<std::uint32_t>(indices.size());
+        std::uint32_t interior = 0;
+        std::uint32_t prims = 0;
+        for (std::uint32_t i = 0; i < src.children; ++i) {
+            node.lo_x[i] = gx.floor_of(src.min_x[i]);
+            node.lo_y[i] = gy.floor_of(src.min_y[i]);
+            node.lo_z[i] = gz.floor_of(src.min_z[i]);
+            node.hi_x[i] = gx.ceil_of(src.max_x[i]);
+            node.hi_y[i] = gy.ceil_of(src.max_y[i]);
+            node.hi_z[i] = gz.ceil_of(src.max_z[i]);
+            const std::uint32_t count = src.count[i];
+            if (count == 0) {
+                node.offset[i] = static_cast<std::uint16_t>(interior++);
+                node.count[i] = 0;
+                from.push_back(src.child[i]);
+                nodes.push_back(Node{});
+                continue;
+            }
+            if (prims + count > std::numeric_limits<std::uint16_t>::max())
+                return false;
+            node.offset[i] = static_cast<std::uint16_t>(prims);
+            node.count[i] = static_cast<std::uint16_t>(count);
+            prims += count;
+            for (std::uint32_t k = 0; k < count; ++k)
+                indices.push_back(source_indices[src.child[i] + k]);
+        }
+        nodes[n] = node;
+    }
+    nodes_ = std::move(nodes);
+    indices_ = std::move(indices);
+    return true;
+}
+
+template class QuantizedBvh<4>;
+template class QuantizedBvh<8>;
+
+}  // namespace raylabs
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "accel/Bvh.hpp"
+#include "accel/FlatArray.hpp"
+#include "accel/WideBvh.hpp"
+#include "core/Ray.hpp"
+#include "math/Simd.hpp"
+
+namespace raylabs {
+
+/// Compressed W-wide BVH (W = 4 or 8) built from a WideBvh: each node keeps its own box as
+/// a float origin and a power-of-two step per axis, and the boxes of its children as 8-bit
+/// offsets on that grid, rounded outwards. Children are addressed by 16-bit offsets from
+/// two 32-bit bases (the interior children of a node are stored next to each other, and so
+/// are the primitive indices of its leaves). A BVH4 node takes 64 bytes instead of 192, a
+/// BVH8 node 128 instead of 320.
+/// Decoding is exact: q * 2^e is representable, so origin + q * 2^e rounds the same way in
+/// the builder and in the traversal, and the builder checks that every decoded box
+/// contains the child's. Quantized boxes are a little larger, so rays visit a few more
+/// nodes, but no hit is lost.
+template <int W>
+class QuantizedBvh {
+    static_assert(W == 4 || W == 8, "QuantizedBvh supports 4 or 8 children per node");
+
+   public:
+    struct alignas(W == 4 ? 64 : 32) Node {
+        float origin[3];           // min corner of the node box
+        std::int8_t exponent[3];   // grid step of each axis: 2^exponent
+        std::uint8_t children;     // used slots, always the first ones
+        std::uint32_t child_base;  // first interior child node
+        std::uint32_t prim_base;   // first slot in indices() of the leaf children
+        std::uint8_t lo_x[W], lo_y[W], lo_z[W];
+        std::uint8_t hi_x[W], hi_y[W], hi_z[W];
+        std::uint16_t offset[W];  // from child_base (interior child) or prim_base (leaf)
+        std::uint16_t count[W];   // primitives of a leaf child, 0 for an interior child
+    };
+    static_assert(W != 4 || sizeof(Node) == 64, "BVH4 quantized nodes fill one cache line");
+
+    /// Compress `wide`. Returns false (and stays empty) if a node has more leaf primitives
+    /// than 16-bit offsets can address; keep using the full-precision tree then.
+    bool build(const WideBvh<W>& wide);
+
+    void clear();
+    bool empty() const { return nodes_.empty(); }
+
+    const FlatArray<Node>& nodes() const { return nodes_; }
+    const FlatArray<std::uint32_t>& indices() const { return indices_; }
+
+    /// Bytes of nodes and primitive indices
+    std::size_t memory_bytes() const {
+        return nodes_.size() * sizeof(Node) + indices_.size() * sizeof(std::uint32_t);
+    }
+
+    /// Closest-hit traversal with the same contract as Bvh::intersect()
+    template <typename HitPrim>
+    bool intersect(const Ray& ray, float tMin, float& tMax, HitPrim&& hit_prim) const;
+
+    /// 2^e as a float (e in the normal range)
+    static float step(std::int8_t e) {
+        const auto bits = static_cast<std::uint32_t>(e + 127) << 23;
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+   private:
+    FlatArray<Node> nodes_;
+    FlatArray<std::uint32_t> indices_;  // the wide tree's, regrouped by node
+};
+
+template <int W>
+template <typename HitPrim>
+bool QuantizedBvh<W>::intersect(const Ray& ray, float tMin, float& tMax,
+                                HitPrim&& hit_prim) const {
+    using F = simd::vfloat<W>;
+    if (nodes_.empty())
+        return false;
+
+    const F ox(ray.origin.x), oy(ray.origin.y), oz(ray.origin.z);
+    const F ix(1.0f / ray.direction.x), iy(1.0f / ray.direction.y), iz(1.0f / ray.direction.z);
+
+    struct Entry {
+        std::uint32_t ref;    // node index, or first index slot of a leaf
+        std::uint32_t count;  // 0 = node
+        float t;              // where the ray enters the child
+    };
+    Entry stack[Bvh::kMaxDepth * (W - 1) + 2];
+    int top = 0;
+    stack[top++] = {0, 0, tMin};
+
+    bool found = false;
+    while (top > 0) {
+        const Entry entry = stack[--top];
+        if (entry.t > tMax)
+            continue;
+        if (entry.count > 0) {
+            for (std::uint32_t k = 0; k < entry.count; ++k) {
+                if (hit_prim(indices_[entry.ref + k], tMax))
+                    found = true;
+            }
+            continue;
+        }
+
+        // Decode the child boxes (exactly as the builder checked them), then one slab test
+        const Node& node = nodes_[entry.ref];
+        const F bx(node.origin[0]), by(node.origin[1]), bz(node.origin[2]);
+        const F sx(step(node.exponent[0])), sy(step(node.exponent[1])),
+            sz(step(node.exponent[2]));
+        const F tx0 = (bx + F::load_u8(node.lo_x) * sx - ox) * ix;
+        const F tx1 = (bx + F::load_u8(node.hi_x) * sx - ox) * ix;
+        const F ty0 = (by + F::load_u8(node.lo_y) * sy - oy) * iy;
+        const F ty1 = (by + F::load_u8(node.hi_y) * sy - oy) * iy;
+        const F tz0 = (bz + F::load_u8(node.lo_z) * sz - oz) * iz;
+        const F tz1 = (bz + F::load_u8(node.hi_z) * sz - oz) * iz;
+        const F t_near = max(max(min(tx0, tx1), min(ty0, ty1)), max(min(tz0, tz1), F(tMin)));
+        const F t_far = min(min(max(tx0, tx1), max(ty0, ty1)), min(max(tz0, tz1), F(tMax)));
+        std::uint32_t bits = (t_near <= t_far).bits() & ((1u << node.children) - 1u);
+        if (bits == 0)
+            continue;
+
+        alignas(64) float near[W];
+        t_near.store(near);
+        // Push the hit children far to near so that the nearest is popped first
+        const int base = top;
+        while (bits != 0) {
+            const int i = __builtin_ctz(bits);
+            bits &= bits - 1;
+            const std::uint32_t count = node.count[i];
+            Entry e{(count > 0 ? node.prim_base : node.child_base) + node.offset[i], count,
+                    near[i]};
+            int j = top++;
+            while (j > base && stack[j - 1].t < e.t) {
+                stack[j] = stack[j - 1];
+                --j;
+            }
+            stack[j] = e;
+        }
+    }
+    return found;
+}
+
+extern template class QuantizedBvh<4>;
+extern template class QuantizedBvh<8>;
+
+}  // namespace raylabs
@@ -0,0 +1,92 @@
+#include "accel/UniformGrid.hpp"
+
+namespace raylabs {
+
+namespace {
+
+/// Cells per axis are capped so that the offsets stay small next to the scene itself
+constexpr int kMaxResolution = 512;
+
+}  // namespace
+
+void UniformGrid::clear() {
+    bounds_ = Aabb();
+    res_[0] = res_[1] = res_[2] = 0;
+    cell_start_.clear();
+    items_.clear();
+}
+
+void UniformGrid::build(const std::vector<Aabb>& bounds, float density) {
+    clear();
+    if (bounds.empty())
+        return;
+    for (const Aabb& box : bounds)
+        bounds_.expand(box);
+
+    // Cubic cells sized for `density` cells per primitive. A flat scene gets a thin slab
+    // instead of a zero volume, and a few more cells along its flat axis do no harm.
+    const Vec3 extent = bounds_.extent();
+    const float largest = std::max(extent.x, std::max(extent.y, extent.z));
+    const float pad = largest > 0.0f ? 1e-3f * largest : 1.0f;
+    float ext[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        ext[axis] = std::max(extent[axis], pad);
+        if (extent[axis] < pad)
+            bounds_.max[axis] = bounds_.min[axis] + pad;
+    }
+    const double volume = static_cast<double>(ext[0]) * ext[1] * ext[2];
+    const double cell = std::cbrt(volume / (static_cast<double>(density) * bounds.size()));
+    for (int axis = 0; axis < 3; ++axis) {
+        res_[axis] = std::clamp(static_cast<int>(std::ceil(ext[axis] / cell)), 1, kMaxResolution);
+        cell_size_[axis] = ext[axis] / static_cast<float>(res_[axis]);
+        inv_cell_size_[axis] = 1.0f / cell_size_[axis];
+    }
+
+    // Cell range covered by every box, widened by a sliver so that rounding in the DDA
+    // never walks a ray through a cell that misses a box it touches
+    auto cell_range = [&](const Aabb& box, int lo[3], int hi[3]) {
+        for (int axis = 0; axis < 3; ++axis) {
+            const float margin = 1e-4f * cell_size_[axis];
+            const float u0 = (box.min[axis] - margin - bounds_.min[axis]) * inv_cell_size_[axis];
+            const float u1 = (box.max[axis] + margin - bounds_.min[axis]) * inv_cell_size_[axis];
+            lo[axis] = std::clamp(static_cast<int>(std::floor(u0)), 0, res_[axis] - 1);
+            hi[axis] = std::clamp(static_cast<int>(std::floor(u1)), 0, res_[axis] - 1);
+        }
+    };
+    auto cell_index = [&](int x, int y, int z) {
+        return (static_cast<std::size_t>(z) * static_cast<std::size_t>(res_[1]) +
+                static_cast<std::size_t>(y)) *
+                   static_cast<std::size_t>(res_[0]) +
+               static_cast<std::size_t>(x);
+    };
+
+    // Two passes: count the references of every cell, then fill them in at their offsets
+    const std::size_t cells = static_cast<std::size_t>(res_[0]) * res_[1] * res_[2];
+    cell_start_.assign(cells + 1, 0);
+    int lo[3], hi[3];
+    for (const Aabb& box : bounds) {
+        cell_range(box, lo, hi);
+        for (int z = lo[2]; z <= hi[2]; ++z)
+            for (int y = lo[1]; y <= hi[1]; ++y)
+                for (int x = lo[0]; x <= hi[0]; ++x)
+                    ++cell_start_[cell_index(x, y, z) + 1];
+    }
+    for (std::size_t c = 0; c < cells; ++c)
+        cell_start_[c + 1] += cell_start_[c];
+    items_.resize(cell_start_[cells]);
+    std::vector<std::uint32_t> cursor(cell_start_.begin(), cell_start_.end() - 1);
+    for (std::size_t i = 0; i < bounds.size(); ++i) {
+        cell_range(bounds[i], lo, hi);
+        for (int z = lo[2]; z <= hi[2]; ++z)
+            for (int y = lo[1]; y <= hi[1]; ++y)
+                for (int x = lo[0]; x <= hi[0]; ++x)
+                    items_[cursor[cell_index(x, y, z)]++] = static_cast<std::uint32_t>(i);
+    }
+}
+
+void UniformGrid::remap_indices(const std::vector<std::uint32_t>& ids) {
+    for (std::uint32_t& item : items_)
+        item = ids[item];
+}
+
+}  // namespace raylabs
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "accel/Aabb.hpp"
+#include "core/Ray.hpp"
+
+namespace raylabs {
+
+/// Uniform grid over a set of primitive boxes, walked cell by cell with a 3D DDA
+/// (Amanatides & Woo). The resolution gives about `density` cells per primitive, shaped
+/// after the scene box. Every cell lists the primitives whose box overlaps it, in one array
+/// indexed by per-cell offsets, so a primitive spanning several cells is listed in each.
+/// No hierarchy to descend: cheap to build and fast on evenly filled volumes, but cells in
+/// dense clusters of a sparse scene hold many primitives and empty space costs steps.
+class UniformGrid {
+   public:
+    /// Build over `bounds` (one box per primitive, all bounded). Replaces the previous grid.
+    void build(const std::vector<Aabb>& bounds, float density = 2.0f);
+
+    /// Replace every primitive index i by ids[i], as Bvh::remap_indices()
+    void remap_indices(const std::vector<std::uint32_t>& ids);
+
+    void clear();
+    bool empty() const { return cell_start_.empty(); }
+
+    const Aabb& bounds() const { return bounds_; }
+    int resolution(int axis) const { return res_[axis]; }
+    std::size_t cell_count() const { return cell_start_.empty() ? 0 : cell_start_.size() - 1; }
+    /// Primitive references: every primitive once per cell it overlaps
+    std::size_t reference_count() const { return items_.size(); }
+
+    /// Bytes of the cell offsets and primitive references
+    std::size_t memory_bytes() const {
+        return (cell_start_.size() + items_.size()) * sizeof(std::uint32_t);
+    }
+
+    /// Closest-hit traversal with the same contract as Bvh::intersect(): cells are visited
+    /// in ray order and the walk stops at the first cell the ray leaves after tMax
+    template <typename HitPrim>
+    bool intersect(const Ray& ray, float tMin, float& tMax, HitPrim&& hit_prim) const;
+
+   private:
+    Aabb bounds_;
+    int res_[3] = {0, 0, 0};
+    float cell_size_[3] = {0.0f, 0.0f, 0.0f};
+    float inv_cell_size_[3] = {0.0f, 0.0f, 0.0f};
+    std::vector<std::uint32_t> cell_start_;  // cell c lists items_[cell_start_[c], [c + 1])
+    std::vector<std::uint32_t> items_;
+};
+
+template <typename HitPrim>
+bool UniformGrid::intersect(const Ray& ray, float tMin, float& tMax, HitPrim&& hit_prim) const {
+    if (cell_start_.empty())
+        return false;
+
+    // Clip the ray to the grid box
+    float t0 = tMin;
+    float t1 = tMax;
+    float inv_dir[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        inv_dir[axis] = 1.0f / ray.direction[axis];
+        float near = (bounds_.min[axis] - ray.origin[axis]) * inv_dir[axis];
+        float far = (bounds_.max[axis] - ray.origin[axis]) * inv_dir[axis];
+        if (near > far)
+            std::swap(near, far);
+        t0 = near > t0 ? near : t0;
+        t1 = far < t1 ? far : t1;
+        if (t1 < t0)
+            return false;
+    }
+
+    // Starting cell, and per axis the step, the t of the next cell boundary and the t
+    // between two boundaries
+    int cell[3];
+    int step[3];
+    int stop[3];
+    float t_next[3];
+    float t_delta[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        const float p = ray.origin[axis] + t0 * ray.direction[axis];
+        cell[axis] = std::clamp(
+            static_cast<int>((p - bounds_.min[axis]) * inv_cell_size_[axis]), 0, res_[axis] - 1);
+        const float d = ray.direction[axis];
+        if (d > 0.0f) {
+            step[axis] = 1;
+            stop[axis] = res_[axis];
+            t_next[axis] = (bounds_.min[axis] + static_cast<float>(cell[axis] + 1) *
+                                                    cell_size_[axis] -
+                            ray.origin[axis]) *
+                           inv_dir[axis];
+            t_delta[axis] = cell_size_[axis] * inv_dir[axis];
+        } else if (d < 0.0f) {
+            step[axis] = -1;
+            stop[axis] = -1;
+            t_next[axis] =
+                (bounds_.min[axis] + static_cast<float>(cell[axis]) * cell_size_[axis] -
+                 ray.origin[axis]) *
+                inv_dir[axis];
+            t_delta[axis] = -cell_size_[axis] * inv_dir[axis];
+        } else {
+            step[axis] = 0;
+            stop[axis] = -1;
+            t_next[axis] = std::numeric_limits<float>::infinity();
+            t_delta[axis] = 0.0f;
+        }
+    }
+
+    bool found = false;
+    while (true) {
+        const std::size_t c =
+            (static_cast<std::size_t>(cell[2]) * static_cast<std::size_t>(res_[1]) +
+             static_cast<std::size_t>(cell[1])) *
+                static_cast<std::size_t>(res_[0]) +
+            static_cast<std::size_t>(cell[0]);
+        for (std::uint32_t k = cell_start_[c]; k < cell_start_[c + 1]; ++k) {
+            if (hit_prim(items_[k], tMax))
+                found = true;
+        }
+
+        // Leave through the nearest boundary; a hit before it cannot be beaten further on
+        const int axis = t_next[0] < t_next[1] ? (t_next[0] < t_next[2] ? 0 : 2)
+                                               : (t_next[1] < t_next[2] ? 1 : 2);
+        const float t_exit = t_next[axis];
+        if (tMax <= t_exit || t_exit > t1)
+            break;
+        cell[axis] += step[axis];
+        if (cell[axis] == stop[axis])
+            break;
+        t_next[axis] += t_delta[axis];
+    }
+    return found;
+}
+
+}  // namespace raylabs
@@ -0,0 +1,134 @@
+#include "accel/WideBvh.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace raylabs {
+
+namespace {
+
+template <typename WideNode>
+void set_slot(WideNode& node, int i, const Bvh::Node& child) {
+    node.min_x[i] = child.min[0];
+    node.min_y[i] = child.min[1];
+    node.min_z[i] = child.min[2];
+    node.max_x[i] = child.max[0];
+    node.max_y[i] = child.max[1];
+    node.max_z[i] = child.max[2];
+}
+
+}  // namespace
+
+template <int W>
+void WideBvh<W>::clear() {
+    nodes_.clear();
+    indices_.clear();
+    sources_.clear();
+}
+
+template <int W>
+void WideBvh<W>::adopt(FlatArray<Node> nodes, FlatArray<std::uint32_t> indices,
+                       FlatArray<std::uint32_t> sources) {
+    nodes_ = std::move(nodes);
+    indices_ = std::move(indices);
+    sources_ = std::move(sources);
+}
+
+template <int W>
+void WideBvh<W>::refit(const Bvh& bvh) {
+    const FlatArray<Bvh::Node>& binary = bvh.nodes();
+    for (std::size_t n = 0; n < nodes_.size(); ++n) {
+        Node& node = nodes_[n];
+        for (std::uint32_t i = 0; i < node.children; ++i)
+            set_slot(node, static_cast<int>(i), binary[sources_[n * W + i]]);
+    }
+}
+
+template <int W>
+void WideBvh<W>::build(const Bvh& bvh) {
+    clear();
+    if (bvh.empty())
+        return;
+    const FlatArray<Bvh::Node>& binary = bvh.nodes();
+    indices_ = bvh.indices();
+    const std::size_t expected_nodes = binary.size() / (W - 1) + 1;
+    nodes_.reserve(expected_nodes);
+    sources_.reserve(expected_nodes * W);
+
+    struct Task {
+        std::uint32_t binary_node;  // interior node of the binary tree...
+        std::uint32_t wide_node;    // ...collapsed into this node
+    };
+    std::vector<Task> work;
+    nodes_.push_back(Node{});
+    sources_.assign(W, 0);
+    if (binary[0].is_leaf()) {
+        // Single leaf: a root with one slot
+        Node& root = nodes_[0];
+        const Bvh::Node& leaf = binary[0];
+        set_slot(root, 0, leaf);
+        root.child[0] = leaf.offset;
+        root.count[0] = leaf.count;
+        root.children = 1;
+        return;
+    }
+    work.push_back({0, 0});
+
+    while (!work.empty()) {
+        const Task task = work.back();
+        work.pop_back();
+
+        // Open the largest interior child until W slots are filled (or only leaves remain)
+        std::uint32_t slots[W];
+        int used = 2;
+        slots[0] = binary[task.binary_node].offset;
+        slots[1] = binary[task.binary_node].offset + 1;
+        while (used < W) {
+            int widest = -1;
+            float widest_area = -1.0f;
+            for (int i = 0; i < used; ++i) {
+                const Bvh::Node& node = binary[slots[i]];
+                const float area = node.bounds().half_area();
+                if (!node.is_leaf() && area > widest_area) {
+                    widest = i;
+                    widest_area = area;
+                }
+            }
+            if (widest < 0)
+                break;
+            const std::uint32_t left = binary[slots[widest]].offset;
+            slots[widest] = left;
+            slots[used++] = left + 1;
+        }
+
+        // Unused slots keep a well-defined box; they are masked out by `children` anyway
+        Node node{};
+        node.children = static_cast<std::uint32_t>(used);
+        for (int i = 0; i < W; ++i) {
+            node.min_x[i] = node.min_y[i] = node.min_z[i] = 0.0f;
+            node.max_x[i] = node.max_y[i] = node.max_z[i] = 0.0f;
+        }
+        for (int i = 0; i < used; ++i) {
+            const Bvh::Node& child = binary[slots[i]];
+            set_slot(node, i, child);
+            if (child.is_leaf()) {
+                node.child[i] = child.offset;
+                node.count[i] = child.count;
+            } else {
+                const auto index = static_cast<std::uint32_t>(nodes_.size());
+                nodes_.push_back(Node{});
+                sources_.resize(nodes_.size() * W, 0);
+                node.child[i] = index;
+                node.count[i] = 0;
+                work.push_back({slots[i], index});
+            }
+        }
+        nodes_[task.wide_node] = node;
+        std::copy(slots, slots + used, sources_.begin() + task.wide_node * W);
+    }
+}
+
+template class WideBvh<4>;
+template class WideBvh<8>;
+
+}  // namespace raylabs
@@ -0,0 +1,253 @@
+#include "app/CliOptions.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace raylabs {
+
+namespace {
+
+int parse_int(std::string_view flag, const std::string& value) {
+    try {
+        std::size_t used = 0;
+        int v = std::stoi(value, &used);
+        if (used == value.size())
+            return v;
+    } catch (const std::exception&) {
+    }
+    throw std::runtime_error(std::string(flag) + " expects an integer, got '" + value + "'");
+}
+
+float parse_float(std::string_view flag, const std::string& value) {
+    try {
+        std::size_t used = 0;
+        float v = std::stof(value, &used);
+        if (used == value.size())
+            return v;
+    } catch (const std::exception&) {
+    }
+    throw std::runtime_error(std::string(flag) + " expects a number, got '" + value + "'");
+}
+
+/// "x,y,w,h" -> {x, y, w, h}
+std::array<int, 4> parse_rect(std::string_view flag, const std::string& value) {
+    std::array<int, 4> rect{};
+    std::size_t start = 0;
+    for (std::size_t k = 0; k < rect.size(); ++k) {
+        const std::size_t end = k + 1 < rect.size() ? value.find(',', start) : value.size();
+        if (end == std::string::npos)
+            throw std::runtime_error(std::string(flag) + " expects x,y,width,height, got '" +
+                                     value + "'");
+        rect[k] = parse_int(flag, value.substr(start, end - start));
+        start = end + 1;
+    }
+    return rect;
+}
+
+}  // namespace
+
+CliOptions CliOptions::parse(int argc, const char* const argv[]) {
+    CliOptions opts;
+    bool scene_seen = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto next_value = [&](std::string_view flag) -> std::string {
+            if (i + 1 >= argc)
+                throw std::runtime_error(std::string(flag) + " requires a value");
+            return argv[++i];
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            opts.show_help = true;
+        } else if (arg == "-t" || arg == "--threads") {
+            opts.threads = parse_int(arg, next_value(arg));
+            if (*opts.threads < 0)
+                throw std::runtime_error("--threads must be >= 0");
+        } else if (arg == "-s" || arg == "--samples") {
+            opts.samples = parse_int(arg, next_value(arg));
+            if (*opts.samples <= 0)
+                throw std::runtime_error("--samples must be > 0");
+        } else if (arg == "--time-budget") {
+            opts.time_budget_ms = parse_int(arg, next_value(arg));
+            if (*opts.time_budget_ms < 0)
+                throw std::runtime_error("--time-budget must be >= 0");
+        } else if (arg == "-p" || arg == "--progressive") {
+            opts.progressive = true;
+        } else if (arg == "-a" || arg == "--adaptive") {
+            opts.adaptive = true;
+        } else if (arg == "--adaptive-threshold") {
+            opts.adaptive_threshold = parse_float(arg, next_value(arg));
+            if (*opts.adaptive_threshold <= 0.f)
+                throw std::runtime_error("--adaptive-threshold must be > 0");
+            opts.adaptive = true;
+        } else if (arg == "--spp-image") {
+            opts.spp_output = next_value(arg);
+        } else if (arg == "--packet") {
+            opts.packet_size = parse_int(arg, next_value(arg));
+            if (*opts.packet_size == 1)
+                opts.packet_size = 0;
+            if (*opts.packet_size != 0 && *opts.packet_size != 4 && *opts.packet_size != 8 &&
+                *opts.packet_size != 16)
+                throw std::runtime_error("--packet must be 0, 4, 8 or 16");
+        } else if (arg == "--integrator") {
+            opts.integrator = next_value(arg);
+            if (*opts.integrator != "path" && *opts.integrator != "pathtracer" &&
+                *opts.integrator != "wavefront")
+                throw std::runtime_error("--integrator must be 'path' or 'wavefront'");
+        } else if (arg == "--ray-sort") {
+            opts.ray_sort = true;
+        } else if (arg == "--tile-order") {
+            opts.tile_order = next_value(arg);
+            if (*opts.tile_order != "hilbert" && *opts.tile_order != "morton" &&
+                *opts.tile_order != "row")
+                throw std::runtime_error("--tile-order must be 'hilbert', 'morton' or 'row'");
+        } else if (arg == "--bvh-width") {
+            opts.bvh_width = parse_int(arg, next_value(arg));
+            if (*opts.bvh_width != 2 && *opts.bvh_width != 4 && *opts.bvh_width != 8)
+                throw std::runtime_error("--bvh-width must be 2, 4 or 8");
+        } else if (arg == "--bvh-quantized") {
+            opts.bvh_quantized = true;
+        } else if (arg == "--bvh-spatial-splits") {
+            opts.bvh_spatial_splits = parse_float(arg, next_value(arg));
+            if (*opts.bvh_spatial_splits < 0.f)
+                throw std::runtime_error("--bvh-spatial-splits must be >= 0");
+        } else if (arg == "--bvh-cache") {
+            opts.bvh_cache = next_value(arg);
+        } else if (arg == "--accelerator") {
+            opts.accelerator = next_value(arg);
+            if (*opts.accelerator != "bvh" && *opts.accelerator != "grid" &&
+                *opts.accelerator != "kdtree" && *opts.accelerator != "auto")
+                throw std::runtime_error("--accelerator must be 'bvh', 'grid', 'kdtree' or 'auto'");
+        } else if (arg == "--checkpoint") {
+            opts.checkpoint_path = next_value(arg);
+        } else if (arg == "--checkpoint-interval") {
+            opts.checkpoint_interval_ms = parse_int(arg, next_value(arg));
+            if (*opts.checkpoint_interval_ms < 0)
+                throw std::runtime_error("--checkpoint-interval must be >= 0");
+        } else if (arg == "--resume") {
+            opts.resume_path = next_value(arg);
+        } else if (arg == "--crop") {
+            opts.crop = parse_rect(arg, next_value(arg));
+            const auto& [x, y, w, h] = *opts.crop;
+            if (x < 0 || y < 0 || w <= 0 || h <= 0)
+                throw std::runtime_error("--crop needs x, y >= 0 and width, height > 0");
+        } else if (arg == "--crop-full") {
+            opts.crop_full_frame = true;
+        } else if (arg == "--farm") {
+            opts.farm_workers = parse_int(arg, next_value(arg));
+            if (*opts.farm_workers < 0)
+                throw std::runtime_error("--farm must be >= 0");
+        } else if (arg == "--farm-port") {
+            opts.farm_port = parse_int(arg, next_value(arg));
+            if (opts.farm_port < 0 || opts.farm_port > 65535)
+                throw std::runtime_error("--farm-port must be in [0, 65535]");
+        } else if (arg == "--farm-tile") {
+            opts.farm_tile = parse_int(arg, next_value(arg));
+            if (opts.farm_tile <= 0)
+                throw std::runtime_error("--farm-tile must be > 0");
+        } else if (arg == "--worker") {
+            const std::string address = next_value(arg);
+            const std::size_t colon = address.rfind(':');
+            if (colon == std::string::npos || colon == 0)
+                throw std::runtime_error("--worker expects <host>:<port>, got '" + address + "'");
+            opts.worker_host = address.substr(0, colon);
+            opts.worker_port = parse_int(arg, address.substr(colon + 1));
+            if (opts.worker_port <= 0 || opts.worker_port > 65535)
+                throw std::runtime_error("--worker port must be in [1, 65535]");
+        } else if (!arg.empty() && arg[0] == '-') {
+            throw std::runtime_error("Unknown option: " + arg);
+        } else {
+            if (scene_seen)
+                throw std::runtime_error("Only one scene file may be given (got '" + arg + "')");
+            opts.scene_file = arg;
+            scene_seen = true;
+        }
+    }
+    return opts;
+}
+
+std::string CliOptions::usage(const std::string& program) {
+    std::ostringstream oss;
+    oss << "Usage: " << program << " [options] [scene.json]\n"
+        << "Options:\n"
+        << "  -h, --help             Show this message\n"
+        << "  -t, --threads <n>      Render threads (0 = one per core; overrides image.threads)\n"
+        << "  -s, --samples <n>      Samples per pixel (target spp in progressive mode)\n"
+        << "  -p, --progressive      Render whole-frame passes of one sample per pixel\n"
+        << "      --time-budget <ms> Stop progressive rendering after <ms> milliseconds\n"
+        << "  -a, --adaptive         Variance-driven adaptive sampling (--samples = mean spp)\n"
+        << "      --adaptive-threshold <e>  Relative error at which a pixel stops (implies -a)\n"
+        << "      --spp-image <path> Write a debug image of the spp spent per pixel\n"
+        << "      --packet <n>       Trace camera rays as SIMD packets of 4, 8 or 16 (0 = off)\n"
+        << "      --integrator <name>  'path' (recursive) or 'wavefront' (batched stages)\n"
+        << "      --ray-sort         Wavefront: sort bounced rays by direction and origin\n"
+        << "      --tile-order <o>   Tile traversal: 'hilbert' (default), 'morton' or 'row'\n"
+        << "      --bvh-width <n>    Children per BVH node: 2, 4 (default) or 8\n"
+        << "      --bvh-quantized    Compress the BVH4/8 nodes (8-bit child boxes)\n"
+        << "      --bvh-spatial-splits <f>  Split space too (SBVH), <f> extra refs per primitive\n"
+        << "      --bvh-cache <dir>  Reuse (mmap) BVHs built by earlier runs, cached in <dir>\n"
+        << "      --accelerator <a>  'bvh' (default), 'grid', 'kdtree' or 'auto' (from the scene)\n"
+        << "      --checkpoint <path>  Periodically save the render state to <path>\n"
+        << "      --checkpoint-interval <ms>  Time between checkpoints (0 = every pass)\n"
+        << "      --resume <path>    Continue the render saved in checkpoint <path>\n"
+        << "      --crop <x,y,w,h>   Only render this pixel rectangle (written as a cropped image)\n"
+        << "      --crop-full        With a crop window, write the full frame (black outside)\n"
+        << "      --farm <n>         Coordinate a tile farm with <n> local worker processes\n"
+        << "      --farm-port <port> Port the farm listens on for (remote) workers (0 = any)\n"
+        << "      --farm-tile <px>   Edge of the tiles handed to farm workers (default 64)\n"
+        << "      --worker <host:port>  Render tiles for the coordinator at <host:port>\n";
+    return oss.str();
+}
+
+void CliOptions::apply(io::ImageDTO& image) const {
+    if (threads)
+        image.threads = *threads;
+    if (samples)
+        image.samples = *samples;
+    if (time_budget_ms)
+        image.time_budget_ms = *time_budget_ms;
+    if (progressive)
+        image.progressive = true;
+    if (adaptive)
+        image.adaptive = true;
+    if (adaptive_threshold)
+        image.adaptive_threshold = *adaptive_threshold;
+    if (spp_output)
+        image.spp_output = *spp_output;
+    if (packet_size)
+        image.packet_size = *packet_size;
+    if (integrator)
+        image.integrator = *integrator;
+    if (ray_sort)
+        image.ray_sort = true;
+    if (tile_order)
+        image.tile_order = *tile_order;
+    if (bvh_width)
+        image.bvh_width = *bvh_width;
+    if (bvh_quantized)
+        image.bvh_quantized = true;
+    if (bvh_spatial_splits)
+        image.bvh_spatial_splits = *bvh_spatial_splits;
+    if (bvh_cache)
+        image.bvh_cache = *bvh_cache;
+    if (accelerator)
+        image.accelerator = *accelerator;
+    if (checkpoint_path)
+        image.checkpoint_path = *checkpoint_path;
+    if (checkpoint_interval_ms)
+        image.checkpoint_interval_ms = *checkpoint_interval_ms;
+    if (resume_path)
+        image.resume_path = *resume_path;
+    if (crop) {
+        image.crop_x = (*crop)[0];
+        image.crop_y = (*crop)[1];
+        image.crop_width = (*crop)[2];
+        image.crop_height = (*crop)[3];
+    }
+    if (crop_full_frame)
+        image.crop_full_frame = true;
+}
+
+}  // namespace raylabs
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <optional>
+#include <string>
+
+#include "io/JsonSceneLoader.hpp"
+
+namespace raylabs {
+
+/// Command line options of raylabs_app.
+/// Usage: raylabs [options] [scene.json]
+/// Values given on the command line override the matching fields of the scene file.
+struct CliOptions {
+    std::string scene_file = "assets/scenes/multiple_spheres.json";
+    bool show_help = false;
+    std::optional<int> threads;
+    std::optional<int> samples;
+    std::optional<int> time_budget_ms;
+    bool progressive = false;
+    bool adaptive = false;
+    std::optional<float> adaptive_threshold;
+    std::optional<std::string> spp_output;
+    std::optional<int> packet_size;
+    std::optional<std::string> integrator;
+    bool ray_sort = false;
+    std::optional<std::string> tile_order;
+    std::optional<int> bvh_width;
+    std::optional<std::string> bvh_cache;
+    std::optional<std::string> accelerator;
+    bool bvh_quantized = false;
+    std::optional<float> bvh_spatial_splits;
+    std::optional<std::string> checkpoint_path;
+    std::optional<int> checkpoint_interval_ms;
+    std::optional<std::string> resume_path;
+    std::optional<std::array<int, 4>> crop;  // x, y, width, height
+    bool crop_full_frame = false;
+    // Tile farm: coordinator with `farm_workers` local worker processes, or worker mode
+    std::optional<int> farm_workers;
+    int farm_port = 0;
+    int farm_tile = 64;
+    std::optional<std::string> worker_host;
+    int worker_port = 0;
+
+    /// Parse argv. Throws std::runtime_error on unknown flags or malformed values.
+    static CliOptions parse(int argc, const char* const argv[]);
+
+    /// Help text listing every flag
+    static std::string usage(const std::string& program);
+
+    /// Apply command line overrides on top of the scene's image settings
+    void apply(io::ImageDTO& image) const;
+};
+
+}  // namespace raylabs
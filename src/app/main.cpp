@@ -1,27 +1,33 @@
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <memory>
 #include <sstream>
 #include <string>
+#include "app/CliOptions.hpp"
 #include "core/Camera.hpp"
-#include "core/PathTracer.hpp"
+#include "core/Integrator.hpp"
 #include "core/Sampler.hpp"
 #include "core/Scene.hpp"
 #include "io/JsonSceneLoader.hpp"
 #include "renderer/Renderer.hpp"
+#include "renderer/TileFarm.hpp"
+#include "utils/ThreadPool.hpp"
 
 using namespace std;
 using namespace raylabs;
 
 int main(int argc, char* argv[]) {
-    string scene_file = "assets/scenes/multiple_spheres.json";
-    if (argc > 1) {
-        scene_file = argv[1];
-    }
-
     try {
+        CliOptions options = CliOptions::parse(argc, argv);
+        if (options.show_help) {
+            cout << CliOptions::usage(argv[0]);
+            return 0;
+        }
+
         // Load scene from JSON
-        io::SceneDTO scene_dto = io::JsonSceneLoader::load_from_file(scene_file);
+        io::SceneDTO scene_dto = io::JsonSceneLoader::load_from_file(options.scene_file);
+        options.apply(scene_dto.image);
 
         // Populate Scene and Camera from DTO
         Scene scene;
@@ -29,11 +35,37 @@ int main(int argc, char* argv[]) {
         io::JsonSceneLoader::populateScene(scene_dto, scene, camera);
 
         // Create integrator
-        auto integrator = std::make_shared<PathTracer>();
+        auto integrator = Integrator::create(scene_dto.image.integrator, scene_dto.image.ray_sort);
 
         // Create renderer
         Renderer renderer(scene, camera, scene_dto.image, integrator);
 
+        // Tile farm worker: render the tiles a coordinator hands out
+        if (options.worker_host) {
+            run_farm_worker(*options.worker_host, options.worker_port, renderer,
+                            static_cast<unsigned>(scene_dto.image.threads));
+            return 0;
+        }
+
+        // Tile farm coordinator: local workers share the machine's threads
+        if (options.farm_workers) {
+            FarmOptions farm_options;
+            farm_options.port = options.farm_port;
+            farm_options.tile_size = options.farm_tile;
+            TileFarm farm(renderer, farm_options);
+            const int workers = *options.farm_workers;
+            if (workers > 0) {
+                const int threads = scene_dto.image.threads > 0
+                                        ? scene_dto.image.threads
+                                        : static_cast<int>(ThreadPool::default_thread_count());
+                farm.spawn_local_workers(workers, std::max(1, threads / workers));
+            }
+            Image image = farm.run();
+            cout << "Writing to file: " << scene_dto.image.output_path << endl;
+            renderer.output_image(image).WriteFile(scene_dto.image.output_path.c_str());
+            return 0;
+        }
+
         // Render
         renderer.render();
 
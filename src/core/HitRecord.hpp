@@ -1,10 +1,31 @@
 #pragma once
 
+#include <cstdint>
+
 #include "core/Ray.hpp"
 #include "math/Vec3.hpp"
 
 class Material;
 
+/// What the closest-hit search keeps of a candidate hit (Shape::intersect): the distance
+/// and enough to compute the surface data of the winner once the search is over
+/// (Shape::finalize)
+struct PrimitiveHit {
+    /// Instances nested deeper than this are refused (see Instance)
+    static constexpr int kMaxInstanceLevels = 4;
+
+    float t;
+    float u = 0.0f;  // barycentrics of the hit within a triangle
+    float v = 0.0f;
+    std::uint32_t prim = 0;    // primitive within the shape (triangle of a mesh)
+    std::uint32_t entity = 0;  // entity of the scene hit (Scene::intersect)
+    // Entities hit inside the prototypes of the instances crossed, innermost first: each
+    // Instance pushes the one of its prototype and pops it again to finalize the hit. Levels
+    // below may be left over from a farther candidate; nothing pops them.
+    std::uint32_t prototype_entities[kMaxInstanceLevels] = {};
+    std::uint32_t instance_levels = 0;
+};
+
 struct HitRecord {
     Point3 point;
     Vec3 normal;
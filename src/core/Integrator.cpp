@@ -1,4 +1,63 @@
 #include "core/Integrator.hpp"
 
-// Implementation file for Integrator base class
-// (Currently empty as Integrator is a pure abstract interface)
+#include <cmath>
+#include <stdexcept>
+
+#include "core/PathTracer.hpp"
+#include "core/Sampler.hpp"
+#include "core/Scene.hpp"
+#include "core/WavefrontPathTracer.hpp"
+#include "materials/Material.hpp"
+
+namespace raylabs {
+
+void Integrator::trace_batch(const Ray* rays, const unsigned int* streams, std::size_t count,
+                             const Scene& scene, int max_depth, Color* out) const {
+    for (std::size_t i = 0; i < count; ++i) {
+        Sampler::set_state(streams[i]);
+        out[i] = trace(rays[i], scene, max_depth);
+    }
+}
+
+Color Integrator::direct_lighting(const HitRecord& rec, const Scene& scene) {
+    Color sum(0.0f, 0.0f, 0.0f);
+    if (scene.lights.empty() || !rec.material)
+        return sum;
+    const Color albedo = rec.material->diffuse(rec);
+    if (albedo.R() <= 0.0f && albedo.G() <= 0.0f && albedo.B() <= 0.0f)
+        return sum;
+
+    // Shadow rays leave from just above the surface, like scattered rays
+    const Point3 origin = rec.point + 0.001f * rec.normal;
+    constexpr float kInvPi = 0.31830988618f;
+    for (const Scene::PointLight& light : scene.lights) {
+        const Vec3 to_light = light.position - origin;
+        const float distance_squared = to_light.length_squared();
+        const float distance = std::sqrt(distance_squared);
+        if (distance <= 0.001f)
+            continue;
+        const Vec3 direction = to_light / distance;
+        const float cos_theta = dot(rec.normal, direction);
+        if (cos_theta <= 0.0f)
+            continue;
+        if (scene.occluded(Ray(origin, direction), 0.001f, distance - 0.001f))
+            continue;
+        const float scale = cos_theta * kInvPi / distance_squared;
+        sum += Color(albedo.R() * light.intensity.R() * scale,
+                     albedo.G() * light.intensity.G() * scale,
+                     albedo.B() * light.intensity.B() * scale);
+    }
+    return sum;
+}
+
+std::shared_ptr<Integrator> Integrator::create(const std::string& name, bool sort_rays) {
+    if (name == "path" || name == "pathtracer") {
+        return std::make_shared<PathTracer>();
+    }
+    if (name == "wavefront") {
+        return std::make_shared<WavefrontPathTracer>(sort_rays);
+    }
+    throw std::runtime_error("Unknown integrator: " + name + " (expected 'path' or 'wavefront')");
+}
+
+}  // namespace raylabs
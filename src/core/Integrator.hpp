@@ -1,5 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "core/HitRecord.hpp"
 #include "core/Ray.hpp"
 #include "math/Color.hpp"
 
@@ -18,6 +23,35 @@ class Integrator {
     /// @param max_depth Maximum recursion depth
     /// @return The computed color
     virtual Color trace(const Ray& ray, const Scene& scene, int max_depth) const = 0;
+
+    /// Continue a path whose first intersection is already known (e.g. found by a ray
+    /// packet). `first_hit` is nullptr when the ray escaped the scene.
+    /// The default ignores the hit and traces the ray from scratch.
+    virtual Color trace_hit(const Ray& ray, [[maybe_unused]] const HitRecord* first_hit,
+                            const Scene& scene, int max_depth) const {
+        return trace(ray, scene, max_depth);
+    }
+
+    /// Trace `count` rays at once. `streams[i]` is the random stream state (see
+    /// Sampler::state()) ray i starts from. The default traces the rays one by one.
+    virtual void trace_batch(const Ray* rays, const unsigned int* streams, std::size_t count,
+                             const Scene& scene, int max_depth, Color* out) const;
+
+    /// True if the integrator works best on large batches (the renderer then hands it
+    /// whole tiles through trace_batch() instead of single rays)
+    virtual bool prefers_batches() const { return false; }
+
+    /// Light reaching a hit straight from the scene's point lights, reflected by the diffuse
+    /// part of its material towards the viewer. Each light costs one shadow ray
+    /// (Scene::occluded). Point lights cannot be hit by rays, so this adds to the light the
+    /// path gathers by bouncing without counting anything twice.
+    static Color direct_lighting(const HitRecord& rec, const Scene& scene);
+
+    /// Create an integrator by name: "path" (recursive PathTracer) or "wavefront".
+    /// `sort_rays` turns on the ray sorting stage of the wavefront integrator (the recursive
+    /// one traces a single path at a time and ignores it).
+    /// Throws std::runtime_error for unknown names.
+    static std::shared_ptr<Integrator> create(const std::string& name, bool sort_rays = false);
 };
 
 }  // namespace raylabs
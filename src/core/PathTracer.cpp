@@ -10,23 +10,39 @@ Color PathTracer::trace(const Ray& ray, const Scene& scene, int max_depth) const
     return ray_color(ray, scene, max_depth);
 }
 
+Color PathTracer::trace_hit(const Ray& ray, const HitRecord* first_hit, const Scene& scene,
+                            int max_depth) const {
+    if (max_depth <= 0) {
+        return Color(0.0f, 0.0f, 0.0f);
+    }
+    return shade(ray, first_hit, scene, max_depth);
+}
+
 Color PathTracer::ray_color(const Ray& ray, const Scene& scene, int depth) const {
     if (depth <= 0) {
         return Color(0.0f, 0.0f, 0.0f);
     }
 
     HitRecord rec;
-    if (scene.hit(ray, 0.001f, 1e9f, rec)) {
+    const bool hit = scene.hit(ray, 0.001f, 1e9f, rec);
+    return shade(ray, hit ? &rec : nullptr, scene, depth);
+}
+
+Color PathTracer::shade(const Ray& ray, const HitRecord* hit, const Scene& scene,
+                        int depth) const {
+    if (hit) {
+        const HitRecord& rec = *hit;
         if (rec.material) {
+            Color color = direct_lighting(rec, scene);
             Ray scattered;
             Color attenuation;
             if (rec.material->scatter(ray, rec, attenuation, scattered)) {
                 Color recurse_color = ray_color(scattered, scene, depth - 1);
-                return Color(attenuation.R() * recurse_color.R(),
-                             attenuation.G() * recurse_color.G(),
-                             attenuation.B() * recurse_color.B());
+                color += Color(attenuation.R() * recurse_color.R(),
+                               attenuation.G() * recurse_color.G(),
+                               attenuation.B() * recurse_color.B());
             }
-            return Color(0, 0, 0);
+            return color;
         }
         return Color(0.5f, 0.5f, 0.5f);
     }
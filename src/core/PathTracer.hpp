@@ -13,9 +13,16 @@ class PathTracer : public Integrator {
     /// Compute the color along a ray using path tracing
     Color trace(const Ray& ray, const Scene& scene, int max_depth) const override;
 
+    /// Path tracing from an already intersected camera ray
+    Color trace_hit(const Ray& ray, const HitRecord* first_hit, const Scene& scene,
+                    int max_depth) const override;
+
    private:
     /// Recursive ray color computation
     Color ray_color(const Ray& ray, const Scene& scene, int depth) const;
+
+    /// Shade a ray given its closest hit (nullptr = miss) and recurse
+    Color shade(const Ray& ray, const HitRecord* hit, const Scene& scene, int depth) const;
 };
 
 }  // namespace raylabs
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
+#include "math/Simd.hpp"
+
+namespace raylabs {
+
+template <int N>
+using PacketFloat = simd::vfloat<N>;
+template <int N>
+using PacketMask = simd::vmask<N>;
+
+/// N rays in SoA layout, one SIMD lane per ray
+template <int N>
+struct RayPacket {
+    PacketFloat<N> ox, oy, oz;
+    PacketFloat<N> dx, dy, dz;
+
+    /// Pack `count` (<= N) rays; unused lanes repeat the first ray and must be masked out
+    static RayPacket from_rays(const Ray* rays, int count) {
+        alignas(64) float buf[6][N];
+        for (int i = 0; i < N; ++i) {
+            const Ray& r = rays[i < count ? i : 0];
+            buf[0][i] = r.origin.x;
+            buf[1][i] = r.origin.y;
+            buf[2][i] = r.origin.z;
+            buf[3][i] = r.direction.x;
+            buf[4][i] = r.direction.y;
+            buf[5][i] = r.direction.z;
+        }
+        RayPacket p;
+        p.ox = PacketFloat<N>::load(buf[0]);
+        p.oy = PacketFloat<N>::load(buf[1]);
+        p.oz = PacketFloat<N>::load(buf[2]);
+        p.dx = PacketFloat<N>::load(buf[3]);
+        p.dy = PacketFloat<N>::load(buf[4]);
+        p.dz = PacketFloat<N>::load(buf[5]);
+        return p;
+    }
+
+    Ray ray(int lane) const {
+        return Ray(Point3(ox[lane], oy[lane], oz[lane]), Vec3(dx[lane], dy[lane], dz[lane]));
+    }
+
+    /// Mask of the first `count` lanes
+    static PacketMask<N> first_lanes(int count) {
+        return PacketMask<N>::from_bits(count >= 32 ? ~0u : (1u << count) - 1u);
+    }
+};
+
+/// Closest hit found so far for each lane of a packet
+template <int N>
+struct PacketHit {
+    PacketFloat<N> t;  // distance of the closest hit (tMax of the next test)
+    int entity[N];     // index into Scene::entities, -1 = miss
+    // What the entity's Shape::finalize() needs beyond t (primitive, barycentrics, instance
+    // chain), as Shape::intersect() left it; t and entity are those above
+    PrimitiveHit prims[N];
+
+    explicit PacketHit(float t_max) : t(t_max) {
+        for (int i = 0; i < N; ++i)
+            entity[i] = -1;
+    }
+};
+
+}  // namespace raylabs
@@ -2,12 +2,29 @@
 
 namespace raylabs {
 
+namespace {
+
+thread_local unsigned int tls_seed = 12345;
+
+// Integer finalizer (lowbias32): spreads neighbouring pixel/sample ids over the seed space.
+unsigned int mix(unsigned int h) {
+    h ^= h >> 16;
+    h *= 0x7feb352dU;
+    h ^= h >> 15;
+    h *= 0x846ca68bU;
+    h ^= h >> 16;
+    return h;
+}
+
+}  // namespace
+
 unsigned int Sampler::next_seed() {
-    static thread_local unsigned int seed = 12345;
+    unsigned int seed = tls_seed;
     seed = seed * 1103515245 + 12345;
     seed = (seed << 16) ^ (seed >> 16);
     seed = seed * 224250251 + 198491317;
     seed = (seed << 13) ^ (seed >> 19);
+    tls_seed = seed;
     return seed;
 }
 
@@ -19,4 +36,16 @@ float Sampler::random_float(float min, float max) {
     return min + (max - min) * random_float();
 }
 
+void Sampler::seed_sample(unsigned int x, unsigned int y, unsigned int sample) {
+    tls_seed = mix(mix(mix(x + 0x9e3779b9U) ^ y) + sample * 0x85ebca6bU);
+}
+
+unsigned int Sampler::state() {
+    return tls_seed;
+}
+
+void Sampler::set_state(unsigned int state) {
+    tls_seed = state;
+}
+
 }  // namespace raylabs
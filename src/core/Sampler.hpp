@@ -10,6 +10,15 @@ class Sampler {
     /// Generate a random float in [min, max)
     static float random_float(float min, float max);
 
+    /// Reseed the calling thread's generator for sample `sample` of pixel (x, y).
+    /// Every sample then draws the same numbers whichever thread renders it, which keeps
+    /// the output independent of the thread count and of the tile schedule.
+    static void seed_sample(unsigned int x, unsigned int y, unsigned int sample);
+
+    /// Raw generator state of the calling thread (to save/restore a random stream)
+    static unsigned int state();
+    static void set_state(unsigned int state);
+
    private:
     static unsigned int next_seed();
 };
@@ -0,0 +1,265 @@
+#include "core/Scene.hpp"
+
+#include <limits>
+
+#include "accel/BvhCache.hpp"
+#include "utils/ThreadPool.hpp"
+
+void Scene::build_acceleration(const raylabs::Bvh::BuildOptions& options,
+                               raylabs::ThreadPool* pool, const raylabs::BvhCache* cache) {
+    raylabs::check_build_options(options);
+    std::vector<raylabs::Aabb> bounds;
+    std::vector<std::uint32_t> bounded;
+    unbounded_.clear();
+    for (std::size_t i = 0; i < entities.size(); ++i) {
+        const raylabs::Aabb box = entities[i].shape->bounds();
+        if (box.is_bounded()) {
+            bounds.push_back(box);
+            bounded.push_back(static_cast<std::uint32_t>(i));
+        } else {
+            unbounded_.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    bvh_width_ = options.width;
+    accel_options_ = options;
+    accel_entities_ = entities.size();
+    accel_ready_ = true;
+    accel_cached_ = false;
+    bounded_box_ = raylabs::Aabb();
+    for (const raylabs::Aabb& box : bounds)
+        bounded_box_.expand(box);
+
+    accelerator_ = options.accelerator == raylabs::Accelerator::Auto
+                       ? raylabs::choose_accelerator(raylabs::measure_scene(bounds))
+                       : options.accelerator;
+    grid_.clear();
+    kdtree_.clear();
+    if (accelerator_ != raylabs::Accelerator::Bvh) {
+        bvh_.clear();
+        bvh4_.clear();
+        bvh8_.clear();
+        qbvh4_.clear();
+        qbvh8_.clear();
+        quantized_ = false;
+        if (accelerator_ == raylabs::Accelerator::Grid) {
+            grid_.build(bounds);
+            grid_.remap_indices(bounded);
+        } else {
+            kdtree_.build(bounds);
+            kdtree_.remap_indices(bounded);
+        }
+        return;
+    }
+
+    const bool spatial = options.spatial_split_budget > 0.0f;
+    if (spatial)
+        cache = nullptr;
+    std::uint64_t key = 0;
+    if (cache) {
+        key = raylabs::BvhCache::key(bounds, bounded, options, pool != nullptr);
+        if (cache->load(key, static_cast<std::uint32_t>(entities.size()), bvh_, bvh4_, bvh8_)) {
+            accel_cached_ = true;
+            quantize();
+            return;
+        }
+    }
+    if (spatial) {
+        bvh_.build_spatial(
+            bounds,
+            [&](std::uint32_t i, const raylabs::Aabb& box) {
+                return entities[bounded[i]].shape->clipped_bounds(box);
+            },
+            options);
+    } else if (pool) {
+        bvh_.build_binned(bounds, *pool, options);
+    } else {
+        bvh_.build(bounds, options);
+    }
+    // The BVH numbers the primitives in build order; map them back to entity indices
+    bvh_.remap_indices(bounded);
+    bvh4_.clear();
+    bvh8_.clear();
+    if (options.width == 4)
+        bvh4_.build(bvh_);
+    else if (options.width == 8)
+        bvh8_.build(bvh_);
+    if (cache)
+        cache->store(key, options.width, bvh_, bvh4_, bvh8_);
+    quantize();
+}
+
+void Scene::quantize() {
+    qbvh4_.clear();
+    qbvh8_.clear();
+    quantized_ = false;
+    if (!accel_options_.quantized)
+        return;
+    if (bvh_width_ == 4 && qbvh4_.build(bvh4_)) {
+        bvh4_.clear();
+        quantized_ = true;
+    } else if (bvh_width_ == 8 && qbvh8_.build(bvh8_)) {
+        bvh8_.clear();
+        quantized_ = true;
+    }
+}
+
+std::size_t Scene::acceleration_bytes() const {
+    if (accelerator_ != raylabs::Accelerator::Bvh || bvh_width_ == 2)
+        return traversal_bytes();
+    return bvh_.memory_bytes() + traversal_bytes();
+}
+
+std::size_t Scene::traversal_bytes() const {
+    if (accelerator_ == raylabs::Accelerator::Grid)
+        return grid_.memory_bytes();
+    if (accelerator_ == raylabs::Accelerator::KdTree)
+        return kdtree_.memory_bytes();
+    switch (bvh_width_) {
+        case 4:
+            return quantized_ ? qbvh4_.memory_bytes() : bvh4_.memory_bytes();
+        case 8:
+            return quantized_ ? qbvh8_.memory_bytes() : bvh8_.memory_bytes();
+        default:
+            return bvh_.memory_bytes();
+    }
+}
+
+raylabs::BvhUpdateStats Scene::update_acceleration(raylabs::ThreadPool* pool) {
+    if (!accelerated() || accelerator_ != raylabs::Accelerator::Bvh) {
+        // Keep the structure picked at the first build rather than choosing again
+        raylabs::Bvh::BuildOptions options = accel_options_;
+        if (accel_ready_)
+            options.accelerator = accelerator_;
+        build_acceleration(options, pool);
+        raylabs::BvhUpdateStats stats;
+        stats.rebuilt_subtrees = 1;
+        stats.rebuilt_primitives = entities.size() - unbounded_.size();
+        stats.full_rebuild = true;
+        if (accelerator_ == raylabs::Accelerator::Bvh)
+            stats.sah_cost = bvh_.sah_cost(accel_options_);
+        return stats;
+    }
+
+    // Boxes by entity index, the ids the BVH refers to (unbounded entities are never read)
+    std::vector<raylabs::Aabb> bounds(entities.size());
+    auto fill = [&](std::size_t chunk, std::size_t chunks) {
+        const std::size_t end = entities.size() * (chunk + 1) / chunks;
+        for (std::size_t i = entities.size() * chunk / chunks; i < end; ++i)
+            bounds[i] = entities[i].shape->bounds();
+    };
+    if (pool && entities.size() > 4096) {
+        const std::size_t chunks = pool->size() * 4;
+        pool->parallel_for(chunks, [&](std::size_t c) { fill(c, chunks); });
+    } else {
+        fill(0, 1);
+    }
+
+    const raylabs::BvhUpdateStats stats = bvh_.update(bounds, pool, accel_options_);
+    // The wide tree only needs new boxes unless subtrees were rebuilt; a quantized one is
+    // compressed again from a fresh collapse
+    if (quantized_) {
+        if (bvh_width_ == 4)
+            bvh4_.build(bvh_);
+        else
+            bvh8_.build(bvh_);
+        quantize();
+    } else if (bvh_width_ == 4) {
+        if (stats.rebuilt_subtrees == 0)
+            bvh4_.refit(bvh_);
+        else
+            bvh4_.build(bvh_);
+    } else if (bvh_width_ == 8) {
+        if (stats.rebuilt_subtrees == 0)
+            bvh8_.refit(bvh_);
+        else
+            bvh8_.build(bvh_);
+    }
+    return stats;
+}
+
+raylabs::Aabb Scene::bounds() const {
+    if (!accelerated()) {
+        raylabs::Aabb box;
+        for (const Entity& e : entities)
+            box.expand(e.shape->bounds());
+        return box;
+    }
+    if (!unbounded_.empty())
+        return raylabs::Aabb::unbounded();
+    return bounded_box_;
+}
+
+bool Scene::hit(const Ray& ray, float tMin, float tMax, HitRecord& outRecord) const {
+    PrimitiveHit closest;
+    if (!intersect(ray, tMin, tMax, closest))
+        return false;
+    finalize(ray, closest, outRecord);
+    return true;
+}
+
+bool Scene::intersect(const Ray& ray, float tMin, float tMax, PrimitiveHit& hit) const {
+    // Candidates only cost a t and a few words: the point, normal and material are left to
+    // finalize(), for the closest one
+    bool hitAnything = false;
+    float closest = tMax;
+    auto test_entity = [&](std::uint32_t i, float& t_max) {
+        if (!entities[i].shape->intersect(ray, tMin, t_max, hit))
+            return false;
+        t_max = hit.t;
+        hit.entity = i;
+        return true;
+    };
+
+    if (!accelerated()) {
+        for (std::size_t i = 0; i < entities.size(); ++i) {
+            if (test_entity(static_cast<std::uint32_t>(i), closest))
+                hitAnything = true;
+        }
+        return hitAnything;
+    }
+    for (std::uint32_t i : unbounded_) {
+        if (test_entity(i, closest))
+            hitAnything = true;
+    }
+    if (traverse(ray, tMin, closest, test_entity))
+        hitAnything = true;
+    return hitAnything;
+}
+
+void Scene::finalize(const Ray& ray, const PrimitiveHit& hit, HitRecord& outRecord) const {
+    const Entity& e = entities[hit.entity];
+    // Instances report the material of the prototype entity they hit; the entity's own
+    // material, if any, overrides it
+    outRecord.material = nullptr;
+    e.shape->finalize(ray, hit, outRecord);
+    if (e.material)
+        outRecord.material = e.material.get();
+}
+
+bool Scene::occluded(const Ray& ray, float tMin, float tMax) const {
+    if (!accelerated()) {
+        for (const Entity& e : entities) {
+            if (e.shape->occluded(ray, tMin, tMax))
+                return true;
+        }
+        return false;
+    }
+    for (std::uint32_t i : unbounded_) {
+        if (entities[i].shape->occluded(ray, tMin, tMax))
+            return true;
+    }
+
+    // The closest-hit traversals skip every node or cell that starts beyond tMax: once something is
+    // found, an empty range drains their stack without testing anything else
+    bool blocked = false;
+    float t_max = tMax;
+    auto test_entity = [&](std::uint32_t i, float& limit) {
+        if (blocked || !entities[i].shape->occluded(ray, tMin, limit))
+            return false;
+        blocked = true;
+        limit = -std::numeric_limits<float>::infinity();
+        return true;
+    };
+    traverse(ray, tMin, t_max, test_entity);
+    return blocked;
+}
@@ -1,14 +1,28 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
+#include "accel/Accelerator.hpp"
+#include "accel/Bvh.hpp"
+#include "accel/KdTree.hpp"
+#include "accel/QuantizedBvh.hpp"
+#include "accel/UniformGrid.hpp"
+#include "accel/WideBvh.hpp"
 #include "core/HitRecord.hpp"
 #include "core/Ray.hpp"
+#include "core/RayPacket.hpp"
 #include "entities/Shape.hpp"
+#include "math/Color.hpp"
 
 class Material;
 
+namespace raylabs {
+class BvhCache;
+class ThreadPool;
+}
+
 class Scene {
    public:
     struct Entity {
@@ -16,7 +30,14 @@ class Scene {
         std::shared_ptr<Material> material;
     };
 
+    /// Point light: radiance falls off with the squared distance; it is not visible to rays
+    struct PointLight {
+        Point3 position;
+        Color intensity;
+    };
+
     std::vector<Entity> entities;
+    std::vector<PointLight> lights;
 
     void add(const std::shared_ptr<Shape>& shape, const std::shared_ptr<Material>& material) {
         entities.push_back({shape, material});
@@ -24,18 +45,186 @@ class Scene {
 
     void add(const std::shared_ptr<Shape>& shape) { entities.push_back({shape, nullptr}); }
 
-    bool hit(const Ray& ray, float tMin, float tMax, HitRecord& outRecord) const {
-        HitRecord temp{};
-        bool hitAnything = false;
-        float closest = tMax;
-        for (const auto& e : entities) {
-            if (e.shape->hit(ray, tMin, closest, temp)) {
-                hitAnything = true;
-                closest = temp.t;
-                temp.material = e.material.get();
-                outRecord = temp;
+    /// Build the BVH over the entities with finite bounds; unbounded ones (planes) are kept
+    /// in a separate list and tested against every ray. Call again after changing
+    /// `entities`: until then (or if it is never called) hit() loops over every entity.
+    /// `options.accelerator` selects a uniform grid or a kd-tree instead of the BVH, or lets
+    /// choose_accelerator() pick one from the entity boxes; the BVH settings below and the
+    /// cache then only apply if the BVH is chosen.
+    /// With `options.width` 4 or 8 the binary tree is also collapsed into a wide BVH that
+    /// hit() traverses instead; packets keep using the binary tree.
+    /// With `options.quantized` the wide tree is compressed (QuantizedBvh) and hit() traverses
+    /// that instead. Throws std::runtime_error for any other width, or for a quantized
+    /// binary tree.
+    /// Given a pool, the binned SAH builder runs on it (Bvh::build_binned); otherwise the
+    /// tree is built serially with the exact SAH sweep.
+    /// With `options.spatial_split_budget` above 0, the tree is built serially with spatial
+    /// splits instead (Bvh::build_spatial), the entities clipping their own boxes
+    /// (Shape::clipped_bounds). Throws std::runtime_error for a negative budget.
+    /// TriangleMesh entities build their own BVH over their triangles; given these options
+    /// (as JsonSceneLoader does), they split space inside the mesh too.
+    /// Given a cache, the trees are mapped from it when the same geometry was built before
+    /// with the same options, and stored into it otherwise (see acceleration_cached()).
+    /// Spatial-split trees are not cached: the cache key only covers the entity boxes, and
+    /// their clipped boxes depend on more than that.
+    void build_acceleration(const raylabs::Bvh::BuildOptions& options = {},
+                            raylabs::ThreadPool* pool = nullptr,
+                            const raylabs::BvhCache* cache = nullptr);
+
+    /// Structure hit() traverses (never Accelerator::Auto: the one it resolved to)
+    raylabs::Accelerator accelerator() const { return accelerator_; }
+
+    /// True if the last build_acceleration() loaded the hierarchy from its cache
+    bool acceleration_cached() const { return accel_cached_; }
+
+    /// Move the shape of entity i (animation). Once every entity of the frame has moved,
+    /// call update_acceleration().
+    void transform_entity(std::size_t i, const raylabs::Transform& t) {
+        entities[i].shape->transform(t);
+    }
+
+    /// Bring the hierarchy up to date after shapes moved, with the options of the last
+    /// build_acceleration(): the boxes are refitted and degraded subtrees rebuilt (see
+    /// Bvh::update()), in parallel on `pool` if given. Rebuilds from scratch if entities were
+    /// added since the last build, and grids and kd-trees always.
+    raylabs::BvhUpdateStats update_acceleration(raylabs::ThreadPool* pool = nullptr);
+
+    /// True while the BVH matches `entities`
+    bool accelerated() const { return accel_ready_ && accel_entities_ == entities.size(); }
+
+    /// Box around every entity; unbounded if one of them is (a plane)
+    raylabs::Aabb bounds() const;
+
+    /// Hierarchy over the bounded entities (indices into `entities`); empty when another
+    /// accelerator was built
+    const raylabs::Bvh& bvh() const { return bvh_; }
+
+    /// Node width used by hit(): 2 (binary), 4 or 8
+    int bvh_width() const { return bvh_width_; }
+
+    /// True if hit() traverses quantized nodes (false when the tree could not be compressed)
+    bool bvh_quantized() const { return quantized_; }
+
+    /// Bytes of every acceleration structure the scene holds: nodes (or cells) and primitive
+    /// indices. A wide or quantized BVH counts the binary tree kept next to it for packets
+    /// and update_acceleration().
+    std::size_t acceleration_bytes() const;
+
+    /// Bytes of the structure hit() traverses alone
+    std::size_t traversal_bytes() const;
+
+    /// Closest hit along the ray within [tMin, tMax]: intersect() followed by finalize()
+    bool hit(const Ray& ray, float tMin, float tMax, HitRecord& outRecord) const;
+
+    /// Closest-hit search alone (see Shape::intersect): `hit` gets the distance, the entity
+    /// and what its shape needs to finalize the hit. Left unchanged on a miss.
+    bool intersect(const Ray& ray, float tMin, float tMax, PrimitiveHit& hit) const;
+
+    /// Surface data and material of a hit returned by intersect() for the same ray
+    void finalize(const Ray& ray, const PrimitiveHit& hit, HitRecord& outRecord) const;
+
+    /// Any hit along the ray within [tMin, tMax] (shadow rays): traversal stops at the first
+    /// entity found and no HitRecord is filled
+    bool occluded(const Ray& ray, float tMin, float tMax) const;
+
+    /// Closest hit for every active lane of a coherent ray packet (camera rays).
+    /// Fills `hit.t`, `hit.entity` and `hit.prims` of the lanes that hit something; surface
+    /// data waits for packet_hit_record().
+    template <int N>
+    void hit_packet(const raylabs::RayPacket<N>& rays, float tMin, raylabs::PacketHit<N>& hit,
+                    const raylabs::PacketMask<N>& active) const {
+        auto test_entity = [&](std::uint32_t i, const raylabs::PacketMask<N>& lanes) {
+            const std::uint32_t updated =
+                entities[i].shape->hit_packet(rays, tMin, hit, lanes).bits();
+            for (int lane = 0; lane < N; ++lane) {
+                if ((updated >> lane) & 1u)
+                    hit.entity[lane] = static_cast<int>(i);
             }
+        };
+        if (!accelerated()) {
+            for (std::size_t i = 0; i < entities.size(); ++i)
+                test_entity(static_cast<std::uint32_t>(i), active);
+            return;
+        }
+        for (std::uint32_t i : unbounded_)
+            test_entity(i, active);
+        if (accelerator_ == raylabs::Accelerator::Bvh) {
+            bvh_.intersect_packet(rays, tMin, hit.t, active, test_entity);
+            return;
+        }
+        // Grids and kd-trees have no packet traversal: walk them lane by lane
+        for (int lane = 0; lane < N; ++lane) {
+            if (!active[lane])
+                continue;
+            const auto lane_mask = raylabs::PacketMask<N>::from_bits(1u << lane);
+            float closest = hit.t[lane];
+            traverse(rays.ray(lane), tMin, closest, [&](std::uint32_t i, float& t_max) {
+                test_entity(i, lane_mask);
+                if (!(hit.t[lane] < t_max))
+                    return false;
+                t_max = hit.t[lane];
+                return true;
+            });
         }
-        return hitAnything;
     }
+
+    /// Expand one lane of a packet hit into a HitRecord, through finalize() like a scalar
+    /// hit (`ray` is the lane's ray). Returns false if the lane missed.
+    template <int N>
+    bool packet_hit_record(const Ray& ray, const raylabs::PacketHit<N>& hit, int lane,
+                           HitRecord& outRecord) const {
+        const int e = hit.entity[lane];
+        if (e < 0)
+            return false;
+        PrimitiveHit prim = hit.prims[lane];
+        prim.t = hit.t[lane];
+        prim.entity = static_cast<std::uint32_t>(e);
+        finalize(ray, prim, outRecord);
+        return true;
+    }
+
+   private:
+    /// With accel_options_.quantized, compress the wide tree and drop the full-precision one
+    void quantize();
+
+    /// Closest-hit traversal of the built structure over the bounded entities, with the
+    /// contract of Bvh::intersect()
+    template <typename HitPrim>
+    bool traverse(const Ray& ray, float tMin, float& tMax, HitPrim&& hit_prim) const {
+        switch (accelerator_) {
+            case raylabs::Accelerator::Grid:
+                return grid_.intersect(ray, tMin, tMax, hit_prim);
+            case raylabs::Accelerator::KdTree:
+                return kdtree_.intersect(ray, tMin, tMax, hit_prim);
+            default:
+                break;
+        }
+        switch (bvh_width_) {
+            case 4:
+                return quantized_ ? qbvh4_.intersect(ray, tMin, tMax, hit_prim)
+                                  : bvh4_.intersect(ray, tMin, tMax, hit_prim);
+            case 8:
+                return quantized_ ? qbvh8_.intersect(ray, tMin, tMax, hit_prim)
+                                  : bvh8_.intersect(ray, tMin, tMax, hit_prim);
+            default:
+                return bvh_.intersect(ray, tMin, tMax, hit_prim);
+        }
+    }
+
+    raylabs::Bvh bvh_;
+    raylabs::Bvh::BuildOptions accel_options_;
+    raylabs::WideBvh<4> bvh4_;
+    raylabs::WideBvh<8> bvh8_;
+    raylabs::QuantizedBvh<4> qbvh4_;
+    raylabs::QuantizedBvh<8> qbvh8_;
+    raylabs::UniformGrid grid_;
+    raylabs::KdTree kdtree_;
+    raylabs::Accelerator accelerator_ = raylabs::Accelerator::Bvh;
+    raylabs::Aabb bounded_box_;  // box around the entities in the structure
+    int bvh_width_ = 2;
+    bool quantized_ = false;
+    std::vector<std::uint32_t> unbounded_;  // entities outside the BVH
+    std::size_t accel_entities_ = 0;        // entities.size() when the BVH was built
+    bool accel_ready_ = false;
+    bool accel_cached_ = false;
 };
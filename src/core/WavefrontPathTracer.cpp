@@ -0,0 +1,261 @@
+#include "core/WavefrontPathTracer.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "core/RayPacket.hpp"
+#include "core/Sampler.hpp"
+#include "core/Scene.hpp"
+#include "materials/Material.hpp"
+
+namespace raylabs {
+
+namespace {
+
+constexpr int kPacketWidth = 8;
+constexpr float kTMin = 0.001f;
+constexpr float kTMax = 1e9f;
+
+/// Spread the low 10 bits of v so that two zero bits follow each of them
+std::uint64_t spread_bits(std::uint32_t v) {
+    std::uint64_t x = v & 0x3ffu;
+    x = (x | (x << 16)) & 0x030000ffull;
+    x = (x | (x << 8)) & 0x0300f00full;
+    x = (x | (x << 4)) & 0x030c30c3ull;
+    x = (x | (x << 2)) & 0x09249249ull;
+    return x;
+}
+
+}  // namespace
+
+// ------------------------ PathQueue -----------------------------------------
+
+void WavefrontPathTracer::PathQueue::reserve(std::size_t n) {
+    for (auto* v : {&ox, &oy, &oz, &dx, &dy, &dz, &tr, &tg, &tb}) {
+        v->reserve(n);
+    }
+    pixel.reserve(n);
+    stream.reserve(n);
+}
+
+void WavefrontPathTracer::PathQueue::push(const Ray& ray, float r, float g, float b,
+                                          std::uint32_t out_index, std::uint32_t rng) {
+    ox.push_back(ray.origin.x);
+    oy.push_back(ray.origin.y);
+    oz.push_back(ray.origin.z);
+    dx.push_back(ray.direction.x);
+    dy.push_back(ray.direction.y);
+    dz.push_back(ray.direction.z);
+    tr.push_back(r);
+    tg.push_back(g);
+    tb.push_back(b);
+    pixel.push_back(out_index);
+    stream.push_back(rng);
+}
+
+Ray WavefrontPathTracer::PathQueue::ray(std::size_t i) const {
+    return Ray(Point3(ox[i], oy[i], oz[i]), Vec3(dx[i], dy[i], dz[i]));
+}
+
+void WavefrontPathTracer::PathQueue::compact(const std::vector<unsigned char>& alive) {
+    std::size_t w = 0;
+    for (std::size_t r = 0; r < size(); ++r) {
+        if (!alive[r])
+            continue;
+        ox[w] = ox[r];
+        oy[w] = oy[r];
+        oz[w] = oz[r];
+        dx[w] = dx[r];
+        dy[w] = dy[r];
+        dz[w] = dz[r];
+        tr[w] = tr[r];
+        tg[w] = tg[r];
+        tb[w] = tb[r];
+        pixel[w] = pixel[r];
+        stream[w] = stream[r];
+        ++w;
+    }
+    for (auto* v : {&ox, &oy, &oz, &dx, &dy, &dz, &tr, &tg, &tb}) {
+        v->resize(w);
+    }
+    pixel.resize(w);
+    stream.resize(w);
+}
+
+void WavefrontPathTracer::PathQueue::permute(const std::vector<std::uint32_t>& order) {
+    std::vector<float> floats(order.size());
+    for (auto* v : {&ox, &oy, &oz, &dx, &dy, &dz, &tr, &tg, &tb}) {
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            floats[i] = (*v)[order[i]];
+        }
+        v->swap(floats);
+    }
+    std::vector<std::uint32_t> ints(order.size());
+    for (auto* v : {&pixel, &stream}) {
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            ints[i] = (*v)[order[i]];
+        }
+        v->swap(ints);
+    }
+}
+
+// ------------------------ WavefrontPathTracer -------------------------------
+
+Color WavefrontPathTracer::trace(const Ray& ray, const Scene& scene, int max_depth) const {
+    const unsigned int stream = Sampler::state();
+    Color out;
+    trace_batch(&ray, &stream, 1, scene, max_depth, &out);
+    return out;
+}
+
+void WavefrontPathTracer::intersect(const PathQueue& queue, const Scene& scene,
+                                    std::vector<HitRecord>& hits,
+                                    std::vector<unsigned char>& found) const {
+    const std::size_t n = queue.size();
+    hits.assign(n, HitRecord{});
+    found.assign(n, 0);
+
+    Ray rays[kPacketWidth];
+    for (std::size_t base = 0; base < n; base += kPacketWidth) {
+        const int lanes = static_cast<int>(std::min<std::size_t>(kPacketWidth, n - base));
+        for (int lane = 0; lane < lanes; ++lane) {
+            rays[lane] = queue.ray(base + lane);
+        }
+        const auto packet = RayPacket<kPacketWidth>::from_rays(rays, lanes);
+        PacketHit<kPacketWidth> hit(kTMax);
+        scene.hit_packet(packet, kTMin, hit, RayPacket<kPacketWidth>::first_lanes(lanes));
+        for (int lane = 0; lane < lanes; ++lane) {
+            found[base + lane] =
+                scene.packet_hit_record(rays[lane], hit, lane, hits[base + lane]) ? 1 : 0;
+        }
+    }
+}
+
+void WavefrontPathTracer::sort(PathQueue& queue) const {
+    const std::size_t n = queue.size();
+    if (n < 2 * kPacketWidth) {
+        return;
+    }
+
+    // Origins are quantized to 10 bits per axis over the box of this wave's origins
+    float lo[3] = {std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                   std::numeric_limits<float>::max()};
+    float hi[3] = {-lo[0], -lo[1], -lo[2]};
+    const std::vector<float>* origin[3] = {&queue.ox, &queue.oy, &queue.oz};
+    for (int axis = 0; axis < 3; ++axis) {
+        for (float v : *origin[axis]) {
+            lo[axis] = std::min(lo[axis], v);
+            hi[axis] = std::max(hi[axis], v);
+        }
+    }
+    float scale[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        const float extent = hi[axis] - lo[axis];
+        scale[axis] = extent > 0.0f ? 1023.0f / extent : 0.0f;
+    }
+
+    // Key: direction octant above the Morton code; the index breaks ties
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> keyed(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const std::uint64_t octant = (queue.dx[i] < 0.0f ? 1u : 0u) |
+                                     (queue.dy[i] < 0.0f ? 2u : 0u) |
+                                     (queue.dz[i] < 0.0f ? 4u : 0u);
+        const auto qx = static_cast<std::uint32_t>((queue.ox[i] - lo[0]) * scale[0]);
+        const auto qy = static_cast<std::uint32_t>((queue.oy[i] - lo[1]) * scale[1]);
+        const auto qz = static_cast<std::uint32_t>((queue.oz[i] - lo[2]) * scale[2]);
+        const std::uint64_t morton =
+            spread_bits(qx) | (spread_bits(qy) << 1) | (spread_bits(qz) << 2);
+        keyed[i] = {(octant << 30) | morton, static_cast<std::uint32_t>(i)};
+    }
+    std::sort(keyed.begin(), keyed.end());
+
+    std::vector<std::uint32_t> order(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        order[i] = keyed[i].second;
+    }
+    queue.permute(order);
+}
+
+void WavefrontPathTracer::trace_batch(const Ray* rays, const unsigned int* streams,
+                                      std::size_t count, const Scene& scene, int max_depth,
+                                      Color* out) const {
+    // Generate stage: one path per camera ray, unit throughput. Paths still alive after
+    // max_depth bounces contribute black, like the recursive tracer.
+    PathQueue queue;
+    queue.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = Color(0.0f, 0.0f, 0.0f);
+        if (max_depth > 0) {
+            queue.push(rays[i], 1.0f, 1.0f, 1.0f, static_cast<std::uint32_t>(i), streams[i]);
+        }
+    }
+
+    std::vector<HitRecord> hits;
+    std::vector<unsigned char> found;
+    std::vector<unsigned char> alive;
+    std::vector<std::uint32_t> order;
+
+    for (int depth = 0; depth < max_depth && queue.size() > 0; ++depth) {
+        // Sort stage: camera rays are coherent already, bounced ones are not
+        if (sort_rays_ && depth > 0) {
+            sort(queue);
+        }
+        const std::size_t n = queue.size();
+
+        // Intersect stage
+        intersect(queue, scene, hits, found);
+
+        // Terminate stage: escaped rays pick up the sky, hits without material are grey. A
+        // path writes its pixel when it ends, on top of the direct light it gathered.
+        alive.assign(n, 0);
+        order.clear();
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!found[i]) {
+                const Color sky = Environment::sky_color(Vec3(queue.dx[i], queue.dy[i],
+                                                              queue.dz[i]));
+                out[queue.pixel[i]] += Color(queue.tr[i] * sky.R(), queue.tg[i] * sky.G(),
+                                             queue.tb[i] * sky.B());
+            } else if (!hits[i].material) {
+                out[queue.pixel[i]] +=
+                    Color(queue.tr[i] * 0.5f, queue.tg[i] * 0.5f, queue.tb[i] * 0.5f);
+            } else {
+                order.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+
+        // Shade stage, grouped by material so each scatter() runs over a contiguous run
+        std::stable_sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+            return std::less<const Material*>()(hits[a].material, hits[b].material);
+        });
+        for (std::uint32_t i : order) {
+            const HitRecord& rec = hits[i];
+            const Ray in = queue.ray(i);
+            const Color direct = direct_lighting(rec, scene);
+            out[queue.pixel[i]] += Color(queue.tr[i] * direct.R(), queue.tg[i] * direct.G(),
+                                         queue.tb[i] * direct.B());
+            Sampler::set_state(queue.stream[i]);
+            Ray scattered;
+            Color attenuation;
+            if (rec.material->scatter(in, rec, attenuation, scattered)) {
+                queue.ox[i] = scattered.origin.x;
+                queue.oy[i] = scattered.origin.y;
+                queue.oz[i] = scattered.origin.z;
+                queue.dx[i] = scattered.direction.x;
+                queue.dy[i] = scattered.direction.y;
+                queue.dz[i] = scattered.direction.z;
+                queue.tr[i] *= attenuation.R();
+                queue.tg[i] *= attenuation.G();
+                queue.tb[i] *= attenuation.B();
+                queue.stream[i] = Sampler::state();
+                alive[i] = 1;
+            }
+        }
+
+        // Compact stage
+        queue.compact(alive);
+    }
+}
+
+}  // namespace raylabs
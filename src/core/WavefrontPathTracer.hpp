@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "core/Environment.hpp"
+#include "core/Integrator.hpp"
+
+class Material;
+
+namespace raylabs {
+
+/// Stream (wavefront) path tracer.
+/// Instead of recursing one path at a time, every call keeps all live paths of a batch in
+/// SoA queues and advances them one bounce per wave, stage by stage:
+///   [sort] -> intersect -> (miss / terminate) -> shade grouped by material -> compact
+/// Intersection runs on 8-wide ray packets and shading calls each material's scatter() on a
+/// contiguous run of paths, so the kernels stay coherent and the queues stream through cache.
+/// With `sort_rays`, the secondary rays of every wave are reordered before intersection by
+/// direction octant, then by the Morton code of their origin, so that the rays of a packet
+/// start close together and head the same way and visit the same BVH nodes. Every path
+/// carries its own pixel and random stream, so the image does not change.
+/// Produces the same estimator as PathTracer.
+class WavefrontPathTracer : public Integrator {
+   public:
+    explicit WavefrontPathTracer(bool sort_rays = false) : sort_rays_(sort_rays) {}
+    ~WavefrontPathTracer() override = default;
+
+    bool sort_rays() const { return sort_rays_; }
+
+    /// Single ray: a batch of one
+    Color trace(const Ray& ray, const Scene& scene, int max_depth) const override;
+
+    void trace_batch(const Ray* rays, const unsigned int* streams, std::size_t count,
+                     const Scene& scene, int max_depth, Color* out) const override;
+
+    bool prefers_batches() const override { return true; }
+
+   private:
+    /// Live paths in SoA layout
+    struct PathQueue {
+        std::vector<float> ox, oy, oz;  // ray origin
+        std::vector<float> dx, dy, dz;  // ray direction
+        std::vector<float> tr, tg, tb;  // path throughput
+        std::vector<std::uint32_t> pixel;   // output slot
+        std::vector<std::uint32_t> stream;  // random stream state
+
+        std::size_t size() const { return pixel.size(); }
+        void reserve(std::size_t n);
+        void push(const Ray& ray, float r, float g, float b, std::uint32_t out_index,
+                  std::uint32_t rng);
+        Ray ray(std::size_t i) const;
+        /// Keep only the paths flagged in `alive`, preserving their order
+        void compact(const std::vector<unsigned char>& alive);
+        /// Reorder the paths: path i moves to where `order` lists it
+        void permute(const std::vector<std::uint32_t>& order);
+    };
+
+    /// Sort stage: reorder the queued rays by direction octant and origin Morton code
+    void sort(PathQueue& queue) const;
+
+    /// Intersection stage: closest hit of every queued ray (hits[i].material == nullptr and
+    /// found[i] == 0 on a miss)
+    void intersect(const PathQueue& queue, const Scene& scene, std::vector<HitRecord>& hits,
+                   std::vector<unsigned char>& found) const;
+
+    bool sort_rays_ = false;
+};
+
+}  // namespace raylabs
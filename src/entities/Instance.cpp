@@ -0,0 +1,69 @@
+#include "Instance.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+Instance::Instance(std::shared_ptr<const Scene> prototype, const raylabs::Transform& to_world)
+    : prototype_(std::move(prototype)), to_world_(to_world), to_object_(to_world.inverse()) {
+    for (const Scene::Entity& e : prototype_->entities) {
+        if (const auto* inner = dynamic_cast<const Instance*>(e.shape.get()))
+            levels_ = std::max(levels_, inner->levels() + 1);
+    }
+    if (levels_ > PrimitiveHit::kMaxInstanceLevels) {
+        throw std::runtime_error("Instances nest at most " +
+                                 std::to_string(PrimitiveHit::kMaxInstanceLevels) +
+                                 " levels deep, got " + std::to_string(levels_));
+    }
+    update_bounds();
+}
+
+bool Instance::intersect(const Ray& ray, float tMin, float tMax, PrimitiveHit& hit) const {
+    const Ray local(to_object_.point(ray.origin), to_object_.vector(ray.direction));
+    // Start from an empty chain: `hit` may hold that of another candidate
+    PrimitiveHit inner;
+    if (!prototype_->intersect(local, tMin, tMax, inner))
+        return false;
+    inner.prototype_entities[inner.instance_levels++] = inner.entity;
+    hit = inner;
+    return true;
+}
+
+void Instance::finalize(const Ray& ray, const PrimitiveHit& hit, HitRecord& rec) const {
+    const Ray local(to_object_.point(ray.origin), to_object_.vector(ray.direction));
+    // Our entry is the last one pushed; instances inside the prototype pop theirs in turn
+    PrimitiveHit inner = hit;
+    inner.entity = inner.prototype_entities[--inner.instance_levels];
+    prototype_->finalize(local, inner, rec);
+    // The scale is positive, so the side the ray comes from is unchanged
+    rec.point = ray.at(rec.t);
+    rec.normal = to_world_.rotate_vector(rec.normal);
+}
+
+bool Instance::occluded(const Ray& ray, float tMin, float tMax) const {
+    const Ray local(to_object_.point(ray.origin), to_object_.vector(ray.direction));
+    return prototype_->occluded(local, tMin, tMax);
+}
+
+void Instance::transform(const raylabs::Transform& t) {
+    to_world_ = t * to_world_;
+    to_object_ = to_world_.inverse();
+    update_bounds();
+}
+
+void Instance::update_bounds() {
+    const raylabs::Aabb local = prototype_->bounds();
+    if (!local.is_bounded()) {
+        bounds_ = local;
+        return;
+    }
+    // World box of the eight corners of the object-space box
+    bounds_ = raylabs::Aabb();
+    for (int corner = 0; corner < 8; ++corner) {
+        const Point3 p((corner & 1) ? local.max.x : local.min.x,
+                       (corner & 2) ? local.max.y : local.min.y,
+                       (corner & 4) ? local.max.z : local.min.z);
+        bounds_.expand(to_world_.point(p));
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <memory>
+
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
+#include "core/Scene.hpp"
+#include "entities/Shape.hpp"
+#include "math/Transform.hpp"
+
+/// A placed copy of a prototype scene (object instancing). The prototype is the
+/// bottom-level structure: its entities and BVH are built once, in object space, and shared
+/// by every instance, which only stores its transform and world box. Added to a Scene,
+/// instances are the leaves of the top-level BVH.
+/// Rays are moved into object space with the inverse transform; as their direction is not
+/// renormalized, t is the same in both spaces. Hits keep the prototype's materials unless
+/// the instance entity has one of its own.
+/// A hit keeps the prototype entity it met in PrimitiveHit::prototype_entities, one per
+/// level of nesting, so that prototypes holding instances themselves are finalized through
+/// the same chain of entities without searching again.
+class Instance : public Shape {
+   public:
+    /// `prototype` must be accelerated (Scene::build_acceleration) before it is shared.
+    /// Throws std::runtime_error if instances would nest more than
+    /// PrimitiveHit::kMaxInstanceLevels deep.
+    Instance(std::shared_ptr<const Scene> prototype, const raylabs::Transform& to_world);
+
+    bool intersect(const Ray& ray, float tMin, float tMax, PrimitiveHit& hit) const override;
+    void finalize(const Ray& ray, const PrimitiveHit& hit, HitRecord& rec) const override;
+    bool occluded(const Ray& ray, float tMin, float tMax) const override;
+    raylabs::Aabb bounds() const override { return bounds_; }
+    void transform(const raylabs::Transform& t) override;
+
+    const Scene& prototype() const { return *prototype_; }
+    const raylabs::Transform& to_world() const { return to_world_; }
+    /// Instances a ray goes through to reach a primitive: 1, plus those inside the prototype
+    int levels() const { return levels_; }
+
+   private:
+    void update_bounds();
+
+    std::shared_ptr<const Scene> prototype_;
+    raylabs::Transform to_world_;
+    raylabs::Transform to_object_;
+    raylabs::Aabb bounds_;
+    int levels_ = 1;
+};
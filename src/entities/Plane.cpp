@@ -3,7 +3,7 @@
 
 Plane::Plane(const Point3& p, const Vec3& n) : point(p), normal(normalize(n)) {}
 
-bool Plane::hit(const Ray& ray, float tMin, float tMax, HitRecord& hitRecord) const {
+bool Plane::intersect(const Ray& ray, float tMin, float tMax, PrimitiveHit& hit) const {
     const float EPS = 1e-6f;
     float denom = dot(normal, ray.direction);
     if (std::fabs(denom) < EPS) {
@@ -13,8 +13,57 @@ bool Plane::hit(const Ray& ray, float tMin, float tMax, HitRecord& hitRecord) co
     if (t < tMin || t > tMax) {
         return false;
     }
-    hitRecord.t = t;
-    hitRecord.point = ray.at(t);
-    hitRecord.set_face_normal(ray, normal);
+    hit.t = t;
     return true;
 }
+
+void Plane::finalize(const Ray& ray, const PrimitiveHit& hit, HitRecord& rec) const {
+    rec.t = hit.t;
+    rec.point = ray.at(hit.t);
+    rec.set_face_normal(ray, normal);
+}
+
+bool Plane::occluded(const Ray& ray, float tMin, float tMax) const {
+    const float EPS = 1e-6f;
+    float denom = dot(normal, ray.direction);
+    if (std::fabs(denom) < EPS) {
+        return false;
+    }
+    float t = dot(point - ray.origin, normal) / denom;
+    return t >= tMin && t <= tMax;
+}
+
+template <int N>
+raylabs::PacketMask<N> Plane::hit_packet_n(const raylabs::RayPacket<N>& rays, float tMin,
+                                           raylabs::PacketHit<N>& hit,
+                                           const raylabs::PacketMask<N>& active) const {
+    using F = raylabs::PacketFloat<N>;
+    const float EPS = 1e-6f;
+    const F denom = F(normal.x) * rays.dx + F(normal.y) * rays.dy + F(normal.z) * rays.dz;
+    const F num = (F(point.x) - rays.ox) * F(normal.x) + (F(point.y) - rays.oy) * F(normal.y) +
+                  (F(point.z) - rays.oz) * F(normal.z);
+    const F t = num / denom;
+
+    const raylabs::PacketMask<N> mask =
+        active & (abs(denom) >= F(EPS)) & (t >= F(tMin)) & (t <= hit.t);
+    hit.t = select(mask, t, hit.t);
+    return mask;
+}
+
+raylabs::PacketMask<4> Plane::hit_packet(const raylabs::RayPacket<4>& rays, float tMin,
+                                         raylabs::PacketHit<4>& hit,
+                                         const raylabs::PacketMask<4>& active) const {
+    return hit_packet_n(rays, tMin, hit, active);
+}
+
+raylabs::PacketMask<8> Plane::hit_packet(const raylabs::RayPacket<8>& rays, float tMin,
+                                         raylabs::PacketHit<8>& hit,
+                                         const raylabs::PacketMask<8>& active) const {
+    return hit_packet_n(rays, tMin, hit, active);
+}
+
+raylabs::PacketMask<16> Plane::hit_packet(const raylabs::RayPacket<16>& rays, float tMin,
+                                          raylabs::PacketHit<16>& hit,
+                                          const raylabs::PacketMask<16>& active) const {
+    return hit_packet_n(rays, tMin, hit, active);
+}
@@ -13,5 +13,29 @@ class Plane : public Shape {
     Plane() : point(0, 0, 0), normal(0, 1, 0) {}
     Plane(const Point3& p, const Vec3& n);
 
-    bool hit(const Ray& ray, float tMin, float tMax, HitRecord& hitRecord) const override;
+    bool intersect(const Ray& ray, float tMin, float tMax, PrimitiveHit& hit) const override;
+    void finalize(const Ray& ray, const PrimitiveHit& hit, HitRecord& rec) const override;
+    bool occluded(const Ray& ray, float tMin, float tMax) const override;
+
+    /// Infinite: never part of the BVH
+    raylabs::Aabb bounds() const override { return raylabs::Aabb::unbounded(); }
+    void transform(const raylabs::Transform& t) override {
+        point = t.point(point);
+        normal = normalize(t.rotate_vector(normal));
+    }
+    raylabs::PacketMask<4> hit_packet(const raylabs::RayPacket<4>& rays, float tMin,
+                                      raylabs::PacketHit<4>& hit,
+                                      const raylabs::PacketMask<4>& active) const override;
+    raylabs::PacketMask<8> hit_packet(const raylabs::RayPacket<8>& rays, float tMin,
+                                      raylabs::PacketHit<8>& hit,
+                                      const raylabs::PacketMask<8>& active) const override;
+    raylabs::PacketMask<16> hit_packet(const raylabs::RayPacket<16>& rays, float tMin,
+                                       raylabs::PacketHit<16>& hit,
+                                       const raylabs::PacketMask<16>& active) const override;
+
+   private:
+    template <int N>
+    raylabs::PacketMask<N> hit_packet_n(const raylabs::RayPacket<N>& rays, float tMin,
+                                        raylabs::PacketHit<N>& hit,
+                                        const raylabs::PacketMask<N>& active) const;
 };
@@ -1,11 +1,96 @@
 #pragma once
 
+#include "accel/Aabb.hpp"
 #include "core/HitRecord.hpp"
 #include "core/Ray.hpp"
+#include "core/RayPacket.hpp"
+#include "math/Transform.hpp"
 
 class Shape {
    public:
     virtual ~Shape() = default;
 
-    virtual bool hit(const Ray& ray, float tMin, float tMax, HitRecord& hitRecord) const = 0;
+    /// Closest hit within [tMin, tMax]: intersect() followed by finalize()
+    bool hit(const Ray& ray, float tMin, float tMax, HitRecord& hitRecord) const {
+        PrimitiveHit prim;
+        if (!intersect(ray, tMin, tMax, prim))
+            return false;
+        finalize(ray, prim, hitRecord);
+        return true;
+    }
+
+    /// Cheap part of a closest-hit query: the distance of the closest hit within
+    /// [tMin, tMax], and the primitive and barycentrics finalize() needs. `hit` is left
+    /// unchanged on a miss, and its entity is not the shape's to set.
+    /// Searches over many shapes call this for every candidate and finalize() for the
+    /// closest only, so the point, normal and square roots are computed once per ray.
+    virtual bool intersect(const Ray& ray, float tMin, float tMax, PrimitiveHit& hit) const = 0;
+
+    /// Fill t, point and normal (and the material, for shapes that carry their own) of a
+    /// hit returned by intersect() for the same ray
+    virtual void finalize(const Ray& ray, const PrimitiveHit& hit, HitRecord& rec) const = 0;
+
+    /// Any-hit query (shadow rays): true if the ray meets the shape within [tMin, tMax].
+    /// Nothing else is computed; the default falls back to intersect(), shapes override it
+    /// with a test that stops at the first primitive found.
+    virtual bool occluded(const Ray& ray, float tMin, float tMax) const {
+        PrimitiveHit prim;
+        return intersect(ray, tMin, tMax, prim);
+    }
+
+    /// Box enclosing the shape. Shapes without finite bounds (planes) keep the default and
+    /// are tested against every ray instead of going into the scene's BVH.
+    virtual raylabs::Aabb bounds() const { return raylabs::Aabb::unbounded(); }
+
+    /// Box around the part of the shape lying inside `box` (empty if none), for BVHs built
+    /// with spatial splits. The default intersects bounds() with it; triangles clip
+    /// themselves for a tighter fit.
+    virtual raylabs::Aabb clipped_bounds(const raylabs::Aabb& box) const {
+        return raylabs::intersection(bounds(), box);
+    }
+
+    /// Move the shape in place (animation). A scene holding it must then be brought up to
+    /// date with Scene::update_acceleration().
+    virtual void transform(const raylabs::Transform& t) = 0;
+
+    /// Packet intersection: tests the active lanes against their closest hit so far
+    /// (hit.t acts as tMax) and overwrites t of the lanes hitting closer, along with
+    /// hit.prims for finalize(), which runs later for the closest hit only. Returns the
+    /// updated lanes. The default runs intersect() lane by lane; shapes with a SIMD kernel
+    /// override these, and may leave hit.prims alone if their finalize() only reads t.
+    virtual raylabs::PacketMask<4> hit_packet(const raylabs::RayPacket<4>& rays, float tMin,
+                                              raylabs::PacketHit<4>& hit,
+                                              const raylabs::PacketMask<4>& active) const {
+        return hit_lanes(rays, tMin, hit, active);
+    }
+    virtual raylabs::PacketMask<8> hit_packet(const raylabs::RayPacket<8>& rays, float tMin,
+                                              raylabs::PacketHit<8>& hit,
+                                              const raylabs::PacketMask<8>& active) const {
+        return hit_lanes(rays, tMin, hit, active);
+    }
+    virtual raylabs::PacketMask<16> hit_packet(const raylabs::RayPacket<16>& rays, float tMin,
+                                               raylabs::PacketHit<16>& hit,
+                                               const raylabs::PacketMask<16>& active) const {
+        return hit_lanes(rays, tMin, hit, active);
+    }
+
+   protected:
+    /// Scalar fallback for the packet interface
+    template <int N>
+    raylabs::PacketMask<N> hit_lanes(const raylabs::RayPacket<N>& rays, float tMin,
+                                     raylabs::PacketHit<N>& hit,
+                                     const raylabs::PacketMask<N>& active) const {
+        std::uint32_t updated = 0;
+        for (int lane = 0; lane < N; ++lane) {
+            if (!active[lane])
+                continue;
+            PrimitiveHit prim;
+            if (intersect(rays.ray(lane), tMin, hit.t[lane], prim)) {
+                hit.prims[lane] = prim;
+                hit.t.set(lane, prim.t);
+                updated |= 1u << lane;
+            }
+        }
+        return raylabs::PacketMask<N>::from_bits(updated);
+    }
 };
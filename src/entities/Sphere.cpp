@@ -1,7 +1,7 @@
 #include "Sphere.hpp"
 #include "math/Math_utils.hpp"
 
-bool Sphere::hit(const Ray& ray, float tMin, float tMax, HitRecord& rec) const {
+bool Sphere::intersect(const Ray& ray, float tMin, float tMax, PrimitiveHit& hit) const {
     Vec3 oc = ray.origin - center;
 
     float a = dot(ray.direction, ray.direction);
@@ -24,10 +24,86 @@ bool Sphere::hit(const Ray& ray, float tMin, float tMax, HitRecord& rec) const {
         }
     }
 
-    rec.t = root;
+    hit.t = root;
+    return true;
+}
+
+void Sphere::finalize(const Ray& ray, const PrimitiveHit& hit, HitRecord& rec) const {
+    rec.t = hit.t;
     rec.point = ray.at(rec.t);
     Vec3 outward_normal = (rec.point - center) / radius;
     rec.set_face_normal(ray, outward_normal);
+}
 
-    return true;
+bool Sphere::occluded(const Ray& ray, float tMin, float tMax) const {
+    Vec3 oc = ray.origin - center;
+    float a = dot(ray.direction, ray.direction);
+    float half_b = dot(oc, ray.direction);
+    float c = dot(oc, oc) - radius * radius;
+    float discriminant = half_b * half_b - a * c;
+    if (discriminant < 0) {
+        return false;
+    }
+    // Either root inside the range will do
+    float sqrtd = raylabs::sqrt(discriminant);
+    float near_root = (-half_b - sqrtd) / a;
+    float far_root = (-half_b + sqrtd) / a;
+    return (near_root >= tMin && near_root <= tMax) || (far_root >= tMin && far_root <= tMax);
+}
+
+raylabs::Aabb Sphere::bounds() const {
+    const float r = radius < 0.0f ? -radius : radius;
+    return raylabs::Aabb(center - Vec3(r, r, r), center + Vec3(r, r, r));
+}
+
+template <int N>
+raylabs::PacketMask<N> Sphere::hit_packet_n(const raylabs::RayPacket<N>& rays, float tMin,
+                                            raylabs::PacketHit<N>& hit,
+                                            const raylabs::PacketMask<N>& active) const {
+    using F = raylabs::PacketFloat<N>;
+    const F ocx = rays.ox - F(center.x);
+    const F ocy = rays.oy - F(center.y);
+    const F ocz = rays.oz - F(center.z);
+
+    const F a = rays.dx * rays.dx + rays.dy * rays.dy + rays.dz * rays.dz;
+    const F half_b = ocx * rays.dx + ocy * rays.dy + ocz * rays.dz;
+    const F c = ocx * ocx + ocy * ocy + ocz * ocz - F(radius * radius);
+    const F discriminant = half_b * half_b - a * c;
+
+    raylabs::PacketMask<N> mask = active & (discriminant >= F(0.0f));
+    if (!raylabs::simd::any(mask)) {
+        return mask;
+    }
+
+    const F sqrtd = sqrt(max(discriminant, F(0.0f)));
+    const F near_root = (-half_b - sqrtd) / a;
+    const F far_root = (-half_b + sqrtd) / a;
+    const auto near_ok = (near_root >= F(tMin)) & (near_root <= hit.t);
+    const auto far_ok = (far_root >= F(tMin)) & (far_root <= hit.t);
+    mask = mask & (near_ok | far_ok);
+    if (!raylabs::simd::any(mask)) {
+        return mask;
+    }
+
+    const F t = select(near_ok, near_root, far_root);
+    hit.t = select(mask, t, hit.t);
+    return mask;
+}
+
+raylabs::PacketMask<4> Sphere::hit_packet(const raylabs::RayPacket<4>& rays, float tMin,
+                                          raylabs::PacketHit<4>& hit,
+                                          const raylabs::PacketMask<4>& active) const {
+    return hit_packet_n(rays, tMin, hit, active);
+}
+
+raylabs::PacketMask<8> Sphere::hit_packet(const raylabs::RayPacket<8>& rays, float tMin,
+                                          raylabs::PacketHit<8>& hit,
+                                          const raylabs::PacketMask<8>& active) const {
+    return hit_packet_n(rays, tMin, hit, active);
+}
+
+raylabs::PacketMask<16> Sphere::hit_packet(const raylabs::RayPacket<16>& rays, float tMin,
+                                           raylabs::PacketHit<16>& hit,
+                                           const raylabs::PacketMask<16>& active) const {
+    return hit_packet_n(rays, tMin, hit, active);
 }
@@ -13,5 +13,27 @@ class Sphere : public Shape {
     Sphere() : center(0, 0, 0), radius(1.0f) {}
     Sphere(const Point3& c, float r) : center(c), radius(r) {}
 
-    bool hit(const Ray& ray, float tMin, float tMax, HitRecord& rec) const override;
+    bool intersect(const Ray& ray, float tMin, float tMax, PrimitiveHit& hit) const override;
+    void finalize(const Ray& ray, const PrimitiveHit& hit, HitRecord& rec) const override;
+    bool occluded(const Ray& ray, float tMin, float tMax) const override;
+    raylabs::Aabb bounds() const override;
+    void transform(const raylabs::Transform& t) override {
+        center = t.point(center);
+        radius *= t.scale;
+    }
+    raylabs::PacketMask<4> hit_packet(const raylabs::RayPacket<4>& rays, float tMin,
+                                      raylabs::PacketHit<4>& hit,
+                                      const raylabs::PacketMask<4>& active) const override;
+    raylabs::PacketMask<8> hit_packet(const raylabs::RayPacket<8>& rays, float tMin,
+                                      raylabs::PacketHit<8>& hit,
+                                      const raylabs::PacketMask<8>& active) const override;
+    raylabs::PacketMask<16> hit_packet(const raylabs::RayPacket<16>& rays, float tMin,
+                                       raylabs::PacketHit<16>& hit,
+                                       const raylabs::PacketMask<16>& active) const override;
+
+   private:
+    template <int N>
+    raylabs::PacketMask<N> hit_packet_n(const raylabs::RayPacket<N>& rays, float tMin,
+                                        raylabs::PacketHit<N>& hit,
+                                        const raylabs::PacketMask<N>& active) const;
 };
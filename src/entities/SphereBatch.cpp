@@ -0,0 +1,222 @@
+#include "SphereBatch.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "accel/Bvh.hpp"
+#include "utils/ThreadPool.hpp"
+
+SphereBatch::SphereBatch(const std::vector<Member>& spheres) {
+    if (spheres.empty() || spheres.size() > static_cast<std::size_t>(kWidth)) {
+        throw std::runtime_error("A sphere batch holds 1 to " + std::to_string(kWidth) +
+                                 " spheres, got " + std::to_string(spheres.size()));
+    }
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::fill(std::begin(cx_), std::end(cx_), nan);
+    std::fill(std::begin(cy_), std::end(cy_), nan);
+    std::fill(std::begin(cz_), std::end(cz_), nan);
+    std::fill(std::begin(r_), std::end(r_), 0.0f);
+    count_ = static_cast<int>(spheres.size());
+    materials_.reserve(spheres.size());
+    for (int i = 0; i < count_; ++i) {
+        const Member& s = spheres[static_cast<std::size_t>(i)];
+        cx_[i] = s.center.x;
+        cy_[i] = s.center.y;
+        cz_[i] = s.center.z;
+        r_[i] = s.radius;
+        materials_.push_back(s.material);
+    }
+}
+
+std::vector<std::shared_ptr<SphereBatch>> SphereBatch::group(const std::vector<Member>& spheres,
+                                                             raylabs::ThreadPool* pool,
+                                                             std::vector<Slot>* slots) {
+    std::vector<raylabs::Aabb> bounds;
+    bounds.reserve(spheres.size());
+    for (const Member& s : spheres) {
+        const float r = s.radius < 0.0f ? -s.radius : s.radius;
+        bounds.emplace_back(s.center - Vec3(r, r, r), s.center + Vec3(r, r, r));
+    }
+    std::vector<std::shared_ptr<SphereBatch>> batches;
+    if (slots)
+        slots->assign(spheres.size(), Slot{0, -1});
+    if (spheres.empty())
+        return batches;
+
+    // A batch costs about one sphere test whatever it holds: the SAH only splits a leaf
+    // when its spheres are far enough apart for the rays to miss some of them
+    raylabs::Bvh bvh;
+    raylabs::Bvh::BuildOptions options;
+    options.max_leaf_size = kWidth;
+    options.intersection_cost = 1.0f / static_cast<float>(kWidth);
+    if (pool)
+        bvh.build_binned(bounds, *pool, options);
+    else
+        bvh.build(bounds, options);
+
+    std::vector<Member> members;
+    for (const raylabs::Bvh::Node& node : bvh.nodes()) {
+        if (!node.is_leaf())
+            continue;
+        // Leaves past the maximum depth may hold more than kWidth spheres
+        for (std::uint32_t k = 0; k < node.count; k += kWidth) {
+            members.clear();
+            const std::uint32_t end = std::min<std::uint32_t>(node.count, k + kWidth);
+            for (std::uint32_t j = k; j < end; ++j) {
+                const std::uint32_t sphere = bvh.indices()[node.offset + j];
+                if (slots) {
+                    (*slots)[sphere] = {static_cast<std::uint32_t>(batches.size()),
+                                        static_cast<int>(members.size())};
+                }
+                members.push_back(spheres[sphere]);
+            }
+            batches.push_back(std::make_shared<SphereBatch>(members));
+        }
+    }
+    return batches;
+}
+
+SphereBatch::M SphereBatch::roots(const Ray& ray, F& near_root, F& far_root) const {
+    // Sphere::intersect on every lane
+    const F ocx = F(ray.origin.x) - F::load(cx_);
+    const F ocy = F(ray.origin.y) - F::load(cy_);
+    const F ocz = F(ray.origin.z) - F::load(cz_);
+    const F r = F::load(r_);
+    const F dx(ray.direction.x), dy(ray.direction.y), dz(ray.direction.z);
+
+    const F a(dot(ray.direction, ray.direction));
+    const F half_b = ocx * dx + ocy * dy + ocz * dz;
+    const F c = ocx * ocx + ocy * ocy + ocz * ocz - r * r;
+    const F discriminant = half_b * half_b - a * c;
+
+    const F sqrtd = sqrt(max(discriminant, F(0.0f)));
+    near_root = (-half_b - sqrtd) / a;
+    far_root = (-half_b + sqrtd) / a;
+    return discriminant >= F(0.0f);
+}
+
+bool SphereBatch::intersect(const Ray& ray, float tMin, float tMax, PrimitiveHit& hit) const {
+    F near_root, far_root;
+    M mask = roots(ray, near_root, far_root);
+    if (!raylabs::simd::any(mask))
+        return false;
+    const M near_ok = (near_root >= F(tMin)) & (near_root <= F(tMax));
+    const M far_ok = (far_root >= F(tMin)) & (far_root <= F(tMax));
+    mask = mask & (near_ok | far_ok);
+    if (!raylabs::simd::any(mask))
+        return false;
+
+    // Closest of the lanes hit; the first one on ties, like separate shapes in scene order
+    alignas(64) float t[kWidth];
+    select(near_ok, near_root, far_root).store(t);
+    int closest = -1;
+    for (std::uint32_t bits = mask.bits(); bits != 0; bits &= bits - 1) {
+        const int lane = std::countr_zero(bits);
+        if (closest < 0 || t[lane] < t[closest])
+            closest = lane;
+    }
+    hit.t = t[closest];
+    hit.prim = static_cast<std::uint32_t>(closest);
+    return true;
+}
+
+void SphereBatch::finalize(const Ray& ray, const PrimitiveHit& hit, HitRecord& rec) const {
+    const int i = static_cast<int>(hit.prim);
+    rec.t = hit.t;
+    rec.point = ray.at(rec.t);
+    Vec3 outward_normal = (rec.point - center(i)) / r_[i];
+    rec.set_face_normal(ray, outward_normal);
+    rec.material = materials_[hit.prim].get();
+}
+
+bool SphereBatch::occluded(const Ray& ray, float tMin, float tMax) const {
+    F near_root, far_root;
+    const M mask = roots(ray, near_root, far_root);
+    if (!raylabs::simd::any(mask))
+        return false;
+    // Either root inside the range will do
+    const M near_ok = (near_root >= F(tMin)) & (near_root <= F(tMax));
+    const M far_ok = (far_root >= F(tMin)) & (far_root <= F(tMax));
+    return raylabs::simd::any(mask & (near_ok | far_ok));
+}
+
+template <int N>
+raylabs::PacketMask<N> SphereBatch::hit_packet_n(const raylabs::RayPacket<N>& rays, float tMin,
+                                                 raylabs::PacketHit<N>& hit,
+                                                 const raylabs::PacketMask<N>& active) const {
+    using P = raylabs::PacketFloat<N>;
+    using PM = raylabs::PacketMask<N>;
+    // Sphere's kernel for every sphere of the batch, the lanes keeping the closest
+    const P limit = hit.t;
+    const P a = rays.dx * rays.dx + rays.dy * rays.dy + rays.dz * rays.dz;
+    PM updated = PM::from_bits(0);
+    for (int i = 0; i < count_; ++i) {
+        const P ocx = rays.ox - P(cx_[i]);
+        const P ocy = rays.oy - P(cy_[i]);
+        const P ocz = rays.oz - P(cz_[i]);
+        const P half_b = ocx * rays.dx + ocy * rays.dy + ocz * rays.dz;
+        const P c = ocx * ocx + ocy * ocy + ocz * ocz - P(r_[i] * r_[i]);
+        const P discriminant = half_b * half_b - a * c;
+        PM mask = active & (discriminant >= P(0.0f));
+        if (!raylabs::simd::any(mask))
+            continue;
+
+        const P sqrtd = sqrt(max(discriminant, P(0.0f)));
+        const P near_root = (-half_b - sqrtd) / a;
+        const P far_root = (-half_b + sqrtd) / a;
+        const PM near_ok = (near_root >= P(tMin)) & (near_root <= limit);
+        const PM far_ok = (far_root >= P(tMin)) & (far_root <= limit);
+        const P t = select(near_ok, near_root, far_root);
+        // On ties the first sphere keeps the lane, as in intersect()
+        mask = mask & (near_ok | far_ok) & ((!updated) | (t < hit.t));
+        if (!raylabs::simd::any(mask))
+            continue;
+
+        hit.t = select(mask, t, hit.t);
+        for (std::uint32_t bits = mask.bits(); bits != 0; bits &= bits - 1)
+            hit.prims[std::countr_zero(bits)].prim = static_cast<std::uint32_t>(i);
+        updated = updated | mask;
+    }
+    return updated;
+}
+
+raylabs::PacketMask<4> SphereBatch::hit_packet(const raylabs::RayPacket<4>& rays, float tMin,
+                                               raylabs::PacketHit<4>& hit,
+                                               const raylabs::PacketMask<4>& active) const {
+    return hit_packet_n(rays, tMin, hit, active);
+}
+
+raylabs::PacketMask<8> SphereBatch::hit_packet(const raylabs::RayPacket<8>& rays, float tMin,
+                                               raylabs::PacketHit<8>& hit,
+                                               const raylabs::PacketMask<8>& active) const {
+    return hit_packet_n(rays, tMin, hit, active);
+}
+
+raylabs::PacketMask<16> SphereBatch::hit_packet(const raylabs::RayPacket<16>& rays, float tMin,
+                                                raylabs::PacketHit<16>& hit,
+                                                const raylabs::PacketMask<16>& active) const {
+    return hit_packet_n(rays, tMin, hit, active);
+}
+
+raylabs::Aabb SphereBatch::bounds() const {
+    raylabs::Aabb box;
+    for (int i = 0; i < count_; ++i) {
+        const float r = r_[i] < 0.0f ? -r_[i] : r_[i];
+        box.expand(raylabs::Aabb(center(i) - Vec3(r, r, r), center(i) + Vec3(r, r, r)));
+    }
+    return box;
+}
+
+void SphereBatch::transform(const raylabs::Transform& t) {
+    for (int i = 0; i < count_; ++i) {
+        const Point3 c = t.point(center(i));
+        cx_[i] = c.x;
+        cy_[i] = c.y;
+        cz_[i] = c.z;
+        r_[i] *= t.scale;
+    }
+}
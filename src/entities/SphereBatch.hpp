@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
+#include "core/RayPacket.hpp"
+#include "entities/Shape.hpp"
+#include "math/Simd.hpp"
+#include "math/Vec3.hpp"
+
+class Material;
+
+namespace raylabs {
+class ThreadPool;
+}
+
+/// Up to kWidth neighbouring spheres as one Shape, stored as one array per coordinate (SoA)
+/// and intersected with a single SIMD kernel: one ray against every sphere of the batch per
+/// instruction (16 with AVX-512, 8 with AVX, 4 with SSE; plain lane loops elsewhere). Each
+/// sphere keeps its own material, which finalize() reports, so batches are added to a scene
+/// without one. Hits are the same as those of the separate Sphere shapes.
+class SphereBatch : public Shape {
+   public:
+    static constexpr int kWidth = raylabs::simd::kNativeWidth;
+
+    struct Member {
+        Point3 center;
+        float radius;
+        std::shared_ptr<Material> material;
+    };
+
+    /// Where group() put a sphere: its batch, and its place in that batch
+    struct Slot {
+        std::uint32_t batch;
+        int member;
+    };
+
+    /// Throws std::runtime_error for no spheres or more than kWidth
+    explicit SphereBatch(const std::vector<Member>& spheres);
+
+    /// Split spheres into batches of spatial neighbours: the leaves of a BVH built over them
+    /// with kWidth spheres per leaf at most (binned SAH on `pool` if given, exact SAH
+    /// otherwise), so a sphere much larger than its neighbours ends up in a batch of its own.
+    /// `slots`, if given, receives the slot of each sphere.
+    static std::vector<std::shared_ptr<SphereBatch>> group(const std::vector<Member>& spheres,
+                                                           raylabs::ThreadPool* pool = nullptr,
+                                                           std::vector<Slot>* slots = nullptr);
+
+    /// Closest sphere of the batch; its index goes to PrimitiveHit::prim
+    bool intersect(const Ray& ray, float tMin, float tMax, PrimitiveHit& hit) const override;
+    void finalize(const Ray& ray, const PrimitiveHit& hit, HitRecord& rec) const override;
+    bool occluded(const Ray& ray, float tMin, float tMax) const override;
+    raylabs::Aabb bounds() const override;
+    void transform(const raylabs::Transform& t) override;
+    /// The spheres one after the other, each against the whole packet; the sphere of every
+    /// updated lane goes to hit.prims[lane].prim
+    raylabs::PacketMask<4> hit_packet(const raylabs::RayPacket<4>& rays, float tMin,
+                                      raylabs::PacketHit<4>& hit,
+                                      const raylabs::PacketMask<4>& active) const override;
+    raylabs::PacketMask<8> hit_packet(const raylabs::RayPacket<8>& rays, float tMin,
+                                      raylabs::PacketHit<8>& hit,
+                                      const raylabs::PacketMask<8>& active) const override;
+    raylabs::PacketMask<16> hit_packet(const raylabs::RayPacket<16>& rays, float tMin,
+                                       raylabs::PacketHit<16>& hit,
+                                       const raylabs::PacketMask<16>& active) const override;
+
+    int size() const { return count_; }
+    Point3 center(int i) const { return Point3(cx_[i], cy_[i], cz_[i]); }
+    float radius(int i) const { return r_[i]; }
+    const Material* material(int i) const { return materials_[i].get(); }
+
+   private:
+    using F = raylabs::simd::vfloat<kWidth>;
+    using M = raylabs::simd::vmask<kWidth>;
+
+    /// Both roots of every lane, with the lanes whose ray meets the sphere at all
+    M roots(const Ray& ray, F& near_root, F& far_root) const;
+
+    template <int N>
+    raylabs::PacketMask<N> hit_packet_n(const raylabs::RayPacket<N>& rays, float tMin,
+                                        raylabs::PacketHit<N>& hit,
+                                        const raylabs::PacketMask<N>& active) const;
+
+    // Unused lanes hold NaN centers, which every comparison rejects
+    alignas(64) float cx_[kWidth];
+    alignas(64) float cy_[kWidth];
+    alignas(64) float cz_[kWidth];
+    alignas(64) float r_[kWidth];
+    int count_ = 0;
+    std::vector<std::shared_ptr<Material>> materials_;
+};
@@ -6,6 +6,41 @@
 #include "entities/Shape.hpp"
 #include "math/Vec3.hpp"
 
+/// Box around the part of triangle abc inside `box` (empty if none), for spatial splits
+inline raylabs::Aabb clipped_triangle_bounds(const Point3& a, const Point3& b, const Point3& c,
+                                             const raylabs::Aabb& box) {
+    // Sutherland-Hodgman against the six faces of the box: each adds at most one vertex
+    Point3 poly[9] = {a, b, c};
+    Point3 clipped[9];
+    int n = 3;
+    for (int face = 0; face < 6 && n > 0; ++face) {
+        const int axis = face / 2;
+        const bool lower = face % 2 == 0;
+        const float bound = lower ? box.min[axis] : box.max[axis];
+        auto inside = [&](const Point3& p) { return lower ? p[axis] >= bound : p[axis] <= bound; };
+        int m = 0;
+        for (int i = 0; i < n; ++i) {
+            const Point3& p = poly[i];
+            const Point3& q = poly[(i + 1) % n];
+            if (inside(p))
+                clipped[m++] = p;
+            if (inside(p) != inside(q)) {
+                Point3 x = p + (bound - p[axis]) / (q[axis] - p[axis]) * (q - p);
+                x[axis] = bound;
+                clipped[m++] = x;
+            }
+        }
+        n = m;
+        for (int i = 0; i < n; ++i)
+            poly[i] = clipped[i];
+    }
+    raylabs::Aabb part;
+    for (int i = 0; i < n; ++i)
+        part.expand(poly[i]);
+    // Rounding in the edge crossings must not push the box out of `box`
+    return part.is_empty() ? part : raylabs::intersection(part, box);
+}
+
 class Triangle : public Shape {
    public:
     Point3 a;
@@ -15,7 +50,7 @@ class Triangle : public Shape {
     Triangle() : a(0, 0, 0), b(1, 0, 0), c(0, 1, 0) {}
     Triangle(const Point3& a_, const Point3& b_, const Point3& c_) : a(a_), b(b_), c(c_) {}
 
-    bool hit(const Ray& ray, float tMin, float tMax, HitRecord& hitRecord) const override {
+    bool intersect(const Ray& ray, float tMin, float tMax, PrimitiveHit& hit) const override {
         const float EPS = 1e-6f;
         Vec3 edge1 = b - a;
         Vec3 edge2 = c - a;
@@ -39,10 +74,118 @@ class Triangle : public Shape {
         if (t < tMin || t > tMax)
             return false;
 
-        hitRecord.t = t;
-        hitRecord.point = ray.at(t);
-        Vec3 outward_normal = normalize(cross(edge1, edge2));
-        hitRecord.set_face_normal(ray, outward_normal);
+        hit.t = t;
+        hit.u = u;
+        hit.v = v;
         return true;
     }
+
+    void finalize(const Ray& ray, const PrimitiveHit& hit, HitRecord& rec) const override {
+        rec.t = hit.t;
+        rec.point = ray.at(hit.t);
+        Vec3 outward_normal = normalize(cross(b - a, c - a));
+        rec.set_face_normal(ray, outward_normal);
+    }
+
+    bool occluded(const Ray& ray, float tMin, float tMax) const override {
+        // Same tests as intersect(), without keeping the barycentrics
+        const float EPS = 1e-6f;
+        Vec3 edge1 = b - a;
+        Vec3 edge2 = c - a;
+        Vec3 pvec = cross(ray.direction, edge2);
+        float det = dot(edge1, pvec);
+        if (std::fabs(det) < EPS)
+            return false;
+        float invDet = 1.0f / det;
+
+        Vec3 tvec = ray.origin - a;
+        float u = dot(tvec, pvec) * invDet;
+        if (u < 0.0f || u > 1.0f)
+            return false;
+
+        Vec3 qvec = cross(tvec, edge1);
+        float v = dot(ray.direction, qvec) * invDet;
+        if (v < 0.0f || u + v > 1.0f)
+            return false;
+
+        float t = dot(edge2, qvec) * invDet;
+        return t >= tMin && t <= tMax;
+    }
+
+    raylabs::Aabb bounds() const override {
+        raylabs::Aabb box;
+        box.expand(a);
+        box.expand(b);
+        box.expand(c);
+        return box;
+    }
+
+    raylabs::Aabb clipped_bounds(const raylabs::Aabb& box) const override {
+        return clipped_triangle_bounds(a, b, c, box);
+    }
+
+    void transform(const raylabs::Transform& t) override {
+        a = t.point(a);
+        b = t.point(b);
+        c = t.point(c);
+    }
+
+    raylabs::PacketMask<4> hit_packet(const raylabs::RayPacket<4>& rays, float tMin,
+                                      raylabs::PacketHit<4>& hit,
+                                      const raylabs::PacketMask<4>& active) const override {
+        return hit_packet_n(rays, tMin, hit, active);
+    }
+    raylabs::PacketMask<8> hit_packet(const raylabs::RayPacket<8>& rays, float tMin,
+                                      raylabs::PacketHit<8>& hit,
+                                      const raylabs::PacketMask<8>& active) const override {
+        return hit_packet_n(rays, tMin, hit, active);
+    }
+    raylabs::PacketMask<16> hit_packet(const raylabs::RayPacket<16>& rays, float tMin,
+                                       raylabs::PacketHit<16>& hit,
+                                       const raylabs::PacketMask<16>& active) const override {
+        return hit_packet_n(rays, tMin, hit, active);
+    }
+
+   private:
+    /// Moller-Trumbore on N lanes; same tests as intersect()
+    template <int N>
+    raylabs::PacketMask<N> hit_packet_n(const raylabs::RayPacket<N>& rays, float tMin,
+                                        raylabs::PacketHit<N>& hit,
+                                        const raylabs::PacketMask<N>& active) const {
+        using F = raylabs::PacketFloat<N>;
+        const float EPS = 1e-6f;
+        const Vec3 edge1 = b - a;
+        const Vec3 edge2 = c - a;
+
+        // pvec = cross(d, edge2)
+        const F px = rays.dy * F(edge2.z) - rays.dz * F(edge2.y);
+        const F py = rays.dz * F(edge2.x) - rays.dx * F(edge2.z);
+        const F pz = rays.dx * F(edge2.y) - rays.dy * F(edge2.x);
+        const F det = F(edge1.x) * px + F(edge1.y) * py + F(edge1.z) * pz;
+        raylabs::PacketMask<N> mask = active & (abs(det) >= F(EPS));
+        if (!raylabs::simd::any(mask))
+            return mask;
+        const F inv_det = F(1.0f) / det;
+
+        const F tx = rays.ox - F(a.x);
+        const F ty = rays.oy - F(a.y);
+        const F tz = rays.oz - F(a.z);
+        const F u = (tx * px + ty * py + tz * pz) * inv_det;
+        mask = mask & (u >= F(0.0f)) & (u <= F(1.0f));
+
+        // qvec = cross(tvec, edge1)
+        const F qx = ty * F(edge1.z) - tz * F(edge1.y);
+        const F qy = tz * F(edge1.x) - tx * F(edge1.z);
+        const F qz = tx * F(edge1.y) - ty * F(edge1.x);
+        const F v = (rays.dx * qx + rays.dy * qy + rays.dz * qz) * inv_det;
+        mask = mask & (v >= F(0.0f)) & (u + v <= F(1.0f));
+
+        const F t = (F(edge2.x) * qx + F(edge2.y) * qy + F(edge2.z) * qz) * inv_det;
+        mask = mask & (t >= F(tMin)) & (t <= hit.t);
+        if (!raylabs::simd::any(mask))
+            return mask;
+
+        hit.t = select(mask, t, hit.t);
+        return mask;
+    }
 };
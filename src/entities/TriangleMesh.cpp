@@ -0,0 +1,209 @@
+#include "TriangleMesh.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "entities/Triangle.hpp"
+#include "utils/ThreadPool.hpp"
+
+TriangleMesh::TriangleMesh(std::shared_ptr<const Buffers> buffers, raylabs::ThreadPool* pool,
+                           const raylabs::BvhBuildOptions& options)
+    : buffers_(std::move(buffers)), options_(options) {
+    raylabs::check_build_options(options_);
+    const Buffers& b = *buffers_;
+    const std::size_t vertices = b.vertex_count();
+    if (b.indices.empty())
+        throw std::runtime_error("Triangle mesh without triangles");
+    if (b.indices.size() % 3 != 0) {
+        throw std::runtime_error("Triangle mesh index count must be a multiple of 3, got " +
+                                 std::to_string(b.indices.size()));
+    }
+    if (b.y.size() != vertices || b.z.size() != vertices)
+        throw std::runtime_error("Triangle mesh position arrays differ in size");
+    if (b.has_normals() && (b.nx.size() != vertices || b.ny.size() != vertices ||
+                            b.nz.size() != vertices)) {
+        throw std::runtime_error("Triangle mesh needs one normal per vertex (or none)");
+    }
+    for (std::uint32_t index : b.indices) {
+        if (index >= vertices) {
+            throw std::runtime_error("Triangle mesh index " + std::to_string(index) +
+                                     " past its " + std::to_string(vertices) + " vertices");
+        }
+    }
+    build(pool);
+}
+
+void TriangleMesh::build(raylabs::ThreadPool* pool) {
+    const Buffers& b = *buffers_;
+    std::vector<raylabs::Aabb> boxes(b.triangle_count());
+    bounds_ = raylabs::Aabb();
+    for (std::size_t tri = 0; tri < boxes.size(); ++tri) {
+        for (int k = 0; k < 3; ++k) {
+            const std::uint32_t i = b.indices[3 * tri + static_cast<std::size_t>(k)];
+            boxes[tri].expand(Point3(b.x[i], b.y[i], b.z[i]));
+        }
+        bounds_.expand(boxes[tri]);
+    }
+    if (options_.spatial_split_budget > 0.0f) {
+        auto vertex = [&](std::size_t k) {
+            const std::uint32_t i = b.indices[k];
+            return Point3(b.x[i], b.y[i], b.z[i]);
+        };
+        bvh_.build_spatial(
+            boxes,
+            [&](std::uint32_t tri, const raylabs::Aabb& box) {
+                const std::size_t k = 3 * static_cast<std::size_t>(tri);
+                return clipped_triangle_bounds(vertex(k), vertex(k + 1), vertex(k + 2), box);
+            },
+            options_);
+    } else if (pool) {
+        bvh_.build_binned(boxes, *pool, options_);
+    } else {
+        bvh_.build(boxes, options_);
+    }
+    bvh4_.clear();
+    bvh8_.clear();
+    qbvh4_.clear();
+    qbvh8_.clear();
+    quantized_ = false;
+    if (options_.width == 2)
+        return;
+    if (options_.width == 4)
+        bvh4_.build(bvh_);
+    else
+        bvh8_.build(bvh_);
+    bvh_.clear();
+    if (!options_.quantized)
+        return;
+    if (options_.width == 4 && qbvh4_.build(bvh4_)) {
+        bvh4_.clear();
+        quantized_ = true;
+    } else if (options_.width == 8 && qbvh8_.build(bvh8_)) {
+        bvh8_.clear();
+        quantized_ = true;
+    }
+}
+
+bool TriangleMesh::intersect_triangle(const Ray& ray, std::uint32_t tri, float tMin,
+                                      float tMax, float& t, float& u, float& v) const {
+    const Buffers& b = *buffers_;
+    const std::uint32_t i0 = b.indices[3 * static_cast<std::size_t>(tri)];
+    const std::uint32_t i1 = b.indices[3 * static_cast<std::size_t>(tri) + 1];
+    const std::uint32_t i2 = b.indices[3 * static_cast<std::size_t>(tri) + 2];
+    const Point3 p0(b.x[i0], b.y[i0], b.z[i0]);
+    const Point3 p1(b.x[i1], b.y[i1], b.z[i1]);
+    const Point3 p2(b.x[i2], b.y[i2], b.z[i2]);
+
+    const float EPS = 1e-6f;
+    const Vec3 edge1 = p1 - p0;
+    const Vec3 edge2 = p2 - p0;
+    const Vec3 pvec = cross(ray.direction, edge2);
+    const float det = dot(edge1, pvec);
+    if (std::fabs(det) < EPS)
+        return false;
+    const float invDet = 1.0f / det;
+
+    const Vec3 tvec = ray.origin - p0;
+    u = dot(tvec, pvec) * invDet;
+    if (u < 0.0f || u > 1.0f)
+        return false;
+
+    const Vec3 qvec = cross(tvec, edge1);
+    v = dot(ray.direction, qvec) * invDet;
+    if (v < 0.0f || u + v > 1.0f)
+        return false;
+
+    t = dot(edge2, qvec) * invDet;
+    return t >= tMin && t <= tMax;
+}
+
+bool TriangleMesh::intersect(const Ray& ray, float tMin, float tMax, PrimitiveHit& hit) const {
+    std::uint32_t closest = 0;
+    float closest_u = 0.0f, closest_v = 0.0f;
+    const bool found = traverse(ray, tMin, tMax, [&](std::uint32_t tri, float& t_max) {
+        float t, u, v;
+        if (!intersect_triangle(ray, tri, tMin, t_max, t, u, v))
+            return false;
+        t_max = t;
+        closest = tri;
+        closest_u = u;
+        closest_v = v;
+        return true;
+    });
+    if (!found)
+        return false;
+    hit.t = tMax;
+    hit.u = closest_u;
+    hit.v = closest_v;
+    hit.prim = closest;
+    return true;
+}
+
+void TriangleMesh::finalize(const Ray& ray, const PrimitiveHit& hit, HitRecord& rec) const {
+    const Buffers& b = *buffers_;
+    const std::uint32_t i0 = b.indices[3 * static_cast<std::size_t>(hit.prim)];
+    const std::uint32_t i1 = b.indices[3 * static_cast<std::size_t>(hit.prim) + 1];
+    const std::uint32_t i2 = b.indices[3 * static_cast<std::size_t>(hit.prim) + 2];
+    const Point3 p0(b.x[i0], b.y[i0], b.z[i0]);
+    const Vec3 edge1 = Point3(b.x[i1], b.y[i1], b.z[i1]) - p0;
+    const Vec3 edge2 = Point3(b.x[i2], b.y[i2], b.z[i2]) - p0;
+    const Vec3 geometric = normalize(cross(edge1, edge2));
+    rec.t = hit.t;
+    rec.point = ray.at(hit.t);
+    rec.set_face_normal(ray, geometric);
+    if (b.has_normals()) {
+        // The side comes from the geometric normal, the shading from the vertex normals
+        const float w = 1.0f - hit.u - hit.v;
+        const Vec3 smooth = normalize(w * Vec3(b.nx[i0], b.ny[i0], b.nz[i0]) +
+                                      hit.u * Vec3(b.nx[i1], b.ny[i1], b.nz[i1]) +
+                                      hit.v * Vec3(b.nx[i2], b.ny[i2], b.nz[i2]));
+        rec.normal = rec.front_face ? smooth : -smooth;
+    }
+}
+
+bool TriangleMesh::occluded(const Ray& ray, float tMin, float tMax) const {
+    // Any triangle will do: drop tMax below every t so that the traversal drains at once
+    bool blocked = false;
+    traverse(ray, tMin, tMax, [&](std::uint32_t tri, float& t_max) {
+        float t, u, v;
+        if (!intersect_triangle(ray, tri, tMin, t_max, t, u, v))
+            return false;
+        blocked = true;
+        t_max = -std::numeric_limits<float>::infinity();
+        return true;
+    });
+    return blocked;
+}
+
+void TriangleMesh::transform(const raylabs::Transform& t) {
+    auto moved = std::make_shared<Buffers>(*buffers_);
+    for (std::size_t i = 0; i < moved->vertex_count(); ++i) {
+        const Point3 p = t.point(Point3(moved->x[i], moved->y[i], moved->z[i]));
+        moved->x[i] = p.x;
+        moved->y[i] = p.y;
+        moved->z[i] = p.z;
+        if (moved->has_normals()) {
+            const Vec3 n = t.rotate_vector(Vec3(moved->nx[i], moved->ny[i], moved->nz[i]));
+            moved->nx[i] = n.x;
+            moved->ny[i] = n.y;
+            moved->nz[i] = n.z;
+        }
+    }
+    buffers_ = std::move(moved);
+    build(nullptr);
+}
+
+std::size_t TriangleMesh::memory_bytes() const {
+    const Buffers& b = *buffers_;
+    return (b.x.size() + b.y.size() + b.z.size() + b.nx.size() + b.ny.size() + b.nz.size()) *
+               sizeof(float) +
+           b.indices.size() * sizeof(std::uint32_t) + bvh_.memory_bytes() +
+           (quantized_ ? qbvh4_.memory_bytes() + qbvh8_.memory_bytes()
+                       : bvh4_.memory_bytes() + bvh4_.sources().size() * sizeof(std::uint32_t) +
+                             bvh8_.memory_bytes() +
+                             bvh8_.sources().size() * sizeof(std::uint32_t));
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "accel/Bvh.hpp"
+#include "accel/FlatArray.hpp"
+#include "accel/QuantizedBvh.hpp"
+#include "accel/WideBvh.hpp"
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
+#include "entities/Shape.hpp"
+#include "math/Transform.hpp"
+
+namespace raylabs {
+class ThreadPool;
+}
+
+/// Indexed triangle mesh, one Shape for all its triangles. The vertices are stored as one
+/// array per coordinate (SoA) and shared by the triangles through an index buffer; the mesh
+/// builds its own BVH over them (bottom level, like an Instance's prototype), with the same
+/// options as the scene's, and is a single leaf of the scene's BVH. A triangle costs its 12
+/// bytes of indices plus its share of the vertices and of the BVH: about 37 bytes in all on
+/// a closed mesh with quantized BVH4 nodes, 49 with normals, where a Triangle shape takes a
+/// heap block, a shared_ptr and a scene entity.
+/// Triangles are intersected with the same tests as Triangle, so a mesh and the equivalent
+/// Triangle shapes report the same hits.
+class TriangleMesh : public Shape {
+   public:
+    /// Geometry of a mesh. Read-only once a mesh uses it, so several meshes may share it; the
+    /// arrays may own their memory or borrow it (FlatArray::borrow), e.g. from a mapped file.
+    struct Buffers {
+        raylabs::FlatArray<float> x, y, z;     // vertex positions
+        raylabs::FlatArray<float> nx, ny, nz;  // per-vertex normals, empty for flat shading
+        // Three vertex indices per triangle; the front face sees them counter-clockwise
+        raylabs::FlatArray<std::uint32_t> indices;
+
+        std::size_t vertex_count() const { return x.size(); }
+        std::size_t triangle_count() const { return indices.size() / 3; }
+        bool has_normals() const { return !nx.empty(); }
+    };
+
+    /// Check the buffers and build the BVH (binned SAH on `pool` if given, exact SAH
+    /// otherwise, spatial splits whatever the pool with options.spatial_split_budget above 0)
+    /// with the node width, quantization and SAH settings of `options`; its accelerator is
+    /// ignored, meshes always use a BVH. Throws std::runtime_error for an
+    /// empty mesh, an index count that is not a multiple of 3, an index past the vertices,
+    /// coordinate and normal arrays whose sizes differ from the vertex count, or options
+    /// check_build_options() refuses.
+    explicit TriangleMesh(std::shared_ptr<const Buffers> buffers,
+                          raylabs::ThreadPool* pool = nullptr,
+                          const raylabs::BvhBuildOptions& options = {});
+
+    /// Closest triangle, with its index and barycentrics; finalize() interpolates the
+    /// vertex normals of that one only
+    bool intersect(const Ray& ray, float tMin, float tMax, PrimitiveHit& hit) const override;
+    void finalize(const Ray& ray, const PrimitiveHit& hit, HitRecord& rec) const override;
+    bool occluded(const Ray& ray, float tMin, float tMax) const override;
+    raylabs::Aabb bounds() const override { return bounds_; }
+
+    /// Moves a copy of the vertices (the buffers may be shared) and rebuilds the BVH with
+    /// the options it was built with
+    void transform(const raylabs::Transform& t) override;
+
+    const Buffers& buffers() const { return *buffers_; }
+    std::size_t triangle_count() const { return buffers_->triangle_count(); }
+
+    /// Bytes of vertex and index buffers plus the BVH
+    std::size_t memory_bytes() const;
+
+   private:
+    /// Build the binary tree (with spatial splits, serially, if options_ allow them; the
+    /// triangles clip themselves like Triangle shapes) and collapse it to options_.width;
+    /// with options_.quantized, compress the wide tree, keeping the full-precision one only
+    /// if the compression fails (see QuantizedBvh::build()). The same steps as
+    /// Scene::build_acceleration().
+    void build(raylabs::ThreadPool* pool);
+
+    template <typename HitPrim>
+    bool traverse(const Ray& ray, float tMin, float& tMax, HitPrim&& hit_prim) const {
+        switch (options_.width) {
+            case 4:
+                return quantized_ ? qbvh4_.intersect(ray, tMin, tMax, hit_prim)
+                                  : bvh4_.intersect(ray, tMin, tMax, hit_prim);
+            case 8:
+                return quantized_ ? qbvh8_.intersect(ray, tMin, tMax, hit_prim)
+                                  : bvh8_.intersect(ray, tMin, tMax, hit_prim);
+            default:
+                return bvh_.intersect(ray, tMin, tMax, hit_prim);
+        }
+    }
+
+    /// Möller-Trumbore on triangle `tri`, with the tests and operation order of
+    /// Triangle::intersect
+    bool intersect_triangle(const Ray& ray, std::uint32_t tri, float tMin, float tMax,
+                            float& t, float& u, float& v) const;
+
+    std::shared_ptr<const Buffers> buffers_;
+    raylabs::BvhBuildOptions options_;
+    raylabs::Bvh bvh_;  // kept for width 2 only
+    raylabs::WideBvh<4> bvh4_;
+    raylabs::WideBvh<8> bvh8_;
+    raylabs::QuantizedBvh<4> qbvh4_;
+    raylabs::QuantizedBvh<8> qbvh8_;
+    bool quantized_ = false;
+    raylabs::Aabb bounds_;
+};
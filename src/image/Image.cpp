@@ -1,4 +1,5 @@
 #include "image/Image.hpp"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include "lodepng/lodepng.h"
@@ -28,7 +29,7 @@ void Image::SetPixel(unsigned int x, unsigned int y, Color color) {
     buffer[index] = color;
 }
 
-Color Image::GetPixel(unsigned int x, unsigned int y) {
+Color Image::GetPixel(unsigned int x, unsigned int y) const {
     unsigned int index = (y * width) + x;
 
     if (index >= buffer.size()) {
@@ -37,6 +38,29 @@ Color Image::GetPixel(unsigned int x, unsigned int y) {
     return buffer[index];
 }
 
+void Image::SetBlock(unsigned int x, unsigned int y, unsigned int w, unsigned int h,
+                     const Color* pixels) {
+    if (x + w > width || y + h > height) {
+        throw std::invalid_argument("Image: Block outside the image");
+    }
+    for (unsigned int row = 0; row < h; ++row) {
+        std::copy_n(pixels + row * w, w, buffer.begin() + (y + row) * width + x);
+    }
+}
+
+Image Image::Crop(unsigned int x, unsigned int y, unsigned int w, unsigned int h) const {
+    if (x + w > width || y + h > height) {
+        throw std::invalid_argument("Image: Crop outside the image");
+    }
+    Image out(w, h);
+    for (unsigned int row = 0; row < h; ++row) {
+        for (unsigned int col = 0; col < w; ++col) {
+            out.buffer[row * w + col] = buffer[(y + row) * width + x + col];
+        }
+    }
+    return out;
+}
+
 void Image::WriteFile(const char* filename) {
     std::vector<unsigned char> image;
     image.resize(width * height * 4);
@@ -16,7 +16,17 @@ class Image {
     ~Image();
 
     void SetPixel(unsigned int x, unsigned int y, Color color);
-    Color GetPixel(unsigned int x, unsigned int y);
+    Color GetPixel(unsigned int x, unsigned int y) const;
+
+    /// Copy a w x h block of row-major pixels whose top-left corner is (x, y), one row at a time
+    void SetBlock(unsigned int x, unsigned int y, unsigned int w, unsigned int h,
+                  const Color* pixels);
+
+    unsigned int Width() const { return width; }
+    unsigned int Height() const { return height; }
+
+    /// Copy of the w x h block whose top-left corner is (x, y)
+    Image Crop(unsigned int x, unsigned int y, unsigned int w, unsigned int h) const;
 
     void WriteFile(const char* filename);
 };
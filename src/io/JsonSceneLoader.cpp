@@ -2,25 +2,37 @@
 
 #include <algorithm>
 #include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
 #include <fstream>
+#include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <unordered_map>
 
 #include <nlohmann/json.hpp>
+#include "accel/BvhCache.hpp"
 #include "core/Camera.hpp"
 #include "core/Scene.hpp"
+#include "entities/Instance.hpp"
 #include "entities/Plane.hpp"
 #include "entities/Sphere.hpp"
+#include "entities/SphereBatch.hpp"
 #include "entities/Triangle.hpp"
+#include "entities/TriangleMesh.hpp"
 #include "io/Logger.hpp"
+#include "io/ObjLoader.hpp"
+#include "io/PlyLoader.hpp"
 #include "materials/Checker.hpp"
 #include "materials/Dielectric.hpp"
 #include "materials/Lambertian.hpp"
 #include "materials/Material.hpp"
 #include "materials/Metal.hpp"
 #include "math/Color.hpp"
+#include "math/Transform.hpp"
 #include "math/Vec3.hpp"
+#include "utils/ThreadPool.hpp"
 
 using json = nlohmann::json;
 
@@ -71,6 +83,8 @@ io::ObjectType parse_object_type(const std::string& s) {
         return io::ObjectType::Sphere;
     if (t == "plane")
         return io::ObjectType::Plane;
+    if (t == "mesh")
+        return io::ObjectType::Mesh;
     throw std::runtime_error("Unknown object type: " + s);
 }
 
@@ -118,6 +132,143 @@ std::shared_ptr<Material> parse_material_inline(const json& m) {
 
 namespace io {
 
+namespace {
+
+// The "material" of an object: an id, or an inline material added to scene.materials as
+// `inline_id`. `what` names the object type in error messages.
+std::string parse_material_ref(const json& o, SceneDTO& scene, const std::string& inline_id,
+                               const char* what) {
+    // Support both string (material_id) and object (inline material)
+    if (o.at("material").is_string())
+        return o.at("material").get<std::string>();
+    if (!o.at("material").is_object()) {
+        throw std::runtime_error(std::string(what) +
+                                 ".material must be a string (id) or object (inline)");
+    }
+    // Inline material: create a unique ID and add to materials map
+    const auto& mat_obj = o.at("material");
+    MaterialDTO md;
+    md.id = inline_id;
+    md.type = parse_material_type(mat_obj.at("type").get<std::string>());
+    if (mat_obj.contains("albedo")) {
+        md.albedo = color3_from(mat_obj.at("albedo"), "albedo");
+    }
+    if (md.type == MaterialType::Metal && mat_obj.contains("fuzz")) {
+        md.roughness = mat_obj.at("fuzz").get<float>();
+    } else if (md.type == MaterialType::Metal && mat_obj.contains("roughness")) {
+        md.roughness = mat_obj.at("roughness").get<float>();
+    }
+    if (md.type == MaterialType::Dielectric && mat_obj.contains("ior")) {
+        md.ior = mat_obj.at("ior").get<float>();
+    }
+    if (md.type == MaterialType::Checker && mat_obj.contains("color1") &&
+        mat_obj.contains("color2")) {
+        md.albedo = color3_from(mat_obj.at("color1"), "color1");
+        // Note: color2 is not stored in MaterialDTO, will use default in populateScene
+    }
+    scene.materials.emplace(inline_id, md);
+    return inline_id;
+}
+
+// "vertices": [[x, y, z], ...], "indices": [i0, i1, i2, ...] or [[i0, i1, i2], ...] and
+// optionally "normals": [[x, y, z], ...], one per vertex
+MeshDTO parse_mesh(const json& o) {
+    if (!o.at("vertices").is_array() || !o.at("indices").is_array())
+        throw std::runtime_error("Mesh.vertices and Mesh.indices must be arrays");
+    MeshDTO mesh;
+    mesh.vertices.reserve(o.at("vertices").size());
+    for (const auto& v : o.at("vertices"))
+        mesh.vertices.push_back(vec3_from(v, "objects[*].vertices"));
+    if (o.contains("normals")) {
+        if (!o.at("normals").is_array())
+            throw std::runtime_error("Mesh.normals must be an array");
+        for (const auto& n : o.at("normals"))
+            mesh.normals.push_back(vec3_from(n, "objects[*].normals"));
+    }
+    for (const auto& i : o.at("indices")) {
+        if (i.is_array()) {
+            if (i.size() != 3)
+                throw std::runtime_error("Mesh.indices entries must be triangles of 3 indices");
+            for (const auto& k : i)
+                mesh.indices.push_back(k.get<std::uint32_t>());
+        } else {
+            mesh.indices.push_back(i.get<std::uint32_t>());
+        }
+    }
+
+    if (mesh.indices.empty() || mesh.indices.size() % 3 != 0)
+        throw std::runtime_error("Mesh.indices must hold 3 indices per triangle");
+    for (std::uint32_t i : mesh.indices) {
+        if (i >= mesh.vertices.size()) {
+            throw std::runtime_error("Mesh index " + std::to_string(i) + " past its " +
+                                     std::to_string(mesh.vertices.size()) + " vertices");
+        }
+    }
+    if (!mesh.normals.empty() && mesh.normals.size() != mesh.vertices.size())
+        throw std::runtime_error("Mesh.normals must hold one normal per vertex");
+    return mesh;
+}
+
+// One entry of an "objects" array. Inline materials are added to scene.materials as
+// `inline_id`; mesh files are looked up relative to `base_dir`.
+ObjectDTO parse_object(const json& o, SceneDTO& scene, const std::string& inline_id,
+                       const std::filesystem::path& base_dir) {
+    if (!o.contains("type"))
+        throw std::runtime_error("Object missing 'type' field");
+    const auto type = parse_object_type(o.at("type").get<std::string>());
+
+    ObjectDTO obj;
+    obj.type = type;
+
+    std::string material_id;
+    switch (type) {
+        case ObjectType::Sphere: {
+            if (!o.contains("center") || !o.contains("radius") || !o.contains("material"))
+                throw std::runtime_error("Sphere requires 'center', 'radius', 'material'");
+            obj.sphere.center = vec3_from(o.at("center"), "objects[*].center");
+            obj.sphere.radius = o.at("radius").get<float>();
+            obj.sphere.material_id = parse_material_ref(o, scene, inline_id, "Sphere");
+            obj.sphere.batch = get_or<bool>(o, "batch", true);
+            material_id = obj.sphere.material_id;
+            if (obj.sphere.radius <= 0.f)
+                throw std::runtime_error("Sphere.radius must be > 0");
+        } break;
+        case ObjectType::Plane: {
+            if (!o.contains("point") || !o.contains("normal") || !o.contains("material"))
+                throw std::runtime_error("Plane requires 'point', 'normal', 'material'");
+            obj.plane.point = vec3_from(o.at("point"), "objects[*].point");
+            obj.plane.normal = vec3_from(o.at("normal"), "objects[*].normal");
+            obj.plane.material_id = parse_material_ref(o, scene, inline_id, "Plane");
+            material_id = obj.plane.material_id;
+        } break;
+        case ObjectType::Mesh: {
+            if (o.contains("file") && o.contains("material")) {
+                const std::filesystem::path file(o.at("file").get<std::string>());
+                const std::string extension = to_lower(file.extension().string());
+                if (extension != ".obj" && extension != ".ply")
+                    throw std::runtime_error("Mesh.file must be an .obj or .ply file: " +
+                                             file.string());
+                obj.mesh.file = (file.is_relative() ? base_dir / file : file).string();
+            } else if (o.contains("vertices") && o.contains("indices") && o.contains("material")) {
+                obj.mesh = parse_mesh(o);
+            } else {
+                throw std::runtime_error(
+                    "Mesh requires 'file' or 'vertices' and 'indices', and 'material'");
+            }
+            obj.mesh.material_id = parse_material_ref(o, scene, inline_id, "Mesh");
+            material_id = obj.mesh.material_id;
+        } break;
+    }
+
+    // Soft-check material existence to help users early (not fatal: some pipelines add built-ins).
+    if (!material_id.empty() && !scene.materials.count(material_id))
+        Logger::warn("Object references unknown material id: " + material_id);
+
+    return obj;
+}
+
+}  // namespace
+
 SceneDTO JsonSceneLoader::load_from_file(const std::string& path) {
     std::ifstream ifs(path);
     if (!ifs) {
@@ -141,6 +292,8 @@ SceneDTO JsonSceneLoader::parse_json_string(const std::string& json_text,
     }
 
     SceneDTO scene;
+    // Files named by the scene are relative to it
+    const std::filesystem::path base_dir = std::filesystem::path(origin_hint).parent_path();
 
     // ---- image ----
     if (j.contains("image")) {
@@ -149,6 +302,62 @@ SceneDTO JsonSceneLoader::parse_json_string(const std::string& json_text,
         scene.image.height = get_or<int>(ji, "height", 450);
         scene.image.samples = get_or<int>(ji, "samples", 1);
         scene.image.max_depth = get_or<int>(ji, "max_depth", 4);
+        scene.image.threads = get_or<int>(ji, "threads", 0);
+        scene.image.progressive = get_or<bool>(ji, "progressive", false);
+        scene.image.time_budget_ms = get_or<int>(ji, "time_budget_ms", 0);
+        // "adaptive": true, or an object with the sampler parameters
+        if (ji.contains("adaptive")) {
+            const auto& ja = ji.at("adaptive");
+            if (ja.is_boolean()) {
+                scene.image.adaptive = ja.get<bool>();
+            } else if (ja.is_object()) {
+                scene.image.adaptive = get_or<bool>(ja, "enabled", true);
+                scene.image.adaptive_threshold = get_or<float>(ja, "threshold", 0.02f);
+                scene.image.min_samples = get_or<int>(ja, "min_samples", 4);
+                scene.image.max_samples = get_or<int>(ja, "max_samples", 0);
+            } else {
+                throw std::runtime_error("Image.adaptive must be a boolean or an object");
+            }
+        }
+        scene.image.spp_output = get_or<std::string>(ji, "spp_output", "");
+        scene.image.packet_size = get_or<int>(ji, "packet_size", 0);
+        scene.image.integrator = get_or<std::string>(ji, "integrator", "path");
+        scene.image.ray_sort = get_or<bool>(ji, "ray_sort", false);
+        scene.image.tile_order = get_or<std::string>(ji, "tile_order", "hilbert");
+        scene.image.bvh_width = get_or<int>(ji, "bvh_width", 4);
+        scene.image.bvh_quantized = get_or<bool>(ji, "bvh_quantized", false);
+        scene.image.bvh_spatial_splits = get_or<float>(ji, "bvh_spatial_splits", 0.0f);
+        scene.image.accelerator = get_or<std::string>(ji, "accelerator", "bvh");
+        scene.image.bvh_cache = get_or<std::string>(ji, "bvh_cache", "");
+        if (ji.contains("checkpoint")) {
+            const auto& jc = ji["checkpoint"];
+            if (jc.is_string()) {
+                scene.image.checkpoint_path = jc.get<std::string>();
+            } else if (jc.is_object()) {
+                scene.image.checkpoint_path = get_or<std::string>(jc, "path", "");
+                scene.image.checkpoint_interval_ms = get_or<int>(jc, "interval_ms", 60000);
+            } else {
+                throw std::runtime_error("Image.checkpoint must be a path or an object");
+            }
+        }
+        // "crop": [x, y, width, height], or an object that may also keep the full frame
+        if (ji.contains("crop")) {
+            const auto& jr = ji.at("crop");
+            if (jr.is_array() && jr.size() == 4) {
+                scene.image.crop_x = jr[0].get<int>();
+                scene.image.crop_y = jr[1].get<int>();
+                scene.image.crop_width = jr[2].get<int>();
+                scene.image.crop_height = jr[3].get<int>();
+            } else if (jr.is_object()) {
+                scene.image.crop_x = get_or<int>(jr, "x", 0);
+                scene.image.crop_y = get_or<int>(jr, "y", 0);
+                scene.image.crop_width = get_or<int>(jr, "width", 0);
+                scene.image.crop_height = get_or<int>(jr, "height", 0);
+                scene.image.crop_full_frame = get_or<bool>(jr, "full_frame", false);
+            } else {
+                throw std::runtime_error("Image.crop must be [x, y, width, height] or an object");
+            }
+        }
         scene.image.output_path = get_or<std::string>(ji, "output", "output/render.png");
 
         if (scene.image.width <= 0 || scene.image.height <= 0)
@@ -161,6 +370,65 @@ SceneDTO JsonSceneLoader::parse_json_string(const std::string& json_text,
             Logger::warn("Image.max_depth < 0; clamping to 0");
             scene.image.max_depth = 0;
         }
+        if (scene.image.threads < 0) {
+            Logger::warn("Image.threads < 0; using one thread per core");
+            scene.image.threads = 0;
+        }
+        if (scene.image.time_budget_ms < 0) {
+            Logger::warn("Image.time_budget_ms < 0; disabling the deadline");
+            scene.image.time_budget_ms = 0;
+        }
+        if (scene.image.adaptive_threshold <= 0.f)
+            throw std::runtime_error("Image.adaptive.threshold must be > 0");
+        if (scene.image.min_samples < 2) {
+            Logger::warn("Image.adaptive.min_samples < 2; variance needs two samples, using 2");
+            scene.image.min_samples = 2;
+        }
+        if (scene.image.packet_size == 1) {
+            scene.image.packet_size = 0;
+        } else if (scene.image.packet_size != 0 && scene.image.packet_size != 4 &&
+                   scene.image.packet_size != 8 && scene.image.packet_size != 16) {
+            throw std::runtime_error("Image.packet_size must be 0, 4, 8 or 16");
+        }
+        if (scene.image.integrator != "path" && scene.image.integrator != "pathtracer" &&
+            scene.image.integrator != "wavefront") {
+            throw std::runtime_error("Image.integrator must be 'path' or 'wavefront' (got '" +
+                                     scene.image.integrator + "')");
+        }
+        if (scene.image.tile_order != "hilbert" && scene.image.tile_order != "morton" &&
+            scene.image.tile_order != "row") {
+            throw std::runtime_error("Image.tile_order must be 'hilbert', 'morton' or 'row' (got '" +
+                                     scene.image.tile_order + "')");
+        }
+        if (scene.image.bvh_width != 2 && scene.image.bvh_width != 4 &&
+            scene.image.bvh_width != 8) {
+            throw std::runtime_error("Image.bvh_width must be 2, 4 or 8");
+        }
+        if (scene.image.bvh_quantized && scene.image.bvh_width == 2)
+            throw std::runtime_error("Image.bvh_quantized needs a bvh_width of 4 or 8");
+        if (scene.image.bvh_spatial_splits < 0.0f)
+            throw std::runtime_error("Image.bvh_spatial_splits must be >= 0");
+        if (scene.image.accelerator != "bvh" && scene.image.accelerator != "grid" &&
+            scene.image.accelerator != "kdtree" && scene.image.accelerator != "auto") {
+            throw std::runtime_error(
+                "Image.accelerator must be 'bvh', 'grid', 'kdtree' or 'auto' (got '" +
+                scene.image.accelerator + "')");
+        }
+        if (scene.image.checkpoint_interval_ms < 0) {
+            Logger::warn("Image.checkpoint.interval_ms < 0; checkpointing after every pass");
+            scene.image.checkpoint_interval_ms = 0;
+        }
+        if (scene.image.crop_width != 0 || scene.image.crop_height != 0) {
+            const auto& im = scene.image;
+            if (im.crop_x < 0 || im.crop_y < 0 || im.crop_width <= 0 || im.crop_height <= 0 ||
+                im.crop_x + im.crop_width > im.width || im.crop_y + im.crop_height > im.height) {
+                throw std::runtime_error("Image.crop must be a non-empty rectangle inside the frame");
+            }
+        }
+        if (scene.image.max_samples < 0) {
+            Logger::warn("Image.adaptive.max_samples < 0; using the default");
+            scene.image.max_samples = 0;
+        }
     } else {
         Logger::warn("Missing 'image' block; using defaults.");
     }
@@ -239,113 +507,72 @@ SceneDTO JsonSceneLoader::parse_json_string(const std::string& json_text,
         scene.objects.reserve(jo.size());
 
         for (const auto& o : jo) {
-            if (!o.contains("type"))
-                throw std::runtime_error("Object missing 'type' field");
-            const auto type = parse_object_type(o.at("type").get<std::string>());
-
-            ObjectDTO obj;
-            obj.type = type;
-
-            switch (type) {
-                case ObjectType::Sphere: {
-                    if (!o.contains("center") || !o.contains("radius") || !o.contains("material"))
-                        throw std::runtime_error("Sphere requires 'center', 'radius', 'material'");
-                    obj.sphere.center = vec3_from(o.at("center"), "objects[*].center");
-                    obj.sphere.radius = o.at("radius").get<float>();
-                    // Support both string (material_id) and object (inline material)
-                    if (o.at("material").is_string()) {
-                        obj.sphere.material_id = o.at("material").get<std::string>();
-                    } else if (o.at("material").is_object()) {
-                        // Inline material: create a unique ID and add to materials map
-                        std::string inline_id = "__inline_" + std::to_string(scene.objects.size());
-                        const auto& mat_obj = o.at("material");
-                        MaterialDTO md;
-                        md.id = inline_id;
-                        md.type = parse_material_type(mat_obj.at("type").get<std::string>());
-                        if (mat_obj.contains("albedo")) {
-                            md.albedo = color3_from(mat_obj.at("albedo"), "albedo");
-                        }
-                        if (md.type == MaterialType::Metal && mat_obj.contains("fuzz")) {
-                            md.roughness = mat_obj.at("fuzz").get<float>();
-                        } else if (md.type == MaterialType::Metal &&
-                                   mat_obj.contains("roughness")) {
-                            md.roughness = mat_obj.at("roughness").get<float>();
-                        }
-                        if (md.type == MaterialType::Dielectric && mat_obj.contains("ior")) {
-                            md.ior = mat_obj.at("ior").get<float>();
-                        }
-                        if (md.type == MaterialType::Checker && mat_obj.contains("color1") &&
-                            mat_obj.contains("color2")) {
-                            md.albedo = color3_from(mat_obj.at("color1"), "color1");
-                            // Note: color2 is not stored in MaterialDTO, will use default in populateScene
-                        }
-                        scene.materials.emplace(inline_id, md);
-                        obj.sphere.material_id = inline_id;
-                    } else {
-                        throw std::runtime_error(
-                            "Sphere.material must be a string (id) or object (inline)");
-                    }
-                    if (obj.sphere.radius <= 0.f)
-                        throw std::runtime_error("Sphere.radius must be > 0");
-                } break;
-                case ObjectType::Plane: {
-                    if (!o.contains("point") || !o.contains("normal") || !o.contains("material"))
-                        throw std::runtime_error("Plane requires 'point', 'normal', 'material'");
-                    obj.plane.point = vec3_from(o.at("point"), "objects[*].point");
-                    obj.plane.normal = vec3_from(o.at("normal"), "objects[*].normal");
-                    // Support both string (material_id) and object (inline material)
-                    if (o.at("material").is_string()) {
-                        obj.plane.material_id = o.at("material").get<std::string>();
-                    } else if (o.at("material").is_object()) {
-                        // Inline material: create a unique ID and add to materials map
-                        std::string inline_id = "__inline_" + std::to_string(scene.objects.size());
-                        const auto& mat_obj = o.at("material");
-                        MaterialDTO md;
-                        md.id = inline_id;
-                        md.type = parse_material_type(mat_obj.at("type").get<std::string>());
-                        if (mat_obj.contains("albedo")) {
-                            md.albedo = color3_from(mat_obj.at("albedo"), "albedo");
-                        }
-                        if (md.type == MaterialType::Metal && mat_obj.contains("fuzz")) {
-                            md.roughness = mat_obj.at("fuzz").get<float>();
-                        } else if (md.type == MaterialType::Metal &&
-                                   mat_obj.contains("roughness")) {
-                            md.roughness = mat_obj.at("roughness").get<float>();
-                        }
-                        if (md.type == MaterialType::Dielectric && mat_obj.contains("ior")) {
-                            md.ior = mat_obj.at("ior").get<float>();
-                        }
-                        if (md.type == MaterialType::Checker && mat_obj.contains("color1") &&
-                            mat_obj.contains("color2")) {
-                            md.albedo = color3_from(mat_obj.at("color1"), "color1");
-                            // Note: color2 is not stored in MaterialDTO, will use default in populateScene
-                        }
-                        scene.materials.emplace(inline_id, md);
-                        obj.plane.material_id = inline_id;
-                    } else {
-                        throw std::runtime_error(
-                            "Plane.material must be a string (id) or object (inline)");
-                    }
-                } break;
-            }
+            scene.objects.push_back(
+                parse_object(o, scene, "__inline_" + std::to_string(scene.objects.size()),
+                             base_dir));
+        }
+    } else if (!j.contains("instances")) {
+        Logger::warn("No 'objects' block; scene will be empty.");
+    }
 
-            // Soft-check material existence to help users early (not fatal: some pipelines add built-ins).
-            if (!obj.sphere.material_id.empty()) {
-                if (!scene.materials.count(obj.sphere.material_id)) {
-                    Logger::warn("Object references unknown material id: " +
-                                 obj.sphere.material_id);
-                }
+    // ---- prototypes and instances ----
+    // "prototypes": {name: [objects...]} are built once; every entry of "instances" places
+    // one of them: {"prototype": name, "translate": [x, y, z], "rotate": {"axis": [x, y, z],
+    // "degrees": d}, "scale": s, "material": id}
+    if (j.contains("prototypes")) {
+        const auto& jp = j.at("prototypes");
+        if (!jp.is_object())
+            throw std::runtime_error("'prototypes' must be an object (name -> objects)");
+        for (auto it = jp.begin(); it != jp.end(); ++it) {
+            if (!it.value().is_array())
+                throw std::runtime_error("Prototype '" + it.key() +
+                                         "' must be an array of objects");
+            PrototypeDTO proto;
+            for (const auto& o : it.value()) {
+                proto.objects.push_back(parse_object(
+                    o, scene,
+                    "__inline_" + it.key() + "_" + std::to_string(proto.objects.size()),
+                    base_dir));
             }
-            if (!obj.plane.material_id.empty()) {
-                if (!scene.materials.count(obj.plane.material_id)) {
-                    Logger::warn("Object references unknown material id: " + obj.plane.material_id);
-                }
+            scene.prototypes.emplace(it.key(), std::move(proto));
+        }
+    }
+    if (j.contains("instances")) {
+        const auto& ji = j.at("instances");
+        if (!ji.is_array())
+            throw std::runtime_error("'instances' must be an array");
+        scene.instances.reserve(ji.size());
+        for (const auto& i : ji) {
+            InstanceDTO inst;
+            if (!i.contains("prototype"))
+                throw std::runtime_error("Instance requires 'prototype'");
+            inst.prototype = i.at("prototype").get<std::string>();
+            if (!scene.prototypes.count(inst.prototype))
+                throw std::runtime_error("Instance references unknown prototype: " +
+                                         inst.prototype);
+            if (i.contains("translate"))
+                inst.translate = vec3_from(i.at("translate"), "instances[*].translate");
+            if (i.contains("rotate")) {
+                const auto& jr = i.at("rotate");
+                if (!jr.is_object())
+                    throw std::runtime_error("Instance.rotate must be {\"axis\", \"degrees\"}");
+                if (jr.contains("axis"))
+                    inst.rotate_axis = vec3_from(jr.at("axis"), "instances[*].rotate.axis");
+                inst.rotate_deg = get_or<float>(jr, "degrees", 0.f);
             }
-
-            scene.objects.push_back(std::move(obj));
+            inst.scale = get_or<float>(i, "scale", 1.f);
+            inst.material_id = get_or<std::string>(i, "material", "");
+            if (inst.scale <= 0.f)
+                throw std::runtime_error("Instance.scale must be > 0");
+            const auto& a = inst.rotate_axis;
+            if (inst.rotate_deg != 0.f && a.x == 0.f && a.y == 0.f && a.z == 0.f)
+                throw std::runtime_error("Instance.rotate.axis must not be zero");
+            if (!inst.material_id.empty() && !scene.materials.count(inst.material_id))
+                Logger::warn("Instance references unknown material id: " + inst.material_id);
+            scene.instances.push_back(std::move(inst));
         }
-    } else {
-        Logger::warn("No 'objects' block; scene will be empty.");
+    } else if (j.contains("prototypes")) {
+        Logger::warn("'prototypes' without 'instances'; nothing of them will be rendered.");
     }
 
     // ---- lights ----
@@ -441,6 +668,7 @@ bool JsonSceneLoader::loadFromString(const std::string& json_text, ::Scene& scen
                 }
             }
         }
+        scene.build_acceleration();
         return true;
     } catch (const std::exception& e) {
         if (err)
@@ -486,7 +714,8 @@ bool JsonSceneLoader::loadFromString(const std::string& json_text, ::Scene& scen
     }
 }
 
-void JsonSceneLoader::populateScene(const SceneDTO& dto, ::Scene& scene, ::Camera& camera) {
+std::vector<ObjectPlacement> JsonSceneLoader::populateScene(const SceneDTO& dto, ::Scene& scene,
+                                                            ::Camera& camera) {
     // Populate camera
     camera.position =
         Point3(dto.camera.look_from.x, dto.camera.look_from.y, dto.camera.look_from.z);
@@ -523,33 +752,195 @@ void JsonSceneLoader::populateScene(const SceneDTO& dto, ::Scene& scene, ::Camer
         material_map[id] = mat;
     }
 
-    // Populate scene with objects
-    for (const auto& obj : dto.objects) {
-        std::shared_ptr<Material> mat = nullptr;
-        if (!obj.sphere.material_id.empty()) {
-            auto it = material_map.find(obj.sphere.material_id);
-            if (it != material_map.end()) {
-                mat = it->second;
+    // The hierarchies are built with the render threads so that large scenes get to the first
+    // pixel quickly; meshes build theirs on the same pool, with the same options, as they are
+    // added
+    raylabs::Bvh::BuildOptions accel;
+    accel.width = dto.image.bvh_width;
+    accel.quantized = dto.image.bvh_quantized;
+    accel.spatial_split_budget = dto.image.bvh_spatial_splits;
+    accel.accelerator = raylabs::accelerator_from_string(dto.image.accelerator);
+    raylabs::ThreadPool pool(static_cast<unsigned>(dto.image.threads));
+    std::optional<raylabs::BvhCache> cache;
+    if (!dto.image.bvh_cache.empty())
+        cache.emplace(dto.image.bvh_cache);
+    const raylabs::BvhCache* cache_ptr = cache ? &*cache : nullptr;
+
+    // Mesh files are read once, however many objects use them
+    std::unordered_map<std::string, std::shared_ptr<const TriangleMesh::Buffers>> mesh_files;
+    auto mesh_file = [&](const std::string& path) {
+        auto& buffers = mesh_files[path];
+        if (!buffers) {
+            const auto read_start = std::chrono::steady_clock::now();
+            if (to_lower(std::filesystem::path(path).extension().string()) == ".ply")
+                buffers = PlyLoader::load_from_file(path, &pool);
+            else
+                buffers = ObjLoader::load_from_file(path, &pool);
+            const std::chrono::duration<double, std::milli> read_time =
+                std::chrono::steady_clock::now() - read_start;
+            Logger::info("Read ", buffers->triangle_count(), " triangles from ", path, " in ",
+                         read_time.count(), " ms");
+        }
+        return buffers;
+    };
+
+    // Populate a scene (the main one or a prototype) with objects, one entity each in order,
+    // except the spheres: those are set aside and added last, gathered into SIMD batches of
+    // neighbours, each sphere keeping its material. Returns where each object went.
+    auto add_objects = [&](const std::vector<ObjectDTO>& objects, ::Scene& target) {
+        std::vector<ObjectPlacement> placements(objects.size());
+        std::vector<SphereBatch::Member> spheres;
+        std::vector<std::size_t> sphere_objects;  // index in `objects` of each of `spheres`
+        for (std::size_t o = 0; o < objects.size(); ++o) {
+            const ObjectDTO& obj = objects[o];
+            placements[o].entity = target.entities.size();
+            std::shared_ptr<Material> mat = nullptr;
+            if (!obj.sphere.material_id.empty()) {
+                auto it = material_map.find(obj.sphere.material_id);
+                if (it != material_map.end()) {
+                    mat = it->second;
+                }
+            } else if (!obj.plane.material_id.empty()) {
+                auto it = material_map.find(obj.plane.material_id);
+                if (it != material_map.end()) {
+                    mat = it->second;
+                }
+            } else if (!obj.mesh.material_id.empty()) {
+                auto it = material_map.find(obj.mesh.material_id);
+                if (it != material_map.end()) {
+                    mat = it->second;
+                }
             }
-        } else if (!obj.plane.material_id.empty()) {
-            auto it = material_map.find(obj.plane.material_id);
-            if (it != material_map.end()) {
-                mat = it->second;
+
+            switch (obj.type) {
+                case ObjectType::Sphere: {
+                    Point3 center(obj.sphere.center.x, obj.sphere.center.y, obj.sphere.center.z);
+                    if (obj.sphere.batch) {
+                        spheres.push_back({center, obj.sphere.radius, mat});
+                        sphere_objects.push_back(o);
+                    } else {
+                        target.add(std::make_shared<Sphere>(center, obj.sphere.radius), mat);
+                    }
+                } break;
+                case ObjectType::Plane: {
+                    Point3 point(obj.plane.point.x, obj.plane.point.y, obj.plane.point.z);
+                    Vec3 normal(obj.plane.normal.x, obj.plane.normal.y, obj.plane.normal.z);
+                    target.add(std::make_shared<Plane>(point, normal), mat);
+                } break;
+                case ObjectType::Mesh: {
+                    if (!obj.mesh.file.empty()) {
+                        target.add(std::make_shared<TriangleMesh>(mesh_file(obj.mesh.file),
+                                                                  &pool, accel),
+                                   mat);
+                        break;
+                    }
+                    auto buffers = std::make_shared<TriangleMesh::Buffers>();
+                    for (const auto& v : obj.mesh.vertices) {
+                        buffers->x.push_back(v.x);
+                        buffers->y.push_back(v.y);
+                        buffers->z.push_back(v.z);
+                    }
+                    for (const auto& n : obj.mesh.normals) {
+                        buffers->nx.push_back(n.x);
+                        buffers->ny.push_back(n.y);
+                        buffers->nz.push_back(n.z);
+                    }
+                    buffers->indices = obj.mesh.indices;
+                    target.add(
+                        std::make_shared<TriangleMesh>(std::move(buffers), &pool, accel), mat);
+                } break;
             }
         }
+        const std::size_t first_batch = target.entities.size();
+        if (spheres.size() == 1) {
+            target.add(std::make_shared<Sphere>(spheres[0].center, spheres[0].radius),
+                       spheres[0].material);
+            placements[sphere_objects[0]].entity = first_batch;
+        } else if (!spheres.empty()) {
+            std::vector<SphereBatch::Slot> slots;
+            const auto batches = SphereBatch::group(spheres, &pool, &slots);
+            for (const auto& batch : batches)
+                target.add(batch);
+            for (std::size_t s = 0; s < spheres.size(); ++s)
+                placements[sphere_objects[s]] = {first_batch + slots[s].batch, slots[s].member};
+            Logger::info("Grouped ", spheres.size(), " spheres into ", batches.size(),
+                         " batches of up to ", SphereBatch::kWidth);
+        }
+        return placements;
+    };
+    const std::vector<ObjectPlacement> placements = add_objects(dto.objects, scene);
+
+    for (const auto& light : dto.lights) {
+        switch (light.type) {
+            case LightType::Point:
+                scene.lights.push_back(
+                    {Point3(light.point.position.x, light.point.position.y,
+                            light.point.position.z),
+                     Color(light.point.intensity.r, light.point.intensity.g,
+                           light.point.intensity.b)});
+                break;
+        }
+    }
 
-        switch (obj.type) {
-            case ObjectType::Sphere: {
-                Point3 center(obj.sphere.center.x, obj.sphere.center.y, obj.sphere.center.z);
-                scene.add(std::make_shared<Sphere>(center, obj.sphere.radius), mat);
-            } break;
-            case ObjectType::Plane: {
-                Point3 point(obj.plane.point.x, obj.plane.point.y, obj.plane.point.z);
-                Vec3 normal(obj.plane.normal.x, obj.plane.normal.y, obj.plane.normal.z);
-                scene.add(std::make_shared<Plane>(point, normal), mat);
-            } break;
+    // Two levels: each prototype gets its own BVH, shared by all its instances, which are
+    // the leaves of the scene's BVH
+    std::unordered_map<std::string, std::shared_ptr<const ::Scene>> prototypes;
+    for (const auto& [name, proto] : dto.prototypes) {
+        auto built = std::make_shared<::Scene>();
+        add_objects(proto.objects, *built);
+        built->build_acceleration(accel, &pool, cache_ptr);
+        prototypes[name] = std::move(built);
+    }
+    for (const auto& inst : dto.instances) {
+        const Vec3 axis(inst.rotate_axis.x, inst.rotate_axis.y, inst.rotate_axis.z);
+        const auto to_world =
+            raylabs::Transform::translate(Vec3(inst.translate.x, inst.translate.y,
+                                               inst.translate.z)) *
+            (inst.rotate_deg != 0.f
+                 ? raylabs::Transform::rotate(axis, inst.rotate_deg * 3.14159265f / 180.0f)
+                 : raylabs::Transform()) *
+            raylabs::Transform::uniform_scale(inst.scale);
+        std::shared_ptr<Material> mat = nullptr;
+        if (!inst.material_id.empty()) {
+            auto it = material_map.find(inst.material_id);
+            if (it != material_map.end())
+                mat = it->second;
         }
+        scene.add(std::make_shared<Instance>(prototypes.at(inst.prototype), to_world), mat);
+    }
+
+    // Timed alone: mesh files, sphere grouping and prototypes are done by now
+    const auto start = std::chrono::steady_clock::now();
+    scene.build_acceleration(accel, &pool, cache_ptr);
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    if (!dto.instances.empty()) {
+        Logger::info(dto.instances.size(), " instances of ", prototypes.size(), " prototypes");
+    }
+    if (scene.accelerator() != raylabs::Accelerator::Bvh) {
+        Logger::info(raylabs::to_string(scene.accelerator()), " over ", scene.entities.size(),
+                     " entities built in ", elapsed.count(), " ms, ",
+                     scene.acceleration_bytes() / 1024, " KiB");
+        return placements;
+    }
+    const char* layout = scene.bvh_quantized() ? " KiB of quantized nodes" : " KiB of nodes";
+    if (scene.acceleration_cached()) {
+        Logger::info("BVH", accel.width, " over ", scene.bvh().primitive_count(),
+                     " entities mapped from the cache in ", elapsed.count(), " ms, ",
+                     scene.acceleration_bytes() / 1024, layout);
+        return placements;
+    }
+    if (accel.spatial_split_budget > 0.0f) {
+        Logger::info("BVH", accel.width, " with spatial splits over ", scene.entities.size(),
+                     " entities (", scene.bvh().primitive_count(), " references) built in ",
+                     elapsed.count(), " ms (SAH cost ", scene.bvh().sah_cost(accel), "), ",
+                     scene.acceleration_bytes() / 1024, layout);
+        return placements;
     }
+    Logger::info("BVH", accel.width, " over ", scene.bvh().primitive_count(), " entities built in ",
+                 elapsed.count(), " ms on ", pool.size(), " threads (SAH cost ",
+                 scene.bvh().sah_cost(accel), "), ", scene.acceleration_bytes() / 1024, layout);
+    return placements;
 }
 
 }  // namespace io
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -34,6 +35,56 @@ struct ImageDTO {
     int height = 450;
     int samples = 1;
     int max_depth = 4;
+    int threads = 0;  // render threads, 0 = one per hardware thread
+    // Progressive mode: whole-frame passes of one sample per pixel until `samples` spp
+    // or the time budget is reached. A time budget > 0 implies progressive.
+    bool progressive = false;
+    int time_budget_ms = 0;  // 0 = no deadline
+    // Adaptive sampling (implies progressive): `samples` becomes the average budget per
+    // pixel; pixels stop once their relative error drops below the threshold and the saved
+    // samples go to noisy pixels, up to max_samples each.
+    bool adaptive = false;
+    float adaptive_threshold = 0.02f;
+    int min_samples = 4;
+    int max_samples = 0;     // 0 = 8 x samples
+    std::string spp_output;  // optional debug image of the spp spent per pixel
+    int packet_size = 0;     // camera rays traced as SIMD packets of 4, 8 or 16 (0 = off)
+    std::string integrator = "path";  // "path" (recursive) or "wavefront"
+    // Wavefront only: reorder the bounced rays of every wave by direction octant and origin
+    // (Morton code) before intersecting them, so that neighbouring rays visit the same nodes
+    bool ray_sort = false;
+    // Order in which the tiles are handed to the threads: "hilbert" or "morton" keep
+    // consecutive tiles (and each thread's block of them) spatially close, "row" is row-major
+    std::string tile_order = "hilbert";
+    // Children per BVH node for closest-hit queries: 2 (binary), 4 or 8 (one SIMD slab test
+    // per node, 8 needs an AVX build to pay off)
+    int bvh_width = 4;
+    // Structure over the scene: "bvh", "grid" (uniform grid), "kdtree" or "auto" (picked
+    // from the primitive count, size variation and how evenly they fill the scene box)
+    std::string accelerator = "bvh";
+    // Quantized wide nodes (8-bit child boxes relative to the parent): about a third of the
+    // memory, for scenes where the hierarchy no longer fits the caches
+    bool bvh_quantized = false;
+    // Spatial splits (SBVH) for scenes of long thin triangles: extra primitive references the
+    // BVH may make, as a fraction of the primitives (0 = off, 0.3 = up to 30% more)
+    float bvh_spatial_splits = 0.0f;
+    // Directory of the on-disk BVH cache ("" = off): hierarchies are stored there by content
+    // hash and mapped back by later runs over the same geometry
+    std::string bvh_cache;
+    // Checkpointing (implies progressive): the pass state is saved to checkpoint_path every
+    // checkpoint_interval_ms (0 = after every pass) and once more at the end. A render
+    // started from resume_path continues exactly where that checkpoint stopped.
+    std::string checkpoint_path;
+    int checkpoint_interval_ms = 60000;
+    std::string resume_path;
+    // Crop window: only the pixels [crop_x, crop_x + crop_width) x [crop_y, crop_y + crop_height)
+    // are rendered, with the projection of the full frame. The output holds the window alone,
+    // or the full frame with everything outside it black (crop_full_frame). 0 x 0 = no crop.
+    int crop_x = 0;
+    int crop_y = 0;
+    int crop_width = 0;
+    int crop_height = 0;
+    bool crop_full_frame = false;
     std::string output_path = "output/render.png";
 };
 
@@ -47,12 +98,14 @@ struct MaterialDTO {
     float ior = 1.5f;                  // for Dielectric
 };
 
-enum class ObjectType { Sphere, Plane };
+enum class ObjectType { Sphere, Plane, Mesh };
 
 struct SphereDTO {
     Vec3f center{0, 0, 0};
     float radius = 1.f;
     std::string material_id;
+    // false ("batch": false) keeps the sphere out of the SIMD batches, an entity of its own
+    bool batch = true;
 };
 
 struct PlaneDTO {
@@ -61,10 +114,38 @@ struct PlaneDTO {
     std::string material_id;
 };
 
+// Indexed triangle mesh: three vertex indices per triangle, counter-clockwise seen from the
+// front, and optionally one normal per vertex for smooth shading. Either inline, or read
+// from a file (Wavefront .obj or binary .ply) when `file` is set.
+struct MeshDTO {
+    std::string file;  // relative paths are resolved against the scene file's directory
+    std::vector<Vec3f> vertices;
+    std::vector<Vec3f> normals;  // empty = flat shading
+    std::vector<std::uint32_t> indices;
+    std::string material_id;
+};
+
 struct ObjectDTO {
     ObjectType type = ObjectType::Sphere;
     SphereDTO sphere;  // valid if type==Sphere
     PlaneDTO plane;    // valid if type==Plane
+    MeshDTO mesh;      // valid if type==Mesh
+};
+
+// Geometry shared by instances, built once in its own object space
+struct PrototypeDTO {
+    std::vector<ObjectDTO> objects;
+};
+
+// Placement of a prototype: scale, then rotation, then translation. The material, if set,
+// replaces the prototype's own materials.
+struct InstanceDTO {
+    std::string prototype;
+    Vec3f translate{0, 0, 0};
+    Vec3f rotate_axis{0, 1, 0};
+    float rotate_deg = 0.f;
+    float scale = 1.f;
+    std::string material_id;
 };
 
 enum class LightType { Point };
@@ -84,9 +165,17 @@ struct SceneDTO {
     ImageDTO image;
     std::unordered_map<std::string, MaterialDTO> materials;  // by id
     std::vector<ObjectDTO> objects;
+    std::unordered_map<std::string, PrototypeDTO> prototypes;  // by name
+    std::vector<InstanceDTO> instances;
     std::vector<LightDTO> lights;
 };
 
+/// Where populateScene() put one of SceneDTO::objects
+struct ObjectPlacement {
+    std::size_t entity = 0;  // index into Scene::entities
+    int member = -1;         // sphere of the SphereBatch at `entity`, -1 for a shape of its own
+};
+
 class JsonSceneLoader {
    public:
     /// Parse a JSON scene file into strongly-typed DTOs.
@@ -98,8 +187,12 @@ class JsonSceneLoader {
     static SceneDTO parse_json_string(const std::string& json_text,
                                       const std::string& origin_hint = "string");
 
-    /// Populate Scene and Camera from SceneDTO
-    static void populateScene(const SceneDTO& dto, ::Scene& scene, ::Camera& camera);
+    /// Populate Scene and Camera from SceneDTO. The scene's entities are the objects in
+    /// order, except the spheres gathered into SIMD batches (SphereBatch), which follow them,
+    /// then the instances in order. Returns where each of dto.objects went, for
+    /// Scene::transform_entity().
+    static std::vector<ObjectPlacement> populateScene(const SceneDTO& dto, ::Scene& scene,
+                                                      ::Camera& camera);
 
     // Compatibility methods for old API (for tests)
     /// Legacy: Load from string and populate Scene (for tests)
@@ -0,0 +1,391 @@
+#include "io/ObjLoader.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include "io/Logger.hpp"
+#include "utils/MappedFile.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace {
+
+constexpr std::uint32_t kNoNormal = std::numeric_limits<std::uint32_t>::max();
+constexpr std::size_t kMinChunkBytes = 1 << 20;
+
+struct Chunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    // Statements counted by the first pass; their prefix sums give the chunk's offsets
+    std::size_t lines = 0, positions = 0, normals = 0, triangles = 0;
+    std::size_t first_line = 0, first_position = 0, first_normal = 0, first_triangle = 0;
+    bool corners_without_normals = false;
+    std::exception_ptr error;  // where the second pass stopped, if it did
+};
+
+bool is_blank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+const char* skip_blanks(const char* p, const char* end) {
+    while (p < end && is_blank(*p))
+        ++p;
+    return p;
+}
+
+/// Cut [data, data + size) into about `count` chunks, each ending after a newline
+std::vector<Chunk> split(const char* data, std::size_t size, std::size_t count) {
+    const std::size_t target = std::max(kMinChunkBytes, size / std::max<std::size_t>(count, 1));
+    std::vector<Chunk> chunks;
+    const char* end = data + size;
+    for (const char* p = data; p < end;) {
+        const char* q = p + std::min(target, static_cast<std::size_t>(end - p));
+        if (q < end) {
+            const void* nl = std::memchr(q, '\n', static_cast<std::size_t>(end - q));
+            q = nl ? static_cast<const char*>(nl) + 1 : end;
+        }
+        Chunk chunk;
+        chunk.begin = p;
+        chunk.end = q;
+        chunks.push_back(chunk);
+        p = q;
+    }
+    return chunks;
+}
+
+/// Call line(begin, end) for every line of the chunk, without its line break and comment
+template <typename Line>
+void for_each_line(const Chunk& chunk, Line&& line) {
+    for (const char* p = chunk.begin; p < chunk.end;) {
+        const void* nl = std::memchr(p, '\n', static_cast<std::size_t>(chunk.end - p));
+        const char* next = nl ? static_cast<const char*>(nl) : chunk.end;
+        const void* comment = std::memchr(p, '#', static_cast<std::size_t>(next - p));
+        const char* last = comment ? static_cast<const char*>(comment) : next;
+        if (last > p && last[-1] == '\r')
+            --last;
+        line(p, last);
+        p = next + 1;
+    }
+}
+
+enum class Statement { Other, Position, Normal, Face };
+
+/// Kind of the statement at `p` (past leading blanks) and the start of its arguments
+Statement classify(const char*& p, const char* end) {
+    p = skip_blanks(p, end);
+    if (end - p >= 2 && p[0] == 'v' && is_blank(p[1])) {
+        p += 2;
+        return Statement::Position;
+    }
+    if (end - p >= 3 && p[0] == 'v' && p[1] == 'n' && is_blank(p[2])) {
+        p += 3;
+        return Statement::Normal;
+    }
+    if (end - p >= 2 && p[0] == 'f' && is_blank(p[1])) {
+        p += 2;
+        return Statement::Face;
+    }
+    return Statement::Other;
+}
+
+std::size_t count_tokens(const char* p, const char* end) {
+    std::size_t tokens = 0;
+    while ((p = skip_blanks(p, end)) < end) {
+        ++tokens;
+        while (p < end && !is_blank(*p))
+            ++p;
+    }
+    return tokens;
+}
+
+/// Parse a float at `p` (after blanks); nullptr if there is none
+const char* parse_float(const char* p, const char* end, float& value) {
+    p = skip_blanks(p, end);
+    if (p < end && *p == '+')
+        ++p;
+#if defined(__cpp_lib_to_chars)
+    const auto [next, ec] = std::from_chars(p, end, value);
+    return ec == std::errc() ? next : nullptr;
+#else
+    // No floating-point from_chars in this standard library: strtof on a terminated copy
+    char token[64];
+    std::size_t n = 0;
+    while (p + n < end && !is_blank(p[n]) && n + 1 < sizeof(token)) {
+        token[n] = p[n];
+        ++n;
+    }
+    token[n] = '\0';
+    char* stop = nullptr;
+    value = std::strtof(token, &stop);
+    return stop == token ? nullptr : p + (stop - token);
+#endif
+}
+
+[[noreturn]] void fail(const std::string& origin, std::size_t line, const std::string& what) {
+    throw std::runtime_error(origin + ":" + std::to_string(line) + ": " + what);
+}
+
+/// Zero-based index of an OBJ reference (1-based, or negative from the last of `seen`
+/// elements), checked against the `total` elements of the file
+std::uint32_t resolve(long long ref, std::size_t seen, std::size_t total, const char* what,
+                      const std::string& origin, std::size_t line) {
+    long long index = ref > 0 ? ref - 1 : static_cast<long long>(seen) + ref;
+    if (ref == 0 || index < 0 || static_cast<std::size_t>(index) >= total)
+        fail(origin, line, std::string(what) + " index " + std::to_string(ref) + " out of range");
+    return static_cast<std::uint32_t>(index);
+}
+
+void run(raylabs::ThreadPool* pool, std::size_t count,
+         const std::function<void(std::size_t)>& body) {
+    if (pool) {
+        pool->parallel_for(count, body);
+        return;
+    }
+    for (std::size_t i = 0; i < count; ++i)
+        body(i);
+}
+
+/// First pass: statements per chunk
+void count(Chunk& chunk) {
+    for_each_line(chunk, [&](const char* p, const char* end) {
+        ++chunk.lines;
+        switch (classify(p, end)) {
+            case Statement::Position:
+                ++chunk.positions;
+                break;
+            case Statement::Normal:
+                ++chunk.normals;
+                break;
+            case Statement::Face: {
+                const std::size_t corners = count_tokens(p, end);
+                chunk.triangles += corners >= 3 ? corners - 2 : 0;
+            } break;
+            case Statement::Other:
+                break;
+        }
+    });
+}
+
+/// Where the second pass writes
+struct Output {
+    float* x;
+    float* y;
+    float* z;
+    float* nx;
+    float* ny;
+    float* nz;
+    std::uint32_t* indices;
+    std::uint32_t* corner_normals;  // normal of every index, nullptr if the file has none
+    std::size_t positions;
+    std::size_t normals;
+};
+
+/// Second pass: parse the chunk into its slots of `out`
+void parse_chunk(Chunk& chunk, const Output& out, const std::string& origin) {
+    std::size_t line = chunk.first_line;
+    std::size_t position = chunk.first_position;
+    std::size_t normal = chunk.first_normal;
+    std::size_t corner = 3 * chunk.first_triangle;
+    for_each_line(chunk, [&](const char* p, const char* end) {
+        ++line;
+        const Statement statement = classify(p, end);
+        switch (statement) {
+            case Statement::Position:
+            case Statement::Normal: {
+                const bool is_position = statement == Statement::Position;
+                float v[3];
+                for (float& c : v) {
+                    if (!(p = parse_float(p, end, c)))
+                        fail(origin, line, is_position ? "bad vertex" : "bad normal");
+                }
+                if (is_position) {
+                    out.x[position] = v[0];
+                    out.y[position] = v[1];
+                    out.z[position] = v[2];
+                    ++position;
+                } else {
+                    out.nx[normal] = v[0];
+                    out.ny[normal] = v[1];
+                    out.nz[normal] = v[2];
+                    ++normal;
+                }
+            } break;
+            case Statement::Face: {
+                std::uint32_t first[2] = {0, 0}, previous[2] = {0, 0};
+                std::size_t corners = 0;
+                while ((p = skip_blanks(p, end)) < end) {
+                    long long v = 0, n = 0;
+                    auto result = std::from_chars(p, end, v);
+                    if (result.ec != std::errc())
+                        fail(origin, line, "bad face corner");
+                    p = result.ptr;
+                    if (p < end && *p == '/') {
+                        ++p;
+                        while (p < end && *p != '/' && !is_blank(*p))
+                            ++p;  // texture coordinate
+                        if (p < end && *p == '/') {
+                            result = std::from_chars(p + 1, end, n);
+                            if (result.ec != std::errc())
+                                fail(origin, line, "bad face normal");
+                            p = result.ptr;
+                        }
+                    }
+                    if (p < end && !is_blank(*p))
+                        fail(origin, line, "bad face corner");
+                    const std::uint32_t here[2] = {
+                        resolve(v, position, out.positions, "vertex", origin, line),
+                        n != 0 ? resolve(n, normal, out.normals, "normal", origin, line)
+                               : kNoNormal};
+                    if (n == 0)
+                        chunk.corners_without_normals = true;
+                    // Fan around the first corner
+                    if (corners == 0) {
+                        std::copy(here, here + 2, first);
+                    } else if (corners >= 2) {
+                        const std::uint32_t* const triangle[3] = {first, previous, here};
+                        for (const std::uint32_t* c : triangle) {
+                            out.indices[corner] = c[0];
+                            if (out.corner_normals)
+                                out.corner_normals[corner] = c[1];
+                            ++corner;
+                        }
+                    }
+                    std::copy(here, here + 2, previous);
+                    ++corners;
+                }
+                if (corners < 3)
+                    fail(origin, line, "face with fewer than 3 vertices");
+            } break;
+            case Statement::Other:
+                break;
+        }
+    });
+}
+
+/// Give every vertex the normal its corners refer to, duplicating the positions used with
+/// several normals
+void assign_normals(TriangleMesh::Buffers& mesh, const std::vector<std::uint32_t>& corner_normals,
+                    const std::vector<float>& nx, const std::vector<float>& ny,
+                    const std::vector<float>& nz) {
+    std::vector<std::uint32_t> vertex_normal(mesh.vertex_count(), kNoNormal);
+    std::unordered_map<std::uint64_t, std::uint32_t> copies;  // (position, normal) -> vertex
+    std::uint32_t* indices = mesh.indices.data();
+    for (std::size_t c = 0; c < corner_normals.size(); ++c) {
+        const std::uint32_t v = indices[c];
+        const std::uint32_t n = corner_normals[c];
+        if (vertex_normal[v] == kNoNormal) {
+            vertex_normal[v] = n;
+        } else if (vertex_normal[v] != n) {
+            const std::uint64_t key = (static_cast<std::uint64_t>(v) << 32) | n;
+            auto [it, added] =
+                copies.emplace(key, static_cast<std::uint32_t>(mesh.vertex_count()));
+            if (added) {
+                mesh.x.push_back(mesh.x[v]);
+                mesh.y.push_back(mesh.y[v]);
+                mesh.z.push_back(mesh.z[v]);
+                vertex_normal.push_back(n);
+            }
+            indices[c] = it->second;
+        }
+    }
+    mesh.nx.resize(vertex_normal.size());
+    mesh.ny.resize(vertex_normal.size());
+    mesh.nz.resize(vertex_normal.size());
+    float* out[3] = {mesh.nx.data(), mesh.ny.data(), mesh.nz.data()};
+    for (std::size_t v = 0; v < vertex_normal.size(); ++v) {
+        // Vertices no face uses keep a null normal; it is never interpolated
+        const std::uint32_t n = vertex_normal[v];
+        out[0][v] = n == kNoNormal ? 0.0f : nx[n];
+        out[1][v] = n == kNoNormal ? 0.0f : ny[n];
+        out[2][v] = n == kNoNormal ? 0.0f : nz[n];
+    }
+}
+
+}  // namespace
+
+namespace io {
+
+std::shared_ptr<TriangleMesh::Buffers> ObjLoader::load_from_file(const std::string& path,
+                                                                 raylabs::ThreadPool* pool) {
+    std::size_t size = 0;
+    const std::shared_ptr<const void> file = raylabs::map_file(path, size);
+    if (!file)
+        throw std::runtime_error("Cannot open OBJ file (or empty): " + path);
+    return parse(std::string_view(static_cast<const char*>(file.get()), size), pool, path);
+}
+
+std::shared_ptr<TriangleMesh::Buffers> ObjLoader::parse(std::string_view text,
+                                                        raylabs::ThreadPool* pool,
+                                                        const std::string& origin_hint) {
+    std::vector<Chunk> chunks =
+        split(text.data(), text.size(), pool ? 8 * static_cast<std::size_t>(pool->size()) : 1);
+    run(pool, chunks.size(), [&](std::size_t i) { count(chunks[i]); });
+
+    Chunk total;
+    for (Chunk& chunk : chunks) {
+        chunk.first_line = total.lines;
+        chunk.first_position = total.positions;
+        chunk.first_normal = total.normals;
+        chunk.first_triangle = total.triangles;
+        total.lines += chunk.lines;
+        total.positions += chunk.positions;
+        total.normals += chunk.normals;
+        total.triangles += chunk.triangles;
+    }
+    if (total.positions >= kNoNormal || total.normals >= kNoNormal)
+        throw std::runtime_error("OBJ too large for 32-bit indices: " + origin_hint);
+
+    auto mesh = std::make_shared<TriangleMesh::Buffers>();
+    mesh->x.resize(total.positions);
+    mesh->y.resize(total.positions);
+    mesh->z.resize(total.positions);
+    mesh->indices.resize(3 * total.triangles);
+    std::vector<float> nx(total.normals), ny(total.normals), nz(total.normals);
+    std::vector<std::uint32_t> corner_normals(total.normals > 0 ? 3 * total.triangles : 0);
+    const Output out{mesh->x.data(),
+                     mesh->y.data(),
+                     mesh->z.data(),
+                     nx.data(),
+                     ny.data(),
+                     nz.data(),
+                     mesh->indices.data(),
+                     corner_normals.empty() ? nullptr : corner_normals.data(),
+                     total.positions,
+                     total.normals};
+    run(pool, chunks.size(), [&](std::size_t i) {
+        try {
+            parse_chunk(chunks[i], out, origin_hint);
+        } catch (const std::runtime_error&) {
+            chunks[i].error = std::current_exception();
+        }
+    });
+    // Chunks fail in any order: report the earliest line, as a serial parse would
+    for (const Chunk& chunk : chunks) {
+        if (chunk.error)
+            std::rethrow_exception(chunk.error);
+    }
+    if (total.triangles == 0)
+        throw std::runtime_error("OBJ without faces: " + origin_hint);
+
+    if (!corner_normals.empty()) {
+        const bool partial = std::any_of(chunks.begin(), chunks.end(), [](const Chunk& c) {
+            return c.corners_without_normals;
+        });
+        if (partial)
+            Logger::warn("OBJ faces without normals, using flat shading: " + origin_hint);
+        else
+            assign_normals(*mesh, corner_normals, nx, ny, nz);
+    }
+    return mesh;
+}
+
+}  // namespace io
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "entities/TriangleMesh.hpp"
+
+namespace raylabs {
+class ThreadPool;
+}
+
+namespace io {
+
+/// Wavefront OBJ importer producing the buffers of a TriangleMesh.
+/// Reads `v` positions, `vn` normals and `f` faces (v, v/vt, v//vn or v/vt/vn corners,
+/// negative indices counting back from the last vertex, polygons split into fans); texture
+/// coordinates, groups and materials are skipped. The text is cut into chunks at line
+/// boundaries and parsed on the pool in two passes: the first counts the vertices and
+/// triangles of every chunk, the second parses them straight into their place in the mesh
+/// buffers. OBJ indexes normals separately from positions: a position used with several
+/// normals is duplicated once per extra normal, and the normals are dropped (flat shading)
+/// if some faces have none.
+class ObjLoader {
+   public:
+    /// Map and parse an OBJ file. Throws std::runtime_error if it cannot be read, or with
+    /// the file and line of the first malformed statement (the lowest line among the
+    /// chunks that failed).
+    static std::shared_ptr<TriangleMesh::Buffers> load_from_file(
+        const std::string& path, raylabs::ThreadPool* pool = nullptr);
+
+    /// Parse OBJ text; `origin_hint` names it in error messages
+    static std::shared_ptr<TriangleMesh::Buffers> parse(std::string_view text,
+                                                        raylabs::ThreadPool* pool = nullptr,
+                                                        const std::string& origin_hint = "string");
+
+   private:
+    // disallow instance
+    ObjLoader() = delete;
+};
+
+}  // namespace io
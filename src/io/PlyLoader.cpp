@@ -0,0 +1,457 @@
+#include "io/PlyLoader.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "utils/MappedFile.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace {
+
+constexpr std::size_t kBlock = 1 << 16;  // vertices or faces per task
+
+enum class Type { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+std::size_t size_of(Type t) {
+    switch (t) {
+        case Type::Int8:
+        case Type::UInt8:
+            return 1;
+        case Type::Int16:
+        case Type::UInt16:
+            return 2;
+        case Type::Int32:
+        case Type::UInt32:
+        case Type::Float32:
+            return 4;
+        case Type::Float64:
+            return 8;
+    }
+    return 0;
+}
+
+bool parse_type(const std::string& s, Type& t) {
+    if (s == "char" || s == "int8")
+        t = Type::Int8;
+    else if (s == "uchar" || s == "uint8")
+        t = Type::UInt8;
+    else if (s == "short" || s == "int16")
+        t = Type::Int16;
+    else if (s == "ushort" || s == "uint16")
+        t = Type::UInt16;
+    else if (s == "int" || s == "int32")
+        t = Type::Int32;
+    else if (s == "uint" || s == "uint32")
+        t = Type::UInt32;
+    else if (s == "float" || s == "float32")
+        t = Type::Float32;
+    else if (s == "double" || s == "float64")
+        t = Type::Float64;
+    else
+        return false;
+    return true;
+}
+
+struct Property {
+    std::string name;
+    Type type = Type::Float32;
+    bool list = false;
+    Type count_type = Type::UInt8;  // lists only
+    std::size_t offset = 0;         // from the start of the item, if no property is a list
+};
+
+struct Element {
+    std::string name;
+    std::size_t count = 0;
+    std::vector<Property> properties;
+    std::size_t stride = 0;  // bytes per item, if no property is a list
+    bool has_lists = false;
+
+    const Property* find(const char* property) const {
+        for (const Property& p : properties) {
+            if (p.name == property)
+                return &p;
+        }
+        return nullptr;
+    }
+};
+
+struct Header {
+    bool swap = false;  // file byte order differs from ours
+    std::vector<Element> elements;
+    std::size_t size = 0;  // bytes before the data
+};
+
+Header parse_header(std::string_view data, const std::string& origin) {
+    auto fail = [&](const std::string& what) -> void {
+        throw std::runtime_error(origin + ": " + what);
+    };
+    const std::size_t end = data.find("end_header");
+    if (data.substr(0, 3) != "ply" || end == std::string_view::npos)
+        fail("not a PLY file");
+    const std::size_t newline = data.find('\n', end);
+    if (newline == std::string_view::npos)
+        fail("truncated header");
+
+    Header header;
+    header.size = newline + 1;
+    std::istringstream lines{std::string(data.substr(0, end))};
+    std::string line;
+    bool format = false;
+    while (std::getline(lines, line)) {
+        std::istringstream words(line);
+        std::string keyword;
+        words >> keyword;
+        if (keyword == "format") {
+            std::string kind;
+            words >> kind;
+            if (kind == "binary_little_endian")
+                header.swap = std::endian::native != std::endian::little;
+            else if (kind == "binary_big_endian")
+                header.swap = std::endian::native != std::endian::big;
+            else
+                fail("only binary PLY is supported (format " + kind + ")");
+            format = true;
+        } else if (keyword == "element") {
+            Element element;
+            words >> element.name >> element.count;
+            if (!words)
+                fail("bad element line: " + line);
+            header.elements.push_back(element);
+        } else if (keyword == "property") {
+            if (header.elements.empty())
+                fail("property before any element");
+            Element& element = header.elements.back();
+            Property property;
+            std::string type;
+            words >> type;
+            if (type == "list") {
+                std::string count_type;
+                words >> count_type >> type;
+                property.list = true;
+                if (!parse_type(count_type, property.count_type))
+                    fail("unknown PLY type " + count_type);
+                element.has_lists = true;
+            }
+            words >> property.name;
+            if (!words || !parse_type(type, property.type))
+                fail("bad property line: " + line);
+            property.offset = element.stride;
+            element.stride += size_of(property.type);
+            element.properties.push_back(property);
+        }
+    }
+    if (!format)
+        fail("missing format line");
+    return header;
+}
+
+template <typename T>
+T load(const char* p, bool swap) {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, p, sizeof(T));
+    if (swap)
+        std::reverse(bytes, bytes + sizeof(T));
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+double read_number(const char* p, Type t, bool swap) {
+    switch (t) {
+        case Type::Int8:
+            return load<std::int8_t>(p, swap);
+        case Type::UInt8:
+            return load<std::uint8_t>(p, swap);
+        case Type::Int16:
+            return load<std::int16_t>(p, swap);
+        case Type::UInt16:
+            return load<std::uint16_t>(p, swap);
+        case Type::Int32:
+            return load<std::int32_t>(p, swap);
+        case Type::UInt32:
+            return load<std::uint32_t>(p, swap);
+        case Type::Float32:
+            return load<float>(p, swap);
+        case Type::Float64:
+            return load<double>(p, swap);
+    }
+    return 0.0;
+}
+
+long long read_integer(const char* p, Type t, bool swap) {
+    switch (t) {
+        case Type::UInt32:
+            return load<std::uint32_t>(p, swap);
+        case Type::Int32:
+            return load<std::int32_t>(p, swap);
+        default:
+            return static_cast<long long>(read_number(p, t, swap));
+    }
+}
+
+void run(raylabs::ThreadPool* pool, std::size_t count,
+         const std::function<void(std::size_t)>& body) {
+    if (pool) {
+        pool->parallel_for(count, body);
+        return;
+    }
+    for (std::size_t i = 0; i < count; ++i)
+        body(i);
+}
+
+/// Bounds-checked walk over the items of an element with lists
+class Cursor {
+   public:
+    Cursor(const char* p, const char* end, const std::string& origin)
+        : p_(p), end_(end), origin_(origin) {}
+
+    const char* take(std::size_t bytes) {
+        if (static_cast<std::size_t>(end_ - p_) < bytes)
+            throw std::runtime_error(origin_ + ": truncated data");
+        const char* at = p_;
+        p_ += bytes;
+        return at;
+    }
+
+    /// Size of the next list, leaving the cursor on its first value
+    std::size_t list_size(const Property& property, bool swap) {
+        const long long n = read_integer(take(size_of(property.count_type)),
+                                         property.count_type, swap);
+        if (n < 0)
+            throw std::runtime_error(origin_ + ": negative list size");
+        return static_cast<std::size_t>(n);
+    }
+
+    void skip(const Property& property, bool swap) {
+        if (property.list)
+            take(list_size(property, swap) * size_of(property.type));
+        else
+            take(size_of(property.type));
+    }
+
+    const char* position() const { return p_; }
+
+   private:
+    const char* p_;
+    const char* end_;
+    const std::string& origin_;
+};
+
+std::uint32_t checked_index(long long index, std::size_t vertices, std::size_t face,
+                            const std::string& origin) {
+    if (index < 0 || static_cast<unsigned long long>(index) >= vertices) {
+        throw std::runtime_error(origin + ": face " + std::to_string(face) + " uses vertex " +
+                                 std::to_string(index) + " of " + std::to_string(vertices));
+    }
+    return static_cast<std::uint32_t>(index);
+}
+
+void read_vertices(const Element& element, const char* data, bool swap,
+                   TriangleMesh::Buffers& mesh, raylabs::ThreadPool* pool) {
+    const Property* coordinates[6] = {element.find("x"),  element.find("y"),
+                                      element.find("z"),  element.find("nx"),
+                                      element.find("ny"), element.find("nz")};
+    const bool normals = coordinates[3] && coordinates[4] && coordinates[5];
+    const int used = normals ? 6 : 3;
+    raylabs::FlatArray<float>* arrays[6] = {&mesh.x, &mesh.y, &mesh.z,
+                                            &mesh.nx, &mesh.ny, &mesh.nz};
+    float* out[6] = {};
+    for (int c = 0; c < used; ++c) {
+        arrays[c]->resize(element.count);
+        out[c] = arrays[c]->data();
+    }
+    bool fast = !swap;
+    for (int c = 0; c < used; ++c)
+        fast = fast && coordinates[c]->type == Type::Float32;
+
+    const std::size_t stride = element.stride;
+    run(pool, (element.count + kBlock - 1) / kBlock, [&](std::size_t block) {
+        const std::size_t first = block * kBlock;
+        const std::size_t last = std::min(element.count, first + kBlock);
+        for (int c = 0; c < used; ++c) {
+            const char* p = data + coordinates[c]->offset;
+            float* o = out[c];
+            if (fast) {
+                for (std::size_t i = first; i < last; ++i)
+                    std::memcpy(o + i, p + i * stride, sizeof(float));
+            } else {
+                const Type type = coordinates[c]->type;
+                for (std::size_t i = first; i < last; ++i)
+                    o[i] = static_cast<float>(read_number(p + i * stride, type, swap));
+            }
+        }
+    });
+}
+
+/// Faces that are all triangles, in blocks on the pool. Returns false, leaving `mesh.indices`
+/// to the caller, as soon as a face of another size shows up. Blocks read their faces at
+/// offsets that only hold for triangles, so an index out of range is reported once every
+/// block has seen nothing but triangles.
+bool read_triangles(const Element& element, const Property& list, const char* data,
+                    const char* end, bool swap, TriangleMesh::Buffers& mesh,
+                    raylabs::ThreadPool* pool, const std::string& origin) {
+    const std::size_t count_size = size_of(list.count_type);
+    const std::size_t index_size = size_of(list.type);
+    const std::size_t stride = count_size + 3 * index_size;
+    if (element.properties.size() != 1 ||
+        static_cast<std::size_t>(end - data) / stride < element.count) {
+        return false;
+    }
+    mesh.indices.resize(3 * element.count);
+    std::uint32_t* indices = mesh.indices.data();
+    const std::size_t vertices = mesh.vertex_count();
+    const bool fast = !swap && (list.type == Type::Int32 || list.type == Type::UInt32);
+    const std::size_t blocks = (element.count + kBlock - 1) / kBlock;
+    // First face of each block with an index out of range, element.count if none
+    std::vector<std::size_t> bad_faces(blocks, element.count);
+    std::atomic<bool> triangles{true};
+    run(pool, blocks, [&](std::size_t block) {
+        const std::size_t first = block * kBlock;
+        const std::size_t last = std::min(element.count, first + kBlock);
+        std::size_t& bad_face = bad_faces[block];
+        for (std::size_t f = first; f < last && triangles.load(std::memory_order_relaxed); ++f) {
+            const char* p = data + f * stride;
+            if (read_integer(p, list.count_type, swap) != 3) {
+                triangles = false;
+                return;
+            }
+            p += count_size;
+            std::uint32_t* out = indices + 3 * f;
+            if (fast) {
+                std::memcpy(out, p, 3 * sizeof(std::uint32_t));
+                // Negative int32 indices wrap to huge values and fail here too
+                if (bad_face == element.count &&
+                    (out[0] >= vertices || out[1] >= vertices || out[2] >= vertices)) {
+                    bad_face = f;
+                }
+            } else {
+                for (std::size_t k = 0; k < 3; ++k) {
+                    const long long index = read_integer(p + k * index_size, list.type, swap);
+                    if (index < 0 || static_cast<unsigned long long>(index) >= vertices) {
+                        bad_face = std::min(bad_face, f);
+                        continue;
+                    }
+                    out[k] = static_cast<std::uint32_t>(index);
+                }
+            }
+        }
+    });
+    if (!triangles)
+        return false;
+    for (std::size_t f : bad_faces) {
+        if (f == element.count)
+            continue;
+        const char* p = data + f * stride + count_size;
+        for (std::size_t k = 0; k < 3; ++k)
+            checked_index(read_integer(p + k * index_size, list.type, swap), vertices, f, origin);
+    }
+    return true;
+}
+
+/// Any faces: serial walk, polygons split into fans around their first vertex
+void read_polygons(const Element& element, const Property& list, Cursor& cursor, bool swap,
+                   TriangleMesh::Buffers& mesh, const std::string& origin) {
+    std::vector<std::uint32_t> indices;
+    indices.reserve(3 * element.count);
+    const std::size_t vertices = mesh.vertex_count();
+    const std::size_t index_size = size_of(list.type);
+    for (std::size_t f = 0; f < element.count; ++f) {
+        for (const Property& property : element.properties) {
+            if (&property != &list) {
+                cursor.skip(property, swap);
+                continue;
+            }
+            const std::size_t n = cursor.list_size(property, swap);
+            const char* p = cursor.take(n * index_size);
+            auto index = [&](std::size_t k) {
+                return checked_index(read_integer(p + k * index_size, list.type, swap), vertices,
+                                     f, origin);
+            };
+            for (std::size_t k = 2; k < n; ++k) {
+                indices.push_back(index(0));
+                indices.push_back(index(k - 1));
+                indices.push_back(index(k));
+            }
+        }
+    }
+    mesh.indices = std::move(indices);
+}
+
+}  // namespace
+
+namespace io {
+
+std::shared_ptr<TriangleMesh::Buffers> PlyLoader::load_from_file(const std::string& path,
+                                                                 raylabs::ThreadPool* pool) {
+    std::size_t size = 0;
+    const std::shared_ptr<const void> file = raylabs::map_file(path, size);
+    if (!file)
+        throw std::runtime_error("Cannot open PLY file (or empty): " + path);
+    return parse(std::string_view(static_cast<const char*>(file.get()), size), pool, path);
+}
+
+std::shared_ptr<TriangleMesh::Buffers> PlyLoader::parse(std::string_view data,
+                                                        raylabs::ThreadPool* pool,
+                                                        const std::string& origin_hint) {
+    const Header header = parse_header(data, origin_hint);
+    const char* end = data.data() + data.size();
+    auto mesh = std::make_shared<TriangleMesh::Buffers>();
+
+    // Elements are stored one after the other: walk them to find "vertex" and "face"
+    Cursor cursor(data.data() + header.size, end, origin_hint);
+    bool have_vertices = false, have_faces = false;
+    for (const Element& element : header.elements) {
+        if (element.name == "vertex") {
+            if (element.has_lists)
+                throw std::runtime_error(origin_hint + ": list properties on vertices");
+            if (!element.find("x") || !element.find("y") || !element.find("z"))
+                throw std::runtime_error(origin_hint + ": vertices without x, y, z");
+            if (element.count >= std::numeric_limits<std::uint32_t>::max())
+                throw std::runtime_error(origin_hint + ": too many vertices for 32-bit indices");
+            const char* vertices = cursor.take(element.count * element.stride);
+            read_vertices(element, vertices, header.swap, *mesh, pool);
+            have_vertices = true;
+        } else if (element.name == "face") {
+            if (!have_vertices)
+                throw std::runtime_error(origin_hint + ": faces before vertices");
+            const Property* list = element.find("vertex_indices");
+            if (!list)
+                list = element.find("vertex_index");
+            if (!list || !list->list)
+                throw std::runtime_error(origin_hint + ": faces without a vertex_indices list");
+            const char* faces = cursor.position();
+            if (read_triangles(element, *list, faces, end, header.swap, *mesh, pool,
+                               origin_hint)) {
+                cursor.take(element.count * (size_of(list->count_type) +
+                                             3 * size_of(list->type)));
+            } else {
+                read_polygons(element, *list, cursor, header.swap, *mesh, origin_hint);
+            }
+            have_faces = true;
+        } else if (element.has_lists) {
+            for (std::size_t i = 0; i < element.count; ++i) {
+                for (const Property& property : element.properties)
+                    cursor.skip(property, header.swap);
+            }
+        } else {
+            cursor.take(element.count * element.stride);
+        }
+        if (have_vertices && have_faces)
+            break;
+    }
+    if (!have_faces || mesh->indices.empty())
+        throw std::runtime_error(origin_hint + ": PLY without faces");
+    return mesh;
+}
+
+}  // namespace io
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "entities/TriangleMesh.hpp"
+
+namespace raylabs {
+class ThreadPool;
+}
+
+namespace io {
+
+/// Binary PLY importer (little- or big-endian) producing the buffers of a TriangleMesh.
+/// Reads the x, y, z and optional nx, ny, nz properties of the "vertex" element, of any
+/// scalar type, and the "vertex_indices" (or "vertex_index") list of the "face" element;
+/// polygons are split into fans and every other element is skipped.
+/// The file is mapped and converted in one pass straight into the mesh buffers, on the pool
+/// in blocks of vertices and faces. The common scanner layout (float coordinates, faces
+/// that are all triangles with 32-bit indices, native byte order) takes a fast path of
+/// plain strided copies; any other layout is converted value by value, and faces of
+/// varying sizes are read serially.
+/// The vertices cannot be borrowed from the file as they are: PLY interleaves the
+/// properties of a vertex where the mesh keeps one array per coordinate.
+class PlyLoader {
+   public:
+    /// Map and convert a PLY file. Throws std::runtime_error if it cannot be read, is not
+    /// binary PLY, lacks positions or faces, is truncated or has an index out of range.
+    static std::shared_ptr<TriangleMesh::Buffers> load_from_file(
+        const std::string& path, raylabs::ThreadPool* pool = nullptr);
+
+    /// Convert PLY data held in memory; `origin_hint` names it in error messages
+    static std::shared_ptr<TriangleMesh::Buffers> parse(std::string_view data,
+                                                        raylabs::ThreadPool* pool = nullptr,
+                                                        const std::string& origin_hint = "data");
+
+   private:
+    // disallow instance
+    PlyLoader() = delete;
+};
+
+}  // namespace io
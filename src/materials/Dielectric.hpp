@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cmath>
+#include "core/Sampler.hpp"
 #include "materials/Material.hpp"
 #include "math/Color.hpp"
 #include "math/Vec3.hpp"
@@ -51,11 +52,5 @@ class Dielectric : public Material {
         return r0 + (1.0f - r0) * powf((1.0f - cosine), 5.0f);
     }
 
-    static float random_float() {
-        static thread_local unsigned int seed = 11111;
-        seed = seed * 1103515245 + 12345;
-        seed = (seed << 13) ^ seed;
-        seed = (seed * (seed * seed * 15731 + 789221) + 1376312589);
-        return (seed & 0x7FFFFFFF) / 2147483647.0f;
-    }
+    static float random_float() { return raylabs::Sampler::random_float(); }
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cmath>
+#include "core/Sampler.hpp"
 #include "materials/Material.hpp"
 #include "math/Color.hpp"
 #include "math/Vec3.hpp"
@@ -26,6 +27,8 @@ class Lambertian : public Material {
         return true;
     }
 
+    Color diffuse([[maybe_unused]] const HitRecord& rec) const override { return albedo; }
+
    private:
     static Vec3 random_unit_vector() {
         while (true) {
@@ -37,11 +40,6 @@ class Lambertian : public Material {
     }
 
     static float random_float(float min, float max) {
-        static thread_local unsigned int seed = 12345;
-        seed = seed * 1103515245 + 12345;
-        seed = (seed << 13) ^ seed;
-        seed = (seed * (seed * seed * 15731 + 789221) + 1376312589);
-        float normalized = (seed & 0x7FFFFFFF) / 2147483647.0f;
-        return min + normalized * (max - min);
+        return raylabs::Sampler::random_float(min, max);
     }
 };
@@ -10,4 +10,8 @@ class Material {
 
     virtual bool scatter(const Ray& ray_in, const HitRecord& rec, Color& attenuation,
                          Ray& scattered) const = 0;
+
+    /// Lambertian reflectance lit directly by the scene's point lights (see
+    /// Integrator::direct_lighting()); black for materials that only scatter specularly
+    virtual Color diffuse([[maybe_unused]] const HitRecord& rec) const { return Color(0, 0, 0); }
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cmath>
+#include "core/Sampler.hpp"
 #include "materials/Material.hpp"
 #include "math/Color.hpp"
 #include "math/Vec3.hpp"
@@ -47,11 +48,6 @@ class Metal : public Material {
     }
 
     static float random_float(float min, float max) {
-        static thread_local unsigned int seed = 54321;
-        seed = seed * 1103515245 + 12345;
-        seed = (seed << 13) ^ seed;
-        seed = (seed * (seed * seed * 15731 + 789221) + 1376312589);
-        float normalized = (seed & 0x7FFFFFFF) / 2147483647.0f;
-        return min + normalized * (max - min);
+        return raylabs::Sampler::random_float(min, max);
     }
 };
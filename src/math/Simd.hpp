@@ -0,0 +1,521 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define RAYLABS_SIMD_SSE 1
+#endif
+#if defined(__AVX__)
+#define RAYLABS_SIMD_AVX 1
+#endif
+#if defined(__AVX512F__)
+#define RAYLABS_SIMD_AVX512 1
+#endif
+
+// Thin N-wide float/mask types for packet and SoA kernels.
+// - vfloat<4> maps to SSE, vfloat<8> to AVX and vfloat<16> to AVX-512 when the compiler
+//   targets them (configure with -DRAYLABS_ENABLE_AVX2=ON or -DRAYLABS_ENABLE_AVX512=ON),
+//   every other width (and every width on other architectures) uses plain lane loops that
+//   the optimizer can auto-vectorize.
+// - Masks are lane-wise booleans produced by comparisons and consumed by select()/any().
+namespace raylabs::simd {
+
+/// Widest vfloat backed by one register on the targeted instruction set
+#if defined(RAYLABS_SIMD_AVX512)
+inline constexpr int kNativeWidth = 16;
+#elif defined(RAYLABS_SIMD_AVX)
+inline constexpr int kNativeWidth = 8;
+#else
+inline constexpr int kNativeWidth = 4;
+#endif
+
+// ------------------------ generic (loop) implementation -----------------------
+
+template <int N>
+struct vmask {
+    bool m[N];
+
+    vmask() = default;
+    explicit vmask(bool b) {
+        for (int i = 0; i < N; ++i)
+            m[i] = b;
+    }
+
+    /// Lane i set when bit i of b is set
+    static vmask from_bits(std::uint32_t b) {
+        vmask r;
+        for (int i = 0; i < N; ++i)
+            r.m[i] = i < 32 && ((b >> i) & 1u);
+        return r;
+    }
+
+    bool operator[](int i) const { return m[i]; }
+
+    friend vmask operator&(const vmask& a, const vmask& b) {
+        vmask r;
+        for (int i = 0; i < N; ++i)
+            r.m[i] = a.m[i] && b.m[i];
+        return r;
+    }
+    friend vmask operator|(const vmask& a, const vmask& b) {
+        vmask r;
+        for (int i = 0; i < N; ++i)
+            r.m[i] = a.m[i] || b.m[i];
+        return r;
+    }
+    friend vmask operator!(const vmask& a) {
+        vmask r;
+        for (int i = 0; i < N; ++i)
+            r.m[i] = !a.m[i];
+        return r;
+    }
+
+    /// Bit i set when lane i is set (lanes >= 32 are not represented)
+    std::uint32_t bits() const {
+        std::uint32_t b = 0;
+        for (int i = 0; i < N && i < 32; ++i)
+            b |= static_cast<std::uint32_t>(m[i]) << i;
+        return b;
+    }
+};
+
+template <int N>
+struct vfloat {
+    alignas(N * sizeof(float) > 64 ? 64 : N * sizeof(float)) float v[N];
+
+    vfloat() = default;
+    vfloat(float s) {  // NOLINT(google-explicit-constructor): broadcast
+        for (int i = 0; i < N; ++i)
+            v[i] = s;
+    }
+
+    static vfloat load(const float* p) {
+        vfloat r;
+        std::memcpy(r.v, p, sizeof(r.v));
+        return r;
+    }
+    /// N bytes widened to floats (quantized boxes)
+    static vfloat load_u8(const std::uint8_t* p) {
+        vfloat r;
+        for (int i = 0; i < N; ++i)
+            r.v[i] = static_cast<float>(p[i]);
+        return r;
+    }
+    void store(float* p) const { std::memcpy(p, v, sizeof(v)); }
+
+    float operator[](int i) const { return v[i]; }
+    void set(int i, float s) { v[i] = s; }
+
+#define RAYLABS_SIMD_BINOP(op)                                \
+    friend vfloat operator op(const vfloat& a, const vfloat& b) { \
+        vfloat r;                                             \
+        for (int i = 0; i < N; ++i)                           \
+            r.v[i] = a.v[i] op b.v[i];                        \
+        return r;                                             \
+    }
+    RAYLABS_SIMD_BINOP(+)
+    RAYLABS_SIMD_BINOP(-)
+    RAYLABS_SIMD_BINOP(*)
+    RAYLABS_SIMD_BINOP(/)
+#undef RAYLABS_SIMD_BINOP
+
+#define RAYLABS_SIMD_CMP(op)                                     \
+    friend vmask<N> operator op(const vfloat& a, const vfloat& b) { \
+        vmask<N> r;                                              \
+        for (int i = 0; i < N; ++i)                              \
+            r.m[i] = a.v[i] op b.v[i];                           \
+        return r;                                                \
+    }
+    RAYLABS_SIMD_CMP(<)
+    RAYLABS_SIMD_CMP(<=)
+    RAYLABS_SIMD_CMP(>)
+    RAYLABS_SIMD_CMP(>=)
+#undef RAYLABS_SIMD_CMP
+
+    friend vfloat operator-(const vfloat& a) {
+        vfloat r;
+        for (int i = 0; i < N; ++i)
+            r.v[i] = -a.v[i];
+        return r;
+    }
+    friend vfloat min(const vfloat& a, const vfloat& b) {
+        vfloat r;
+        for (int i = 0; i < N; ++i)
+            r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+        return r;
+    }
+    friend vfloat max(const vfloat& a, const vfloat& b) {
+        vfloat r;
+        for (int i = 0; i < N; ++i)
+            r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+        return r;
+    }
+    friend vfloat abs(const vfloat& a) {
+        vfloat r;
+        for (int i = 0; i < N; ++i)
+            r.v[i] = std::fabs(a.v[i]);
+        return r;
+    }
+    friend vfloat sqrt(const vfloat& a) {
+        vfloat r;
+        for (int i = 0; i < N; ++i)
+            r.v[i] = std::sqrt(a.v[i]);
+        return r;
+    }
+    /// Lane-wise m ? a : b
+    friend vfloat select(const vmask<N>& m, const vfloat& a, const vfloat& b) {
+        vfloat r;
+        for (int i = 0; i < N; ++i)
+            r.v[i] = m.m[i] ? a.v[i] : b.v[i];
+        return r;
+    }
+};
+
+template <int N>
+inline bool any(const vmask<N>& m) {
+    for (int i = 0; i < N; ++i)
+        if (m.m[i])
+            return true;
+    return false;
+}
+
+template <int N>
+inline bool all(const vmask<N>& m) {
+    for (int i = 0; i < N; ++i)
+        if (!m.m[i])
+            return false;
+    return true;
+}
+
+// ------------------------ SSE: 4 lanes ----------------------------------------
+
+#if defined(RAYLABS_SIMD_SSE)
+
+template <>
+struct vmask<4> {
+    __m128 m;
+
+    vmask() = default;
+    explicit vmask(__m128 x) : m(x) {}
+    explicit vmask(bool b) : m(_mm_castsi128_ps(_mm_set1_epi32(b ? -1 : 0))) {}
+
+    static vmask from_bits(std::uint32_t b) {
+        const __m128i lane_bits = _mm_set_epi32(8, 4, 2, 1);
+        const __m128i sel = _mm_and_si128(_mm_set1_epi32(static_cast<int>(b)), lane_bits);
+        return vmask(_mm_castsi128_ps(_mm_cmpeq_epi32(sel, lane_bits)));
+    }
+
+    bool operator[](int i) const { return (bits() >> i) & 1u; }
+    std::uint32_t bits() const { return static_cast<std::uint32_t>(_mm_movemask_ps(m)); }
+
+    friend vmask operator&(const vmask& a, const vmask& b) { return vmask(_mm_and_ps(a.m, b.m)); }
+    friend vmask operator|(const vmask& a, const vmask& b) { return vmask(_mm_or_ps(a.m, b.m)); }
+    friend vmask operator!(const vmask& a) {
+        return vmask(_mm_xor_ps(a.m, _mm_castsi128_ps(_mm_set1_epi32(-1))));
+    }
+};
+
+template <>
+struct vfloat<4> {
+    __m128 v;
+
+    vfloat() = default;
+    explicit vfloat(__m128 x) : v(x) {}
+    vfloat(float s) : v(_mm_set1_ps(s)) {}  // NOLINT(google-explicit-constructor): broadcast
+
+    static vfloat load(const float* p) { return vfloat(_mm_loadu_ps(p)); }
+    static vfloat load_u8(const std::uint8_t* p) {
+        std::int32_t packed;
+        std::memcpy(&packed, p, sizeof(packed));
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i bytes = _mm_cvtsi32_si128(packed);
+        const __m128i words = _mm_unpacklo_epi8(bytes, zero);
+        return vfloat(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero)));
+    }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+
+    float operator[](int i) const {
+        alignas(16) float tmp[4];
+        _mm_store_ps(tmp, v);
+        return tmp[i];
+    }
+    void set(int i, float s) {
+        alignas(16) float tmp[4];
+        _mm_store_ps(tmp, v);
+        tmp[i] = s;
+        v = _mm_load_ps(tmp);
+    }
+
+    friend vfloat operator+(const vfloat& a, const vfloat& b) {
+        return vfloat(_mm_add_ps(a.v, b.v));
+    }
+    friend vfloat operator-(const vfloat& a, const vfloat& b) {
+        return vfloat(_mm_sub_ps(a.v, b.v));
+    }
+    friend vfloat operator*(const vfloat& a, const vfloat& b) {
+        return vfloat(_mm_mul_ps(a.v, b.v));
+    }
+    friend vfloat operator/(const vfloat& a, const vfloat& b) {
+        return vfloat(_mm_div_ps(a.v, b.v));
+    }
+    friend vmask<4> operator<(const vfloat& a, const vfloat& b) {
+        return vmask<4>(_mm_cmplt_ps(a.v, b.v));
+    }
+    friend vmask<4> operator<=(const vfloat& a, const vfloat& b) {
+        return vmask<4>(_mm_cmple_ps(a.v, b.v));
+    }
+    friend vmask<4> operator>(const vfloat& a, const vfloat& b) {
+        return vmask<4>(_mm_cmpgt_ps(a.v, b.v));
+    }
+    friend vmask<4> operator>=(const vfloat& a, const vfloat& b) {
+        return vmask<4>(_mm_cmpge_ps(a.v, b.v));
+    }
+    friend vfloat operator-(const vfloat& a) { return vfloat(_mm_xor_ps(a.v, _mm_set1_ps(-0.0f))); }
+    friend vfloat min(const vfloat& a, const vfloat& b) { return vfloat(_mm_min_ps(a.v, b.v)); }
+    friend vfloat max(const vfloat& a, const vfloat& b) { return vfloat(_mm_max_ps(a.v, b.v)); }
+    friend vfloat abs(const vfloat& a) { return vfloat(_mm_andnot_ps(_mm_set1_ps(-0.0f), a.v)); }
+    friend vfloat sqrt(const vfloat& a) { return vfloat(_mm_sqrt_ps(a.v)); }
+    friend vfloat select(const vmask<4>& m, const vfloat& a, const vfloat& b) {
+        return vfloat(_mm_or_ps(_mm_and_ps(m.m, a.v), _mm_andnot_ps(m.m, b.v)));
+    }
+};
+
+template <>
+inline bool any(const vmask<4>& m) {
+    return _mm_movemask_ps(m.m) != 0;
+}
+
+template <>
+inline bool all(const vmask<4>& m) {
+    return _mm_movemask_ps(m.m) == 0xF;
+}
+
+#endif  // RAYLABS_SIMD_SSE
+
+// ------------------------ AVX: 8 lanes ----------------------------------------
+
+#if defined(RAYLABS_SIMD_AVX)
+
+template <>
+struct vmask<8> {
+    __m256 m;
+
+    vmask() = default;
+    explicit vmask(__m256 x) : m(x) {}
+    explicit vmask(bool b) : m(_mm256_castsi256_ps(_mm256_set1_epi32(b ? -1 : 0))) {}
+
+    static vmask from_bits(std::uint32_t b) {
+        alignas(32) std::int32_t lanes[8];
+        for (int i = 0; i < 8; ++i)
+            lanes[i] = ((b >> i) & 1u) ? -1 : 0;
+        const __m256i m = _mm256_load_si256(reinterpret_cast<const __m256i*>(lanes));
+        return vmask(_mm256_castsi256_ps(m));
+    }
+
+    bool operator[](int i) const { return (bits() >> i) & 1u; }
+    std::uint32_t bits() const { return static_cast<std::uint32_t>(_mm256_movemask_ps(m)); }
+
+    friend vmask operator&(const vmask& a, const vmask& b) {
+        return vmask(_mm256_and_ps(a.m, b.m));
+    }
+    friend vmask operator|(const vmask& a, const vmask& b) { return vmask(_mm256_or_ps(a.m, b.m)); }
+    friend vmask operator!(const vmask& a) {
+        return vmask(_mm256_xor_ps(a.m, _mm256_castsi256_ps(_mm256_set1_epi32(-1))));
+    }
+};
+
+template <>
+struct vfloat<8> {
+    __m256 v;
+
+    vfloat() = default;
+    explicit vfloat(__m256 x) : v(x) {}
+    vfloat(float s) : v(_mm256_set1_ps(s)) {}  // NOLINT(google-explicit-constructor): broadcast
+
+    static vfloat load(const float* p) { return vfloat(_mm256_loadu_ps(p)); }
+    static vfloat load_u8(const std::uint8_t* p) {
+        // Widened in two SSE halves: 256-bit integer ops need AVX2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        const __m128i words = _mm_unpacklo_epi8(bytes, zero);
+        const __m128 lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero));
+        const __m128 hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(words, zero));
+        return vfloat(_mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1));
+    }
+    void store(float* p) const { _mm256_storeu_ps(p, v); }
+
+    float operator[](int i) const {
+        alignas(32) float tmp[8];
+        _mm256_store_ps(tmp, v);
+        return tmp[i];
+    }
+    void set(int i, float s) {
+        alignas(32) float tmp[8];
+        _mm256_store_ps(tmp, v);
+        tmp[i] = s;
+        v = _mm256_load_ps(tmp);
+    }
+
+    friend vfloat operator+(const vfloat& a, const vfloat& b) {
+        return vfloat(_mm256_add_ps(a.v, b.v));
+    }
+    friend vfloat operator-(const vfloat& a, const vfloat& b) {
+        return vfloat(_mm256_sub_ps(a.v, b.v));
+    }
+    friend vfloat operator*(const vfloat& a, const vfloat& b) {
+        return vfloat(_mm256_mul_ps(a.v, b.v));
+    }
+    friend vfloat operator/(const vfloat& a, const vfloat& b) {
+        return vfloat(_mm256_div_ps(a.v, b.v));
+    }
+    friend vmask<8> operator<(const vfloat& a, const vfloat& b) {
+        return vmask<8>(_mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ));
+    }
+    friend vmask<8> operator<=(const vfloat& a, const vfloat& b) {
+        return vmask<8>(_mm256_cmp_ps(a.v, b.v, _CMP_LE_OQ));
+    }
+    friend vmask<8> operator>(const vfloat& a, const vfloat& b) {
+        return vmask<8>(_mm256_cmp_ps(a.v, b.v, _CMP_GT_OQ));
+    }
+    friend vmask<8> operator>=(const vfloat& a, const vfloat& b) {
+        return vmask<8>(_mm256_cmp_ps(a.v, b.v, _CMP_GE_OQ));
+    }
+    friend vfloat operator-(const vfloat& a) {
+        return vfloat(_mm256_xor_ps(a.v, _mm256_set1_ps(-0.0f)));
+    }
+    friend vfloat min(const vfloat& a, const vfloat& b) { return vfloat(_mm256_min_ps(a.v, b.v)); }
+    friend vfloat max(const vfloat& a, const vfloat& b) { return vfloat(_mm256_max_ps(a.v, b.v)); }
+    friend vfloat abs(const vfloat& a) {
+        return vfloat(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v));
+    }
+    friend vfloat sqrt(const vfloat& a) { return vfloat(_mm256_sqrt_ps(a.v)); }
+    friend vfloat select(const vmask<8>& m, const vfloat& a, const vfloat& b) {
+        return vfloat(_mm256_blendv_ps(b.v, a.v, m.m));
+    }
+};
+
+template <>
+inline bool any(const vmask<8>& m) {
+    return _mm256_movemask_ps(m.m) != 0;
+}
+
+template <>
+inline bool all(const vmask<8>& m) {
+    return _mm256_movemask_ps(m.m) == 0xFF;
+}
+
+#endif  // RAYLABS_SIMD_AVX
+
+// ------------------------ AVX-512: 16 lanes -----------------------------------
+
+#if defined(RAYLABS_SIMD_AVX512)
+
+template <>
+struct vmask<16> {
+    __mmask16 m;
+
+    vmask() = default;
+    explicit vmask(__mmask16 x) : m(x) {}
+    explicit vmask(bool b) : m(static_cast<__mmask16>(b ? 0xFFFF : 0)) {}
+
+    static vmask from_bits(std::uint32_t b) { return vmask(static_cast<__mmask16>(b & 0xFFFF)); }
+
+    bool operator[](int i) const { return (bits() >> i) & 1u; }
+    std::uint32_t bits() const { return m; }
+
+    friend vmask operator&(const vmask& a, const vmask& b) {
+        return vmask(static_cast<__mmask16>(a.m & b.m));
+    }
+    friend vmask operator|(const vmask& a, const vmask& b) {
+        return vmask(static_cast<__mmask16>(a.m | b.m));
+    }
+    friend vmask operator!(const vmask& a) { return vmask(static_cast<__mmask16>(~a.m)); }
+};
+
+template <>
+struct vfloat<16> {
+    __m512 v;
+
+    vfloat() = default;
+    explicit vfloat(__m512 x) : v(x) {}
+    vfloat(float s) : v(_mm512_set1_ps(s)) {}  // NOLINT(google-explicit-constructor): broadcast
+
+    static vfloat load(const float* p) { return vfloat(_mm512_loadu_ps(p)); }
+    static vfloat load_u8(const std::uint8_t* p) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        return vfloat(_mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(bytes)));
+    }
+    void store(float* p) const { _mm512_storeu_ps(p, v); }
+
+    float operator[](int i) const {
+        alignas(64) float tmp[16];
+        _mm512_store_ps(tmp, v);
+        return tmp[i];
+    }
+    void set(int i, float s) {
+        alignas(64) float tmp[16];
+        _mm512_store_ps(tmp, v);
+        tmp[i] = s;
+        v = _mm512_load_ps(tmp);
+    }
+
+    friend vfloat operator+(const vfloat& a, const vfloat& b) {
+        return vfloat(_mm512_add_ps(a.v, b.v));
+    }
+    friend vfloat operator-(const vfloat& a, const vfloat& b) {
+        return vfloat(_mm512_sub_ps(a.v, b.v));
+    }
+    friend vfloat operator*(const vfloat& a, const vfloat& b) {
+        return vfloat(_mm512_mul_ps(a.v, b.v));
+    }
+    friend vfloat operator/(const vfloat& a, const vfloat& b) {
+        return vfloat(_mm512_div_ps(a.v, b.v));
+    }
+    friend vmask<16> operator<(const vfloat& a, const vfloat& b) {
+        return vmask<16>(_mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ));
+    }
+    friend vmask<16> operator<=(const vfloat& a, const vfloat& b) {
+        return vmask<16>(_mm512_cmp_ps_mask(a.v, b.v, _CMP_LE_OQ));
+    }
+    friend vmask<16> operator>(const vfloat& a, const vfloat& b) {
+        return vmask<16>(_mm512_cmp_ps_mask(a.v, b.v, _CMP_GT_OQ));
+    }
+    friend vmask<16> operator>=(const vfloat& a, const vfloat& b) {
+        return vmask<16>(_mm512_cmp_ps_mask(a.v, b.v, _CMP_GE_OQ));
+    }
+    friend vfloat operator-(const vfloat& a) {
+        // Sign flip with integer ops: the float ones need AVX-512DQ
+        const __m512i sign = _mm512_set1_epi32(static_cast<int>(0x80000000u));
+        return vfloat(_mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a.v), sign)));
+    }
+    // The all-lanes mask forms: GCC 12 reports the unmasked ones' _mm512_undefined_ps()
+    // as uninitialized (same instruction either way)
+    friend vfloat min(const vfloat& a, const vfloat& b) {
+        return vfloat(_mm512_mask_min_ps(a.v, 0xFFFF, a.v, b.v));
+    }
+    friend vfloat max(const vfloat& a, const vfloat& b) {
+        return vfloat(_mm512_mask_max_ps(a.v, 0xFFFF, a.v, b.v));
+    }
+    friend vfloat abs(const vfloat& a) { return vfloat(_mm512_abs_ps(a.v)); }
+    friend vfloat sqrt(const vfloat& a) { return vfloat(_mm512_mask_sqrt_ps(a.v, 0xFFFF, a.v)); }
+    friend vfloat select(const vmask<16>& m, const vfloat& a, const vfloat& b) {
+        return vfloat(_mm512_mask_blend_ps(m.m, b.v, a.v));
+    }
+};
+
+template <>
+inline bool any(const vmask<16>& m) {
+    return m.m != 0;
+}
+
+template <>
+inline bool all(const vmask<16>& m) {
+    return m.m == 0xFFFF;
+}
+
+#endif  // RAYLABS_SIMD_AVX512
+
+}  // namespace raylabs::simd
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cmath>
+
+#include "math/Vec3.hpp"
+
+namespace raylabs {
+
+/// Similarity transform p -> scale * R p + translation (rotation, uniform scale, then
+/// translation). Every shape stays the same kind of shape under it, spheres included.
+struct Transform {
+    Vec3 r0{1, 0, 0};  // rows of the rotation R
+    Vec3 r1{0, 1, 0};
+    Vec3 r2{0, 0, 1};
+    float scale = 1.0f;
+    Vec3 translation{0, 0, 0};
+
+    static Transform translate(const Vec3& offset) {
+        Transform t;
+        t.translation = offset;
+        return t;
+    }
+
+    static Transform uniform_scale(float s) {
+        Transform t;
+        t.scale = s;
+        return t;
+    }
+
+    /// Rotation of `radians` around `axis` (right-handed), through the origin
+    static Transform rotate(const Vec3& axis, float radians) {
+        const Vec3 a = normalize(axis);
+        const float c = std::cos(radians);
+        const float s = std::sin(radians);
+        const float k = 1.0f - c;
+        Transform t;
+        t.r0 = Vec3(c + a.x * a.x * k, a.x * a.y * k - a.z * s, a.x * a.z * k + a.y * s);
+        t.r1 = Vec3(a.y * a.x * k + a.z * s, c + a.y * a.y * k, a.y * a.z * k - a.x * s);
+        t.r2 = Vec3(a.z * a.x * k - a.y * s, a.z * a.y * k + a.x * s, c + a.z * a.z * k);
+        return t;
+    }
+
+    /// Rotation around the axis through `pivot` (e.g. a turntable)
+    static Transform rotate_about(const Point3& pivot, const Vec3& axis, float radians) {
+        return translate(pivot) * rotate(axis, radians) * translate(-pivot);
+    }
+
+    /// R v (for normals: R is orthonormal and the scale is uniform)
+    Vec3 rotate_vector(const Vec3& v) const { return Vec3(dot(r0, v), dot(r1, v), dot(r2, v)); }
+    Vec3 vector(const Vec3& v) const { return scale * rotate_vector(v); }
+    Point3 point(const Point3& p) const { return vector(p) + translation; }
+
+    /// p -> R^T (p - translation) / scale
+    Transform inverse() const {
+        Transform t;
+        t.r0 = Vec3(r0.x, r1.x, r2.x);
+        t.r1 = Vec3(r0.y, r1.y, r2.y);
+        t.r2 = Vec3(r0.z, r1.z, r2.z);
+        t.scale = 1.0f / scale;
+        t.translation = -t.vector(translation);
+        return t;
+    }
+
+    /// a * b applies b first, then a
+    friend Transform operator*(const Transform& a, const Transform& b) {
+        // Columns of Rb, to form the rows of Ra Rb
+        const Vec3 c0(b.r0.x, b.r1.x, b.r2.x);
+        const Vec3 c1(b.r0.y, b.r1.y, b.r2.y);
+        const Vec3 c2(b.r0.z, b.r1.z, b.r2.z);
+        Transform t;
+        t.r0 = Vec3(dot(a.r0, c0), dot(a.r0, c1), dot(a.r0, c2));
+        t.r1 = Vec3(dot(a.r1, c0), dot(a.r1, c1), dot(a.r1, c2));
+        t.r2 = Vec3(dot(a.r2, c0), dot(a.r2, c1), dot(a.r2, c2));
+        t.scale = a.scale * b.scale;
+        t.translation = a.point(b.translation);
+        return t;
+    }
+};
+
+}  // namespace raylabs
@@ -0,0 +1,164 @@
+#include "renderer/Checkpoint.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace raylabs {
+
+namespace {
+
+constexpr char kMagic[4] = {'R', 'L', 'C', 'K'};
+constexpr std::uint32_t kVersion = 3;
+
+template <typename T>
+void write_raw(std::ofstream& out, const T* data, std::size_t count) {
+    out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(sizeof(T) * count));
+}
+
+template <typename T>
+void read_raw(std::ifstream& in, T* data, std::size_t count, const std::string& path) {
+    in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(sizeof(T) * count));
+    if (!in) {
+        throw std::runtime_error("Checkpoint file is truncated: " + path);
+    }
+}
+
+struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::int32_t width;
+    std::int32_t height;
+    std::int32_t samples;
+    std::int32_t window[4];
+    std::int32_t adaptive;
+    std::int32_t pass;
+    std::int32_t max_depth;
+    std::uint64_t spent;
+    std::uint64_t scene_digest;
+};
+
+}  // namespace
+
+void Checkpoint::save(const std::string& path) const {
+    const std::size_t n = static_cast<std::size_t>(width) * height;
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot write checkpoint: " + tmp);
+        }
+        Header h{};
+        std::memcpy(h.magic, kMagic, sizeof(kMagic));
+        h.version = kVersion;
+        h.width = width;
+        h.height = height;
+        h.samples = samples;
+        std::memcpy(h.window, window, sizeof(h.window));
+        h.adaptive = adaptive ? 1 : 0;
+        h.pass = pass;
+        h.max_depth = max_depth;
+        h.spent = spent;
+        h.scene_digest = scene_digest;
+        write_raw(out, &h, 1);
+
+        std::vector<float> rgb(3 * n);
+        for (std::size_t i = 0; i < n; ++i) {
+            rgb[3 * i + 0] = accum[i].R();
+            rgb[3 * i + 1] = accum[i].G();
+            rgb[3 * i + 2] = accum[i].B();
+        }
+        write_raw(out, rgb.data(), rgb.size());
+        write_raw(out, sample_counts.data(), n);
+        if (adaptive) {
+            for (const PixelStats& st : stats) {
+                write_raw(out, &st.n, 1);
+                write_raw(out, &st.mean, 1);
+                write_raw(out, &st.m2, 1);
+            }
+            write_raw(out, active.data(), n);
+        }
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("Failed writing checkpoint: " + tmp);
+        }
+    }
+    std::filesystem::rename(tmp, path);
+}
+
+Checkpoint Checkpoint::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open checkpoint: " + path);
+    }
+    Header h{};
+    read_raw(in, &h, 1, path);
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error("Not a raylabs checkpoint: " + path);
+    }
+    if (h.version != kVersion) {
+        throw std::runtime_error("Unsupported checkpoint version " + std::to_string(h.version) +
+                                 ": " + path);
+    }
+    if (h.width <= 0 || h.height <= 0 || h.pass < 0) {
+        throw std::runtime_error("Corrupt checkpoint header: " + path);
+    }
+
+    Checkpoint cp;
+    cp.width = h.width;
+    cp.height = h.height;
+    cp.samples = h.samples;
+    std::memcpy(cp.window, h.window, sizeof(cp.window));
+    cp.adaptive = h.adaptive != 0;
+    cp.pass = h.pass;
+    cp.max_depth = h.max_depth;
+    cp.spent = h.spent;
+    cp.scene_digest = h.scene_digest;
+
+    const std::size_t n = static_cast<std::size_t>(cp.width) * cp.height;
+    std::vector<float> rgb(3 * n);
+    read_raw(in, rgb.data(), rgb.size(), path);
+    cp.accum.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        cp.accum[i] = Color(rgb[3 * i + 0], rgb[3 * i + 1], rgb[3 * i + 2]);
+    }
+    cp.sample_counts.resize(n);
+    read_raw(in, cp.sample_counts.data(), n, path);
+    if (cp.adaptive) {
+        cp.stats.resize(n);
+        for (PixelStats& st : cp.stats) {
+            read_raw(in, &st.n, 1, path);
+            read_raw(in, &st.mean, 1, path);
+            read_raw(in, &st.m2, 1, path);
+        }
+        cp.active.resize(n);
+        read_raw(in, cp.active.data(), n, path);
+    }
+    return cp;
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    if (pending_.valid()) {
+        pending_.wait();
+    }
+}
+
+bool CheckpointWriter::busy() const {
+    return pending_.valid() &&
+           pending_.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+void CheckpointWriter::write(Checkpoint snapshot, const std::string& path) {
+    wait();
+    pending_ = std::async(std::launch::async, [cp = std::move(snapshot), path] { cp.save(path); });
+}
+
+void CheckpointWriter::wait() {
+    if (pending_.valid()) {
+        pending_.get();
+    }
+}
+
+}  // namespace raylabs
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+#include "math/Color.hpp"
+#include "renderer/PixelStats.hpp"
+
+namespace raylabs {
+
+/// Snapshot of a progressive render, taken between two passes.
+/// The sampler needs no state of its own: every sample's random stream is seeded from
+/// (x, y, sample index), so the per-pixel sample counts are enough to continue each pixel's
+/// sequence exactly where it stopped.
+struct Checkpoint {
+    int width = 0;
+    int height = 0;
+    int samples = 0;               // image.samples of the render
+    int window[4] = {0, 0, 0, 0};  // pixels rendered (crop window): x0, y0, x1, y1
+    bool adaptive = false;
+    int max_depth = 0;               // image.max_depth of the render
+    std::uint64_t scene_digest = 0;  // scene_digest() of the scene and camera rendered
+    int pass = 0;             // passes completed; one cut short by the deadline does not count
+    std::uint64_t spent = 0;  // samples taken so far (adaptive budget)
+    std::vector<Color> accum;
+    std::vector<int> sample_counts;
+    std::vector<PixelStats> stats;       // adaptive only
+    std::vector<unsigned char> active;   // adaptive only
+
+    /// Write the compact binary file (native little-endian layout). The data goes to
+    /// `path`.tmp first and is renamed over `path`, so a crash never leaves a torn file.
+    void save(const std::string& path) const;
+
+    /// Read a file written by save(). Throws std::runtime_error on a missing, foreign or
+    /// truncated file.
+    static Checkpoint load(const std::string& path);
+};
+
+/// Writes checkpoints on a background thread so the render threads never wait for the disk.
+/// One write is in flight at most: the renderer skips a checkpoint while the previous one
+/// is still being written.
+class CheckpointWriter {
+   public:
+    CheckpointWriter() = default;
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    /// True while a write is still running
+    bool busy() const;
+
+    /// Start writing `snapshot` to `path` in the background (waits for a previous write)
+    void write(Checkpoint snapshot, const std::string& path);
+
+    /// Block until the pending write is done; rethrows its error, if any
+    void wait();
+
+   private:
+    std::future<void> pending_;
+};
+
+}  // namespace raylabs
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cmath>
+
+namespace raylabs {
+
+/// Running mean/variance of a pixel's sample luminance (Welford's online algorithm).
+/// Numerically stable in float even after thousands of samples.
+struct PixelStats {
+    int n = 0;
+    float mean = 0.0f;
+    float m2 = 0.0f;  // sum of squared differences from the current mean
+
+    void add(float x) {
+        n++;
+        const float delta = x - mean;
+        mean += delta / static_cast<float>(n);
+        m2 += delta * (x - mean);
+    }
+
+    /// Unbiased sample variance (0 below two samples)
+    float variance() const { return n > 1 ? m2 / static_cast<float>(n - 1) : 0.0f; }
+
+    /// Standard error of the mean estimate
+    float standard_error() const {
+        return n > 0 ? std::sqrt(variance() / static_cast<float>(n)) : 0.0f;
+    }
+
+    /// Standard error relative to the mean; dark pixels are measured against `floor` so they
+    /// do not need an absurd number of samples to converge
+    float relative_error(float floor) const {
+        return standard_error() / (mean > floor ? mean : floor);
+    }
+};
+
+/// Rec. 709 luminance, the quantity the adaptive sampler measures noise on
+inline float luminance(float r, float g, float b) {
+    return 0.2126f * r + 0.7152f * g + 0.0722f * b;
+}
+
+}  // namespace raylabs
@@ -1,12 +1,56 @@
 #include "renderer/Renderer.hpp"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
 #include "core/PathTracer.hpp"
 #include "math/Color.hpp"
 #include "math/Vec3.hpp"
+#include "renderer/TileFarm.hpp"
+#include "utils/ThreadPool.hpp"
 
 namespace raylabs {
 
+namespace {
+
+/// Interleave the bits of x and y (x in the even bits): the Z-order index of (x, y)
+std::uint32_t morton_index(std::uint32_t x, std::uint32_t y) {
+    auto spread = [](std::uint32_t v) {
+        v &= 0xffff;
+        v = (v | (v << 8)) & 0x00ff00ff;
+        v = (v | (v << 4)) & 0x0f0f0f0f;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+/// Distance of (x, y) along the Hilbert curve filling an n x n grid (n a power of two)
+std::uint32_t hilbert_index(std::uint32_t n, std::uint32_t x, std::uint32_t y) {
+    std::uint32_t d = 0;
+    for (std::uint32_t s = n / 2; s > 0; s /= 2) {
+        const std::uint32_t rx = (x & s) > 0 ? 1 : 0;
+        const std::uint32_t ry = (y & s) > 0 ? 1 : 0;
+        d += s * s * ((3 * rx) ^ ry);
+        // Rotate the quadrant so that the sub-curve starts where the previous one ended
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+}  // namespace
+
 Renderer::Renderer(const Scene& scene, const Camera& camera, const io::ImageDTO& image_config,
                    std::shared_ptr<Integrator> integrator)
     : scene_(scene),
@@ -17,25 +61,51 @@ Renderer::Renderer(const Scene& scene, const Camera& camera, const io::ImageDTO&
     if (!integrator_) {
         integrator_ = std::make_shared<PathTracer>();
     }
+    const Rect window = render_window();
+    if (window.x0 < 0 || window.y0 < 0 || window.x0 >= window.x1 || window.y0 >= window.y1 ||
+        window.x1 > image_config_.width || window.y1 > image_config_.height) {
+        throw std::runtime_error("Crop window must be a non-empty rectangle inside the " +
+                                 std::to_string(image_config_.width) + "x" +
+                                 std::to_string(image_config_.height) + " frame");
+    }
+    if (image_config_.tile_order != "hilbert" && image_config_.tile_order != "morton" &&
+        image_config_.tile_order != "row") {
+        throw std::runtime_error("Unknown tile order '" + image_config_.tile_order + "'");
+    }
 }
 
 void Renderer::render() {
+    render_frame();
+
+    std::cout << "Writing to file: " << image_config_.output_path << std::endl;
+    output_image(image_).WriteFile(image_config_.output_path.c_str());
+
+    if (!image_config_.spp_output.empty()) {
+        std::cout << "Writing spp image to: " << image_config_.spp_output << std::endl;
+        write_spp_image(image_config_.spp_output);
+    }
+}
+
+void Renderer::render_frame() {
+    ThreadPool pool(static_cast<unsigned>(image_config_.threads));
+
     std::cout << "Rendering image of size " << image_config_.width << "x" << image_config_.height
-              << std::endl;
+              << " on " << pool.size() << " threads" << std::endl;
+    const Rect window = render_window();
+    if (window.x1 - window.x0 != image_config_.width ||
+        window.y1 - window.y0 != image_config_.height) {
+        std::cout << "Crop window: " << (window.x1 - window.x0) << "x" << (window.y1 - window.y0)
+                  << " pixels at (" << window.x0 << ", " << window.y0 << ")" << std::endl;
+    }
     std::cout << "Rendering with " << image_config_.samples << " samples per pixel and "
               << image_config_.max_depth << " bounces..." << std::endl;
 
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    for (int y = 0; y < image_config_.height; y++) {
-        if (y % 50 == 0) {
-            float progress = (y * 100.0f) / image_config_.height;
-            std::cout << "Progress: " << progress << "%" << std::endl;
-        }
-        for (int x = 0; x < image_config_.width; x++) {
-            Color pixel_color = render_pixel(x, y);
-            image_.SetPixel(x, y, pixel_color);
-        }
+    if (progressive()) {
+        render_progressive(pool);
+    } else {
+        render_tiles(pool);
     }
 
     auto end_time = std::chrono::high_resolution_clock::now();
@@ -43,30 +113,486 @@ void Renderer::render() {
 
     std::cout << "Rendering completed in " << duration.count() << " ms ("
               << (duration.count() / 1000.0) << " seconds)" << std::endl;
+}
 
-    std::cout << "Writing to file: " << image_config_.output_path << std::endl;
-    image_.WriteFile(image_config_.output_path.c_str());
+Renderer::Rect Renderer::render_window() const {
+    if (image_config_.crop_width == 0 && image_config_.crop_height == 0) {
+        return {0, 0, image_config_.width, image_config_.height};
+    }
+    return {image_config_.crop_x, image_config_.crop_y,
+            image_config_.crop_x + image_config_.crop_width,
+            image_config_.crop_y + image_config_.crop_height};
+}
+
+Image Renderer::output_image(const Image& frame) const {
+    if (image_config_.crop_full_frame) {
+        return frame;
+    }
+    const Rect window = render_window();
+    return frame.Crop(static_cast<unsigned>(window.x0), static_cast<unsigned>(window.y0),
+                      static_cast<unsigned>(window.x1 - window.x0),
+                      static_cast<unsigned>(window.y1 - window.y0));
+}
+
+int Renderer::sample_count(int x, int y) const {
+    const Rect window = render_window();
+    if (x < window.x0 || x >= window.x1 || y < window.y0 || y >= window.y1) {
+        return 0;
+    }
+    if (sample_counts_.empty()) {
+        return image_config_.samples;
+    }
+    return sample_counts_[static_cast<std::size_t>(y) * image_config_.width + x];
+}
+
+void Renderer::render_tiles(ThreadPool& pool) {
+    accum_.clear();
+    sample_counts_.clear();
+
+    const std::vector<Tile> tiles = make_tiles();
+    std::atomic<std::size_t> tiles_done{0};
+    std::atomic<int> last_reported{-1};
+    std::mutex log_mtx;
+
+    pool.parallel_for(tiles.size(), [&](std::size_t i) {
+        render_tile(tiles[i]);
+
+        const std::size_t done = tiles_done.fetch_add(1) + 1;
+        const int decile = static_cast<int>(done * 10 / tiles.size());
+        int previous = last_reported.load();
+        while (decile > previous && !last_reported.compare_exchange_weak(previous, decile)) {
+        }
+        if (decile > previous) {
+            std::scoped_lock lock(log_mtx);
+            std::cout << "Progress: " << decile * 10 << "%" << std::endl;
+        }
+    });
+}
+
+void Renderer::render_region(ThreadPool& pool, int x0, int y0, int x1, int y1) {
+    x0 = std::clamp(x0, 0, image_config_.width);
+    x1 = std::clamp(x1, x0, image_config_.width);
+    y0 = std::clamp(y0, 0, image_config_.height);
+    y1 = std::clamp(y1, y0, image_config_.height);
+    const std::vector<Tile> tiles = make_tiles({x0, y0, x1, y1});
+    pool.parallel_for(tiles.size(), [&](std::size_t i) { render_tile(tiles[i]); });
+}
+
+int Renderer::adaptive_max_samples() const {
+    return image_config_.max_samples > 0 ? image_config_.max_samples
+                                         : 8 * image_config_.samples;
+}
+
+void Renderer::render_progressive(ThreadPool& pool) {
+    using clock = std::chrono::steady_clock;
+    const auto start = clock::now();
+    const bool has_deadline = image_config_.time_budget_ms > 0;
+    const auto deadline = start + std::chrono::milliseconds(image_config_.time_budget_ms);
+    const bool adaptive = image_config_.adaptive;
+
+    const std::size_t pixel_count =
+        static_cast<std::size_t>(image_config_.width) * image_config_.height;
+    const Rect window = render_window();
+    const std::size_t window_pixels =
+        static_cast<std::size_t>(window.x1 - window.x0) * (window.y1 - window.y0);
+    accum_.assign(pixel_count, Color());
+    sample_counts_.assign(pixel_count, 0);
+    if (adaptive) {
+        stats_.assign(pixel_count, PixelStats{});
+        active_.assign(pixel_count, 1);
+    } else {
+        stats_.clear();
+        active_.clear();
+    }
+    int first_pass = 0;
+    std::size_t spent = 0;
+    if (!image_config_.resume_path.empty() || !image_config_.checkpoint_path.empty())
+        scene_digest_ = scene_digest(scene_, camera_);
+    if (!image_config_.resume_path.empty()) {
+        Checkpoint cp = Checkpoint::load(image_config_.resume_path);
+        restore_checkpoint(cp);
+        first_pass = cp.pass;
+        spent = static_cast<std::size_t>(cp.spent);
+        std::cout << "Resuming from " << image_config_.resume_path << " after " << first_pass
+                  << " passes" << std::endl;
+    }
+
+    // Checkpoints are written between passes, when the buffers are consistent
+    const std::string checkpoint_path = image_config_.checkpoint_path.empty()
+                                            ? image_config_.resume_path
+                                            : image_config_.checkpoint_path;
+    const auto checkpoint_interval =
+        std::chrono::milliseconds(image_config_.checkpoint_interval_ms);
+    CheckpointWriter writer;
+    auto last_checkpoint = clock::now();
+
+    // Adaptive mode redistributes the fixed-spp budget of the whole window.
+    const std::size_t budget = window_pixels * static_cast<std::size_t>(image_config_.samples);
+    const int max_passes = adaptive ? adaptive_max_samples() : image_config_.samples;
+
+    const std::vector<Tile> tiles = make_tiles();
+    std::atomic<bool> out_of_time{false};
+
+    // Only passes that reached every tile count: the pixels a pass cut short by the deadline
+    // did not reach are caught up by the next pass, of this run or of a resumed one.
+    int pass = first_pass;
+    while (pass < max_passes && !out_of_time.load()) {
+        std::atomic<std::size_t> taken{0};
+        std::atomic<bool> cut{false};
+        pool.parallel_for(tiles.size(), [&](std::size_t i) {
+            // The first pass always completes so that every pixel has a sample; later passes
+            // stop picking up tiles once the deadline has gone by.
+            if (pass > 0 && has_deadline) {
+                if (out_of_time.load(std::memory_order_relaxed) || clock::now() >= deadline) {
+                    out_of_time.store(true, std::memory_order_relaxed);
+                    cut.store(true, std::memory_order_relaxed);
+                    return;
+                }
+            }
+            taken.fetch_add(sample_tile(tiles[i], pass), std::memory_order_relaxed);
+        });
+        spent += taken.load();
+        const auto elapsed =
+            std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start);
+        if (cut.load()) {
+            std::cout << "Pass " << (pass + 1) << "/" << max_passes << " cut short: "
+                      << taken.load() << " samples (" << elapsed.count() << " ms)" << std::endl;
+            break;
+        }
+        ++pass;
+        if (has_deadline && clock::now() >= deadline) {
+            out_of_time.store(true);
+        }
+        std::cout << "Pass " << pass << "/" << max_passes << " done: " << taken.load()
+                  << " samples (" << elapsed.count() << " ms)" << std::endl;
+
+        if (adaptive && (taken.load() == 0 || spent >= budget)) {
+            break;
+        }
+
+        // Skipped while the previous checkpoint is still being written
+        if (!checkpoint_path.empty() && !writer.busy() &&
+            clock::now() - last_checkpoint >= checkpoint_interval) {
+            save_checkpoint(writer, checkpoint_path, pass, spent);
+            last_checkpoint = clock::now();
+        }
+    }
+
+    if (!checkpoint_path.empty()) {
+        save_checkpoint(writer, checkpoint_path, pass, spent);
+        try {
+            writer.wait();
+            std::cout << "Checkpoint written to " << checkpoint_path << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: checkpoint failed: " << e.what() << std::endl;
+        }
+    }
+
+    if (out_of_time.load()) {
+        std::cout << "Time budget of " << image_config_.time_budget_ms << " ms reached after "
+                  << pass << " passes" << std::endl;
+    }
+    if (adaptive) {
+        std::cout << "Adaptive sampling spent " << spent << " of " << budget << " samples ("
+                  << (static_cast<double>(spent) / static_cast<double>(window_pixels))
+                  << " spp on average)" << std::endl;
+    }
+    resolve_image();
 }
 
-Color Renderer::render_pixel(int x, int y) const {
-    Color pixel_color(0.0f, 0.0f, 0.0f);
+std::size_t Renderer::sample_tile(const Tile& tile, int pass) {
+    std::vector<SampleRequest> requests;
+    requests.reserve(static_cast<std::size_t>(kTileSize) * kTileSize);
+    for (int y = tile.y0; y < tile.y1; y++) {
+        for (int x = tile.x0; x < tile.x1; x++) {
+            const std::size_t idx = static_cast<std::size_t>(y) * image_config_.width + x;
+            // Adaptive: the pixels still active. Otherwise the pixels that do not have their
+            // sample of this pass yet, which skips those sampled by a pass cut short.
+            if (active_.empty() ? sample_counts_[idx] <= pass : active_[idx] != 0) {
+                requests.push_back({x, y, sample_counts_[idx]});
+            }
+        }
+    }
 
+    std::vector<Color> samples(requests.size());
+    trace_samples(requests.data(), requests.size(), samples.data());
+    for (std::size_t i = 0; i < requests.size(); ++i) {
+        record_sample(static_cast<std::size_t>(requests[i].y) * image_config_.width + requests[i].x,
+                      samples[i]);
+    }
+    return requests.size();
+}
+
+void Renderer::restore_checkpoint(const Checkpoint& cp) {
+    if (cp.width != image_config_.width || cp.height != image_config_.height) {
+        throw std::runtime_error("Checkpoint is " + std::to_string(cp.width) + "x" +
+                                 std::to_string(cp.height) + ", the render is " +
+                                 std::to_string(image_config_.width) + "x" +
+                                 std::to_string(image_config_.height));
+    }
+    if (cp.adaptive != image_config_.adaptive) {
+        throw std::runtime_error(cp.adaptive ? "Checkpoint comes from an adaptive render"
+                                             : "Checkpoint comes from a non-adaptive render");
+    }
+    const Rect window = render_window();
+    if (cp.window[0] != window.x0 || cp.window[1] != window.y0 || cp.window[2] != window.x1 ||
+        cp.window[3] != window.y1) {
+        throw std::runtime_error(
+            "Checkpoint covers the pixels [" + std::to_string(cp.window[0]) + ", " +
+            std::to_string(cp.window[2]) + ") x [" + std::to_string(cp.window[1]) + ", " +
+            std::to_string(cp.window[3]) + "), the render [" + std::to_string(window.x0) + ", " +
+            std::to_string(window.x1) + ") x [" + std::to_string(window.y0) + ", " +
+            std::to_string(window.y1) + "): resume with the same crop window");
+    }
+    // Samples of another scene or path depth would be blended into this one
+    if (cp.max_depth != image_config_.max_depth) {
+        throw std::runtime_error("Checkpoint was rendered with max_depth " +
+                                 std::to_string(cp.max_depth) + ", the render uses " +
+                                 std::to_string(image_config_.max_depth));
+    }
+    if (cp.scene_digest != scene_digest_) {
+        throw std::runtime_error(
+            "Checkpoint was rendered from another scene or camera: resume with the same scene");
+    }
+    // Samples already taken cannot be given back
+    if (image_config_.samples < cp.samples) {
+        throw std::runtime_error("Checkpoint was rendered for " + std::to_string(cp.samples) +
+                                 " samples per pixel, more than the " +
+                                 std::to_string(image_config_.samples) + " requested");
+    }
+    accum_ = cp.accum;
+    sample_counts_ = cp.sample_counts;
+    if (cp.adaptive) {
+        stats_ = cp.stats;
+        active_ = cp.active;
+        // A larger sample cap than the interrupted run's lets converged-by-cap pixels go on
+        for (std::size_t i = 0; i < stats_.size(); ++i) {
+            if (!active_[i] && stats_[i].n < adaptive_max_samples() &&
+                stats_[i].relative_error(kDarkFloor) >= image_config_.adaptive_threshold) {
+                active_[i] = 1;
+            }
+        }
+    }
+}
+
+void Renderer::save_checkpoint(CheckpointWriter& writer, const std::string& path, int passes,
+                               std::size_t spent) const {
+    Checkpoint cp;
+    cp.width = image_config_.width;
+    cp.height = image_config_.height;
+    cp.samples = image_config_.samples;
+    const Rect window = render_window();
+    cp.window[0] = window.x0;
+    cp.window[1] = window.y0;
+    cp.window[2] = window.x1;
+    cp.window[3] = window.y1;
+    cp.adaptive = image_config_.adaptive;
+    cp.max_depth = image_config_.max_depth;
+    cp.scene_digest = scene_digest_;
+    cp.pass = passes;
+    cp.spent = spent;
+    cp.accum = accum_;
+    cp.sample_counts = sample_counts_;
+    cp.stats = stats_;
+    cp.active = active_;
+    try {
+        writer.write(std::move(cp), path);
+    } catch (const std::exception& e) {
+        // Raised by the previous write; the render itself goes on
+        std::cerr << "Warning: checkpoint failed: " << e.what() << std::endl;
+    }
+}
+
+void Renderer::record_sample(std::size_t idx, const Color& sample) {
+    accum_[idx] += sample;
+    sample_counts_[idx]++;
+
+    if (!stats_.empty()) {
+        PixelStats& st = stats_[idx];
+        st.add(luminance(sample.R(), sample.G(), sample.B()));
+        if (st.n >= adaptive_max_samples() ||
+            (st.n >= image_config_.min_samples &&
+             st.relative_error(kDarkFloor) < image_config_.adaptive_threshold)) {
+            active_[idx] = 0;
+        }
+    }
+}
+
+void Renderer::resolve_image() {
+    const Rect window = render_window();
+    for (int y = window.y0; y < window.y1; y++) {
+        for (int x = window.x0; x < window.x1; x++) {
+            const std::size_t idx = static_cast<std::size_t>(y) * image_config_.width + x;
+            if (sample_counts_[idx] == 0) {
+                continue;
+            }
+            const float n = static_cast<float>(sample_counts_[idx]);
+            const Color& sum = accum_[idx];
+            image_.SetPixel(x, y, Color(sum.R() / n, sum.G() / n, sum.B() / n).clamp01());
+        }
+    }
+}
+
+void Renderer::write_spp_image(const std::string& path) const {
+    int max_spp = 1;
+    for (int y = 0; y < image_config_.height; y++) {
+        for (int x = 0; x < image_config_.width; x++) {
+            max_spp = std::max(max_spp, sample_count(x, y));
+        }
+    }
+    Image spp(image_config_.width, image_config_.height);
+    for (int y = 0; y < image_config_.height; y++) {
+        for (int x = 0; x < image_config_.width; x++) {
+            const float level = static_cast<float>(sample_count(x, y)) / max_spp;
+            spp.SetPixel(x, y, Color(level, level, level));
+        }
+    }
+    output_image(spp).WriteFile(path.c_str());
+}
+
+std::vector<Renderer::Tile> Renderer::make_tiles() const {
+    return make_tiles(render_window());
+}
+
+std::vector<Renderer::Tile> Renderer::make_tiles(const Tile& region) const {
+    std::vector<Tile> tiles;
+    for (int y = region.y0; y < region.y1; y += kTileSize) {
+        for (int x = region.x0; x < region.x1; x += kTileSize) {
+            tiles.push_back(
+                {x, y, std::min(x + kTileSize, region.x1), std::min(y + kTileSize, region.y1)});
+        }
+    }
+    if (image_config_.tile_order == "row") {
+        return tiles;
+    }
+
+    // Sort the tiles by their position along a space-filling curve over the tile grid.
+    // parallel_for() deals out contiguous index blocks, so each thread also gets a compact
+    // patch of the frame rather than a band of rows.
+    const bool hilbert = image_config_.tile_order == "hilbert";
+    const int columns = (region.x1 - region.x0 + kTileSize - 1) / kTileSize;
+    const int rows = (region.y1 - region.y0 + kTileSize - 1) / kTileSize;
+    std::uint32_t grid = 1;
+    while (grid < static_cast<std::uint32_t>(std::max(columns, rows))) {
+        grid *= 2;
+    }
+    std::vector<std::pair<std::uint32_t, Tile>> keyed;
+    keyed.reserve(tiles.size());
+    for (const Tile& t : tiles) {
+        const auto tx = static_cast<std::uint32_t>((t.x0 - region.x0) / kTileSize);
+        const auto ty = static_cast<std::uint32_t>((t.y0 - region.y0) / kTileSize);
+        keyed.emplace_back(hilbert ? hilbert_index(grid, tx, ty) : morton_index(tx, ty), t);
+    }
+    std::sort(keyed.begin(), keyed.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (std::size_t i = 0; i < keyed.size(); ++i) {
+        tiles[i] = keyed[i].second;
+    }
+    return tiles;
+}
+
+void Renderer::render_tile(const Tile& tile) {
+    const int width = tile.x1 - tile.x0;
+    const int height = tile.y1 - tile.y0;
+    std::vector<SampleRequest> requests(static_cast<std::size_t>(width) * height);
+    std::vector<Color> samples(requests.size());
+    std::vector<Color> sums(requests.size());
+
+    // The whole tile at a time, sample by sample: neighbouring camera rays form the packets
+    // (or the wavefront batch) and every pixel still sums its samples in index order.
     for (int s = 0; s < image_config_.samples; s++) {
-        float u = (x + Sampler::random_float()) / float(image_config_.width);
-        float v = 1.0f - (y + Sampler::random_float()) / float(image_config_.height);
-        Ray r = camera_.get_ray(u, v);
+        std::size_t i = 0;
+        for (int y = tile.y0; y < tile.y1; y++) {
+            for (int x = tile.x0; x < tile.x1; x++) {
+                requests[i++] = {x, y, s};
+            }
+        }
+        trace_samples(requests.data(), requests.size(), samples.data());
+        for (std::size_t k = 0; k < sums.size(); k++) {
+            sums[k] += samples[k];
+        }
+    }
 
-        Color sample_color = integrator_->trace(r, scene_, image_config_.max_depth);
-        sample_color = sample_color.clamp01();
-        pixel_color += sample_color;
+    // Resolve in the tile-local buffer and copy it to the frame in one go
+    const float n = static_cast<float>(image_config_.samples);
+    for (Color& c : sums) {
+        c = Color(c.R() / n, c.G() / n, c.B() / n).clamp01();
     }
+    image_.SetBlock(static_cast<unsigned>(tile.x0), static_cast<unsigned>(tile.y0),
+                    static_cast<unsigned>(width), static_cast<unsigned>(height), sums.data());
+}
 
-    pixel_color =
-        Color(pixel_color.R() / image_config_.samples, pixel_color.G() / image_config_.samples,
-              pixel_color.B() / image_config_.samples);
-    pixel_color = pixel_color.clamp01();
+Ray Renderer::camera_ray(const SampleRequest& request) const {
+    Sampler::seed_sample(static_cast<unsigned>(request.x), static_cast<unsigned>(request.y),
+                         static_cast<unsigned>(request.s));
 
-    return pixel_color;
+    float u = (request.x + Sampler::random_float()) / float(image_config_.width);
+    float v = 1.0f - (request.y + Sampler::random_float()) / float(image_config_.height);
+    return camera_.get_ray(u, v);
+}
+
+void Renderer::trace_samples(const SampleRequest* requests, std::size_t count, Color* out) const {
+    if (integrator_->prefers_batches()) {
+        trace_batch(requests, count, out);
+        return;
+    }
+    switch (image_config_.packet_size) {
+        case 4:
+            trace_packets<4>(requests, count, out);
+            return;
+        case 8:
+            trace_packets<8>(requests, count, out);
+            return;
+        case 16:
+            trace_packets<16>(requests, count, out);
+            return;
+        default:
+            break;
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        Ray r = camera_ray(requests[i]);
+        out[i] = integrator_->trace(r, scene_, image_config_.max_depth);
+    }
+}
+
+void Renderer::trace_batch(const SampleRequest* requests, std::size_t count, Color* out) const {
+    std::vector<Ray> rays(count);
+    std::vector<unsigned int> streams(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        rays[i] = camera_ray(requests[i]);
+        streams[i] = Sampler::state();
+    }
+    integrator_->trace_batch(rays.data(), streams.data(), count, scene_, image_config_.max_depth,
+                             out);
+}
+
+template <int N>
+void Renderer::trace_packets(const SampleRequest* requests, std::size_t count, Color* out) const {
+    Ray rays[N];
+    unsigned int streams[N];
+
+    for (std::size_t base = 0; base < count; base += N) {
+        const int lanes = static_cast<int>(std::min<std::size_t>(N, count - base));
+
+        // Generate the camera rays, remembering where each lane's random stream stopped
+        for (int lane = 0; lane < lanes; ++lane) {
+            rays[lane] = camera_ray(requests[base + lane]);
+            streams[lane] = Sampler::state();
+        }
+
+        const RayPacket<N> packet = RayPacket<N>::from_rays(rays, lanes);
+        PacketHit<N> hit(1e9f);
+        scene_.hit_packet(packet, 0.001f, hit, RayPacket<N>::first_lanes(lanes));
+
+        // Paths diverge after the first bounce: continue each lane as a single ray
+        for (int lane = 0; lane < lanes; ++lane) {
+            Sampler::set_state(streams[lane]);
+            HitRecord rec;
+            const bool found = scene_.packet_hit_record(rays[lane], hit, lane, rec);
+            out[base + lane] = integrator_->trace_hit(rays[lane], found ? &rec : nullptr,
+                                                      scene_, image_config_.max_depth);
+        }
+    }
 }
 
 }  // namespace raylabs
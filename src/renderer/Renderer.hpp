@@ -2,15 +2,20 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 #include "core/Camera.hpp"
 #include "core/Integrator.hpp"
 #include "core/Sampler.hpp"
 #include "core/Scene.hpp"
 #include "image/Image.hpp"
 #include "io/JsonSceneLoader.hpp"
+#include "renderer/Checkpoint.hpp"
+#include "renderer/PixelStats.hpp"
 
 namespace raylabs {
 
+class ThreadPool;
+
 class Renderer {
    public:
     Renderer(const Scene& scene, const Camera& camera, const io::ImageDTO& image_config,
@@ -19,15 +24,134 @@ class Renderer {
     /// Render the scene and write to output file
     void render();
 
+    /// Render the scene into the internal image (no file output)
+    void render_frame();
+
+    /// Render the pixels [x0, x1) x [y0, y1) into image() with the fixed sample count,
+    /// exactly as render_frame() would (tile farm workers render their tiles this way)
+    void render_region(ThreadPool& pool, int x0, int y0, int x1, int y1);
+
+    /// Pixel rectangle [x0, x1) x [y0, y1) of the frame
+    struct Rect {
+        int x0, y0;  // inclusive
+        int x1, y1;  // exclusive
+    };
+
+    /// Pixels that get rendered: the crop window, or the whole frame without one
+    Rect render_window() const;
+
+    /// `frame` as written to the output file: the crop window alone, unless the image
+    /// settings keep the full frame (black outside the window)
+    Image output_image(const Image& frame) const;
+
+    /// Image settings the renderer was created with
+    const io::ImageDTO& config() const { return image_config_; }
+
+    /// Scene and camera the renderer was created with
+    const Scene& scene() const { return scene_; }
+    const Camera& camera() const { return camera_; }
+
+    /// Last rendered frame
+    const Image& image() const { return image_; }
+
+    /// Samples taken by pixel (x, y) in the last frame
+    int sample_count(int x, int y) const;
+
+    /// Edge length of the square tiles handed to the worker threads
+    static constexpr int kTileSize = 32;
+
    private:
+    using Tile = Rect;
+
+    /// One camera sample to trace: sample index `s` of pixel (x, y)
+    struct SampleRequest {
+        int x, y, s;
+    };
+
     const Scene& scene_;
     const Camera& camera_;
     io::ImageDTO image_config_;
     std::shared_ptr<Integrator> integrator_;
     Image image_;
 
-    /// Render a single pixel with antialiasing
-    Color render_pixel(int x, int y) const;
+    // Progressive state: unclamped running sum of the samples and sample count per pixel
+    std::vector<Color> accum_;
+    std::vector<int> sample_counts_;
+    // scene_digest() of the scene and camera, which checkpoints record (0 without them)
+    std::uint64_t scene_digest_ = 0;
+    // Adaptive state: luminance statistics and whether the pixel still takes samples
+    std::vector<PixelStats> stats_;
+    std::vector<unsigned char> active_;
+
+    bool progressive() const {
+        return image_config_.progressive || image_config_.time_budget_ms > 0 ||
+               image_config_.adaptive || !image_config_.checkpoint_path.empty() ||
+               !image_config_.resume_path.empty();
+    }
+
+    /// Adaptive mode: luminance below this floor counts as this bright when measuring
+    /// relative error
+    static constexpr float kDarkFloor = 0.05f;
+
+    /// Per-pixel cap of the adaptive sampler
+    int adaptive_max_samples() const;
+
+    /// Fixed sample count: every tile renders its pixels to completion in one go
+    void render_tiles(ThreadPool& pool);
+
+    /// Progressive: whole-frame passes of one sample per pixel until the target spp or
+    /// the deadline is reached. In adaptive mode passes skip converged pixels and run until
+    /// the frame's sample budget is spent. Optionally resumes from and saves checkpoints;
+    /// a resumed job keeps checkpointing to its resume file unless another path is given.
+    void render_progressive(ThreadPool& pool);
+
+    /// Add one sample to every still active pixel of the tile (adaptive) or to every pixel
+    /// holding no more than `pass` samples. Returns the samples taken.
+    std::size_t sample_tile(const Tile& tile, int pass);
+
+    /// Accumulate a sample into pixel idx; adaptive mode also updates its statistics and
+    /// retires the pixel once converged
+    void record_sample(std::size_t idx, const Color& sample);
+
+    /// Load the pass state of a checkpoint; throws if it does not fit the current render
+    /// (frame size, crop window, adaptive mode, max_depth, scene and camera, or fewer samples
+    /// requested than it was for)
+    void restore_checkpoint(const Checkpoint& cp);
+
+    /// Snapshot the pass state and hand it to the background writer
+    void save_checkpoint(CheckpointWriter& writer, const std::string& path, int passes,
+                         std::size_t spent) const;
+
+    /// Average accum_ into image_ (pixels without samples stay black)
+    void resolve_image();
+
+    /// Write the spp-per-pixel debug image (black = fewest, white = most samples)
+    void write_spp_image(const std::string& path) const;
+
+    /// Split the render window (or another region) into kTileSize x kTileSize tiles, listed
+    /// in the configured tile order
+    std::vector<Tile> make_tiles() const;
+    std::vector<Tile> make_tiles(const Tile& region) const;
+
+    /// Render every pixel of a tile into a tile-local buffer, then copy it to the frame;
+    /// tiles never overlap so no locking is needed
+    void render_tile(const Tile& tile);
+
+    /// Trace a batch of camera samples (unclamped radiance in `out`: pixels are clamped once
+    /// averaged, when resolved into the image). With image.packet_size set, the camera rays go
+    /// through the scene as SIMD packets; a batch-oriented integrator (wavefront) gets the
+    /// whole list at once.
+    void trace_samples(const SampleRequest* requests, std::size_t count, Color* out) const;
+
+    /// Batch path of trace_samples(): all camera rays handed to Integrator::trace_batch()
+    void trace_batch(const SampleRequest* requests, std::size_t count, Color* out) const;
+
+    /// Packet path of trace_samples(): first hits for N rays at once, then one path each
+    template <int N>
+    void trace_packets(const SampleRequest* requests, std::size_t count, Color* out) const;
+
+    /// Seed the sample's random stream and build its jittered camera ray
+    Ray camera_ray(const SampleRequest& request) const;
 };
 
 }  // namespace raylabs
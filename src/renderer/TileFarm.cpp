@@ -0,0 +1,430 @@
+#include "renderer/TileFarm.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <cstring>
+#include <thread>
+#include <typeinfo>
+#include "core/Camera.hpp"
+#include "core/Scene.hpp"
+#include "materials/Material.hpp"
+#include "renderer/Renderer.hpp"
+#include "utils/ThreadPool.hpp"
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace raylabs {
+
+namespace {
+
+constexpr std::uint32_t kMagic = 0x4d464c52;  // "RLFM"
+constexpr std::uint32_t kVersion = 2;
+
+enum MessageType : std::uint32_t { kHello = 1, kTile = 2, kDone = 3, kResult = 4, kReject = 5 };
+
+struct HelloMsg {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::int32_t width, height, samples, max_depth;
+    std::uint64_t scene_digest;
+};
+
+struct TileMsg {
+    std::int32_t id;
+    std::int32_t x0, y0, x1, y1;
+};
+
+struct ResultMsg {
+    std::int32_t id;
+    std::uint32_t pixel_count;
+};
+
+template <typename T>
+void send_message(const Socket& conn, MessageType type, const T& body) {
+    char buffer[sizeof(std::uint32_t) + sizeof(T)];
+    const std::uint32_t t = type;
+    std::copy_n(reinterpret_cast<const char*>(&t), sizeof(t), buffer);
+    std::copy_n(reinterpret_cast<const char*>(&body), sizeof(T), buffer + sizeof(t));
+    conn.send_all(buffer, sizeof(buffer));
+}
+
+void send_message(const Socket& conn, MessageType type) {
+    const std::uint32_t t = type;
+    conn.send_all(&t, sizeof(t));
+}
+
+std::uint32_t recv_type(const Socket& conn, int timeout_ms) {
+    std::uint32_t type = 0;
+    conn.recv_all(&type, sizeof(type), timeout_ms);
+    return type;
+}
+
+HelloMsg make_hello(const Renderer& renderer) {
+    const io::ImageDTO& cfg = renderer.config();
+    return {kMagic,      kVersion,    cfg.width, cfg.height, cfg.samples, cfg.max_depth,
+            scene_digest(renderer.scene(), renderer.camera())};
+}
+
+/// FNV-1a over 32-bit words
+struct Hasher {
+    std::uint64_t h = 14695981039346656037ull;
+
+    void word(std::uint32_t w) {
+        h ^= w;
+        h *= 1099511628211ull;
+    }
+    void value(float f) {
+        std::uint32_t w;
+        std::memcpy(&w, &f, sizeof(w));
+        word(w);
+    }
+    void point(const Vec3& p) {
+        value(p.x);
+        value(p.y);
+        value(p.z);
+    }
+    void color(const Color& c) {
+        value(c.R());
+        value(c.G());
+        value(c.B());
+    }
+};
+
+}  // namespace
+
+std::uint64_t scene_digest(const Scene& scene, const Camera& camera) {
+    Hasher hash;
+    hash.word(static_cast<std::uint32_t>(scene.entities.size()));
+    const HitRecord probe{};
+    for (const Scene::Entity& e : scene.entities) {
+        const Aabb box = e.shape->bounds();
+        if (box.is_bounded()) {
+            hash.point(box.min);
+            hash.point(box.max);
+        } else {
+            // Planes: where a few fixed rays meet them
+            for (const Vec3& dir :
+                 {Vec3(0.3f, -1, 0.2f), Vec3(-0.4f, 0.1f, -1), Vec3(1, 0.5f, 0)}) {
+                HitRecord rec;
+                hash.value(e.shape->hit(Ray(Point3(0.1f, 0.2f, 0.3f), dir), 0.0f, 1e30f, rec)
+                               ? rec.t
+                               : -1.0f);
+            }
+        }
+        // The material's kind and its color where it does not depend on the hit point
+        const Material* material = e.material.get();
+        hash.word(material ? static_cast<std::uint32_t>(typeid(*material).hash_code()) : 0u);
+        if (material)
+            hash.color(material->diffuse(probe));
+    }
+    hash.word(static_cast<std::uint32_t>(scene.lights.size()));
+    for (const Scene::PointLight& light : scene.lights) {
+        hash.point(light.position);
+        hash.color(light.intensity);
+    }
+    hash.point(camera.position);
+    hash.point(camera.look_at);
+    hash.point(camera.up);
+    hash.value(camera.fov);
+    hash.value(camera.aspect_ratio);
+    return hash.h;
+}
+
+// ------------------------ Coordinator ---------------------------------------
+
+TileFarm::TileFarm(Renderer& renderer, const FarmOptions& options)
+    : renderer_(renderer), options_(options), listener_(Socket::listen(options.port)) {
+    if (options_.tile_size <= 0) {
+        throw std::runtime_error("Tile farm tile size must be > 0");
+    }
+}
+
+TileFarm::~TileFarm() {
+#ifndef _WIN32
+    for (int pid : children_) {
+        int status = 0;
+        ::waitpid(pid, &status, 0);
+    }
+#endif
+}
+
+void TileFarm::spawn_local_workers(int count, int threads_per_worker) {
+#ifndef _WIN32
+    const int farm_port = port();
+    for (int i = 0; i < count; ++i) {
+        std::cout.flush();
+        const pid_t pid = ::fork();
+        if (pid < 0) {
+            throw std::runtime_error("Cannot fork tile farm worker");
+        }
+        if (pid == 0) {
+            // Child: same scene in memory, no coordinator state
+            listener_.close();
+            int code = 0;
+            try {
+                run_farm_worker("127.0.0.1", farm_port, renderer_,
+                                static_cast<unsigned>(std::max(1, threads_per_worker)));
+            } catch (const std::exception& e) {
+                std::cerr << "Worker " << i << ": " << e.what() << std::endl;
+                code = 1;
+            }
+            std::cout.flush();
+            ::_exit(code);
+        }
+        children_.push_back(pid);
+    }
+#else
+    (void)count;
+    (void)threads_per_worker;
+    throw std::runtime_error("Local tile farm workers need fork() (POSIX only)");
+#endif
+}
+
+Image TileFarm::run() {
+    using clock = std::chrono::steady_clock;
+    const io::ImageDTO& cfg = renderer_.config();
+    const HelloMsg expected = make_hello(renderer_);
+
+    // Only the crop window is handed out; the rest of the frame stays black
+    const Renderer::Rect window = renderer_.render_window();
+    std::vector<TileMsg> tiles;
+    for (int y = window.y0; y < window.y1; y += options_.tile_size) {
+        for (int x = window.x0; x < window.x1; x += options_.tile_size) {
+            tiles.push_back({static_cast<std::int32_t>(tiles.size()), x, y,
+                             std::min(x + options_.tile_size, window.x1),
+                             std::min(y + options_.tile_size, window.y1)});
+        }
+    }
+
+    Image image(cfg.width, cfg.height);
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<int> queue;
+    for (const TileMsg& t : tiles) {
+        queue.push_back(t.id);
+    }
+    std::size_t remaining = tiles.size();
+    int live_workers = 0;
+    auto last_activity = clock::now();
+    std::atomic<bool> stopping{false};
+    requeued_ = 0;
+
+    std::cout << "Tile farm: " << tiles.size() << " tiles of " << options_.tile_size << "px on port "
+              << port() << std::endl;
+
+    // One thread per connected worker: hand out a tile, wait for its pixels, repeat
+    auto serve = [&](Socket conn, int worker_id) {
+        try {
+            if (recv_type(conn, options_.tile_timeout_ms) != kHello) {
+                return;
+            }
+            HelloMsg hello{};
+            conn.recv_all(&hello, sizeof(hello), options_.tile_timeout_ms);
+            if (hello.magic != expected.magic || hello.version != expected.version ||
+                hello.width != expected.width || hello.height != expected.height ||
+                hello.samples != expected.samples || hello.max_depth != expected.max_depth) {
+                std::cerr << "Tile farm: rejecting worker " << worker_id
+                          << " (different image settings)" << std::endl;
+                send_message(conn, kReject);
+                return;
+            }
+            if (hello.scene_digest != expected.scene_digest) {
+                std::cerr << "Tile farm: rejecting worker " << worker_id
+                          << " (different scene)" << std::endl;
+                send_message(conn, kReject);
+                return;
+            }
+        } catch (const std::exception&) {
+            return;
+        }
+
+        {
+            std::scoped_lock lock(mtx);
+            ++live_workers;
+            last_activity = clock::now();
+        }
+        int current = -1;
+        try {
+            for (;;) {
+                {
+                    std::unique_lock lock(mtx);
+                    cv.wait(lock, [&] { return !queue.empty() || remaining == 0; });
+                    if (remaining == 0) {
+                        break;
+                    }
+                    current = queue.front();
+                    queue.pop_front();
+                }
+                const TileMsg& tile = tiles[static_cast<std::size_t>(current)];
+                send_message(conn, kTile, tile);
+
+                if (recv_type(conn, options_.tile_timeout_ms) != kResult) {
+                    throw std::runtime_error("unexpected message");
+                }
+                ResultMsg result{};
+                conn.recv_all(&result, sizeof(result), options_.tile_timeout_ms);
+                const int w = tile.x1 - tile.x0;
+                const int h = tile.y1 - tile.y0;
+                if (result.id != tile.id ||
+                    result.pixel_count != static_cast<std::uint32_t>(w * h)) {
+                    throw std::runtime_error("result does not match tile");
+                }
+                std::vector<float> rgb(3 * result.pixel_count);
+                conn.recv_all(rgb.data(), rgb.size() * sizeof(float), options_.tile_timeout_ms);
+
+                // Tiles never overlap, so the pixels can be stored without the lock
+                std::size_t i = 0;
+                for (int y = tile.y0; y < tile.y1; ++y) {
+                    for (int x = tile.x0; x < tile.x1; ++x, ++i) {
+                        image.SetPixel(x, y, Color(rgb[3 * i], rgb[3 * i + 1], rgb[3 * i + 2]));
+                    }
+                }
+                {
+                    std::scoped_lock lock(mtx);
+                    current = -1;
+                    --remaining;
+                    last_activity = clock::now();
+                }
+                cv.notify_all();
+            }
+            send_message(conn, kDone);
+        } catch (const std::exception& e) {
+            std::scoped_lock lock(mtx);
+            std::cerr << "Tile farm: lost worker " << worker_id << " (" << e.what() << ")";
+            if (current >= 0) {
+                queue.push_front(current);
+                ++requeued_;
+                std::cerr << ", re-queuing tile " << current;
+            }
+            std::cerr << std::endl;
+        }
+        {
+            std::scoped_lock lock(mtx);
+            --live_workers;
+            last_activity = clock::now();
+        }
+        cv.notify_all();
+    };
+
+    std::vector<std::thread> handlers;
+    std::thread acceptor([&] {
+        int next_id = 0;
+        while (!stopping.load()) {
+            Socket conn;
+            try {
+                conn = listener_.accept(100);
+            } catch (const std::exception&) {
+                continue;
+            }
+            if (conn.valid()) {
+                std::scoped_lock lock(mtx);
+                handlers.emplace_back(serve, std::move(conn), next_id++);
+            }
+        }
+    });
+
+    // Wait for the workers; with none connected for a while, render the queue locally
+    std::unique_ptr<ThreadPool> local_pool;
+    {
+        std::unique_lock lock(mtx);
+        while (remaining > 0) {
+            cv.wait_for(lock, std::chrono::milliseconds(100));
+            if (live_workers > 0 || queue.empty() ||
+                clock::now() - last_activity < std::chrono::milliseconds(options_.idle_timeout_ms)) {
+                continue;
+            }
+            const TileMsg tile = tiles[static_cast<std::size_t>(queue.front())];
+            queue.pop_front();
+            lock.unlock();
+            if (!local_pool) {
+                std::cout << "Tile farm: no worker connected, rendering locally" << std::endl;
+                local_pool = std::make_unique<ThreadPool>(static_cast<unsigned>(cfg.threads));
+            }
+            renderer_.render_region(*local_pool, tile.x0, tile.y0, tile.x1, tile.y1);
+            for (int y = tile.y0; y < tile.y1; ++y) {
+                for (int x = tile.x0; x < tile.x1; ++x) {
+                    image.SetPixel(x, y, renderer_.image().GetPixel(x, y));
+                }
+            }
+            lock.lock();
+            --remaining;
+        }
+    }
+    cv.notify_all();
+
+    stopping.store(true);
+    acceptor.join();
+    for (std::thread& t : handlers) {
+        t.join();
+    }
+    std::cout << "Tile farm: frame assembled (" << requeued_ << " tiles re-queued)" << std::endl;
+    return image;
+}
+
+// ------------------------ Worker --------------------------------------------
+
+void run_farm_worker(const std::string& host, int port, Renderer& renderer, unsigned threads) {
+    const io::ImageDTO& cfg = renderer.config();
+
+    // The coordinator may still be starting up
+    Socket conn;
+    for (int attempt = 0;; ++attempt) {
+        try {
+            conn = Socket::connect(host, port);
+            break;
+        } catch (const std::exception&) {
+            if (attempt >= 50) {
+                throw;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+    }
+    send_message(conn, kHello, make_hello(renderer));
+
+    ThreadPool pool(threads);
+    std::vector<float> rgb;
+    for (;;) {
+        const std::uint32_t type = recv_type(conn, -1);
+        if (type == kDone) {
+            return;
+        }
+        if (type == kReject) {
+            throw std::runtime_error(
+                "Coordinator rejected the worker: image settings or scene differ");
+        }
+        if (type != kTile) {
+            throw std::runtime_error("Unexpected message from the coordinator");
+        }
+        TileMsg tile{};
+        conn.recv_all(&tile, sizeof(tile));
+        if (tile.x0 < 0 || tile.y0 < 0 || tile.x1 > cfg.width || tile.y1 > cfg.height ||
+            tile.x0 >= tile.x1 || tile.y0 >= tile.y1) {
+            throw std::runtime_error("Coordinator sent a tile outside the frame");
+        }
+
+        renderer.render_region(pool, tile.x0, tile.y0, tile.x1, tile.y1);
+        rgb.clear();
+        for (int y = tile.y0; y < tile.y1; ++y) {
+            for (int x = tile.x0; x < tile.x1; ++x) {
+                const Color c = renderer.image().GetPixel(x, y);
+                rgb.insert(rgb.end(), {c.R(), c.G(), c.B()});
+            }
+        }
+        const ResultMsg result{tile.id, static_cast<std::uint32_t>(rgb.size() / 3)};
+        send_message(conn, kResult, result);
+        conn.send_all(rgb.data(), rgb.size() * sizeof(float));
+    }
+}
+
+}  // namespace raylabs
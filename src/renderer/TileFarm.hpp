@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "image/Image.hpp"
+#include "utils/Socket.hpp"
+
+class Camera;
+class Scene;
+
+namespace raylabs {
+
+class Renderer;
+
+/// Settings of the tile farm coordinator
+struct FarmOptions {
+    int port = 0;              // TCP port workers connect to (0 = any free port)
+    int tile_size = 64;        // edge of the tiles handed out
+    int tile_timeout_ms = 120000;  // a worker silent for this long on a tile counts as failed
+    int idle_timeout_ms = 10000;   // no worker connected for this long: render locally
+};
+
+/// Coordinator of a multi-process render.
+/// Splits the frame into tiles and hands them out over TCP to worker processes, each
+/// running the usual Renderer on its own copy of the scene, then reassembles the returned
+/// pixels. Tiles of a worker that disconnects, errors or times out go back to the queue.
+/// Workers may join at any time (see run_farm_worker()); local ones are forked from the
+/// coordinator so they share the scene it already loaded.
+///
+/// Wire format (native byte order, one frame per message): a 32-bit message type followed by
+/// its fields. Worker hello {magic, version, width, height, samples, max_depth, 64-bit
+/// scene_digest()}, coordinator tile {id, x0, y0, x1, y1} or done, worker result {id, pixel
+/// count, RGB floats}. Workers whose hello differs from the coordinator's are rejected.
+class TileFarm {
+   public:
+    /// Start listening. The renderer provides the frame settings and renders tiles itself
+    /// if no worker is left.
+    TileFarm(Renderer& renderer, const FarmOptions& options);
+    ~TileFarm();
+
+    TileFarm(const TileFarm&) = delete;
+    TileFarm& operator=(const TileFarm&) = delete;
+
+    /// Port the workers must connect to
+    int port() const { return listener_.local_port(); }
+
+    /// Fork `count` worker processes connected to this coordinator over localhost, each
+    /// rendering with `threads_per_worker` threads. Must be called before run().
+    void spawn_local_workers(int count, int threads_per_worker);
+
+    /// Distribute every tile of the renderer's crop window (the whole frame without one) and
+    /// block until they are all assembled into a full-size frame
+    Image run();
+
+    /// Tiles that had to be handed out again after a worker failure (last run)
+    int requeued_tiles() const { return requeued_; }
+
+   private:
+    Renderer& renderer_;
+    FarmOptions options_;
+    Socket listener_;
+    std::vector<int> children_;
+    int requeued_ = 0;
+};
+
+/// Hash of what a worker must have loaded like the coordinator: the bounds of every entity,
+/// the kind and diffuse color of its material, the lights and the camera. Computed from the
+/// scene in memory, so files it includes (meshes, JSON includes) count too.
+std::uint64_t scene_digest(const Scene& scene, const Camera& camera);
+
+/// Worker side: connect to a coordinator, render the tiles it sends with `renderer` (whose
+/// scene and image settings must match the coordinator's) until told to stop.
+/// Throws std::runtime_error if the connection fails or the coordinator rejects the worker.
+void run_farm_worker(const std::string& host, int port, Renderer& renderer, unsigned threads);
+
+}  // namespace raylabs
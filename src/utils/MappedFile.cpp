@@ -0,0 +1,54 @@
+#include "utils/MappedFile.hpp"
+
+#include <fstream>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace raylabs {
+
+std::shared_ptr<const void> map_file(const std::string& path, std::size_t& size,
+                                     std::size_t alignment) {
+#ifndef _WIN32
+    (void)alignment;  // mappings start on a page boundary
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    size = static_cast<std::size_t>(st.st_size);
+    void* data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // the mapping keeps the file open
+    if (data == MAP_FAILED)
+        return nullptr;
+    return std::shared_ptr<const void>(data, [size](const void* p) {
+        ::munmap(const_cast<void*>(p), size);
+    });
+#else
+    // No mapping here: read the file into an aligned buffer
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+        return nullptr;
+    size = static_cast<std::size_t>(in.tellg());
+    if (size == 0)
+        return nullptr;
+    void* data = ::operator new(size, std::align_val_t(alignment));
+    std::shared_ptr<const void> owner(data, [alignment](const void* p) {
+        ::operator delete(const_cast<void*>(p), std::align_val_t(alignment));
+    });
+    in.seekg(0);
+    if (!in.read(static_cast<char*>(data), static_cast<std::streamsize>(size)))
+        return nullptr;
+    return owner;
+#endif
+}
+
+}  // namespace raylabs
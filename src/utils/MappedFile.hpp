@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace raylabs {
+
+/// Read-only view of a whole file: mapped (mmap) on POSIX systems, read into a buffer aligned
+/// to `alignment` bytes elsewhere. `size` receives the file size; the data stays valid while
+/// the returned owner lives, so FlatArray::borrow() can hand it out. Returns nullptr if the
+/// file cannot be opened or is empty.
+std::shared_ptr<const void> map_file(const std::string& path, std::size_t& size,
+                                     std::size_t alignment = 64);
+
+}  // namespace raylabs
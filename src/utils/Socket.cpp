@@ -0,0 +1,206 @@
+#include "utils/Socket.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace raylabs {
+
+#ifndef _WIN32
+
+namespace {
+
+std::runtime_error socket_error(const std::string& what) {
+    return std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+/// Wait until fd is readable; false on timeout
+bool wait_readable(int fd, int timeout_ms) {
+    pollfd p{fd, POLLIN, 0};
+    for (;;) {
+        const int r = ::poll(&p, 1, timeout_ms);
+        if (r >= 0)
+            return r > 0;
+        if (errno != EINTR)
+            throw socket_error("poll");
+    }
+}
+
+}  // namespace
+
+Socket::~Socket() {
+    close();
+}
+
+Socket::Socket(Socket&& other) noexcept : fd_(std::exchange(other.fd_, -1)) {}
+
+Socket& Socket::operator=(Socket&& other) noexcept {
+    if (this != &other) {
+        close();
+        fd_ = std::exchange(other.fd_, -1);
+    }
+    return *this;
+}
+
+void Socket::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+Socket Socket::connect(const std::string& host, int port) {
+    addrinfo hints{};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = nullptr;
+    const std::string service = std::to_string(port);
+    if (const int err = ::getaddrinfo(host.c_str(), service.c_str(), &hints, &result); err != 0) {
+        throw std::runtime_error("Cannot resolve " + host + ": " + ::gai_strerror(err));
+    }
+    Socket s(::socket(AF_INET, SOCK_STREAM, 0));
+    if (!s.valid()) {
+        ::freeaddrinfo(result);
+        throw socket_error("socket");
+    }
+    const int rc = ::connect(s.fd_, result->ai_addr, result->ai_addrlen);
+    ::freeaddrinfo(result);
+    if (rc != 0) {
+        throw socket_error("Cannot connect to " + host + ":" + service);
+    }
+    const int one = 1;
+    ::setsockopt(s.fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return s;
+}
+
+Socket Socket::listen(int port, int backlog) {
+    Socket s(::socket(AF_INET, SOCK_STREAM, 0));
+    if (!s.valid()) {
+        throw socket_error("socket");
+    }
+    const int one = 1;
+    ::setsockopt(s.fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(static_cast<std::uint16_t>(port));
+    if (::bind(s.fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        throw socket_error("Cannot bind port " + std::to_string(port));
+    }
+    if (::listen(s.fd_, backlog) != 0) {
+        throw socket_error("listen");
+    }
+    return s;
+}
+
+Socket Socket::accept(int timeout_ms) const {
+    if (!wait_readable(fd_, timeout_ms)) {
+        return Socket();
+    }
+    Socket client(::accept(fd_, nullptr, nullptr));
+    if (!client.valid()) {
+        throw socket_error("accept");
+    }
+    const int one = 1;
+    ::setsockopt(client.fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return client;
+}
+
+int Socket::local_port() const {
+    sockaddr_in addr{};
+    socklen_t len = sizeof(addr);
+    if (::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        throw socket_error("getsockname");
+    }
+    return ntohs(addr.sin_port);
+}
+
+void Socket::send_all(const void* data, std::size_t size) const {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        // MSG_NOSIGNAL: a dead peer raises an error here instead of SIGPIPE
+        const ssize_t n = ::send(fd_, p, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            throw socket_error("send");
+        }
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+}
+
+void Socket::recv_all(void* data, std::size_t size, int timeout_ms) const {
+    char* p = static_cast<char*>(data);
+    while (size > 0) {
+        if (!wait_readable(fd_, timeout_ms)) {
+            throw std::runtime_error("Timed out waiting for the peer");
+        }
+        const ssize_t n = ::recv(fd_, p, size, 0);
+        if (n == 0) {
+            throw std::runtime_error("Connection closed by the peer");
+        }
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            throw socket_error("recv");
+        }
+        p += n;
+        size -= static_cast<std::size_t>(n);
+    }
+}
+
+#else  // _WIN32
+
+namespace {
+
+[[noreturn]] void unsupported() {
+    throw std::runtime_error("TCP sockets are only implemented for POSIX systems");
+}
+
+}  // namespace
+
+Socket::~Socket() = default;
+Socket::Socket(Socket&& other) noexcept : fd_(std::exchange(other.fd_, -1)) {}
+Socket& Socket::operator=(Socket&& other) noexcept {
+    fd_ = std::exchange(other.fd_, -1);
+    return *this;
+}
+void Socket::close() {
+    fd_ = -1;
+}
+Socket Socket::connect(const std::string&, int) {
+    unsupported();
+}
+Socket Socket::listen(int, int) {
+    unsupported();
+}
+Socket Socket::accept(int) const {
+    unsupported();
+}
+int Socket::local_port() const {
+    unsupported();
+}
+void Socket::send_all(const void*, std::size_t) const {
+    unsupported();
+}
+void Socket::recv_all(void*, std::size_t, int) const {
+    unsupported();
+}
+
+#endif
+
+}  // namespace raylabs
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace raylabs {
+
+/// Minimal blocking TCP socket (POSIX), owning its file descriptor.
+/// Every failure throws std::runtime_error; a peer that closes the connection counts as one.
+class Socket {
+   public:
+    Socket() = default;
+    explicit Socket(int fd) : fd_(fd) {}
+    ~Socket();
+
+    Socket(Socket&& other) noexcept;
+    Socket& operator=(Socket&& other) noexcept;
+    Socket(const Socket&) = delete;
+    Socket& operator=(const Socket&) = delete;
+
+    /// Connect to host:port (IPv4 name or address)
+    static Socket connect(const std::string& host, int port);
+
+    /// Listen on every interface; port 0 picks a free port (see local_port())
+    static Socket listen(int port, int backlog = 16);
+
+    /// Wait up to timeout_ms for an incoming connection; an invalid socket on timeout
+    Socket accept(int timeout_ms) const;
+
+    /// Port the socket is bound to
+    int local_port() const;
+
+    /// Write the whole buffer
+    void send_all(const void* data, std::size_t size) const;
+
+    /// Read exactly `size` bytes, waiting at most timeout_ms for each chunk (-1 = forever)
+    void recv_all(void* data, std::size_t size, int timeout_ms = -1) const;
+
+    bool valid() const { return fd_ >= 0; }
+    int fd() const { return fd_; }
+    void close();
+
+   private:
+    int fd_ = -1;
+};
+
+}  // namespace raylabs
@@ -0,0 +1,192 @@
+#include "utils/ThreadPool.hpp"
+
+#include <algorithm>
+#include <exception>
+
+namespace raylabs {
+
+namespace {
+
+// Identifies the pool (and queue) the current thread works for, if any.
+thread_local const ThreadPool* tls_pool = nullptr;
+thread_local unsigned tls_queue = 0;
+
+}  // namespace
+
+unsigned ThreadPool::default_thread_count() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1u : n;
+}
+
+ThreadPool::ThreadPool(unsigned thread_count) {
+    if (thread_count == 0) {
+        thread_count = default_thread_count();
+    }
+    queues_.reserve(thread_count);
+    for (unsigned i = 0; i < thread_count; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    workers_.reserve(thread_count - 1);
+    for (unsigned i = 1; i < thread_count; ++i) {
+        workers_.emplace_back([this, i] { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::scoped_lock lock(wake_mtx_);
+        stopping_ = true;
+    }
+    wake_cv_.notify_all();
+    for (auto& t : workers_) {
+        t.join();
+    }
+}
+
+unsigned ThreadPool::current_queue() const {
+    return tls_pool == this ? tls_queue : 0u;
+}
+
+void ThreadPool::submit(Task task) {
+    Queue& q = *queues_[current_queue()];
+    {
+        std::scoped_lock lock(q.mtx);
+        q.tasks.push_back(std::move(task));
+    }
+    pending_.fetch_add(1, std::memory_order_release);
+    {
+        // Taking the lock orders the increment before any sleeping worker re-checks it.
+        std::scoped_lock lock(wake_mtx_);
+    }
+    wake_cv_.notify_one();
+}
+
+bool ThreadPool::try_pop(unsigned self, Task& out) {
+    if (pending_.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    const unsigned n = size();
+    // Own queue first, newest task (best cache reuse) ...
+    {
+        Queue& q = *queues_[self];
+        std::scoped_lock lock(q.mtx);
+        if (!q.tasks.empty()) {
+            out = std::move(q.tasks.back());
+            q.tasks.pop_back();
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    // ... then steal the oldest task of a victim.
+    for (unsigned k = 1; k < n; ++k) {
+        Queue& q = *queues_[(self + k) % n];
+        std::scoped_lock lock(q.mtx);
+        if (!q.tasks.empty()) {
+            out = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::run_one() {
+    Task task;
+    if (!try_pop(current_queue(), task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void ThreadPool::worker_loop(unsigned index) {
+    tls_pool = this;
+    tls_queue = index;
+    for (;;) {
+        Task task;
+        if (try_pop(index, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock lock(wake_mtx_);
+        wake_cv_.wait(lock, [this] {
+            return stopping_ || pending_.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping_) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::parallel_for(std::size_t count, const std::function<void(std::size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    if (size() == 1 || count == 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            body(i);
+        }
+        return;
+    }
+
+    struct Shared {
+        std::atomic<std::size_t> remaining;
+        std::mutex error_mtx;
+        std::exception_ptr error;
+    };
+    auto shared = std::make_shared<Shared>();
+    shared->remaining.store(count, std::memory_order_relaxed);
+
+    auto make_task = [&body, shared](std::size_t i) {
+        return [&body, shared, i] {
+            try {
+                body(i);
+            } catch (...) {
+                std::scoped_lock lock(shared->error_mtx);
+                if (!shared->error) {
+                    shared->error = std::current_exception();
+                }
+            }
+            shared->remaining.fetch_sub(1, std::memory_order_acq_rel);
+        };
+    };
+
+    // Deal contiguous blocks to each queue so neighbouring iterations stay on one thread
+    // unless they get stolen.
+    const unsigned n = size();
+    const unsigned self = current_queue();
+    for (unsigned k = 0; k < n; ++k) {
+        const unsigned qi = (self + k) % n;
+        const std::size_t begin = count * k / n;
+        const std::size_t end = count * (k + 1) / n;
+        if (begin == end) {
+            continue;
+        }
+        Queue& q = *queues_[qi];
+        {
+            std::scoped_lock lock(q.mtx);
+            // Pushed in reverse so the owner's LIFO pops walk the block in order.
+            for (std::size_t i = end; i-- > begin;) {
+                q.tasks.push_back(make_task(i));
+            }
+        }
+        pending_.fetch_add(end - begin, std::memory_order_release);
+    }
+    {
+        std::scoped_lock lock(wake_mtx_);
+    }
+    wake_cv_.notify_all();
+
+    while (shared->remaining.load(std::memory_order_acquire) > 0) {
+        if (!run_one()) {
+            std::this_thread::yield();
+        }
+    }
+
+    if (shared->error) {
+        std::rethrow_exception(shared->error);
+    }
+}
+
+}  // namespace raylabs
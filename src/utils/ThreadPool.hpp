@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace raylabs {
+
+/// Work-stealing thread pool.
+/// Every participant owns a deque: it pops its own tasks LIFO and steals FIFO from the
+/// others when it runs dry. The thread calling parallel_for() takes part in the work, so a
+/// pool of N threads spawns N - 1 workers and uses queue 0 for external callers.
+class ThreadPool {
+   public:
+    using Task = std::function<void()>;
+
+    /// Create a pool of thread_count threads (0 = hardware concurrency)
+    explicit ThreadPool(unsigned thread_count = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Number of threads taking part in parallel_for (workers + caller)
+    unsigned size() const noexcept { return static_cast<unsigned>(queues_.size()); }
+
+    /// Queue a task; from inside a worker it lands on that worker's own deque
+    void submit(Task task);
+
+    /// Run body(i) for every i in [0, count) and block until all iterations are done.
+    /// Iterations are dealt out in contiguous blocks, one block per queue, and balanced by
+    /// stealing. Safe to call from inside a task (the waiting thread keeps executing work).
+    /// The first exception thrown by body is rethrown once every iteration has finished.
+    void parallel_for(std::size_t count, const std::function<void(std::size_t)>& body);
+
+    /// Pop (or steal) one queued task and run it. Returns false if no task was found.
+    bool run_one();
+
+    /// std::thread::hardware_concurrency() with a floor of 1
+    static unsigned default_thread_count();
+
+   private:
+    struct Queue {
+        std::mutex mtx;
+        std::deque<Task> tasks;
+    };
+
+    void worker_loop(unsigned index);
+    bool try_pop(unsigned self, Task& out);
+    unsigned current_queue() const;
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<std::size_t> pending_{0};
+    std::mutex wake_mtx_;
+    std::condition_variable wake_cv_;
+    bool stopping_ = false;
+};
+
+}  // namespace raylabs
@@ -0,0 +1,724 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "accel/Accelerator.hpp"
+#include "accel/Bvh.hpp"
+#include "accel/BvhCache.hpp"
+#include "accel/QuantizedBvh.hpp"
+#include "accel/WideBvh.hpp"
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
+#include "core/RayPacket.hpp"
+#include "core/Scene.hpp"
+#include "entities/Plane.hpp"
+#include "entities/Sphere.hpp"
+#include "entities/Triangle.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace {
+
+/// Random spheres and triangles in a 20-unit cube above a ground plane
+void fill_scene(Scene& scene, int count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> pos(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> size(0.05f, 0.6f);
+    scene.add(std::make_shared<Plane>(Point3(0, -11, 0), Vec3(0, 1, 0)));
+    for (int i = 0; i < count; ++i) {
+        const Point3 p(pos(rng), pos(rng), pos(rng));
+        if (i % 3 == 0) {
+            scene.add(std::make_shared<Triangle>(p, p + Vec3(size(rng), 0, 0),
+                                                 p + Vec3(0, size(rng), size(rng))));
+        } else {
+            scene.add(std::make_shared<Sphere>(p, size(rng)));
+        }
+    }
+}
+
+std::vector<Ray> random_rays(int count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    std::vector<Ray> rays;
+    for (int i = 0; i < count; ++i) {
+        rays.emplace_back(Point3(12.0f * u(rng), 12.0f * u(rng), 12.0f * u(rng)),
+                          Vec3(u(rng), u(rng), u(rng)));
+    }
+    return rays;
+}
+
+}  // namespace
+
+TEST_CASE("Shapes report their bounds; planes are unbounded") {
+    const raylabs::Aabb s = Sphere(Point3(1, 2, 3), 0.5f).bounds();
+    CHECK(s.min.x == doctest::Approx(0.5f));
+    CHECK(s.max.z == doctest::Approx(3.5f));
+    const raylabs::Aabb t = Triangle(Point3(0, 0, 0), Point3(2, 0, 0), Point3(0, 1, -1)).bounds();
+    CHECK(t.max.x == 2.0f);
+    CHECK(t.min.z == -1.0f);
+    CHECK(s.is_bounded());
+    CHECK_FALSE(Plane(Point3(0, 0, 0), Vec3(0, 1, 0)).bounds().is_bounded());
+}
+
+TEST_CASE("BVH closest hits match the linear scan") {
+    Scene linear;
+    Scene accelerated;
+    fill_scene(linear, 3000, 7);
+    fill_scene(accelerated, 3000, 7);
+    accelerated.build_acceleration();
+    REQUIRE(accelerated.accelerated());
+    CHECK_FALSE(linear.accelerated());
+    CHECK(accelerated.bvh().primitive_count() == 3000);  // the plane stays outside
+
+    int hits = 0;
+    for (const Ray& ray : random_rays(2000, 11)) {
+        HitRecord expected{};
+        HitRecord rec{};
+        const bool found = linear.hit(ray, 0.001f, 1e9f, expected);
+        REQUIRE(accelerated.hit(ray, 0.001f, 1e9f, rec) == found);
+        if (found) {
+            ++hits;
+            CHECK(rec.t == expected.t);
+            CHECK(rec.normal.x == expected.normal.x);
+        }
+    }
+    CHECK(hits > 100);
+
+    // Adding an entity invalidates the hierarchy until it is rebuilt
+    accelerated.add(std::make_shared<Sphere>(Point3(0, 0, 0), 1.0f));
+    CHECK_FALSE(accelerated.accelerated());
+}
+
+TEST_CASE("Wide BVHs give the same closest hits as the binary one") {
+    Scene binary;
+    fill_scene(binary, 3000, 5);
+    raylabs::Bvh::BuildOptions options;
+    options.width = 2;
+    binary.build_acceleration(options);
+    const std::vector<Ray> rays = random_rays(2000, 13);
+
+    for (int width : {4, 8}) {
+        Scene wide;
+        fill_scene(wide, 3000, 5);
+        options.width = width;
+        wide.build_acceleration(options);
+        REQUIRE(wide.bvh_width() == width);
+        for (const Ray& ray : rays) {
+            HitRecord expected{};
+            HitRecord rec{};
+            const bool found = binary.hit(ray, 0.001f, 1e9f, expected);
+            REQUIRE(wide.hit(ray, 0.001f, 1e9f, rec) == found);
+            if (found)
+                CHECK(rec.t == expected.t);
+        }
+    }
+
+    options.width = 3;
+    CHECK_THROWS_AS(binary.build_acceleration(options), std::runtime_error);
+}
+
+TEST_CASE("Collapsing keeps every leaf and fills the nodes") {
+    std::vector<raylabs::Aabb> boxes;
+    for (int i = 0; i < 1000; ++i) {
+        const float x = float(i % 10);
+        const float y = float((i / 10) % 10);
+        const float z = float(i / 100);
+        boxes.emplace_back(Point3(x, y, z), Point3(x + 0.5f, y + 0.5f, z + 0.5f));
+    }
+    raylabs::Bvh bvh;
+    bvh.build(boxes);
+    raylabs::WideBvh<4> wide;
+    wide.build(bvh);
+
+    std::size_t referenced = 0;
+    std::size_t slots = 0;
+    for (const auto& node : wide.nodes()) {
+        CHECK(node.children >= 2);
+        CHECK(node.children <= 4);
+        slots += node.children;
+        for (std::uint32_t i = 0; i < node.children; ++i)
+            referenced += node.count[i];
+    }
+    CHECK(referenced == boxes.size());
+    // A slot holds either a binary leaf or another wide node (every node but the root)
+    std::size_t leaves = 0;
+    for (const auto& node : bvh.nodes())
+        leaves += node.is_leaf() ? 1 : 0;
+    CHECK(slots == leaves + wide.nodes().size() - 1);
+    CHECK(wide.nodes().size() * 2 < bvh.nodes().size());
+
+    // A tree that is a single leaf still works
+    raylabs::Bvh tiny;
+    tiny.build({raylabs::Aabb(Point3(0, 0, 0), Point3(1, 1, 1))});
+    raylabs::WideBvh<8> tiny_wide;
+    tiny_wide.build(tiny);
+    float t_max = 100.0f;
+    const bool hit = tiny_wide.intersect(Ray(Point3(0.5f, 0.5f, -5), Vec3(0, 0, 1)), 0.0f, t_max,
+                                         [](std::uint32_t index, float& t) {
+                                             t = 5.0f;
+                                             return index == 0;
+                                         });
+    CHECK(hit);
+    CHECK(t_max == 5.0f);
+}
+
+TEST_CASE("Quantized BVHs keep every child box and the closest hits") {
+    // Boxes far from the origin, some of them flat, so the grids need small steps
+    std::mt19937 rng(37);
+    std::uniform_real_distribution<float> pos(1000.0f, 1010.0f);
+    std::uniform_real_distribution<float> size(0.0f, 0.05f);
+    std::vector<raylabs::Aabb> boxes;
+    for (int i = 0; i < 2000; ++i) {
+        const Point3 p(pos(rng), pos(rng), pos(rng));
+        boxes.emplace_back(p, p + Vec3(size(rng), i % 4 == 0 ? 0.0f : size(rng), size(rng)));
+    }
+    raylabs::Bvh bvh;
+    bvh.build(boxes);
+    raylabs::WideBvh<4> wide;
+    wide.build(bvh);
+    raylabs::QuantizedBvh<4> quantized;
+    REQUIRE(quantized.build(wide));
+    CHECK(quantized.nodes().size() == wide.nodes().size());
+    CHECK(quantized.indices().size() == wide.indices().size());
+    CHECK(3 * quantized.memory_bytes() < 2 * wide.memory_bytes());
+
+    // Walk both trees together: every decoded child box contains the full-precision one
+    using Q = raylabs::QuantizedBvh<4>;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> stack{{0, 0}};
+    std::size_t leaves = 0;
+    bool contained = true;
+    while (!stack.empty()) {
+        const auto [qi, wi] = stack.back();
+        stack.pop_back();
+        const Q::Node& q = quantized.nodes()[qi];
+        const auto& w = wide.nodes()[wi];
+        REQUIRE(q.children == w.children);
+        const float sx = Q::step(q.exponent[0]), sy = Q::step(q.exponent[1]),
+                    sz = Q::step(q.exponent[2]);
+        for (std::uint32_t i = 0; i < w.children; ++i) {
+            contained = contained && q.origin[0] + float(q.lo_x[i]) * sx <= w.min_x[i] &&
+                        q.origin[1] + float(q.lo_y[i]) * sy <= w.min_y[i] &&
+                        q.origin[2] + float(q.lo_z[i]) * sz <= w.min_z[i] &&
+                        q.origin[0] + float(q.hi_x[i]) * sx >= w.max_x[i] &&
+                        q.origin[1] + float(q.hi_y[i]) * sy >= w.max_y[i] &&
+                        q.origin[2] + float(q.hi_z[i]) * sz >= w.max_z[i];
+            REQUIRE(q.count[i] == w.count[i]);
+            if (w.count[i] == 0) {
+                stack.push_back({q.child_base + q.offset[i], w.child[i]});
+            } else {
+                ++leaves;
+                for (std::uint32_t k = 0; k < w.count[i]; ++k) {
+                    contained = contained && quantized.indices()[q.prim_base + q.offset[i] + k] ==
+                                                 wide.indices()[w.child[i] + k];
+                }
+            }
+        }
+    }
+    CHECK(contained);
+    CHECK(leaves > 0);
+
+    // Scenes traversing quantized nodes find the same closest hits
+    Scene binary;
+    fill_scene(binary, 3000, 7);
+    raylabs::Bvh::BuildOptions options;
+    options.width = 2;
+    binary.build_acceleration(options);
+    options.quantized = true;
+    CHECK_THROWS_AS(binary.build_acceleration(options), std::runtime_error);
+    for (int width : {4, 8}) {
+        Scene compressed;
+        fill_scene(compressed, 3000, 7);
+        options.width = width;
+        compressed.build_acceleration(options);
+        REQUIRE(compressed.bvh_quantized());
+        // The binary tree stays for packets and updates, and counts
+        CHECK(compressed.acceleration_bytes() ==
+              compressed.bvh().memory_bytes() + compressed.traversal_bytes());
+        for (const Ray& ray : random_rays(2000, 39)) {
+            HitRecord expected{};
+            HitRecord rec{};
+            const bool found = binary.hit(ray, 0.001f, 1e9f, expected);
+            REQUIRE(compressed.hit(ray, 0.001f, 1e9f, rec) == found);
+            if (found)
+                CHECK(rec.t == expected.t);
+        }
+    }
+}
+
+TEST_CASE("Spatial splits clip slivers, keep the closest hits and respect the budget") {
+    // Clipping a triangle keeps only the part inside the box
+    const Triangle diagonal(Point3(0, 0, 0), Point3(4, 4, 0), Point3(4, 4, 0.1f));
+    const raylabs::Aabb corner = diagonal.clipped_bounds(
+        raylabs::Aabb(Point3(-1, -1, -1), Point3(1, 4, 1)));
+    CHECK(corner.max.x == doctest::Approx(1.0f));
+    CHECK(corner.max.y == doctest::Approx(1.0f));
+    CHECK(diagonal.clipped_bounds(raylabs::Aabb(Point3(3, 0, -1), Point3(4, 1, 1))).is_empty());
+
+    // Long thin triangles in every direction
+    auto slivers = [](Scene& scene) {
+        std::mt19937 rng(31);
+        std::uniform_real_distribution<float> pos(-10.0f, 10.0f);
+        std::uniform_real_distribution<float> span(-6.0f, 6.0f);
+        for (int i = 0; i < 2000; ++i) {
+            const Point3 a(pos(rng), pos(rng), pos(rng));
+            const Point3 b = a + Vec3(span(rng), span(rng), span(rng));
+            scene.add(std::make_shared<Triangle>(a, b, a + Vec3(0.05f, 0.1f, 0.0f)));
+        }
+    };
+    Scene plain;
+    slivers(plain);
+    raylabs::Bvh::BuildOptions options;
+    options.width = 2;
+    plain.build_acceleration(options);
+
+    Scene split;
+    slivers(split);
+    options.spatial_split_budget = 0.3f;
+    split.build_acceleration(options);
+    CHECK(split.bvh().primitive_count() > 2000);
+    CHECK(split.bvh().primitive_count() <= 2600);
+    CHECK(split.bvh().sah_cost(options) < plain.bvh().sah_cost(options));
+
+    int hits = 0;
+    for (const Ray& ray : random_rays(2000, 37)) {
+        HitRecord expected{};
+        HitRecord rec{};
+        const bool found = plain.hit(ray, 0.001f, 1e9f, expected);
+        REQUIRE(split.hit(ray, 0.001f, 1e9f, rec) == found);
+        CHECK(split.occluded(ray, 0.001f, 1e9f) == found);
+        if (!found)
+            continue;
+        ++hits;
+        CHECK(rec.t == expected.t);
+    }
+    CHECK(hits > 200);
+
+    options.spatial_split_budget = -1.0f;
+    CHECK_THROWS_AS(split.build_acceleration(options), std::runtime_error);
+}
+
+TEST_CASE("Grids and kd-trees find the same closest hits as the BVH") {
+    Scene reference;
+    fill_scene(reference, 3000, 21);
+    reference.build_acceleration();
+
+    std::vector<Ray> rays = random_rays(2000, 23);
+    // Axis-aligned rays take the special cases of the DDA and of the kd-tree planes
+    for (int i = 0; i < 200; ++i) {
+        const float a = -9.5f + 0.095f * static_cast<float>(i);
+        rays.emplace_back(Point3(a, 0.37f * a, 15.0f), Vec3(0, 0, -1));
+        rays.emplace_back(Point3(-15.0f, a, -0.5f * a), Vec3(1, 0, 0));
+    }
+
+    for (raylabs::Accelerator kind : {raylabs::Accelerator::Grid, raylabs::Accelerator::KdTree}) {
+        Scene scene;
+        fill_scene(scene, 3000, 21);
+        raylabs::Bvh::BuildOptions options;
+        options.accelerator = kind;
+        scene.build_acceleration(options);
+        REQUIRE(scene.accelerator() == kind);
+        CHECK(scene.bvh().empty());
+        CHECK(scene.acceleration_bytes() > 0);
+
+        int hits = 0;
+        for (const Ray& ray : rays) {
+            HitRecord expected{};
+            HitRecord rec{};
+            const bool found = reference.hit(ray, 0.001f, 1e9f, expected);
+            REQUIRE(scene.hit(ray, 0.001f, 1e9f, rec) == found);
+            CHECK(scene.occluded(ray, 0.001f, 1e9f) == found);
+            if (!found)
+                continue;
+            ++hits;
+            CHECK(rec.t == expected.t);
+        }
+        CHECK(hits > 500);
+
+        // Packets are walked lane by lane
+        Ray lanes[8];
+        for (int i = 0; i < 8; ++i)
+            lanes[i] = rays[static_cast<std::size_t>(i) * 7];
+        const auto packet = raylabs::RayPacket<8>::from_rays(lanes, 8);
+        raylabs::PacketHit<8> hit(1e9f);
+        scene.hit_packet(packet, 0.001f, hit, raylabs::RayPacket<8>::first_lanes(8));
+        for (int lane = 0; lane < 8; ++lane) {
+            HitRecord expected{};
+            if (reference.hit(lanes[lane], 0.001f, 1e9f, expected))
+                CHECK(hit.t[lane] == expected.t);
+            else
+                CHECK(hit.entity[lane] < 0);
+        }
+
+        // Moving shapes rebuilds the structure, keeping its kind
+        scene.transform_entity(5, raylabs::Transform::translate(Vec3(0, 3, 0)));
+        reference.transform_entity(5, raylabs::Transform::translate(Vec3(0, 3, 0)));
+        CHECK(scene.update_acceleration().full_rebuild);
+        reference.update_acceleration();
+        CHECK(scene.accelerator() == kind);
+        for (std::size_t i = 0; i < 300; ++i) {
+            HitRecord expected{};
+            HitRecord rec{};
+            REQUIRE(scene.hit(rays[i], 0.001f, 1e9f, rec) ==
+                    reference.hit(rays[i], 0.001f, 1e9f, expected));
+        }
+    }
+}
+
+TEST_CASE("The automatic accelerator follows the scene statistics") {
+    std::mt19937 rng(29);
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    auto sphere_box = [](const Point3& c, float r) {
+        return raylabs::Aabb(c - Vec3(r, r, r), c + Vec3(r, r, r));
+    };
+
+    // Particles of one size filling a cube: grid
+    std::vector<raylabs::Aabb> particles;
+    for (int i = 0; i < 20000; ++i)
+        particles.push_back(sphere_box(Point3(40 * u(rng), 40 * u(rng), 40 * u(rng)), 0.1f));
+    const raylabs::SceneStatistics even = raylabs::measure_scene(particles);
+    CHECK(even.size_variation < 0.01f);
+    CHECK(even.occupancy > 0.9f);
+    CHECK(raylabs::choose_accelerator(even) == raylabs::Accelerator::Grid);
+
+    // A few dense clusters in a large, mostly empty box, and some large pieces: BVH
+    std::vector<raylabs::Aabb> sparse;
+    for (int i = 0; i < 20000; ++i) {
+        const float cx = 100.0f * static_cast<float>(i % 4);
+        sparse.push_back(sphere_box(Point3(cx + u(rng), u(rng), u(rng)), 0.01f + 0.05f * u(rng)));
+    }
+    for (int i = 0; i < 20; ++i)
+        sparse.push_back(sphere_box(Point3(300 * u(rng), 0, 0), 10.0f));
+    const raylabs::SceneStatistics clustered = raylabs::measure_scene(sparse);
+    CHECK(clustered.occupancy < 0.2f);
+    CHECK(raylabs::choose_accelerator(clustered) == raylabs::Accelerator::Bvh);
+
+    // Long primitives crossing most of the scene, overlapping everywhere: BVH
+    std::vector<raylabs::Aabb> crossing;
+    for (int i = 0; i < 5000; ++i) {
+        const Point3 a(40 * u(rng), 40 * u(rng), 40 * u(rng));
+        const Point3 b(40 * u(rng), 40 * u(rng), 40 * u(rng));
+        raylabs::Aabb box;
+        box.expand(a);
+        box.expand(b);
+        crossing.push_back(box);
+    }
+    const raylabs::SceneStatistics overlapping = raylabs::measure_scene(crossing);
+    CHECK(overlapping.overlap > 2.0f);
+    CHECK(raylabs::choose_accelerator(overlapping) == raylabs::Accelerator::Bvh);
+
+    // Small scenes keep the BVH, and a scene resolves "auto" when it builds
+    particles.resize(500);
+    CHECK(raylabs::choose_accelerator(raylabs::measure_scene(particles)) ==
+          raylabs::Accelerator::Bvh);
+    Scene scene;
+    for (int i = 0; i < 5000; ++i)
+        scene.add(std::make_shared<Sphere>(Point3(40 * u(rng), 40 * u(rng), 40 * u(rng)), 0.1f));
+    raylabs::Bvh::BuildOptions options;
+    options.accelerator = raylabs::Accelerator::Auto;
+    scene.build_acceleration(options);
+    CHECK(scene.accelerator() == raylabs::Accelerator::Grid);
+    CHECK(raylabs::accelerator_from_string("kdtree") == raylabs::Accelerator::KdTree);
+    CHECK_THROWS_AS(raylabs::accelerator_from_string("octree"), std::runtime_error);
+}
+
+TEST_CASE("BVH packet traversal matches scalar hits") {
+    Scene scene;
+    fill_scene(scene, 1000, 3);
+    scene.build_acceleration();
+
+    // Coherent fan, like camera rays
+    Ray rays[8];
+    for (int i = 0; i < 8; ++i) {
+        rays[i] = Ray(Point3(0, 0, 12), Vec3(-0.3f + 0.08f * float(i), 0.05f * float(i), -1));
+    }
+    auto packet = raylabs::RayPacket<8>::from_rays(rays, 8);
+    raylabs::PacketHit<8> hit(1e9f);
+    scene.hit_packet(packet, 0.001f, hit, raylabs::RayPacket<8>::first_lanes(8));
+    for (int lane = 0; lane < 8; ++lane) {
+        HitRecord expected{};
+        const bool found = scene.hit(rays[lane], 0.001f, 1e9f, expected);
+        HitRecord rec{};
+        REQUIRE(scene.packet_hit_record(rays[lane], hit, lane, rec) == found);
+        if (found)
+            CHECK(rec.t == doctest::Approx(expected.t).epsilon(1e-4));
+    }
+}
+
+TEST_CASE("SAH BVH keeps every primitive once and beats a single leaf") {
+    std::vector<raylabs::Aabb> boxes;
+    for (int i = 0; i < 500; ++i) {
+        const float x = float(i % 25);
+        const float y = float(i / 25);
+        boxes.emplace_back(Point3(x, y, 0), Point3(x + 0.5f, y + 0.5f, 0.5f));
+    }
+    raylabs::Bvh bvh;
+    bvh.build(boxes);
+
+    std::vector<int> seen(boxes.size(), 0);
+    for (std::uint32_t index : bvh.indices())
+        seen[index]++;
+    for (int n : seen)
+        CHECK(n == 1);
+    for (const auto& node : bvh.nodes()) {
+        if (node.is_leaf())
+            CHECK(node.count <= 4);
+    }
+    CHECK(bvh.sah_cost() < 0.1f * float(boxes.size()));
+}
+
+TEST_CASE("Binned parallel build matches the linear scan and does not depend on the pool") {
+    Scene linear;
+    Scene binned;
+    fill_scene(linear, 3000, 21);
+    fill_scene(binned, 3000, 21);
+    raylabs::ThreadPool pool(4);
+    binned.build_acceleration({}, &pool);
+    REQUIRE(binned.accelerated());
+
+    for (const Ray& ray : random_rays(2000, 17)) {
+        HitRecord expected{};
+        HitRecord rec{};
+        const bool found = linear.hit(ray, 0.001f, 1e9f, expected);
+        REQUIRE(binned.hit(ray, 0.001f, 1e9f, rec) == found);
+        if (found)
+            CHECK(rec.t == expected.t);
+    }
+
+    // Large enough for parallel subtrees and parallel binning of the top ranges
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> pos(-50.0f, 50.0f);
+    std::vector<raylabs::Aabb> boxes;
+    for (int i = 0; i < 60000; ++i) {
+        const Point3 p(pos(rng), pos(rng), pos(rng));
+        boxes.emplace_back(p, p + Vec3(0.3f, 0.3f, 0.3f));
+    }
+    raylabs::ThreadPool serial(1);
+    raylabs::Bvh a;
+    raylabs::Bvh b;
+    a.build_binned(boxes, serial);
+    b.build_binned(boxes, pool);
+    REQUIRE(a.nodes().size() == b.nodes().size());
+    CHECK(a.indices() == b.indices());
+    bool same_nodes = true;
+    for (std::size_t i = 0; i < a.nodes().size(); ++i) {
+        same_nodes = same_nodes && a.nodes()[i].offset == b.nodes()[i].offset &&
+                     a.nodes()[i].count == b.nodes()[i].count;
+    }
+    CHECK(same_nodes);
+
+    std::vector<int> seen(boxes.size(), 0);
+    for (std::uint32_t index : b.indices())
+        seen[index]++;
+    CHECK(std::count(seen.begin(), seen.end(), 1) == static_cast<long>(boxes.size()));
+
+    // Binning costs a little tree quality compared to the exact sweep
+    raylabs::Bvh exact;
+    exact.build(boxes);
+    CHECK(b.sah_cost() < 1.1f * exact.sah_cost());
+}
+
+TEST_CASE("Updating after small moves refits the BVH in place") {
+    Scene linear;
+    Scene animated;
+    fill_scene(linear, 3000, 31);
+    fill_scene(animated, 3000, 31);
+    animated.build_acceleration();
+    raylabs::ThreadPool pool(3);
+
+    // A few turntable steps around the y axis
+    const auto step = raylabs::Transform::rotate_about(Point3(0, 0, 0), Vec3(0, 1, 0), 0.01f);
+    for (int frame = 0; frame < 3; ++frame) {
+        for (std::size_t i = 0; i < linear.entities.size(); ++i) {
+            linear.transform_entity(i, step);
+            animated.transform_entity(i, step);
+        }
+        const raylabs::BvhUpdateStats stats = animated.update_acceleration(&pool);
+        CHECK_FALSE(stats.full_rebuild);
+        CHECK(stats.rebuilt_subtrees == 0);
+        CHECK(stats.sah_growth < 1.3f);
+    }
+    REQUIRE(animated.accelerated());
+
+    for (const Ray& ray : random_rays(1000, 23)) {
+        HitRecord expected{};
+        HitRecord rec{};
+        const bool found = linear.hit(ray, 0.001f, 1e9f, expected);
+        REQUIRE(animated.hit(ray, 0.001f, 1e9f, rec) == found);
+        if (found)
+            CHECK(rec.t == expected.t);
+    }
+}
+
+TEST_CASE("Updating after large moves rebuilds the degraded subtrees") {
+    Scene linear;
+    Scene animated;
+    fill_scene(linear, 3000, 41);
+    fill_scene(animated, 3000, 41);
+    raylabs::Bvh::BuildOptions options;
+    options.width = 2;
+    animated.build_acceleration(options);
+
+    // Every other entity of one side jumps to the middle: the subtrees there now span both
+    // places, while the root keeps its bounds
+    const auto jump = raylabs::Transform::translate(Vec3(8, 0, 0));
+    for (std::size_t i = 1; i < linear.entities.size(); i += 2) {
+        if (linear.entities[i].shape->bounds().max.x < -4.0f) {
+            linear.transform_entity(i, jump);
+            animated.transform_entity(i, jump);
+        }
+    }
+    const raylabs::BvhUpdateStats stats = animated.update_acceleration();
+    CHECK(stats.rebuilt_subtrees > 0);
+    CHECK_FALSE(stats.full_rebuild);
+    CHECK(stats.rebuilt_primitives < 1500);
+    CHECK(stats.sah_growth < 1.3f);
+
+    for (const Ray& ray : random_rays(1000, 29)) {
+        HitRecord expected{};
+        HitRecord rec{};
+        const bool found = linear.hit(ray, 0.001f, 1e9f, expected);
+        REQUIRE(animated.hit(ray, 0.001f, 1e9f, rec) == found);
+        if (found)
+            CHECK(rec.t == expected.t);
+    }
+
+    // Scrambling everything falls back to a full rebuild
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> u(-20.0f, 20.0f);
+    for (std::size_t i = 1; i < animated.entities.size(); ++i)
+        animated.transform_entity(i, raylabs::Transform::translate(Vec3(u(rng), u(rng), u(rng))));
+    CHECK(animated.update_acceleration().full_rebuild);
+}
+
+TEST_CASE("Rebuilt subtrees stay within the depth limit and reset the SAH baseline") {
+    std::mt19937 rng(47);
+    std::uniform_real_distribution<float> pos(-10.0f, 10.0f);
+    std::vector<raylabs::Aabb> boxes;
+    for (int i = 0; i < 2000; ++i) {
+        const Point3 p(pos(rng), pos(rng), pos(rng));
+        boxes.emplace_back(p, p + Vec3(0.2f, 0.2f, 0.2f));
+    }
+    raylabs::Bvh::BuildOptions options;
+    options.max_depth = 6;
+    raylabs::Bvh bvh;
+    bvh.build(boxes, options);
+
+    auto depth = [&] {
+        int deepest = 0;
+        std::vector<std::pair<std::uint32_t, int>> stack{{0, 0}};
+        while (!stack.empty()) {
+            const auto [index, d] = stack.back();
+            stack.pop_back();
+            deepest = std::max(deepest, d);
+            const raylabs::Bvh::Node& n = bvh.nodes()[index];
+            if (!n.is_leaf()) {
+                stack.push_back({n.offset, d + 1});
+                stack.push_back({n.offset + 1, d + 1});
+            }
+        }
+        return deepest;
+    };
+    REQUIRE(depth() == 6);
+
+    // Same jump as above: the subtrees of one side now span both places
+    for (std::size_t i = 1; i < boxes.size(); i += 2) {
+        if (boxes[i].max.x < -4.0f)
+            boxes[i] = raylabs::Aabb(boxes[i].min + Vec3(8, 0, 0), boxes[i].max + Vec3(8, 0, 0));
+    }
+    const raylabs::BvhUpdateStats stats = bvh.update(boxes, nullptr, options);
+    REQUIRE(stats.rebuilt_subtrees > 0);
+    CHECK_FALSE(stats.full_rebuild);
+    CHECK(depth() <= 6);
+
+    // Nothing moved since: the next update compares against the partly rebuilt tree
+    const raylabs::BvhUpdateStats again = bvh.update(boxes, nullptr, options);
+    CHECK(again.sah_growth == doctest::Approx(1.0f));
+    CHECK(again.rebuilt_subtrees == 0);
+}
+
+TEST_CASE("BVHs stored in the cache are mapped back for the same geometry only") {
+    const std::filesystem::path dir =
+        std::filesystem::temp_directory_path() / "raylabs_test_bvh_cache";
+    std::filesystem::remove_all(dir);
+    const raylabs::BvhCache cache(dir.string());
+    raylabs::ThreadPool pool(2);
+
+    for (int width : {2, 4, 8}) {
+        raylabs::Bvh::BuildOptions options;
+        options.width = width;
+        Scene built;
+        fill_scene(built, 1500, 43);
+        built.build_acceleration(options, &pool, &cache);
+        CHECK_FALSE(built.acceleration_cached());
+
+        Scene mapped;
+        fill_scene(mapped, 1500, 43);
+        mapped.build_acceleration(options, &pool, &cache);
+        REQUIRE(mapped.acceleration_cached());
+        CHECK(mapped.bvh().nodes().borrowed());
+        CHECK(mapped.bvh().nodes().size() == built.bvh().nodes().size());
+        CHECK(mapped.bvh().built_sah() == built.bvh().built_sah());
+        for (const Ray& ray : random_rays(500, 31)) {
+            HitRecord expected{};
+            HitRecord rec{};
+            const bool found = built.hit(ray, 0.001f, 1e9f, expected);
+            REQUIRE(mapped.hit(ray, 0.001f, 1e9f, rec) == found);
+            if (found)
+                CHECK(rec.t == expected.t);
+        }
+
+        // Animating a mapped tree copies it out of the file first
+        mapped.transform_entity(1, raylabs::Transform::translate(Vec3(0.1f, 0, 0)));
+        mapped.update_acceleration(&pool);
+        CHECK_FALSE(mapped.bvh().nodes().borrowed());
+    }
+
+    // Other geometry, or the exact builder instead of the binned one: another key
+    Scene other;
+    fill_scene(other, 1500, 44);
+    other.build_acceleration({}, &pool, &cache);
+    CHECK_FALSE(other.acceleration_cached());
+    Scene exact;
+    fill_scene(exact, 1500, 43);
+    exact.build_acceleration({}, nullptr, &cache);
+    CHECK_FALSE(exact.acceleration_cached());
+
+    // A truncated file is rejected and rebuilt
+    std::vector<raylabs::Aabb> bounds;
+    std::vector<std::uint32_t> ids;
+    for (std::size_t i = 1; i < exact.entities.size(); ++i) {
+        bounds.push_back(exact.entities[i].shape->bounds());
+        ids.push_back(static_cast<std::uint32_t>(i));
+    }
+    const std::uint64_t key = raylabs::BvhCache::key(bounds, ids, {}, false);
+    REQUIRE(std::filesystem::exists(cache.path(key)));
+    std::filesystem::resize_file(cache.path(key), 200);
+    Scene truncated;
+    fill_scene(truncated, 1500, 43);
+    truncated.build_acceleration({}, nullptr, &cache);
+    CHECK_FALSE(truncated.acceleration_cached());
+    CHECK(truncated.bvh().primitive_count() == 1500);
+
+    // So is a whole file whose root points past the nodes (first section after the
+    // 128-byte header, `offset` after the min corner)
+    {
+        std::fstream file(cache.path(key), std::ios::in | std::ios::out | std::ios::binary);
+        REQUIRE(file);
+        const std::uint32_t past_the_end = 1u << 30;
+        file.seekp(128 + 3 * sizeof(float));
+        file.write(reinterpret_cast<const char*>(&past_the_end), sizeof(past_the_end));
+    }
+    Scene damaged;
+    fill_scene(damaged, 1500, 43);
+    damaged.build_acceleration({}, nullptr, &cache);
+    CHECK_FALSE(damaged.acceleration_cached());
+    CHECK(damaged.bvh().primitive_count() == 1500);
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,99 @@
+#include <doctest/doctest.h>
+
+#include <stdexcept>
+
+#include "app/CliOptions.hpp"
+
+TEST_CASE("CliOptions keeps defaults without arguments") {
+    const char* argv[] = {"raylabs"};
+    auto opts = raylabs::CliOptions::parse(1, argv);
+    CHECK(opts.scene_file == "assets/scenes/multiple_spheres.json");
+    CHECK_FALSE(opts.threads.has_value());
+    CHECK_FALSE(opts.show_help);
+}
+
+TEST_CASE("CliOptions parses scene and thread count") {
+    const char* argv[] = {"raylabs", "--threads", "8", "scene.json"};
+    auto opts = raylabs::CliOptions::parse(4, argv);
+    CHECK(opts.scene_file == "scene.json");
+    REQUIRE(opts.threads.has_value());
+    CHECK(*opts.threads == 8);
+
+    io::ImageDTO image;
+    image.threads = 2;
+    opts.apply(image);
+    CHECK(image.threads == 8);
+}
+
+TEST_CASE("CliOptions rejects malformed input") {
+    const char* bad_value[] = {"raylabs", "-t", "many"};
+    CHECK_THROWS_AS(raylabs::CliOptions::parse(3, bad_value), std::runtime_error);
+    const char* missing[] = {"raylabs", "--threads"};
+    CHECK_THROWS_AS(raylabs::CliOptions::parse(2, missing), std::runtime_error);
+    const char* unknown[] = {"raylabs", "--frobnicate"};
+    CHECK_THROWS_AS(raylabs::CliOptions::parse(2, unknown), std::runtime_error);
+    const char* bad_width[] = {"raylabs", "--bvh-width", "3"};
+    CHECK_THROWS_AS(raylabs::CliOptions::parse(3, bad_width), std::runtime_error);
+}
+
+TEST_CASE("CliOptions selects the integrator") {
+    const char* argv[] = {"raylabs", "--integrator", "wavefront"};
+    auto opts = raylabs::CliOptions::parse(3, argv);
+    io::ImageDTO image;
+    opts.apply(image);
+    CHECK(image.integrator == "wavefront");
+    CHECK(image.bvh_width == 4);
+    CHECK_FALSE(image.ray_sort);
+
+    const char* sorted[] = {"raylabs", "--integrator", "wavefront", "--ray-sort"};
+    raylabs::CliOptions::parse(4, sorted).apply(image);
+    CHECK(image.ray_sort);
+
+    const char* wide[] = {"raylabs", "--bvh-width", "8"};
+    raylabs::CliOptions::parse(3, wide).apply(image);
+    CHECK(image.bvh_width == 8);
+    CHECK(image.bvh_cache.empty());
+
+    const char* cached[] = {"raylabs", "--bvh-cache", "cache/bvh"};
+    raylabs::CliOptions::parse(3, cached).apply(image);
+    CHECK(image.bvh_cache == "cache/bvh");
+    CHECK_FALSE(image.bvh_quantized);
+
+    const char* quantized[] = {"raylabs", "--bvh-quantized"};
+    raylabs::CliOptions::parse(2, quantized).apply(image);
+    CHECK(image.bvh_quantized);
+
+    CHECK(image.bvh_spatial_splits == 0.0f);
+    const char* spatial[] = {"raylabs", "--bvh-spatial-splits", "0.3"};
+    raylabs::CliOptions::parse(3, spatial).apply(image);
+    CHECK(image.bvh_spatial_splits == doctest::Approx(0.3f));
+    const char* bad_spatial[] = {"raylabs", "--bvh-spatial-splits", "-1"};
+    CHECK_THROWS_AS(raylabs::CliOptions::parse(3, bad_spatial), std::runtime_error);
+
+    CHECK(image.accelerator == "bvh");
+    const char* grid[] = {"raylabs", "--accelerator", "auto"};
+    raylabs::CliOptions::parse(3, grid).apply(image);
+    CHECK(image.accelerator == "auto");
+    const char* bad_accel[] = {"raylabs", "--accelerator", "octree"};
+    CHECK_THROWS_AS(raylabs::CliOptions::parse(3, bad_accel), std::runtime_error);
+
+    const char* bad[] = {"raylabs", "--integrator", "photon"};
+    CHECK_THROWS_AS(raylabs::CliOptions::parse(3, bad), std::runtime_error);
+}
+
+TEST_CASE("CliOptions parses a crop window") {
+    const char* argv[] = {"raylabs", "--crop", "10,20,30,40", "--crop-full"};
+    auto opts = raylabs::CliOptions::parse(4, argv);
+    io::ImageDTO image;
+    opts.apply(image);
+    CHECK(image.crop_x == 10);
+    CHECK(image.crop_y == 20);
+    CHECK(image.crop_width == 30);
+    CHECK(image.crop_height == 40);
+    CHECK(image.crop_full_frame);
+
+    const char* short_rect[] = {"raylabs", "--crop", "10,20,30"};
+    CHECK_THROWS_AS(raylabs::CliOptions::parse(3, short_rect), std::runtime_error);
+    const char* empty_rect[] = {"raylabs", "--crop", "0,0,0,10"};
+    CHECK_THROWS_AS(raylabs::CliOptions::parse(3, empty_rect), std::runtime_error);
+}
@@ -1,9 +1,16 @@
 #include <doctest/doctest.h>
 
+#include <stdexcept>
 #include <string>
 
+#include "core/Camera.hpp"
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
 #include "core/Scene.hpp"
+#include "entities/Sphere.hpp"
+#include "entities/SphereBatch.hpp"
 #include "io/JsonSceneLoader.hpp"
+#include "math/Transform.hpp"
 
 TEST_CASE("JsonSceneLoader loads plane and triangle") {
     std::string jsonText = R"JSON(
@@ -21,3 +28,120 @@ TEST_CASE("JsonSceneLoader loads plane and triangle") {
     CHECK_MESSAGE(ok, err.c_str());
     CHECK(scene.entities.size() == 2);
 }
+
+TEST_CASE("JsonSceneLoader places instances of shared prototypes") {
+    const std::string jsonText = R"JSON(
+{
+  "materials": { "red": { "type": "lambertian", "albedo": [0.8, 0.1, 0.1] } },
+  "prototypes": {
+    "pair": [
+      { "type": "sphere", "center": [0, 0, 0], "radius": 0.5, "material": "red" },
+      { "type": "sphere", "center": [1, 0, 0], "radius": 0.25, "material": "red" }
+    ]
+  },
+  "instances": [
+    { "prototype": "pair", "translate": [0, 0, -5] },
+    { "prototype": "pair", "translate": [0, 3, -5], "rotate": { "axis": [0, 0, 1], "degrees": 90 },
+      "scale": 2 }
+  ]
+}
+)JSON";
+
+    const io::SceneDTO dto = io::JsonSceneLoader::parse_json_string(jsonText);
+    REQUIRE(dto.prototypes.size() == 1);
+    REQUIRE(dto.instances.size() == 2);
+    CHECK(dto.instances[1].scale == 2.0f);
+    CHECK(dto.instances[1].rotate_deg == 90.0f);
+
+    Scene scene;
+    Camera camera;
+    io::JsonSceneLoader::populateScene(dto, scene, camera);
+    CHECK(scene.entities.size() == 2);
+
+    // Second instance: the small sphere ends up at (0, 5, -5) with radius 0.5
+    HitRecord rec{};
+    REQUIRE(scene.hit(Ray(Point3(0, 5, 0), Vec3(0, 0, -1)), 0.001f, 1e9f, rec));
+    CHECK(rec.t == doctest::Approx(4.5f));
+    CHECK(rec.material != nullptr);
+    REQUIRE(scene.hit(Ray(Point3(0, 3, 0), Vec3(0, 0, -1)), 0.001f, 1e9f, rec));
+    CHECK(rec.t == doctest::Approx(4.0f));
+
+    CHECK_THROWS_AS(io::JsonSceneLoader::parse_json_string(
+                        R"({"instances": [{ "prototype": "missing" }]})"),
+                    std::runtime_error);
+}
+
+TEST_CASE("JsonSceneLoader builds indexed meshes") {
+    const std::string jsonText = R"JSON(
+{
+  "materials": { "grey": { "type": "lambertian" } },
+  "objects": [
+    { "type": "mesh", "material": "grey",
+      "vertices": [[-1, -1, -4], [1, -1, -4], [1, 1, -4], [-1, 1, -4]],
+      "indices": [[0, 1, 2], [0, 2, 3]] }
+  ]
+}
+)JSON";
+
+    const io::SceneDTO dto = io::JsonSceneLoader::parse_json_string(jsonText);
+    REQUIRE(dto.objects.size() == 1);
+    CHECK(dto.objects[0].mesh.indices.size() == 6);
+
+    Scene scene;
+    Camera camera;
+    io::JsonSceneLoader::populateScene(dto, scene, camera);
+    REQUIRE(scene.entities.size() == 1);
+    HitRecord rec{};
+    REQUIRE(scene.hit(Ray(Point3(-0.5f, 0.5f, 0), Vec3(0, 0, -1)), 0.001f, 1e9f, rec));
+    CHECK(rec.t == doctest::Approx(4.0f));
+    CHECK(rec.normal.z == doctest::Approx(1.0f));
+    CHECK(rec.material != nullptr);
+
+    CHECK_THROWS_AS(io::JsonSceneLoader::parse_json_string(
+                        R"({"objects": [{ "type": "mesh", "material": "grey",
+                            "vertices": [[0, 0, 0], [1, 0, 0]], "indices": [0, 1, 2] }]})"),
+                    std::runtime_error);
+}
+
+TEST_CASE("JsonSceneLoader batches spheres and reports where each object went") {
+    const std::string json = R"JSON({
+  "materials": { "grey": { "type": "lambertian" } },
+  "objects": [
+    { "type": "sphere", "center": [0, 0, -5], "radius": 0.5, "material": "grey" },
+    { "type": "plane", "point": [0, -1, 0], "normal": [0, 1, 0], "material": "grey" },
+    { "type": "sphere", "center": [2, 0, -5], "radius": 0.5, "material": "grey" },
+    { "type": "sphere", "center": [4, 0, -5], "radius": 0.5, "material": "grey",
+      "batch": false }
+  ]
+})JSON";
+    Scene scene;
+    Camera camera;
+    const auto placements = io::JsonSceneLoader::populateScene(
+        io::JsonSceneLoader::parse_json_string(json), scene, camera);
+    REQUIRE(placements.size() == 4);
+    // The plane and the sphere kept out of the batches first, in order, then the batch
+    CHECK(placements[1].entity == 0);
+    CHECK(placements[1].member == -1);
+    CHECK(placements[3].entity == 1);
+    CHECK(placements[3].member == -1);
+    for (std::size_t o : {std::size_t(0), std::size_t(2)}) {
+        REQUIRE(placements[o].entity < scene.entities.size());
+        const auto* batch =
+            dynamic_cast<const SphereBatch*>(scene.entities[placements[o].entity].shape.get());
+        REQUIRE(batch != nullptr);
+        REQUIRE(placements[o].member >= 0);
+        CHECK(batch->center(placements[o].member).x == doctest::Approx(o == 0 ? 0.0f : 2.0f));
+    }
+    CHECK(placements[0].member != placements[2].member);
+
+    // Moving the entity of the last object moves that sphere
+    REQUIRE(dynamic_cast<const Sphere*>(scene.entities[placements[3].entity].shape.get()));
+    scene.transform_entity(placements[3].entity, raylabs::Transform::translate(Vec3(0, 10, 0)));
+    scene.update_acceleration();
+    HitRecord rec{};
+    CHECK_FALSE(scene.hit(Ray(Point3(4, 0, 0), Vec3(0, 0, -1)), 0.001f, 1e9f, rec));
+    REQUIRE(scene.hit(Ray(Point3(4, 10, 0), Vec3(0, 0, -1)), 0.001f, 1e9f, rec));
+    CHECK(rec.t == doctest::Approx(4.5f));
+    REQUIRE(scene.hit(Ray(Point3(2, 0, 0), Vec3(0, 0, -1)), 0.001f, 1e9f, rec));
+    CHECK(rec.t == doctest::Approx(4.5f));
+}
@@ -0,0 +1,143 @@
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "core/Camera.hpp"
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
+#include "core/Scene.hpp"
+#include "io/JsonSceneLoader.hpp"
+#include "io/ObjLoader.hpp"
+#include "utils/ThreadPool.hpp"
+
+TEST_CASE("ObjLoader reads positions, faces and normals") {
+    // A square (v/vt/vn corners, a comment, CRLF) and a pentagon given by negative indices
+    const std::string obj =
+        "# square\r\n"
+        "v 0 0 0\r\nv 1 0 0\r\nv 1 1 0\r\nv 0 1 0\r\n"
+        "vt 0 0\nvn 0 0 1\n"
+        "g square\nusemtl grey\n"
+        "f 1/1/1 2/1/1 3/1/1 4/1/1  # two triangles\n"
+        "v 0 0 -1\nv 1 0 -1\nv 1.5 0.5 -1\nv 1 1 -1\nv 0 1 -1\n"
+        "f -5//1 -4//1 -3//1 -2//1 -1//1\n";
+    const auto mesh = io::ObjLoader::parse(obj);
+    CHECK(mesh->vertex_count() == 9);
+    REQUIRE(mesh->triangle_count() == 5);
+    CHECK(mesh->x[6] == 1.5f);
+    CHECK(mesh->z[8] == -1.0f);
+    const std::uint32_t expected[] = {0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7, 4, 7, 8};
+    for (std::size_t i = 0; i < 15; ++i)
+        CHECK(mesh->indices[i] == expected[i]);
+    REQUIRE(mesh->has_normals());
+    CHECK(mesh->nz[0] == 1.0f);
+    CHECK(mesh->nz[8] == 1.0f);
+
+    // A position used with two normals gets one vertex per normal
+    const auto split = io::ObjLoader::parse(
+        "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 0 0 1\nvn 0 0 -1\nvn 0 -1 0\n"
+        "f 1//1 3//1 2//1\nf 1//2 2//2 4//2\n");
+    CHECK(split->vertex_count() == 6);
+    CHECK(split->indices[3] != split->indices[0]);
+    CHECK(split->x[split->indices[3]] == 0.0f);
+    CHECK(split->ny[split->indices[3]] == -1.0f);
+    CHECK(split->nz[split->indices[0]] == -1.0f);
+
+    // Normals on some faces only: flat shading
+    CHECK_FALSE(io::ObjLoader::parse("v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 1\n"
+                                     "f 1//1 2//1 3//1\nf 1 3 2\n")
+                    ->has_normals());
+}
+
+TEST_CASE("ObjLoader parses in parallel chunks like in one piece") {
+    // About 4 MB: several chunks, with negative indices crossing their boundaries
+    std::ostringstream text;
+    const int n = 300;
+    for (int j = 0; j <= n; ++j) {
+        for (int i = 0; i <= n; ++i)
+            text << "v " << i * 0.01 << " " << (i * j % 7) * 0.001 << " " << j * 0.01 << "\n";
+    }
+    for (int j = 0; j < n; ++j) {
+        for (int i = 0; i < n; ++i) {
+            const int k = j * (n + 1) + i + 1;
+            text << "f " << k << " " << k + n + 1 << " " << k + 1 << "\n";
+            text << "v " << i << " 1 " << j << "\nf " << k + 1 << " " << k + n + 1 << " -1\n";
+        }
+    }
+    const std::string obj = text.str();
+    REQUIRE(obj.size() > 3u << 20);
+
+    raylabs::ThreadPool pool(4);
+    const auto serial = io::ObjLoader::parse(obj);
+    const auto parallel = io::ObjLoader::parse(obj, &pool);
+    CHECK(serial->triangle_count() == 2 * n * n);
+    CHECK(parallel->x == serial->x);
+    CHECK(parallel->y == serial->y);
+    CHECK(parallel->z == serial->z);
+    CHECK(parallel->indices == serial->indices);
+    CHECK(serial->indices[5] == static_cast<std::uint32_t>((n + 1) * (n + 1)));
+}
+
+TEST_CASE("ObjLoader reports the line of malformed statements") {
+    raylabs::ThreadPool pool(2);
+    auto message = [&](const std::string& obj) {
+        try {
+            io::ObjLoader::parse(obj, &pool, "bad.obj");
+        } catch (const std::runtime_error& e) {
+            return std::string(e.what());
+        }
+        return std::string();
+    };
+    CHECK(message("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n") ==
+          "bad.obj:4: vertex index 4 out of range");
+    CHECK(message("v 0 0 0\nv 1 x 0\n") == "bad.obj:2: bad vertex");
+    CHECK(message("v 0 0 0\nv 1 0 0\nf 1 2\n") == "bad.obj:3: face with fewer than 3 vertices");
+    CHECK(message("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 0 1 2\n") ==
+          "bad.obj:4: vertex index 0 out of range");
+    CHECK_THROWS_AS(io::ObjLoader::parse("v 0 0 0\n"), std::runtime_error);
+    CHECK_THROWS_AS(io::ObjLoader::load_from_file("missing.obj"), std::runtime_error);
+
+    // Errors in several chunks: the first line wins, whichever chunk fails first
+    std::string chunked = "v 0 0 0\nv 1 0 0\nf 1 2\n";
+    for (int i = 0; i < 400000; ++i)
+        chunked += "v 0 0 1\n";
+    chunked += "v 1 x 0\n";
+    REQUIRE(chunked.size() > 3u << 20);
+    for (int attempt = 0; attempt < 4; ++attempt)
+        CHECK(message(chunked) == "bad.obj:3: face with fewer than 3 vertices");
+}
+
+TEST_CASE("JSON scenes reference OBJ files relative to themselves") {
+    const auto dir = std::filesystem::temp_directory_path() / "raylabs_test_obj";
+    std::filesystem::create_directories(dir / "models");
+    std::ofstream(dir / "models" / "quad.obj")
+        << "v -1 -1 -4\nv 1 -1 -4\nv 1 1 -4\nv -1 1 -4\nf 1 2 3 4\n";
+    std::ofstream(dir / "scene.json") << R"JSON(
+{
+  "materials": { "grey": { "type": "lambertian" } },
+  "objects": [
+    { "type": "mesh", "file": "models/quad.obj", "material": "grey" },
+    { "type": "mesh", "file": "models/quad.obj", "material": "grey" }
+  ]
+}
+)JSON";
+
+    const io::SceneDTO dto = io::JsonSceneLoader::load_from_file((dir / "scene.json").string());
+    REQUIRE(dto.objects.size() == 2);
+    CHECK(dto.objects[0].mesh.file == (dir / "models" / "quad.obj").string());
+    Scene scene;
+    Camera camera;
+    io::JsonSceneLoader::populateScene(dto, scene, camera);
+    REQUIRE(scene.entities.size() == 2);
+    HitRecord rec{};
+    REQUIRE(scene.hit(Ray(Point3(0.5f, -0.5f, 0), Vec3(0, 0, -1)), 0.001f, 1e9f, rec));
+    CHECK(rec.t == doctest::Approx(4.0f));
+
+    CHECK_THROWS_AS(io::JsonSceneLoader::parse_json_string(
+                        R"({"objects": [{ "type": "mesh", "file": "a.stl", "material": "m" }]})"),
+                    std::runtime_error);
+    std::filesystem::remove_all(dir);
+}
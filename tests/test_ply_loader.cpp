@@ -0,0 +1,200 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "core/Camera.hpp"
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
+#include "core/Scene.hpp"
+#include "io/JsonSceneLoader.hpp"
+#include "io/PlyLoader.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace {
+
+/// Binary PLY body writer in either byte order
+struct Writer {
+    std::string bytes;
+    bool big_endian = false;
+
+    template <typename T>
+    void put(T value) {
+        char b[sizeof(T)];
+        std::memcpy(b, &value, sizeof(T));
+        if (big_endian != (std::endian::native == std::endian::big))
+            std::reverse(b, b + sizeof(T));
+        bytes.append(b, sizeof(T));
+    }
+};
+
+/// n x n grid of quads in the z = 0 plane, as triangles (scanner layout) or as quads in a
+/// big-endian file with double coordinates and an extra element before the faces
+std::string grid(int n, bool scanner) {
+    Writer w;
+    w.big_endian = !scanner;
+    const int vertices = (n + 1) * (n + 1);
+    w.bytes = std::string("ply\nformat ") +
+              (scanner ? "binary_little_endian" : "binary_big_endian") +
+              " 1.0\ncomment test grid\nelement vertex " + std::to_string(vertices) + "\n" +
+              (scanner ? "property float x\nproperty float y\nproperty float z\n"
+                         "property float nx\nproperty float ny\nproperty float nz\n"
+                         "property uchar red\n"
+                       : "property double x\nproperty double y\nproperty double z\n") +
+              (scanner ? "" : "element edge 2\nproperty list uchar int vertex_pair\n") +
+              "element face " + std::to_string(scanner ? 2 * n * n : n * n) + "\n" +
+              (scanner ? "property list uchar int vertex_indices\n"
+                       : "property uchar flags\nproperty list ushort uint vertex_index\n") +
+              "end_header\n";
+    for (int j = 0; j <= n; ++j) {
+        for (int i = 0; i <= n; ++i) {
+            if (scanner) {
+                for (float c : {static_cast<float>(i), static_cast<float>(j), 0.0f, 0.0f, 0.0f,
+                                1.0f})
+                    w.put(c);
+                w.put(std::uint8_t(200));
+            } else {
+                for (double c : {static_cast<double>(i), static_cast<double>(j), 0.0})
+                    w.put(c);
+            }
+        }
+    }
+    if (!scanner) {
+        for (int e = 0; e < 2; ++e) {
+            w.put(std::uint8_t(2));
+            w.put(std::int32_t(e));
+            w.put(std::int32_t(e + 1));
+        }
+    }
+    for (int j = 0; j < n; ++j) {
+        for (int i = 0; i < n; ++i) {
+            const std::int32_t k = j * (n + 1) + i;
+            if (scanner) {
+                for (const auto& t : {std::vector<std::int32_t>{k, k + 1, k + n + 2},
+                                      std::vector<std::int32_t>{k, k + n + 2, k + n + 1}}) {
+                    w.put(std::uint8_t(3));
+                    for (std::int32_t v : t)
+                        w.put(v);
+                }
+            } else {
+                w.put(std::uint8_t(0));
+                w.put(std::uint16_t(4));
+                for (std::int32_t v : {k, k + 1, k + n + 2, k + n + 1})
+                    w.put(static_cast<std::uint32_t>(v));
+            }
+        }
+    }
+    return w.bytes;
+}
+
+/// `faces` triangles {f % 997, f % 997 + 1, 3} over 1000 vertices, with face `quad` a quad.
+/// Read at triangle offsets, every face after the quad starts with the last index of the one
+/// before: a count of 3 followed by indices far out of range.
+std::string fan_with_quad(int faces, int quad) {
+    Writer w;
+    w.bytes = "ply\nformat binary_little_endian 1.0\nelement vertex 1000\n"
+              "property float x\nproperty float y\nproperty float z\n"
+              "element face " +
+              std::to_string(faces) +
+              "\nproperty list uchar int vertex_indices\nend_header\n";
+    for (int v = 0; v < 1000; ++v) {
+        w.put(static_cast<float>(v));
+        w.put(static_cast<float>(v % 7));
+        w.put(0.0f);
+    }
+    for (int f = 0; f < faces; ++f) {
+        w.put(std::uint8_t(f == quad ? 4 : 3));
+        w.put(std::int32_t(f % 997));
+        w.put(std::int32_t(f % 997 + 1));
+        if (f == quad)
+            w.put(std::int32_t(2));
+        w.put(std::int32_t(3));
+    }
+    return w.bytes;
+}
+
+}  // namespace
+
+TEST_CASE("PlyLoader converts scanner and generic layouts alike") {
+    const auto scanner = io::PlyLoader::parse(grid(3, true));
+    const auto generic = io::PlyLoader::parse(grid(3, false));
+    REQUIRE(scanner->triangle_count() == 18);
+    REQUIRE(scanner->vertex_count() == 16);
+    CHECK(scanner->x[5] == 1.0f);
+    CHECK(scanner->y[5] == 1.0f);
+    REQUIRE(scanner->has_normals());
+    CHECK(scanner->nz[7] == 1.0f);
+    CHECK_FALSE(generic->has_normals());
+    // Quads are split into the same two triangles
+    CHECK(generic->x == scanner->x);
+    CHECK(generic->y == scanner->y);
+    CHECK(generic->z == scanner->z);
+    CHECK(generic->indices == scanner->indices);
+
+    // Over several blocks of faces, on the pool
+    raylabs::ThreadPool pool(4);
+    const std::string big = grid(200, true);
+    const auto serial = io::PlyLoader::parse(big);
+    const auto parallel = io::PlyLoader::parse(big, &pool);
+    CHECK(parallel->triangle_count() == 80000);
+    CHECK(parallel->indices == serial->indices);
+    CHECK(parallel->x == serial->x);
+    CHECK(parallel->nz == serial->nz);
+
+    // A quad near the end of the first block: the later blocks, misreading their faces as
+    // triangles until the quad is seen, must not report what they find
+    const std::string mixed = fan_with_quad(8 * 65536, 65000);
+    const auto fanned = io::PlyLoader::parse(mixed);
+    CHECK(fanned->triangle_count() == 8 * 65536 + 1);
+    for (int run = 0; run < 20; ++run)
+        CHECK(io::PlyLoader::parse(mixed, &pool)->indices == fanned->indices);
+}
+
+TEST_CASE("PlyLoader rejects what it cannot read") {
+    CHECK_THROWS_AS(io::PlyLoader::parse("ply\nformat ascii 1.0\nelement vertex 0\nend_header\n"),
+                    std::runtime_error);
+    CHECK_THROWS_AS(io::PlyLoader::parse("solid cube\n"), std::runtime_error);
+    std::string truncated = grid(2, true);
+    truncated.resize(truncated.size() - 5);
+    CHECK_THROWS_AS(io::PlyLoader::parse(truncated), std::runtime_error);
+
+    // Last index of the last face pointed past the 9 vertices
+    std::string out_of_range = grid(2, true);
+    const std::int32_t bad = 9;
+    std::memcpy(&out_of_range[out_of_range.size() - 4], &bad, sizeof(bad));
+    raylabs::ThreadPool pool(2);
+    CHECK_THROWS_AS(io::PlyLoader::parse(out_of_range, &pool), std::runtime_error);
+    // Out of range past a quad, on the serial polygon path
+    std::string mixed = fan_with_quad(100, 10);
+    const std::int32_t far = 1000;
+    std::memcpy(&mixed[mixed.size() - 4], &far, sizeof(far));
+    CHECK_THROWS_AS(io::PlyLoader::parse(mixed, &pool), std::runtime_error);
+    CHECK_THROWS_AS(io::PlyLoader::load_from_file("missing.ply"), std::runtime_error);
+}
+
+TEST_CASE("JSON scenes reference PLY files") {
+    const auto dir = std::filesystem::temp_directory_path() / "raylabs_test_ply";
+    std::filesystem::create_directories(dir);
+    std::ofstream(dir / "grid.ply", std::ios::binary) << grid(4, true);
+    const std::string json = R"({
+      "materials": { "grey": { "type": "lambertian" } },
+      "objects": [{ "type": "mesh", "file": "grid.ply", "material": "grey" }]
+    })";
+    const io::SceneDTO dto =
+        io::JsonSceneLoader::parse_json_string(json, (dir / "scene.json").string());
+    Scene scene;
+    Camera camera;
+    io::JsonSceneLoader::populateScene(dto, scene, camera);
+    HitRecord rec{};
+    REQUIRE(scene.hit(Ray(Point3(1.5f, 2.5f, 3.0f), Vec3(0, 0, -1)), 0.001f, 1e9f, rec));
+    CHECK(rec.t == doctest::Approx(3.0f));
+    CHECK(rec.normal.z == doctest::Approx(1.0f));
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,152 @@
+#include <doctest/doctest.h>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "core/HitRecord.hpp"
+#include "core/Ray.hpp"
+#include "core/RayPacket.hpp"
+#include "core/Scene.hpp"
+#include "entities/Instance.hpp"
+#include "entities/Plane.hpp"
+#include "entities/Sphere.hpp"
+#include "entities/SphereBatch.hpp"
+#include "entities/Triangle.hpp"
+#include "materials/Lambertian.hpp"
+#include "math/Transform.hpp"
+
+namespace {
+
+// Fan of rays from one origin, like neighbouring camera rays
+std::vector<Ray> ray_fan(int count) {
+    std::vector<Ray> rays;
+    for (int i = 0; i < count; ++i) {
+        float sx = -1.0f + 2.0f * float(i % 4) / 3.0f;
+        float sy = -1.0f + 2.0f * float(i / 4) / float((count + 3) / 4);
+        rays.emplace_back(Point3(0.1f, 0.2f, 3.0f), Vec3(sx * 0.4f, sy * 0.4f, -1.0f));
+    }
+    return rays;
+}
+
+template <int N>
+void check_matches_scalar(const Shape& shape) {
+    const std::vector<Ray> rays = ray_fan(N);
+    auto packet = raylabs::RayPacket<N>::from_rays(rays.data(), N);
+    raylabs::PacketHit<N> hit(1e9f);
+    const auto mask =
+        shape.hit_packet(packet, 0.001f, hit, raylabs::RayPacket<N>::first_lanes(N));
+
+    for (int lane = 0; lane < N; ++lane) {
+        HitRecord rec{};
+        const bool scalar_hit = shape.hit(rays[lane], 0.001f, 1e9f, rec);
+        CHECK(mask[lane] == scalar_hit);
+        if (scalar_hit && mask[lane]) {
+            CHECK(hit.t[lane] == doctest::Approx(rec.t).epsilon(1e-4));
+            // What the lane keeps for finalize() leads to the same surface
+            PrimitiveHit prim = hit.prims[lane];
+            prim.t = hit.t[lane];
+            HitRecord finalized{};
+            shape.finalize(rays[lane], prim, finalized);
+            CHECK(finalized.t == doctest::Approx(rec.t).epsilon(1e-4));
+            CHECK(finalized.normal.x == doctest::Approx(rec.normal.x).epsilon(1e-3));
+            CHECK(finalized.normal.y == doctest::Approx(rec.normal.y).epsilon(1e-3));
+            CHECK(finalized.normal.z == doctest::Approx(rec.normal.z).epsilon(1e-3));
+            CHECK(finalized.front_face == rec.front_face);
+            CHECK(finalized.material == rec.material);
+        }
+    }
+}
+
+template <int N>
+void check_all_shapes() {
+    check_matches_scalar<N>(Sphere(Point3(0, 0, -1), 1.0f));
+    check_matches_scalar<N>(Plane(Point3(0, -0.5f, 0), Vec3(0, 1, 0.2f)));
+    check_matches_scalar<N>(Triangle(Point3(-1, -1, -2), Point3(1, -1, -2), Point3(0, 1, -2)));
+    // Overlapping spheres, each with its material
+    std::vector<SphereBatch::Member> members;
+    for (int i = 0; i < SphereBatch::kWidth; ++i) {
+        members.push_back({Point3(-0.8f + 0.4f * float(i % 5), 0.3f * float(i / 5 - 1), -1.5f),
+                           0.35f, std::make_shared<Lambertian>(Color(0.1f * float(i), 0, 0))});
+    }
+    check_matches_scalar<N>(SphereBatch(members));
+}
+
+}  // namespace
+
+TEST_CASE("Packet intersection matches scalar hits for 4, 8 and 16 lanes") {
+    check_all_shapes<4>();
+    check_all_shapes<8>();
+    check_all_shapes<16>();
+}
+
+TEST_CASE("Packet intersection leaves inactive lanes untouched") {
+    Sphere sphere(Point3(0, 0, -1), 1.0f);
+    const std::vector<Ray> rays = ray_fan(4);
+    auto packet = raylabs::RayPacket<4>::from_rays(rays.data(), 4);
+    raylabs::PacketHit<4> hit(1e9f);
+    const auto mask = sphere.hit_packet(packet, 0.001f, hit, raylabs::RayPacket<4>::first_lanes(2));
+    CHECK_FALSE(mask[2]);
+    CHECK_FALSE(mask[3]);
+    CHECK(hit.t[3] == 1e9f);
+}
+
+TEST_CASE("Scene packet hit picks the closest entity per lane") {
+    Scene scene;
+    scene.add(std::make_shared<Plane>(Point3(0, 0, -5), Vec3(0, 0, 1)));
+    scene.add(std::make_shared<Sphere>(Point3(0, 0, -2), 0.5f));
+
+    Ray rays[8];
+    for (int i = 0; i < 8; ++i) {
+        rays[i] = Ray(Point3(-0.7f + 0.2f * float(i), 0, 0), Vec3(0, 0, -1));
+    }
+    auto packet = raylabs::RayPacket<8>::from_rays(rays, 8);
+    raylabs::PacketHit<8> hit(1e9f);
+    scene.hit_packet(packet, 0.001f, hit, raylabs::RayPacket<8>::first_lanes(8));
+
+    for (int lane = 0; lane < 8; ++lane) {
+        HitRecord expected{};
+        REQUIRE(scene.hit(rays[lane], 0.001f, 1e9f, expected));
+        HitRecord rec{};
+        REQUIRE(scene.packet_hit_record(rays[lane], hit, lane, rec));
+        CHECK(rec.t == doctest::Approx(expected.t).epsilon(1e-4));
+        CHECK(rec.point.z == doctest::Approx(expected.point.z).epsilon(1e-4));
+        CHECK(rec.front_face == expected.front_face);
+    }
+}
+
+TEST_CASE("Packet hits through instances are finalized like scalar hits") {
+    // Two touching spheres of different materials inside an instance, in front of a plane
+    auto red = std::make_shared<Lambertian>(Color(1, 0, 0));
+    auto blue = std::make_shared<Lambertian>(Color(0, 0, 1));
+    auto prototype = std::make_shared<Scene>();
+    prototype->add(std::make_shared<Sphere>(Point3(-0.25f, 0, 0), 0.25f), red);
+    prototype->add(std::make_shared<Sphere>(Point3(0.25f, 0, 0), 0.25f), blue);
+    prototype->build_acceleration();
+    Scene scene;
+    scene.add(std::make_shared<Instance>(
+        prototype, raylabs::Transform::translate(Vec3(0, 0, -2)) *
+                       raylabs::Transform::rotate(Vec3(0, 0, 1), 0.2f)));
+    scene.add(std::make_shared<Plane>(Point3(0, 0, -5), Vec3(0, 0, 1)), red);
+    scene.build_acceleration();
+
+    Ray rays[8];
+    for (int i = 0; i < 8; ++i)
+        rays[i] = Ray(Point3(-0.7f + 0.2f * float(i), 0.05f, 0), Vec3(0, 0, -1));
+    auto packet = raylabs::RayPacket<8>::from_rays(rays, 8);
+    raylabs::PacketHit<8> hit(1e9f);
+    scene.hit_packet(packet, 0.001f, hit, raylabs::RayPacket<8>::first_lanes(8));
+
+    int on_blue = 0;
+    for (int lane = 0; lane < 8; ++lane) {
+        HitRecord expected{};
+        REQUIRE(scene.hit(rays[lane], 0.001f, 1e9f, expected));
+        HitRecord rec{};
+        REQUIRE(scene.packet_hit_record(rays[lane], hit, lane, rec));
+        CHECK(rec.t == doctest::Approx(expected.t));
+        CHECK(rec.normal.z == doctest::Approx(expected.normal.z));
+        CHECK(rec.material == expected.material);
+        on_blue += rec.material == blue.get() ? 1 : 0;
+    }
+    CHECK(on_blue > 0);
+}
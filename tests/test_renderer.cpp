@@ -0,0 +1,476 @@
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "core/Camera.hpp"
+#include "core/Environment.hpp"
+#include "core/Integrator.hpp"
+#include "core/PathTracer.hpp"
+#include "core/WavefrontPathTracer.hpp"
+#include "core/Scene.hpp"
+#include "entities/Plane.hpp"
+#include "entities/Sphere.hpp"
+#include "io/JsonSceneLoader.hpp"
+#include "materials/Dielectric.hpp"
+#include "materials/Lambertian.hpp"
+#include "materials/Metal.hpp"
+#include "renderer/Renderer.hpp"
+
+namespace {
+
+struct TestScene {
+    Scene scene;
+    Camera camera;
+    io::ImageDTO image;
+
+    TestScene() {
+        scene.add(std::make_shared<Plane>(Point3(0, 0, 0), Vec3(0, 1, 0)),
+                  std::make_shared<Lambertian>(Color(0.8f, 0.8f, 0.0f)));
+        scene.add(std::make_shared<Sphere>(Point3(0, 0.5f, -2), 0.5f),
+                  std::make_shared<Dielectric>(1.5f));
+        scene.add(std::make_shared<Sphere>(Point3(1.1f, 0.5f, -2), 0.5f),
+                  std::make_shared<Metal>(Color(0.9f, 0.9f, 0.9f), 0.3f));
+        scene.lights.push_back({Point3(-1.0f, 3.0f, -1.0f), Color(4.0f, 4.0f, 3.5f)});
+
+        image.width = 70;  // deliberately not a multiple of the tile size
+        image.height = 41;
+        image.samples = 3;
+        image.max_depth = 4;
+        camera = Camera(Point3(0, 1, 1), Point3(0, 0.5f, -2), Vec3(0, 1, 0), 60.0f,
+                        float(image.width) / float(image.height));
+    }
+
+    Image render(int threads, const std::string& integrator = "path",
+                 bool sort_rays = false) const {
+        io::ImageDTO cfg = image;
+        cfg.threads = threads;
+        raylabs::Renderer renderer(scene, camera, cfg,
+                                   raylabs::Integrator::create(integrator, sort_rays));
+        renderer.render_frame();
+        return renderer.image();
+    }
+};
+
+bool same_pixels(const Image& a, const Image& b) {
+    if (a.Width() != b.Width() || a.Height() != b.Height())
+        return false;
+    for (unsigned y = 0; y < a.Height(); ++y) {
+        for (unsigned x = 0; x < a.Width(); ++x) {
+            Color ca = a.GetPixel(x, y);
+            Color cb = b.GetPixel(x, y);
+            if (ca.R() != cb.R() || ca.G() != cb.G() || ca.B() != cb.B())
+                return false;
+        }
+    }
+    return true;
+}
+
+double mean_abs_diff(const Image& a, const Image& b) {
+    double diff = 0.0;
+    for (unsigned y = 0; y < a.Height(); ++y) {
+        for (unsigned x = 0; x < a.Width(); ++x) {
+            Color ca = a.GetPixel(x, y);
+            Color cb = b.GetPixel(x, y);
+            diff += std::fabs(ca.R() - cb.R()) + std::fabs(ca.G() - cb.G()) +
+                    std::fabs(ca.B() - cb.B());
+        }
+    }
+    return diff / (static_cast<double>(a.Width()) * a.Height() * 3);
+}
+
+}  // namespace
+
+TEST_CASE("Renderer output is bit-identical whatever the thread count") {
+    TestScene ts;
+    Image single = ts.render(1);
+    CHECK(same_pixels(single, ts.render(2)));
+    CHECK(same_pixels(single, ts.render(5)));
+}
+
+TEST_CASE("Renderer is deterministic across runs") {
+    TestScene ts;
+    CHECK(same_pixels(ts.render(3), ts.render(3)));
+}
+
+TEST_CASE("Progressive rendering matches a fixed sample count once the target spp is reached") {
+    TestScene ts;
+    Image fixed = ts.render(2);
+
+    io::ImageDTO cfg = ts.image;
+    cfg.threads = 2;
+    cfg.progressive = true;
+    raylabs::Renderer renderer(ts.scene, ts.camera, cfg, nullptr);
+    renderer.render_frame();
+
+    CHECK(same_pixels(fixed, renderer.image()));
+    CHECK(renderer.sample_count(0, 0) == ts.image.samples);
+    CHECK(renderer.sample_count(69, 40) == ts.image.samples);
+}
+
+TEST_CASE("Progressive rendering stops at the time budget with every pixel sampled") {
+    TestScene ts;
+    io::ImageDTO cfg = ts.image;
+    cfg.threads = 2;
+    cfg.samples = 1000000;
+    cfg.time_budget_ms = 50;
+    raylabs::Renderer renderer(ts.scene, ts.camera, cfg, nullptr);
+    renderer.render_frame();
+
+    int min_spp = cfg.samples;
+    int max_spp = 0;
+    for (int y = 0; y < cfg.height; ++y) {
+        for (int x = 0; x < cfg.width; ++x) {
+            min_spp = std::min(min_spp, renderer.sample_count(x, y));
+            max_spp = std::max(max_spp, renderer.sample_count(x, y));
+        }
+    }
+    CHECK(min_spp >= 1);
+    CHECK(max_spp < cfg.samples);
+    CHECK(max_spp - min_spp <= 1);
+}
+
+TEST_CASE("Adaptive sampling moves samples from flat to noisy pixels within the budget") {
+    TestScene ts;
+    io::ImageDTO cfg = ts.image;
+    cfg.threads = 3;
+    cfg.samples = 8;
+    cfg.adaptive = true;
+    cfg.adaptive_threshold = 0.02f;
+    cfg.min_samples = 4;
+    raylabs::Renderer renderer(ts.scene, ts.camera, cfg, nullptr);
+    renderer.render_frame();
+
+    long total = 0;
+    int min_spp = 1 << 30;
+    int max_spp = 0;
+    for (int y = 0; y < cfg.height; ++y) {
+        for (int x = 0; x < cfg.width; ++x) {
+            const int spp = renderer.sample_count(x, y);
+            total += spp;
+            min_spp = std::min(min_spp, spp);
+            max_spp = std::max(max_spp, spp);
+        }
+    }
+    const long pixels = static_cast<long>(cfg.width) * cfg.height;
+    CHECK(min_spp == cfg.min_samples);   // the sky converges right after the minimum
+    CHECK(max_spp > cfg.samples);        // the glass/metal spheres got the savings
+    CHECK(max_spp <= 8 * cfg.samples);   // default per-pixel cap
+    CHECK(total <= pixels * cfg.samples + pixels);  // at most one pass over budget
+
+    // Convergence decisions only depend on each pixel's own samples
+    cfg.threads = 1;
+    raylabs::Renderer single(ts.scene, ts.camera, cfg, nullptr);
+    single.render_frame();
+    CHECK(same_pixels(renderer.image(), single.image()));
+}
+
+TEST_CASE("PixelStats tracks mean and variance with Welford updates") {
+    raylabs::PixelStats st;
+    for (float v : {2.0f, 4.0f, 4.0f, 4.0f, 5.0f, 5.0f, 7.0f, 9.0f}) {
+        st.add(v);
+    }
+    CHECK(st.n == 8);
+    CHECK(st.mean == doctest::Approx(5.0f));
+    CHECK(st.variance() == doctest::Approx(32.0f / 7.0f));
+    CHECK(st.standard_error() == doctest::Approx(std::sqrt(32.0f / 7.0f / 8.0f)));
+}
+
+TEST_CASE("Packet camera rays render the same image as single rays") {
+    TestScene ts;
+    Image scalar = ts.render(2);
+    for (int width : {4, 8, 16}) {
+        io::ImageDTO cfg = ts.image;
+        cfg.threads = 2;
+        cfg.packet_size = width;
+        raylabs::Renderer renderer(ts.scene, ts.camera, cfg, nullptr);
+        renderer.render_frame();
+
+        // The packet kernels use hardware sqrt, so allow for last-bit differences in t
+        CHECK(mean_abs_diff(scalar, renderer.image()) < 0.01);
+    }
+}
+
+TEST_CASE("Wavefront integrator matches the recursive path tracer") {
+    TestScene ts;
+    ts.image.max_depth = 6;
+    Image recursive = ts.render(2, "path");
+    Image wavefront = ts.render(2, "wavefront");
+    // Same random streams per path; only the order of the throughput products differs
+    CHECK(mean_abs_diff(recursive, wavefront) < 0.01);
+    CHECK(same_pixels(wavefront, ts.render(5, "wavefront")));
+}
+
+TEST_CASE("Point lights reach diffuse surfaces through shadow rays") {
+    Scene scene;
+    auto ground = std::make_shared<Lambertian>(Color(0.5f, 0.5f, 0.5f));
+    scene.add(std::make_shared<Plane>(Point3(0, 0, 0), Vec3(0, 1, 0)), ground);
+    scene.lights.push_back({Point3(0, 2, 0), Color(8.0f, 4.0f, 2.0f)});
+
+    HitRecord rec{};
+    const Ray down(Point3(0, 1, 0), Vec3(0, -1, 0));
+    REQUIRE(scene.hit(down, 0.001f, 1e9f, rec));
+    // albedo / pi * intensity * cos / distance^2, the light 2 units straight above
+    const float d = 2.0f - 0.001f;
+    const Color lit = raylabs::Integrator::direct_lighting(rec, scene);
+    CHECK(lit.R() == doctest::Approx(0.5f * 8.0f / (3.14159265f * d * d)));
+    CHECK(lit.B() == doctest::Approx(lit.R() / 4.0f));
+
+    // A sphere between the point and the light casts a shadow; one off to the side does not
+    scene.add(std::make_shared<Sphere>(Point3(3, 1, 0), 0.5f), ground);
+    scene.build_acceleration();
+    CHECK(raylabs::Integrator::direct_lighting(rec, scene).R() == doctest::Approx(lit.R()));
+    scene.add(std::make_shared<Sphere>(Point3(0, 1, 0), 0.5f), ground);
+    CHECK(raylabs::Integrator::direct_lighting(rec, scene).R() == 0.0f);
+
+    // Mirrors and glass are not lit directly
+    HitRecord mirror = rec;
+    const Metal metal(Color(0.9f, 0.9f, 0.9f), 0.0f);
+    mirror.material = &metal;
+    scene.entities.pop_back();
+    CHECK(raylabs::Integrator::direct_lighting(mirror, scene).R() == 0.0f);
+}
+
+TEST_CASE("Sorting bounced rays leaves the wavefront image unchanged") {
+    TestScene ts;
+    ts.image.max_depth = 6;
+    // Paths carry their pixel and random stream through the reordering
+    CHECK(same_pixels(ts.render(2, "wavefront", true), ts.render(2, "wavefront")));
+    auto sorted = std::dynamic_pointer_cast<raylabs::WavefrontPathTracer>(
+        raylabs::Integrator::create("wavefront", true));
+    REQUIRE(sorted);
+    CHECK(sorted->sort_rays());
+}
+
+TEST_CASE("Wavefront integrator handles single rays and zero depth") {
+    TestScene ts;
+    auto wavefront = raylabs::Integrator::create("wavefront");
+    CHECK(wavefront->prefers_batches());
+    Ray up(Point3(0, 1, 0), Vec3(0, 1, 0));
+    Color sky = wavefront->trace(up, ts.scene, 4);
+    Color expected = raylabs::Environment::sky_color(up.direction);
+    CHECK(sky.R() == doctest::Approx(expected.R()));
+    CHECK(sky.B() == doctest::Approx(expected.B()));
+    Color none = wavefront->trace(up, ts.scene, 0);
+    CHECK(none.R() == 0.0f);
+    CHECK_THROWS_AS(raylabs::Integrator::create("bidirectional"), std::runtime_error);
+}
+
+TEST_CASE("A render resumed from a checkpoint matches an uninterrupted one") {
+    TestScene ts;
+    Image fixed = ts.render(2);
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "raylabs_test_resume.ckpt").string();
+
+    // "Interrupted" after one of the three passes
+    io::ImageDTO first = ts.image;
+    first.threads = 2;
+    first.samples = 1;
+    first.checkpoint_path = path;
+    first.checkpoint_interval_ms = 0;
+    raylabs::Renderer partial(ts.scene, ts.camera, first, nullptr);
+    partial.render_frame();
+
+    raylabs::Checkpoint cp = raylabs::Checkpoint::load(path);
+    CHECK(cp.pass == 1);
+    CHECK(cp.width == ts.image.width);
+    CHECK(cp.sample_counts[0] == 1);
+
+    io::ImageDTO resumed = ts.image;
+    resumed.threads = 3;
+    resumed.resume_path = path;
+    raylabs::Renderer renderer(ts.scene, ts.camera, resumed, nullptr);
+    renderer.render_frame();
+    CHECK(same_pixels(fixed, renderer.image()));
+    CHECK(raylabs::Checkpoint::load(path).pass == 3);
+
+    // Mismatched frame size, crop window, path depth, scene or a lower sample count
+    io::ImageDTO other = resumed;
+    other.width = 32;
+    raylabs::Renderer wrong(ts.scene, ts.camera, other, nullptr);
+    CHECK_THROWS_AS(wrong.render_frame(), std::runtime_error);
+    other = resumed;
+    other.crop_x = 8;
+    other.crop_y = 8;
+    other.crop_width = 16;
+    other.crop_height = 16;
+    raylabs::Renderer cropped(ts.scene, ts.camera, other, nullptr);
+    CHECK_THROWS_AS(cropped.render_frame(), std::runtime_error);
+    other = resumed;
+    other.samples = 2;
+    raylabs::Renderer fewer(ts.scene, ts.camera, other, nullptr);
+    CHECK_THROWS_AS(fewer.render_frame(), std::runtime_error);
+    other = resumed;
+    other.max_depth = 8;
+    raylabs::Renderer deeper(ts.scene, ts.camera, other, nullptr);
+    CHECK_THROWS_AS(deeper.render_frame(), std::runtime_error);
+    TestScene edited;
+    edited.scene.lights[0].intensity = Color(1.0f, 1.0f, 1.0f);
+    raylabs::Renderer relit(edited.scene, edited.camera, resumed, nullptr);
+    CHECK_THROWS_AS(relit.render_frame(), std::runtime_error);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("A pass cut by the time budget is not checkpointed as done") {
+    TestScene ts;
+    ts.image.samples = 40;
+    Image fixed = ts.render(2);
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "raylabs_test_cut.ckpt").string();
+
+    io::ImageDTO first = ts.image;
+    first.threads = 2;
+    first.time_budget_ms = 20;
+    first.checkpoint_path = path;
+    first.checkpoint_interval_ms = 0;
+    raylabs::Renderer partial(ts.scene, ts.camera, first, nullptr);
+    partial.render_frame();
+
+    // Every pixel has the samples of the passes counted, some one more from the cut pass
+    const raylabs::Checkpoint cp = raylabs::Checkpoint::load(path);
+    CHECK(cp.pass < ts.image.samples);
+    const auto [lowest, highest] =
+        std::minmax_element(cp.sample_counts.begin(), cp.sample_counts.end());
+    CHECK(*lowest == cp.pass);
+    CHECK(*highest <= cp.pass + 1);
+
+    // Resuming brings every pixel to the target, as if never interrupted
+    io::ImageDTO resumed = ts.image;
+    resumed.threads = 2;
+    resumed.resume_path = path;
+    raylabs::Renderer renderer(ts.scene, ts.camera, resumed, nullptr);
+    renderer.render_frame();
+    CHECK(renderer.sample_count(0, 0) == ts.image.samples);
+    CHECK(renderer.sample_count(69, 40) == ts.image.samples);
+    CHECK(same_pixels(fixed, renderer.image()));
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Progressive sums keep samples unclamped until the image is resolved") {
+    TestScene ts;
+    ts.scene.lights[0].intensity = Color(400.0f, 400.0f, 400.0f);
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "raylabs_test_unclamped.ckpt").string();
+    io::ImageDTO cfg = ts.image;
+    cfg.threads = 2;
+    cfg.samples = 1;
+    cfg.checkpoint_path = path;
+    cfg.checkpoint_interval_ms = 0;
+    raylabs::Renderer renderer(ts.scene, ts.camera, cfg, nullptr);
+    renderer.render_frame();
+
+    const raylabs::Checkpoint cp = raylabs::Checkpoint::load(path);
+    float brightest = 0.0f;
+    for (const Color& c : cp.accum)
+        brightest = std::max({brightest, c.R(), c.G(), c.B()});
+    CHECK(brightest > 1.0f);
+    for (unsigned y = 0; y < renderer.image().Height(); ++y) {
+        for (unsigned x = 0; x < renderer.image().Width(); ++x)
+            CHECK(renderer.image().GetPixel(x, y).R() <= 1.0f);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Checkpoint round-trips adaptive state and rejects foreign files") {
+    raylabs::Checkpoint cp;
+    cp.width = 2;
+    cp.height = 1;
+    cp.samples = 6;
+    cp.window[2] = 2;
+    cp.window[3] = 1;
+    cp.adaptive = true;
+    cp.pass = 7;
+    cp.max_depth = 5;
+    cp.scene_digest = 0x0123456789abcdefull;
+    cp.spent = 12;
+    cp.accum = {Color(1.5f, 0.25f, 0.0f), Color(0.0f, 2.0f, 3.0f)};
+    cp.sample_counts = {5, 7};
+    cp.stats = {raylabs::PixelStats{5, 0.5f, 0.1f}, raylabs::PixelStats{7, 0.25f, 0.2f}};
+    cp.active = {0, 1};
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "raylabs_test_roundtrip.ckpt").string();
+    raylabs::CheckpointWriter writer;
+    writer.write(cp, path);
+    writer.wait();
+
+    raylabs::Checkpoint back = raylabs::Checkpoint::load(path);
+    CHECK(back.pass == 7);
+    CHECK(back.samples == 6);
+    CHECK(back.window[2] == 2);
+    CHECK(back.spent == 12);
+    CHECK(back.max_depth == 5);
+    CHECK(back.scene_digest == 0x0123456789abcdefull);
+    CHECK(back.adaptive);
+    CHECK(back.accum[0].R() == 1.5f);
+    CHECK(back.accum[1].B() == 3.0f);
+    CHECK(back.sample_counts[1] == 7);
+    CHECK(back.stats[1].m2 == 0.2f);
+    CHECK(back.active[0] == 0);
+    CHECK(back.active[1] == 1);
+
+    {
+        std::ofstream junk(path, std::ios::binary | std::ios::trunc);
+        junk << "not a checkpoint at all, just some text";
+    }
+    CHECK_THROWS_AS(raylabs::Checkpoint::load(path), std::runtime_error);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Crop window renders the same pixels as the full frame and nothing else") {
+    TestScene ts;
+    Image full = ts.render(2);
+
+    for (bool progressive : {false, true}) {
+        io::ImageDTO cfg = ts.image;
+        cfg.threads = 2;
+        cfg.progressive = progressive;
+        cfg.crop_x = 21;
+        cfg.crop_y = 9;
+        cfg.crop_width = 40;
+        cfg.crop_height = 17;
+        raylabs::Renderer renderer(ts.scene, ts.camera, cfg, nullptr);
+        renderer.render_frame();
+
+        Image cropped = renderer.output_image(renderer.image());
+        CHECK(same_pixels(cropped, full.Crop(21, 9, 40, 17)));
+        CHECK(renderer.sample_count(0, 0) == 0);
+        CHECK(renderer.sample_count(21, 9) == cfg.samples);
+
+        cfg.crop_full_frame = true;
+        raylabs::Renderer keep_frame(ts.scene, ts.camera, cfg, nullptr);
+        Image frame = keep_frame.output_image(renderer.image());
+        CHECK(frame.Width() == 70);
+        CHECK(frame.GetPixel(20, 9).R() == 0.0f);
+        CHECK(frame.GetPixel(61, 25).G() == 0.0f);
+    }
+
+    io::ImageDTO outside = ts.image;
+    outside.crop_x = 60;
+    outside.crop_width = 20;
+    outside.crop_height = 5;
+    CHECK_THROWS_AS(raylabs::Renderer(ts.scene, ts.camera, outside, nullptr), std::runtime_error);
+}
+
+TEST_CASE("Tile traversal order does not change the image") {
+    TestScene ts;
+    ts.image.tile_order = "row";
+    Image row_major = ts.render(3);
+    for (const char* order : {"morton", "hilbert"}) {
+        io::ImageDTO cfg = ts.image;
+        cfg.threads = 3;
+        cfg.tile_order = order;
+        raylabs::Renderer renderer(ts.scene, ts.camera, cfg, nullptr);
+        renderer.render_frame();
+        CHECK(same_pixels(row_major, renderer.image()));
+    }
+
+    io::ImageDTO bad = ts.image;
+    bad.tile_order = "spiral";
+    CHECK_THROWS_AS(raylabs::Renderer(ts.scene, ts.camera, bad, nullptr), std::runtime_error);
+}
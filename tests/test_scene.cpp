@@ -1,12 +1,107 @@
 #include <doctest/doctest.h>
 
+#include <algorithm>
 #include <memory>
+#include <random>
+#include <stdexcept>
+#include <vector>
 
 #include "core/HitRecord.hpp"
 #include "core/Ray.hpp"
+#include "core/RayPacket.hpp"
 #include "core/Scene.hpp"
+#include "entities/Instance.hpp"
 #include "entities/Plane.hpp"
+#include "entities/Sphere.hpp"
+#include "entities/SphereBatch.hpp"
 #include "entities/Triangle.hpp"
+#include "entities/TriangleMesh.hpp"
+#include "materials/Lambertian.hpp"
+#include "math/Transform.hpp"
+
+namespace {
+
+// How far a scene of grouped shapes may stray from the same shapes added one by one
+struct HitTolerance {
+    float t_epsilon = 0.0f;  // relative; 0 asks for the very same distance
+    float normal_distance_squared = 1e-6f;
+    int disagreements = 0;  // rays that hit (or are occluded) in only one of the scenes
+    float occlusion_range = 1e9f;
+};
+
+std::vector<Ray> random_rays(std::mt19937& rng, int count, const Vec3& extent) {
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    std::vector<Ray> rays;
+    for (int i = 0; i < count; ++i) {
+        const Point3 origin(extent.x * u(rng), extent.y * u(rng), extent.z * u(rng));
+        const Vec3 direction(u(rng), u(rng), u(rng));
+        rays.emplace_back(origin, direction);
+    }
+    return rays;
+}
+
+// Trace `rays` through both scenes and check that `scene` finds the hits of `reference`:
+// distance, normal, side and material, both scalar and through packet_hit_record() on
+// packets of 8. Returns the number of rays that hit.
+int compare_hits(const Scene& reference, const Scene& scene, const std::vector<Ray>& rays,
+                 const HitTolerance& tolerance = {}) {
+    constexpr int N = 8;
+    auto check_same = [&](const HitRecord& rec, const HitRecord& expected, float t_epsilon) {
+        if (t_epsilon == 0.0f)
+            CHECK(rec.t == expected.t);
+        else
+            CHECK(rec.t == doctest::Approx(expected.t).epsilon(t_epsilon));
+        CHECK((rec.normal - expected.normal).length_squared() <=
+              tolerance.normal_distance_squared);
+        CHECK(rec.front_face == expected.front_face);
+        CHECK(rec.material == expected.material);
+    };
+    int hits = 0;
+    int disagreements = 0;
+    for (std::size_t first = 0; first < rays.size(); first += N) {
+        const int count = static_cast<int>(std::min<std::size_t>(N, rays.size() - first));
+        const auto packet = raylabs::RayPacket<N>::from_rays(rays.data() + first, count);
+        raylabs::PacketHit<N> packet_hit(1e9f);
+        scene.hit_packet(packet, 0.001f, packet_hit, raylabs::RayPacket<N>::first_lanes(count));
+        for (int lane = 0; lane < count; ++lane) {
+            const Ray& ray = rays[first + static_cast<std::size_t>(lane)];
+            HitRecord expected{};
+            HitRecord rec{};
+            HitRecord from_packet{};
+            const bool found = reference.hit(ray, 0.001f, 1e9f, expected);
+            if (scene.hit(ray, 0.001f, 1e9f, rec) != found ||
+                scene.packet_hit_record(ray, packet_hit, lane, from_packet) != found ||
+                scene.occluded(ray, 0.001f, tolerance.occlusion_range) !=
+                    reference.occluded(ray, 0.001f, tolerance.occlusion_range)) {
+                ++disagreements;
+                continue;
+            }
+            if (!found)
+                continue;
+            ++hits;
+            check_same(rec, expected, tolerance.t_epsilon);
+            // SIMD kernels round the packet distance their own way
+            check_same(from_packet, expected, std::max(tolerance.t_epsilon, 1e-4f));
+        }
+    }
+    CHECK(disagreements <= tolerance.disagreements);
+    return hits;
+}
+
+// Copies of the spheres and triangles of `prototype`, moved by `t`, with their materials
+void add_copies(Scene& flat, const Scene& prototype, const raylabs::Transform& t) {
+    for (const Scene::Entity& e : prototype.entities) {
+        std::shared_ptr<Shape> copy;
+        if (auto sphere = std::dynamic_pointer_cast<Sphere>(e.shape))
+            copy = std::make_shared<Sphere>(*sphere);
+        else
+            copy = std::make_shared<Triangle>(*std::dynamic_pointer_cast<Triangle>(e.shape));
+        copy->transform(t);
+        flat.add(copy, e.material);
+    }
+}
+
+}  // namespace
 
 TEST_CASE("Scene hit returns closest shape") {
     Scene scene;
@@ -23,3 +118,417 @@ TEST_CASE("Scene hit returns closest shape") {
     CHECK(rec.t == doctest::Approx(1.0f));
     CHECK(rec.point.y == doctest::Approx(0.0f));
 }
+
+TEST_CASE("Instances hit like transformed copies of their prototype") {
+    auto prototype = std::make_shared<Scene>();
+    prototype->add(std::make_shared<Sphere>(Point3(0, 0, 0), 0.5f));
+    prototype->add(std::make_shared<Triangle>(Point3(0.6f, 0, 0), Point3(1.2f, 0, 0),
+                                              Point3(0.6f, 0.7f, 0.3f)));
+    prototype->build_acceleration();
+
+    Scene instanced;
+    Scene flat;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    for (int i = 0; i < 200; ++i) {
+        const auto t = raylabs::Transform::translate(Vec3(8 * u(rng), 8 * u(rng), 8 * u(rng))) *
+                       raylabs::Transform::rotate(Vec3(u(rng), u(rng), 1.0f), 3 * u(rng)) *
+                       raylabs::Transform::uniform_scale(1.0f + 0.5f * u(rng));
+        instanced.add(std::make_shared<Instance>(prototype, t));
+        add_copies(flat, *prototype, t);
+    }
+    instanced.build_acceleration();
+    flat.build_acceleration();
+    CHECK(instanced.bvh().primitive_count() == 200);
+
+    // Object-space rounding may flip rays grazing a silhouette or a triangle edge
+    HitTolerance tolerance;
+    tolerance.t_epsilon = 1e-3f;
+    tolerance.normal_distance_squared = 2e-3f;
+    tolerance.disagreements = 2;
+    CHECK(compare_hits(flat, instanced, random_rays(rng, 2000, Vec3(10, 10, 10)), tolerance) >
+          100);
+
+    // Moving an instance moves its box
+    const raylabs::Aabb before = instanced.entities[0].shape->bounds();
+    instanced.transform_entity(0, raylabs::Transform::translate(Vec3(0, 100, 0)));
+    CHECK(instanced.entities[0].shape->bounds().min.y == doctest::Approx(before.min.y + 100));
+}
+
+TEST_CASE("Hits are finalized for the closest entity, through instances") {
+    auto red = std::make_shared<Lambertian>(Color(1, 0, 0));
+    auto blue = std::make_shared<Lambertian>(Color(0, 0, 1));
+    auto prototype = std::make_shared<Scene>();
+    prototype->add(std::make_shared<Sphere>(Point3(0, 0, 0), 0.5f), red);
+    prototype->add(std::make_shared<Plane>(Point3(0, -1, 0), Vec3(0, 1, 0)), blue);
+    prototype->build_acceleration();
+
+    // Misses leave the search result alone
+    PrimitiveHit prim;
+    prim.t = 7.0f;
+    CHECK_FALSE(prototype->intersect(Ray(Point3(0, 2, 0), Vec3(1, 0, 0)), 0.001f, 1e9f, prim));
+    CHECK(prim.t == 7.0f);
+
+    const auto shift = raylabs::Transform::translate(Vec3(3, 0, 0));
+    const auto turn = raylabs::Transform::rotate(Vec3(0, 0, 1), 0.3f);
+    Scene single;
+    single.add(std::make_shared<Instance>(prototype, shift * turn));
+    single.build_acceleration();
+    // The same placement through an instance of a scene of instances
+    auto middle = std::make_shared<Scene>();
+    middle->add(std::make_shared<Instance>(prototype, turn));
+    middle->build_acceleration();
+    Scene nested;
+    nested.add(std::make_shared<Instance>(middle, shift));
+    nested.build_acceleration();
+
+    for (const Ray& ray : {Ray(Point3(3, 5, 0.1f), Vec3(0, -1, 0)),
+                           Ray(Point3(5, 5, 3), Vec3(0, -1, 0))}) {
+        HitRecord expected{};
+        HitRecord rec{};
+        REQUIRE(single.hit(ray, 0.001f, 1e9f, expected));
+        REQUIRE(nested.hit(ray, 0.001f, 1e9f, rec));
+        CHECK(rec.t == doctest::Approx(expected.t));
+        CHECK(dot(rec.normal, expected.normal) == doctest::Approx(1.0f));
+        CHECK(rec.material == expected.material);
+    }
+    HitRecord rec{};
+    REQUIRE(nested.hit(Ray(Point3(3, 5, 0.1f), Vec3(0, -1, 0)), 0.001f, 1e9f, rec));
+    CHECK(rec.material == red.get());
+    REQUIRE(nested.hit(Ray(Point3(5, 5, 3), Vec3(0, -1, 0)), 0.001f, 1e9f, rec));
+    CHECK(rec.material == blue.get());
+
+    // The chain of prototype entities has room for a fixed number of levels
+    std::shared_ptr<Scene> level = middle;
+    for (int levels = 2; levels < PrimitiveHit::kMaxInstanceLevels; ++levels) {
+        auto outer = std::make_shared<Scene>();
+        outer->add(std::make_shared<Instance>(level, shift));
+        outer->build_acceleration();
+        level = outer;
+    }
+    const auto deepest = std::make_shared<Instance>(level, raylabs::Transform());
+    CHECK(deepest->levels() == PrimitiveHit::kMaxInstanceLevels);
+    REQUIRE(deepest->hit(Ray(Point3(3.0f * (PrimitiveHit::kMaxInstanceLevels - 2), 5, 0.1f),
+                             Vec3(0, -1, 0)),
+                         0.001f, 1e9f, rec));
+    CHECK(rec.material == red.get());
+    auto too_deep = std::make_shared<Scene>();
+    too_deep->add(deepest);
+    too_deep->build_acceleration();
+    CHECK_THROWS_AS(Instance(too_deep, raylabs::Transform()), std::runtime_error);
+}
+
+TEST_CASE("Occlusion queries agree with closest hits") {
+    auto prototype = std::make_shared<Scene>();
+    prototype->add(std::make_shared<Sphere>(Point3(0, 0, 0), 0.4f));
+    prototype->add(std::make_shared<Triangle>(Point3(0.5f, 0, 0), Point3(1.0f, 0, 0),
+                                              Point3(0.5f, 0.6f, 0.2f)));
+    prototype->build_acceleration();
+
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    Scene scene;
+    scene.add(std::make_shared<Plane>(Point3(0, -9, 0), Vec3(0, 1, 0)));
+    for (int i = 0; i < 300; ++i) {
+        const Point3 p(8 * u(rng), 8 * u(rng), 8 * u(rng));
+        if (i % 3 == 0)
+            scene.add(std::make_shared<Sphere>(p, 0.3f + 0.2f * u(rng)));
+        else if (i % 3 == 1)
+            scene.add(std::make_shared<Triangle>(p, p + Vec3(0.8f, 0, 0),
+                                                 p + Vec3(0, 0.8f, 0.3f)));
+        else
+            scene.add(std::make_shared<Instance>(
+                prototype, raylabs::Transform::translate(Vec3(p.x, p.y, p.z))));
+    }
+    std::vector<Ray> rays;
+    std::vector<float> ranges;
+    for (int i = 0; i < 1000; ++i) {
+        rays.emplace_back(Point3(10 * u(rng), 10 * u(rng), 10 * u(rng)),
+                          Vec3(u(rng), u(rng), u(rng)));
+        ranges.push_back(i % 2 == 0 ? 1e9f : 10.0f * (u(rng) + 1.0f));
+    }
+
+    auto check_scene = [&](const Scene& s) {
+        int blocked = 0;
+        for (std::size_t i = 0; i < rays.size(); ++i) {
+            HitRecord rec{};
+            const bool hit = s.hit(rays[i], 0.001f, ranges[i], rec);
+            CHECK(s.occluded(rays[i], 0.001f, ranges[i]) == hit);
+            blocked += hit ? 1 : 0;
+        }
+        CHECK(blocked > 100);
+        CHECK(blocked < static_cast<int>(rays.size()));
+    };
+    check_scene(scene);
+    for (int width : {2, 4, 8}) {
+        for (bool quantized : {false, true}) {
+            if (width == 2 && quantized)
+                continue;
+            raylabs::Bvh::BuildOptions options;
+            options.width = width;
+            options.quantized = quantized;
+            scene.build_acceleration(options);
+            check_scene(scene);
+        }
+    }
+}
+
+TEST_CASE("Triangle meshes hit like separate triangles") {
+    // Bumpy 40 x 40 height field, normals pointing up-ish
+    const int n = 40;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    auto buffers = std::make_shared<TriangleMesh::Buffers>();
+    for (int j = 0; j <= n; ++j) {
+        for (int i = 0; i <= n; ++i) {
+            buffers->x.push_back(static_cast<float>(i) * 0.25f - 5.0f);
+            buffers->y.push_back(0.05f * u(rng));
+            buffers->z.push_back(static_cast<float>(j) * 0.25f - 5.0f);
+            const Vec3 normal = normalize(Vec3(0.3f * u(rng), 1.0f, 0.3f * u(rng)));
+            buffers->nx.push_back(normal.x);
+            buffers->ny.push_back(normal.y);
+            buffers->nz.push_back(normal.z);
+        }
+    }
+    Scene flat;
+    auto vertex = [&](std::uint32_t k) {
+        return Point3(buffers->x[k], buffers->y[k], buffers->z[k]);
+    };
+    for (std::uint32_t j = 0; j < n; ++j) {
+        for (std::uint32_t i = 0; i < n; ++i) {
+            const std::uint32_t k = j * (n + 1) + i;
+            for (std::uint32_t index : {k, k + n + 1, k + 1, k + 1, k + n + 1, k + n + 2})
+                buffers->indices.push_back(index);
+            flat.add(std::make_shared<Triangle>(vertex(k), vertex(k + n + 1), vertex(k + 1)));
+            flat.add(std::make_shared<Triangle>(vertex(k + 1), vertex(k + n + 1),
+                                                vertex(k + n + 2)));
+        }
+    }
+    flat.build_acceleration();
+    raylabs::Bvh::BuildOptions compact;
+    compact.quantized = true;
+    auto mesh = std::make_shared<TriangleMesh>(buffers, nullptr, compact);
+    CHECK(mesh->triangle_count() == 2 * n * n);
+    CHECK(mesh->memory_bytes() < 64 * mesh->triangle_count());
+    Scene scene;
+    scene.add(mesh);
+    scene.build_acceleration();
+
+    // Smooth normals lean away from the faceted ones, but stay on the same side
+    HitTolerance tolerance;
+    tolerance.normal_distance_squared = 1.0f;
+    const std::vector<Ray> rays = random_rays(rng, 2000, Vec3(6, 3, 6));
+    CHECK(compare_hits(flat, scene, rays, tolerance) > 500);
+    for (std::size_t i = 0; i < rays.size(); i += 10) {
+        HitRecord rec{};
+        if (scene.hit(rays[i], 0.001f, 1e9f, rec))
+            CHECK(rec.normal.length() == doctest::Approx(1.0f));
+    }
+
+    // The mesh's own BVH follows the options it is given
+    for (int width : {2, 8}) {
+        raylabs::Bvh::BuildOptions options;
+        options.width = width;
+        options.max_leaf_size = 2;
+        const TriangleMesh other(buffers, nullptr, options);
+        for (int i = 0; i < 200; ++i) {
+            const Ray ray(Point3(6 * u(rng), 3 * u(rng), 6 * u(rng)),
+                          Vec3(u(rng), u(rng), u(rng)));
+            HitRecord expected{};
+            HitRecord rec{};
+            REQUIRE(other.hit(ray, 0.001f, 1e9f, rec) == mesh->hit(ray, 0.001f, 1e9f, expected));
+            CHECK(rec.t == expected.t);
+        }
+    }
+
+    // Long diagonal slivers: spatial splits inside the mesh add references, not hits
+    auto slivers = std::make_shared<TriangleMesh::Buffers>();
+    Scene sliver_triangles;
+    for (std::uint32_t k = 0; k < 64; ++k) {
+        const float z = -2.0f + 0.0625f * static_cast<float>(k);
+        const Point3 corners[3] = {Point3(-5, -5, z), Point3(5, 5, z), Point3(-5, -4.8f, z + 0.5f)};
+        for (const Point3& p : corners) {
+            slivers->x.push_back(p.x);
+            slivers->y.push_back(p.y);
+            slivers->z.push_back(p.z);
+            slivers->indices.push_back(static_cast<std::uint32_t>(slivers->indices.size()));
+        }
+        sliver_triangles.add(std::make_shared<Triangle>(corners[0], corners[1], corners[2]));
+    }
+    sliver_triangles.build_acceleration();
+    raylabs::Bvh::BuildOptions spatial;
+    spatial.spatial_split_budget = 1.0f;
+    const TriangleMesh split(slivers, nullptr, spatial);
+    CHECK(split.memory_bytes() > TriangleMesh(slivers).memory_bytes());
+    for (int i = 0; i < 500; ++i) {
+        const Ray ray(Point3(6 * u(rng), 6 * u(rng), 6 * u(rng)), Vec3(u(rng), u(rng), u(rng)));
+        HitRecord expected{};
+        HitRecord rec{};
+        REQUIRE(split.hit(ray, 0.001f, 1e9f, rec) ==
+                sliver_triangles.hit(ray, 0.001f, 1e9f, expected));
+        CHECK(rec.t == expected.t);
+    }
+
+    raylabs::Bvh::BuildOptions binary_quantized;
+    binary_quantized.width = 2;
+    binary_quantized.quantized = true;
+    CHECK_THROWS_AS(TriangleMesh(buffers, nullptr, binary_quantized), std::runtime_error);
+
+    // Moving the mesh leaves the shared buffers alone
+    mesh->transform(raylabs::Transform::translate(Vec3(0, 10, 0)));
+    CHECK(buffers->y[0] == doctest::Approx(mesh->buffers().y[0] - 10.0f));
+    CHECK(mesh->bounds().min.y > 9.0f);
+
+    auto broken = std::make_shared<TriangleMesh::Buffers>(*buffers);
+    broken->indices.push_back(0);
+    CHECK_THROWS_AS(TriangleMesh{broken}, std::runtime_error);
+    broken->indices.push_back(1);
+    broken->indices.push_back(static_cast<std::uint32_t>(buffers->vertex_count()));
+    CHECK_THROWS_AS(TriangleMesh{broken}, std::runtime_error);
+    broken = std::make_shared<TriangleMesh::Buffers>(*buffers);
+    broken->nx.push_back(0.0f);
+    CHECK_THROWS_AS(TriangleMesh{broken}, std::runtime_error);
+}
+
+TEST_CASE("Sphere batches hit like separate spheres") {
+    // A cloud of small spheres around a large one, three materials
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    std::vector<std::shared_ptr<Material>> materials;
+    for (int i = 0; i < 3; ++i)
+        materials.push_back(std::make_shared<Lambertian>(Color(0.3f * i, 0.5f, 0.5f)));
+    std::vector<SphereBatch::Member> members;
+    members.push_back({Point3(0, -105, 0), 100.0f, materials[0]});
+    for (int i = 0; i < 500; ++i) {
+        members.push_back({Point3(8 * u(rng), 8 * u(rng), 8 * u(rng)), 0.2f + 0.3f * (u(rng) + 1),
+                           materials[static_cast<std::size_t>(i % 3)]});
+    }
+    Scene flat;
+    for (const auto& m : members)
+        flat.add(std::make_shared<Sphere>(m.center, m.radius), m.material);
+    flat.build_acceleration();
+    const auto batches = SphereBatch::group(members);
+    CHECK(batches.size() < members.size() / 2);
+    Scene batched;
+    std::size_t grouped = 0;
+    for (const auto& batch : batches) {
+        batched.add(batch);
+        grouped += static_cast<std::size_t>(batch->size());
+        // The large sphere is alone in its batch
+        if (batch->radius(0) == 100.0f)
+            CHECK(batch->size() == 1);
+    }
+    CHECK(grouped == members.size());
+    batched.build_acceleration();
+
+    // Within the rounding of the SIMD square root, which the scalar sphere computes
+    // differently (and not quite unit length on the large sphere)
+    HitTolerance tolerance;
+    tolerance.t_epsilon = 1e-5f;
+    tolerance.occlusion_range = 20.0f;
+    CHECK(compare_hits(flat, batched, random_rays(rng, 2000, Vec3(10, 10, 10)), tolerance) >
+          1000);
+
+    const Point3 before = batches[0]->center(0);
+    batches[0]->transform(raylabs::Transform::translate(Vec3(0, 50, 0)));
+    CHECK(batches[0]->center(0).y == doctest::Approx(before.y + 50.0f));
+    CHECK(batches[0]->center(0).x == doctest::Approx(before.x));
+    CHECK_THROWS_AS(SphereBatch(std::vector<SphereBatch::Member>{}), std::runtime_error);
+    CHECK_THROWS_AS(SphereBatch(std::vector<SphereBatch::Member>(SphereBatch::kWidth + 1)),
+                    std::runtime_error);
+}
+
+TEST_CASE("Nested instances hit like separate copies") {
+    auto red = std::make_shared<Lambertian>(Color(1, 0, 0));
+    auto blue = std::make_shared<Lambertian>(Color(0, 0, 1));
+    auto prototype = std::make_shared<Scene>();
+    prototype->add(std::make_shared<Sphere>(Point3(0, 0, 0), 0.5f), red);
+    prototype->add(std::make_shared<Triangle>(Point3(0.6f, 0, 0), Point3(1.2f, 0, 0),
+                                              Point3(0.6f, 0.7f, 0.3f)),
+                   blue);
+    prototype->build_acceleration();
+
+    // Clusters of instances, themselves instanced around the scene
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> u(-1.0f, 1.0f);
+    std::vector<raylabs::Transform> inner;
+    auto cluster = std::make_shared<Scene>();
+    for (int i = 0; i < 8; ++i) {
+        inner.push_back(raylabs::Transform::translate(Vec3(2 * u(rng), 2 * u(rng), 2 * u(rng))) *
+                        raylabs::Transform::rotate(Vec3(u(rng), 1.0f, u(rng)), 3 * u(rng)));
+        cluster->add(std::make_shared<Instance>(prototype, inner.back()));
+    }
+    cluster->build_acceleration();
+    Scene nested;
+    Scene flat;
+    for (int i = 0; i < 30; ++i) {
+        const auto outer =
+            raylabs::Transform::translate(Vec3(7 * u(rng), 7 * u(rng), 7 * u(rng))) *
+            raylabs::Transform::rotate(Vec3(1.0f, u(rng), u(rng)), 3 * u(rng)) *
+            raylabs::Transform::uniform_scale(1.0f + 0.3f * u(rng));
+        nested.add(std::make_shared<Instance>(cluster, outer));
+        for (const raylabs::Transform& t : inner)
+            add_copies(flat, *prototype, outer * t);
+    }
+    nested.build_acceleration();
+    flat.build_acceleration();
+
+    // Each level of object space adds its own rounding
+    HitTolerance tolerance;
+    tolerance.t_epsilon = 1e-3f;
+    tolerance.normal_distance_squared = 2e-3f;
+    tolerance.disagreements = 4;
+    CHECK(compare_hits(flat, nested, random_rays(rng, 2000, Vec3(10, 10, 10)), tolerance) > 100);
+}
+
+TEST_CASE("Grouped shapes agree with separate ones on grazing and touching rays") {
+    // Two unit spheres touching at the origin, above a quad split along its diagonal
+    auto red = std::make_shared<Lambertian>(Color(1, 0, 0));
+    auto blue = std::make_shared<Lambertian>(Color(0, 0, 1));
+    const Point3 corners[4] = {Point3(-3, -2, -3), Point3(3, -2, -3), Point3(3, -2, 3),
+                               Point3(-3, -2, 3)};
+    auto flat = std::make_shared<Scene>();
+    flat->add(std::make_shared<Sphere>(Point3(-1, 0, 0), 1.0f), red);
+    flat->add(std::make_shared<Sphere>(Point3(1, 0, 0), 1.0f), blue);
+    flat->add(std::make_shared<Triangle>(corners[0], corners[1], corners[2]), red);
+    flat->add(std::make_shared<Triangle>(corners[0], corners[2], corners[3]), red);
+    flat->build_acceleration();
+
+    auto buffers = std::make_shared<TriangleMesh::Buffers>();
+    for (const Point3& p : corners) {
+        buffers->x.push_back(p.x);
+        buffers->y.push_back(p.y);
+        buffers->z.push_back(p.z);
+    }
+    for (std::uint32_t index : {0u, 1u, 2u, 0u, 2u, 3u})
+        buffers->indices.push_back(index);
+    Scene grouped;
+    grouped.add(std::make_shared<SphereBatch>(std::vector<SphereBatch::Member>{
+        {Point3(-1, 0, 0), 1.0f, red}, {Point3(1, 0, 0), 1.0f, blue}}));
+    grouped.add(std::make_shared<TriangleMesh>(buffers), red);
+    grouped.build_acceleration();
+    Scene instanced;
+    instanced.add(std::make_shared<Instance>(flat, raylabs::Transform()));
+    instanced.build_acceleration();
+
+    std::vector<Ray> rays;
+    // Tangent to the top and to the side of one sphere (rays through the contact point
+    // would tie between the spheres), and head-on through both centres
+    rays.emplace_back(Point3(-1, 1, 5), Vec3(0, 0, -1));
+    rays.emplace_back(Point3(-2, 5, 0), Vec3(0, -1, 0));
+    rays.emplace_back(Point3(-5, 0, 0), Vec3(1, 0, 0));
+    rays.emplace_back(Point3(5, 0, 0), Vec3(-1, 0, 0));
+    // Down onto the shared edge, the shared and the lone corners, and the outer edge
+    for (const Point3& p : {Point3(2.5f, 5, 2.5f), Point3(-2.5f, 5, -2.5f), Point3(3, 5, 3),
+                            Point3(-3, 5, -3), Point3(3, 5, -3), Point3(3, 5, 0)})
+        rays.emplace_back(p, Vec3(0, -1, 0));
+    // In the plane of the quad, and just past its edge
+    rays.emplace_back(Point3(-5, -2, 1), Vec3(1, 0, 0));
+    rays.emplace_back(Point3(3.001f, 5, 0), Vec3(0, -1, 0));
+
+    HitTolerance tolerance;
+    tolerance.t_epsilon = 1e-5f;
+    const int hits = compare_hits(*flat, grouped, rays, tolerance);
+    CHECK(hits >= 8);
+    CHECK(compare_hits(*flat, instanced, rays, tolerance) == hits);
+}
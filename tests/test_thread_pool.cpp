@@ -0,0 +1,50 @@
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include "utils/ThreadPool.hpp"
+
+TEST_CASE("ThreadPool parallel_for visits every index exactly once") {
+    raylabs::ThreadPool pool(4);
+    CHECK(pool.size() == 4);
+
+    std::vector<std::atomic<int>> visits(1000);
+    pool.parallel_for(visits.size(), [&](std::size_t i) { visits[i].fetch_add(1); });
+
+    bool all_once = true;
+    for (const auto& v : visits) {
+        all_once = all_once && v.load() == 1;
+    }
+    CHECK(all_once);
+}
+
+TEST_CASE("ThreadPool supports nested parallel_for") {
+    raylabs::ThreadPool pool(3);
+    std::atomic<int> total{0};
+    pool.parallel_for(8, [&](std::size_t) {
+        pool.parallel_for(16, [&](std::size_t) { total.fetch_add(1); });
+    });
+    CHECK(total.load() == 8 * 16);
+}
+
+TEST_CASE("ThreadPool rethrows task exceptions after finishing the loop") {
+    raylabs::ThreadPool pool(2);
+    std::atomic<int> ran{0};
+    CHECK_THROWS_AS(pool.parallel_for(32,
+                                      [&](std::size_t i) {
+                                          ran.fetch_add(1);
+                                          if (i == 5)
+                                              throw std::runtime_error("boom");
+                                      }),
+                    std::runtime_error);
+    CHECK(ran.load() == 32);
+}
+
+TEST_CASE("ThreadPool with a single thread runs inline") {
+    raylabs::ThreadPool pool(1);
+    int sum = 0;
+    pool.parallel_for(10, [&](std::size_t i) { sum += static_cast<int>(i); });
+    CHECK(sum == 45);
+}
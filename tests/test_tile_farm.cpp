@@ -0,0 +1,168 @@
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "core/Camera.hpp"
+#include "core/Scene.hpp"
+#include "entities/Plane.hpp"
+#include "entities/Sphere.hpp"
+#include "materials/Lambertian.hpp"
+#include "materials/Metal.hpp"
+#include "renderer/Renderer.hpp"
+#include "renderer/TileFarm.hpp"
+#include "utils/Socket.hpp"
+
+namespace {
+
+struct FarmScene {
+    Scene scene;
+    Camera camera;
+    io::ImageDTO image;
+
+    FarmScene() {
+        scene.add(std::make_shared<Plane>(Point3(0, 0, 0), Vec3(0, 1, 0)),
+                  std::make_shared<Lambertian>(Color(0.8f, 0.8f, 0.0f)));
+        scene.add(std::make_shared<Sphere>(Point3(0, 0.5f, -2), 0.5f),
+                  std::make_shared<Metal>(Color(0.9f, 0.9f, 0.9f), 0.3f));
+        image.width = 50;
+        image.height = 30;
+        image.samples = 2;
+        image.max_depth = 3;
+        image.threads = 1;
+        camera = Camera(Point3(0, 1, 1), Point3(0, 0.5f, -2), Vec3(0, 1, 0), 60.0f,
+                        float(image.width) / float(image.height));
+    }
+
+    Image reference() const {
+        raylabs::Renderer renderer(scene, camera, image, nullptr);
+        renderer.render_frame();
+        return renderer.image();
+    }
+};
+
+bool same_pixels(const Image& a, const Image& b) {
+    if (a.Width() != b.Width() || a.Height() != b.Height())
+        return false;
+    for (unsigned y = 0; y < a.Height(); ++y) {
+        for (unsigned x = 0; x < a.Width(); ++x) {
+            Color ca = a.GetPixel(x, y);
+            Color cb = b.GetPixel(x, y);
+            if (ca.R() != cb.R() || ca.G() != cb.G() || ca.B() != cb.B())
+                return false;
+        }
+    }
+    return true;
+}
+
+raylabs::FarmOptions small_tiles() {
+    raylabs::FarmOptions options;
+    options.tile_size = 16;
+    options.tile_timeout_ms = 5000;
+    return options;
+}
+
+}  // namespace
+
+TEST_CASE("Tile farm assembles the same image as a local render") {
+    FarmScene fs;
+    raylabs::Renderer coordinator(fs.scene, fs.camera, fs.image, nullptr);
+    raylabs::TileFarm farm(coordinator, small_tiles());
+    const int port = farm.port();
+
+    auto frame = std::async(std::launch::async, [&] { return farm.run(); });
+    auto worker = [&] {
+        raylabs::Renderer renderer(fs.scene, fs.camera, fs.image, nullptr);
+        raylabs::run_farm_worker("127.0.0.1", port, renderer, 1);
+    };
+    std::thread w1(worker), w2(worker);
+    Image image = frame.get();
+    w1.join();
+    w2.join();
+
+    CHECK(same_pixels(image, fs.reference()));
+    CHECK(farm.requeued_tiles() == 0);
+}
+
+TEST_CASE("Tile farm re-queues the tile of a worker that disconnects") {
+    FarmScene fs;
+    raylabs::Renderer coordinator(fs.scene, fs.camera, fs.image, nullptr);
+    raylabs::TileFarm farm(coordinator, small_tiles());
+    const int port = farm.port();
+    auto frame = std::async(std::launch::async, [&] { return farm.run(); });
+
+    // Says hello, takes a tile and dies without answering
+    {
+        raylabs::Socket conn = raylabs::Socket::connect("127.0.0.1", port);
+        const std::uint64_t digest = raylabs::scene_digest(fs.scene, fs.camera);
+        const std::uint32_t hello[] = {1u,  0x4d464c52u, 2u, 50u, 30u, 2u, 3u,
+                                       static_cast<std::uint32_t>(digest),
+                                       static_cast<std::uint32_t>(digest >> 32)};
+        conn.send_all(hello, sizeof(hello));
+        std::uint32_t tile[6];
+        conn.recv_all(tile, sizeof(tile), 5000);
+        CHECK(tile[0] == 2u);
+    }
+
+    raylabs::Renderer renderer(fs.scene, fs.camera, fs.image, nullptr);
+    raylabs::run_farm_worker("127.0.0.1", port, renderer, 2);
+    Image image = frame.get();
+
+    CHECK(farm.requeued_tiles() == 1);
+    CHECK(same_pixels(image, fs.reference()));
+}
+
+TEST_CASE("Tile farm rejects mismatched workers and falls back to local rendering") {
+    FarmScene fs;
+    raylabs::Renderer coordinator(fs.scene, fs.camera, fs.image, nullptr);
+    raylabs::FarmOptions options = small_tiles();
+    options.idle_timeout_ms = 200;
+    raylabs::TileFarm farm(coordinator, options);
+    const int port = farm.port();
+    auto frame = std::async(std::launch::async, [&] { return farm.run(); });
+
+    io::ImageDTO other = fs.image;
+    other.samples = 5;
+    raylabs::Renderer mismatched(fs.scene, fs.camera, other, nullptr);
+    CHECK_THROWS_AS(raylabs::run_farm_worker("127.0.0.1", port, mismatched, 1),
+                    std::runtime_error);
+
+    // Same image settings, another scene
+    FarmScene moved;
+    moved.scene.entities[1].shape->transform(raylabs::Transform::translate(Vec3(0, 0.1f, 0)));
+    raylabs::Renderer wrong_scene(moved.scene, moved.camera, fs.image, nullptr);
+    CHECK_THROWS_AS(raylabs::run_farm_worker("127.0.0.1", port, wrong_scene, 1),
+                    std::runtime_error);
+
+    CHECK(same_pixels(frame.get(), fs.reference()));
+}
+
+TEST_CASE("Tile farm renders with forked local worker processes") {
+    FarmScene fs;
+    raylabs::Renderer coordinator(fs.scene, fs.camera, fs.image, nullptr);
+    raylabs::TileFarm farm(coordinator, small_tiles());
+    farm.spawn_local_workers(2, 1);
+    CHECK(same_pixels(farm.run(), fs.reference()));
+}
+
+TEST_CASE("Scene digest tells scenes apart") {
+    const FarmScene a, b;
+    const std::uint64_t digest = raylabs::scene_digest(a.scene, a.camera);
+    CHECK(raylabs::scene_digest(b.scene, b.camera) == digest);
+
+    FarmScene plane;
+    plane.scene.entities[0].shape->transform(raylabs::Transform::translate(Vec3(0, 0.5f, 0)));
+    CHECK(raylabs::scene_digest(plane.scene, plane.camera) != digest);
+    FarmScene color;
+    color.scene.entities[0].material = std::make_shared<Lambertian>(Color(0.8f, 0.1f, 0.0f));
+    CHECK(raylabs::scene_digest(color.scene, color.camera) != digest);
+    FarmScene light;
+    light.scene.lights.push_back({Point3(0, 3, 0), Color(1, 1, 1)});
+    CHECK(raylabs::scene_digest(light.scene, light.camera) != digest);
+    FarmScene view;
+    view.camera.fov = 50.0f;
+    CHECK(raylabs::scene_digest(view.scene, view.camera) != digest);
+}
@@ -1,4 +1,5 @@
 #include <doctest/doctest.h>
+#include "math/Transform.hpp"
 #include "math/Vec3.hpp"
 
 TEST_CASE("Vec3 construction") {
@@ -103,3 +104,19 @@ TEST_CASE("Custom sqrt function") {
     CHECK(raylabs::sqrt(25.0f) == doctest::Approx(5.0f));
     CHECK(raylabs::sqrt(2.0f) == doctest::Approx(1.414213f).epsilon(0.001));
 }
+
+TEST_CASE("Transform rotates about a pivot and composes") {
+    const float half_pi = 1.57079632679f;
+    const auto t = raylabs::Transform::rotate_about(Point3(1, 0, 0), Vec3(0, 1, 0), half_pi);
+    const Point3 p = t.point(Point3(2, 5, 0));
+    CHECK(p.x == doctest::Approx(1.0f));
+    CHECK(p.y == doctest::Approx(5.0f));
+    CHECK(p.z == doctest::Approx(-1.0f));
+
+    const auto scaled = raylabs::Transform::translate(Vec3(0, 1, 0)) *
+                        raylabs::Transform::uniform_scale(2.0f);
+    const Point3 q = scaled.point(Point3(1, 1, 1));
+    CHECK(q.x == doctest::Approx(2.0f));
+    CHECK(q.y == doctest::Approx(3.0f));
+    CHECK(scaled.vector(Vec3(0, 0, 1)).z == doctest::Approx(2.0f));
+}